@@ -0,0 +1,98 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+//
+/// \file Measures the time of writing theta CFAs.
+///
+/// For each size N given on the command line (2000, 20000 and 200000 by
+/// default), a chain automaton of N transitions over N/10 variables is built
+/// and written into a null stream. Only the writing is timed.
+//
+//===----------------------------------------------------------------------===//
+#include "../tools/gazer-theta/lib/ThetaCfaGenerator.h"
+
+#include "gazer/Core/Expr/ExprBuilder.h"
+#include "gazer/Support/Stopwatch.h"
+
+#include <llvm/ADT/StringExtras.h>
+#include <llvm/Support/raw_ostream.h>
+
+using namespace gazer;
+
+static void buildChain(AutomataSystem& system, ExprBuilder& builder, unsigned size)
+{
+    Cfa* cfa = system.createCfa("main");
+    system.setMainAutomaton(cfa);
+
+    auto& intTy = IntType::Get(system.getContext());
+
+    std::vector<Variable*> variables;
+    unsigned numVariables = std::max(size / 10, 1u);
+    for (unsigned i = 0; i < numVariables; ++i) {
+        variables.push_back(cfa->createLocal("x" + std::to_string(i), intTy));
+    }
+
+    Location* previous = cfa->getEntry();
+    for (unsigned i = 0; i < size; ++i) {
+        Location* next = i + 1 == size ? cfa->getExit() : cfa->createLocation();
+        Variable* lhs = variables[i % numVariables];
+        Variable* rhs = variables[(i + 1) % numVariables];
+
+        cfa->createAssignTransition(previous, next, builder.Lt(rhs->getRefExpr(), builder.IntLit(i)), {
+            { lhs, builder.Add(rhs->getRefExpr(), builder.IntLit(1)) }
+        });
+        previous = next;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    std::vector<unsigned> sizes;
+    for (int i = 1; i < argc; ++i) {
+        unsigned size;
+        if (!llvm::to_integer(argv[i], size) || size == 0) {
+            llvm::errs() << "ERROR: invalid size '" << argv[i] << "'\n";
+            return 1;
+        }
+        sizes.push_back(size);
+    }
+
+    if (sizes.empty()) {
+        sizes = { 2000, 20000, 200000 };
+    }
+
+    for (unsigned size : sizes) {
+        GazerContext context;
+        AutomataSystem system(context);
+        auto builder = CreateExprBuilder(context);
+        buildChain(system, *builder, size);
+
+        theta::ThetaNameMapping names;
+        theta::ThetaCfaGenerator generator{system};
+
+        Stopwatch<> timer;
+        timer.start();
+        generator.write(llvm::nulls(), names);
+        timer.stop();
+
+        llvm::outs() << "transitions: " << size << ", time: ";
+        timer.format(llvm::outs(), "ms");
+        llvm::outs() << "\n";
+    }
+
+    return 0;
+}
@@ -0,0 +1,121 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+//
+/// \file This file defines a bidirectional mapping between objects and
+/// unique, sanitized names, to be used by emitters of textual formats.
+//
+//===----------------------------------------------------------------------===//
+#ifndef GAZER_ADT_NAMETABLE_H
+#define GAZER_ADT_NAMETABLE_H
+
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/StringExtras.h>
+#include <llvm/ADT/StringMap.h>
+
+#include <bitset>
+#include <string>
+
+namespace gazer
+{
+
+/// Assigns a unique name to each key, derived from a client-supplied base name.
+///
+/// Characters of the base name which are not alphanumeric and not listed
+/// as valid are replaced with an underscore. If the resulting name is already
+/// taken or reserved, it receives the smallest numeric suffix not tried yet
+/// for the same base name, thus repeated clashes do not restart the search.
+/// Both directions of the mapping are hash lookups.
+///
+/// \tparam KeyT A DenseMap-compatible key type, whose default value
+///     is never used as a key (e.g. a pointer).
+template<class KeyT>
+class NameTable
+{
+public:
+    explicit NameTable(llvm::StringRef validChars = "_")
+    {
+        for (unsigned c = 0; c < 256; ++c) {
+            mValidChars[c] = llvm::isAlnum(static_cast<char>(c));
+        }
+
+        for (char c : validChars) {
+            mValidChars[static_cast<unsigned char>(c)] = true;
+        }
+    }
+
+    NameTable(const NameTable&) = delete;
+    NameTable& operator=(const NameTable&) = delete;
+
+    NameTable(NameTable&&) = default;
+    NameTable& operator=(NameTable&&) = default;
+
+    /// Prevents \p name from being assigned to any key.
+    void reserve(llvm::StringRef name) { mKeys.try_emplace(name, KeyT{}); }
+
+    /// Returns the name of \p key, creating a new one from \p baseName
+    /// if \p key does not have a name yet.
+    llvm::StringRef getOrCreateName(KeyT key, llvm::StringRef baseName)
+    {
+        auto it = mNames.find(key);
+        if (it != mNames.end()) {
+            return it->second;
+        }
+
+        mBuffer.assign(baseName.begin(), baseName.end());
+        for (char& c : mBuffer) {
+            if (!mValidChars[static_cast<unsigned char>(c)]) {
+                c = '_';
+            }
+        }
+
+        if (mKeys.count(mBuffer) != 0) {
+            unsigned& suffix = mNextSuffix[mBuffer];
+            size_t baseLength = mBuffer.size();
+            do {
+                mBuffer.resize(baseLength);
+                mBuffer += llvm::utostr(suffix++);
+            } while (mKeys.count(mBuffer) != 0);
+        }
+
+        // The keys of a StringMap have a stable address, so they are
+        // referenced by the reverse mapping.
+        llvm::StringRef name = mKeys.try_emplace(mBuffer, key).first->getKey();
+        mNames[key] = name;
+
+        return name;
+    }
+
+    /// Returns the name of \p key, or an empty string if it has none.
+    llvm::StringRef getName(KeyT key) const { return mNames.lookup(key); }
+
+    /// Returns the key named \p name, or the default value of KeyT if there is none.
+    KeyT lookup(llvm::StringRef name) const { return mKeys.lookup(name); }
+
+    size_t size() const { return mNames.size(); }
+
+private:
+    std::bitset<256> mValidChars;
+    llvm::StringMap<KeyT> mKeys;
+    llvm::DenseMap<KeyT, llvm::StringRef> mNames;
+    llvm::StringMap<unsigned> mNextSuffix;
+    std::string mBuffer;
+};
+
+} // end namespace gazer
+
+#endif
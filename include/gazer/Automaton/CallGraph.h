@@ -45,14 +45,8 @@ public:
             : mCfa(cfa)
         {}
 
-        void addCall(CallTransition* call, Node* node)
-        {
-            assert(call != nullptr);
-            assert(node != nullptr);
-
-            mCallsToOthers.emplace_back(call, node);
-            node->mCallsToThis.emplace_back(call);
-        }
+        void addCall(CallTransition* call, Node* node);
+        void removeCall(CallTransition* call);
 
         Cfa* getCfa() const { return mCfa; }
 
@@ -64,6 +58,10 @@ public:
         Cfa* mCfa;
         std::vector<CallSite> mCallsToOthers;
         std::vector<CallTransition*> mCallsToThis;
+
+        // The number of recursive calls, and those of them which are not tail calls.
+        unsigned mNumSelfCalls = 0;
+        unsigned mNumNonTailSelfCalls = 0;
     };
 public:
     explicit CallGraph(AutomataSystem& system);
@@ -75,6 +73,12 @@ public:
     /// the procedure directly before the exit.
     bool isTailRecursive(Cfa* cfa);
 
+    /// Updates the graph after \p call was inserted into its automaton.
+    void addCall(CallTransition* call);
+
+    /// Updates the graph before \p call is removed from its automaton.
+    void removeCall(CallTransition* call);
+
     AutomataSystem& getSystem() const { return mSystem; };
 
     Node* lookupNode(Cfa* cfa);
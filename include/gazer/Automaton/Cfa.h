@@ -114,6 +114,14 @@ public:
         mAssignments.push_back(assignment);
     }
 
+    template<class Predicate>
+    void removeAssignmentsIf(Predicate p) {
+        mAssignments.erase(
+            std::remove_if(mAssignments.begin(), mAssignments.end(), p),
+            mAssignments.end()
+        );
+    }
+
     static bool classof(const Transition* edge) {
         return edge->getKind() == Edge_Assign;
     }
@@ -217,6 +225,10 @@ public:
     /// Marks an already existing variable as an output.
     void addOutput(Variable* variable);
 
+    /// Adds a variable of another automaton in the same system to the locals
+    /// of this automaton, without creating a copy of it.
+    void addLocal(Variable* variable);
+
     void addErrorCode(Location* location, ExprPtr errorCodeExpr);
     ExprPtr getErrorFieldExpr(Location* location);
 
@@ -292,6 +304,9 @@ public:
     void printDeclaration(llvm::raw_ostream& os) const;
 
     //------------------------------ Deletion -------------------------------//
+    /// Removes the locations which are not reachable from the entry. The exit
+    /// location is always kept: if it is unreachable, it is connected to the
+    /// entry with an 'assume false' transition.
     void removeUnreachableLocations();
 
     template<class Predicate>
@@ -0,0 +1,227 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file This file declares a non-relational abstract interpretation framework
+/// for control flow automata, along with its value domains.
+///
+//===----------------------------------------------------------------------===//
+#ifndef GAZER_AUTOMATON_CFAABSTRACTINTERPRETATION_H
+#define GAZER_AUTOMATON_CFAABSTRACTINTERPRETATION_H
+
+#include "gazer/Automaton/Cfa.h"
+
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/IR/ConstantRange.h>
+#include <llvm/Support/KnownBits.h>
+
+#include <optional>
+
+namespace gazer
+{
+
+class ExprBuilder;
+
+//===----------------------------------------------------------------------===//
+// Value domains
+//
+// A domain describes the possible values of a single Boolean or bit-vector
+// variable. Booleans are represented as 1-bit values. Each domain class must
+// provide the following static members:
+//
+//  - ValueTy: the type of abstract values.
+//  - getTop(width), getConstant(value): the value with no information and
+//    the value representing a single constant.
+//  - isBottom(value), isTop(value), getSingleElement(value): queries for the
+//    empty value, the value with no information and for single constants.
+//  - equals, join, meet, widen: lattice operations. Widening must ensure
+//    that each ascending chain of widened values is finite.
+//  - transfer(expr, operands): the abstract value of a bit-vector operation
+//    or comparison, given the values of its operands.
+//  - refine(kind, lhs, rhs): the values of 'lhs' for which the comparison
+//    'lhs kind rhs' may hold.
+//===----------------------------------------------------------------------===//
+
+/// Wrapped intervals, represented by llvm::ConstantRange.
+/// Constants are the single-element intervals of this domain.
+class IntervalDomain
+{
+public:
+    using ValueTy = llvm::ConstantRange;
+
+    static ValueTy getTop(unsigned width) { return llvm::ConstantRange::getFull(width); }
+    static ValueTy getConstant(const llvm::APInt& value) { return llvm::ConstantRange(value); }
+
+    static bool isBottom(const ValueTy& value) { return value.isEmptySet(); }
+    static bool isTop(const ValueTy& value) { return value.isFullSet(); }
+    static std::optional<llvm::APInt> getSingleElement(const ValueTy& value);
+
+    static bool equals(const ValueTy& left, const ValueTy& right) { return left == right; }
+    static ValueTy join(const ValueTy& left, const ValueTy& right) { return left.unionWith(right); }
+    static ValueTy meet(const ValueTy& left, const ValueTy& right) { return left.intersectWith(right); }
+
+    /// Keeps the bound of \p previous which did not change, and moves the other
+    /// bound to the unsigned extremum.
+    static ValueTy widen(const ValueTy& previous, const ValueTy& next);
+
+    static ValueTy transfer(const ExprRef<NonNullaryExpr>& expr, llvm::ArrayRef<ValueTy> operands);
+    static ValueTy refine(Expr::ExprKind kind, const ValueTy& lhs, const ValueTy& rhs);
+};
+
+/// Known zero and one bits, represented by llvm::KnownBits.
+class KnownBitsDomain
+{
+public:
+    using ValueTy = llvm::KnownBits;
+
+    static ValueTy getTop(unsigned width) { return llvm::KnownBits(width); }
+    static ValueTy getConstant(const llvm::APInt& value);
+
+    static bool isBottom(const ValueTy& value) { return value.hasConflict(); }
+    static bool isTop(const ValueTy& value) { return (value.Zero | value.One).isNullValue(); }
+    static std::optional<llvm::APInt> getSingleElement(const ValueTy& value);
+
+    static bool equals(const ValueTy& left, const ValueTy& right) {
+        return left.Zero == right.Zero && left.One == right.One;
+    }
+    static ValueTy join(const ValueTy& left, const ValueTy& right);
+    static ValueTy meet(const ValueTy& left, const ValueTy& right);
+
+    /// The domain has a finite height, thus widening is the same as joining.
+    static ValueTy widen(const ValueTy& previous, const ValueTy& next) { return join(previous, next); }
+
+    static ValueTy transfer(const ExprRef<NonNullaryExpr>& expr, llvm::ArrayRef<ValueTy> operands);
+    static ValueTy refine(Expr::ExprKind kind, const ValueTy& lhs, const ValueTy& rhs);
+};
+
+//===----------------------------------------------------------------------===//
+/// The abstract state of a location: the values of the tracked variables.
+/// Variables which are not present in the state may take any value.
+template<class Domain>
+class AbstractState
+{
+public:
+    using ValueTy = typename Domain::ValueTy;
+
+    static AbstractState getBottom()
+    {
+        AbstractState state;
+        state.mIsBottom = true;
+        return state;
+    }
+
+    bool isBottom() const { return mIsBottom; }
+
+    std::optional<ValueTy> lookup(Variable* variable) const
+    {
+        auto it = mValues.find(variable);
+        if (it == mValues.end()) {
+            return std::nullopt;
+        }
+
+        return it->second;
+    }
+
+    /// Sets the value of \p variable. If \p value is bottom, the whole state becomes bottom.
+    void set(Variable* variable, const ValueTy& value);
+
+    /// Restricts the value of \p variable to \p value.
+    void refine(Variable* variable, const ValueTy& value);
+
+    void forget(Variable* variable) { mValues.erase(variable); }
+
+    AbstractState join(const AbstractState& other) const;
+    AbstractState widen(const AbstractState& next) const;
+    bool equals(const AbstractState& other) const;
+
+    const llvm::DenseMap<Variable*, ValueTy>& values() const { return mValues; }
+
+private:
+    bool mIsBottom = false;
+    llvm::DenseMap<Variable*, ValueTy> mValues;
+};
+
+template<class Domain>
+class AbstractExprEvaluator;
+
+/// Over-approximates the values of the variables of an automaton at each of
+/// its locations, using the non-relational value domain \p Domain.
+///
+/// The analysis is intraprocedural: inputs, uninitialized locals and the outputs
+/// of called automata may take any value. Only Boolean and bit-vector variables
+/// are tracked. Guards restrict the values of the variables they compare to
+/// other expressions. The states are computed by a worklist iteration over the
+/// locations in reverse post-order. The states of loop heads are widened after
+/// they have grown \p widenDelay times.
+template<class Domain>
+class CfaAbstractInterpreter
+{
+public:
+    using ValueTy = typename Domain::ValueTy;
+    using StateTy = AbstractState<Domain>;
+
+    explicit CfaAbstractInterpreter(Cfa& cfa, unsigned widenDelay = 2);
+
+    CfaAbstractInterpreter(const CfaAbstractInterpreter&) = delete;
+    CfaAbstractInterpreter& operator=(const CfaAbstractInterpreter&) = delete;
+
+    ~CfaAbstractInterpreter();
+
+    bool isReachable(Location* location) const { return mStates.count(location) != 0; }
+
+    /// Returns the state of \p location, which must be reachable.
+    const StateTy& getState(Location* location) const;
+
+    /// Returns the state of the source of \p edge restricted by its guard,
+    /// that is, the state in which its assignments and arguments are evaluated.
+    /// Returns bottom if \p edge can never be taken.
+    StateTy getGuardedState(Transition* edge);
+
+    /// Returns the abstract value of \p expr in \p state, or an empty optional
+    /// if \p expr is not of a tracked type or nothing is known about it.
+    std::optional<ValueTy> evaluate(const ExprPtr& expr, const StateTy& state);
+
+private:
+    void run(unsigned widenDelay);
+
+    StateTy assume(const ExprPtr& guard, const StateTy& state);
+    void refine(const ExprPtr& expr, bool positive, StateTy& state);
+    StateTy getPostState(Transition* edge, const StateTy& state);
+
+private:
+    Cfa& mCfa;
+    std::unique_ptr<AbstractExprEvaluator<Domain>> mEvaluator;
+    llvm::DenseMap<Location*, StateTy> mStates;
+};
+
+extern template class AbstractState<IntervalDomain>;
+extern template class AbstractState<KnownBitsDomain>;
+extern template class CfaAbstractInterpreter<IntervalDomain>;
+extern template class CfaAbstractInterpreter<KnownBitsDomain>;
+
+/// Simplifies \p cfa using the invariants computed in the interval and
+/// known bits domains. Transitions which can never be taken are removed,
+/// along with the locations (including error locations) which become
+/// unreachable. Variables with a constant value are replaced by their
+/// value in guards, assignments, call arguments and error codes.
+///
+/// \return True if \p cfa was changed.
+bool SimplifyCfaWithInvariants(Cfa& cfa, ExprBuilder& builder);
+
+} // end namespace gazer
+
+#endif
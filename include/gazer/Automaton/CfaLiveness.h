@@ -0,0 +1,74 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file This file declares a live variable analysis for control flow automata.
+///
+//===----------------------------------------------------------------------===//
+#ifndef GAZER_AUTOMATON_CFALIVENESS_H
+#define GAZER_AUTOMATON_CFALIVENESS_H
+
+#include "gazer/Automaton/Cfa.h"
+
+#include <llvm/ADT/BitVector.h>
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/SmallVector.h>
+
+namespace gazer
+{
+
+/// Computes the variables which are live at the locations of an automaton,
+/// that is, the variables whose current value may be read on a path starting
+/// from the location before they are assigned again.
+///
+/// Transitions read the variables of their guard and of their assigned values
+/// or input arguments, and assign their assigned variables or output arguments.
+/// The outputs are read at the exit location and the variables of the error
+/// code are read at each error location.
+class CfaLiveness
+{
+public:
+    explicit CfaLiveness(Cfa& cfa);
+
+    CfaLiveness(const CfaLiveness&) = delete;
+    CfaLiveness& operator=(const CfaLiveness&) = delete;
+
+    /// Returns true if \p variable is live at the beginning of \p location.
+    /// All variables are considered live at locations which are not
+    /// reachable from the entry location.
+    bool isLiveAt(Variable* variable, Location* location) const;
+
+    /// Returns true if \p variable is live at any location reachable from
+    /// the entry. Variables which are not are never read, their assignments
+    /// can be removed.
+    bool isLiveAnywhere(Variable* variable) const;
+
+    /// Appends the variables live at the beginning of \p location to \p result.
+    /// Returns false without changing \p result if \p location is not reachable
+    /// from the entry location.
+    bool getLiveVariables(Location* location, llvm::SmallVectorImpl<Variable*>& result) const;
+
+private:
+    std::vector<Variable*> mVariables;
+    llvm::DenseMap<Variable*, unsigned> mVariableNumbers;
+    llvm::DenseMap<Location*, llvm::BitVector> mLiveVariables;
+    llvm::BitVector mLiveAnywhere;
+};
+
+} // end namespace gazer
+
+#endif
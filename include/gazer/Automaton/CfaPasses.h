@@ -0,0 +1,139 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file This file declares a pass manager for transformations on control
+/// flow automata, along with the simplification passes.
+///
+//===----------------------------------------------------------------------===//
+#ifndef GAZER_AUTOMATON_CFAPASSES_H
+#define GAZER_AUTOMATON_CFAPASSES_H
+
+#include "gazer/Automaton/Cfa.h"
+
+#include <llvm/ADT/StringRef.h>
+
+#include <memory>
+
+namespace gazer
+{
+
+class ExprBuilder;
+
+/// A transformation of a single automaton.
+///
+/// Passes must keep the automaton a connected graph with its entry and
+/// exit locations, and they must not change which error codes can be
+/// reached from the entry location.
+class CfaPass
+{
+public:
+    explicit CfaPass(llvm::StringRef name)
+        : mName(name)
+    {}
+
+    CfaPass(const CfaPass&) = delete;
+    CfaPass& operator=(const CfaPass&) = delete;
+
+    llvm::StringRef getName() const { return mName; }
+
+    /// Transforms \p cfa. Returns true if \p cfa was changed.
+    virtual bool run(Cfa& cfa) = 0;
+
+    virtual ~CfaPass() = default;
+
+private:
+    std::string mName;
+};
+
+/// Runs a sequence of passes on each automaton of a system, and counts
+/// the locations, transitions and locals removed by each pass.
+class CfaPassManager
+{
+    struct PassInfo
+    {
+        std::unique_ptr<CfaPass> pass;
+        unsigned numRuns = 0;
+        unsigned numChanged = 0;
+        int64_t removedLocations = 0;
+        int64_t removedTransitions = 0;
+        int64_t removedLocals = 0;
+    };
+public:
+    CfaPassManager() = default;
+
+    CfaPassManager(const CfaPassManager&) = delete;
+    CfaPassManager& operator=(const CfaPassManager&) = delete;
+
+    void addPass(std::unique_ptr<CfaPass> pass);
+
+    /// Runs the passes in the order they were added on each automaton of \p system.
+    /// Returns true if any of the automata was changed.
+    bool run(AutomataSystem& system);
+
+    /// Runs the passes in the order they were added on \p cfa.
+    bool run(Cfa& cfa);
+
+    void printStats(llvm::raw_ostream& os) const;
+
+private:
+    std::vector<PassInfo> mPasses;
+    size_t mNumBeginLocs = 0;
+    size_t mNumEndLocs = 0;
+    size_t mNumBeginTransitions = 0;
+    size_t mNumEndTransitions = 0;
+    size_t mNumBeginLocals = 0;
+    size_t mNumEndLocals = 0;
+};
+
+//===----------------------------------------------------------------------===//
+// Simplification passes
+//===----------------------------------------------------------------------===//
+
+/// Removes the transitions and locations which are infeasible according to
+/// the invariants found by abstract interpretation, see SimplifyCfaWithInvariants.
+std::unique_ptr<CfaPass> createInvariantPruningPass(ExprBuilder& builder);
+
+/// Removes the locations from which neither the exit nor an error location
+/// is reachable, and bypasses the locations whose only outgoing transition
+/// (or only incoming transition) has no guard and no assignments.
+std::unique_ptr<CfaPass> createLocationCompactionPass(ExprBuilder& builder);
+
+/// Composes the two assign transitions of locations with a single incoming
+/// and a single outgoing transition into one transition. The variables assigned
+/// by the first transition are substituted by their values in the second one,
+/// and their assignments are only kept if they are still live afterwards.
+/// Transitions are not composed if that would grow the tree size of their
+/// expressions considerably.
+std::unique_ptr<CfaPass> createSequentialMergePass(ExprBuilder& builder);
+
+/// Merges the assign transitions with the same source, target and assignments
+/// into a single transition, guarded by the disjunction of their guards.
+std::unique_ptr<CfaPass> createParallelMergePass(ExprBuilder& builder);
+
+/// Removes the assignments to variables which are not live at the target of
+/// their transition, along with assignments of a variable to itself, and the
+/// locals which are not referenced anymore afterwards.
+std::unique_ptr<CfaPass> createDeadAssignmentEliminationPass();
+
+/// Collapses the loop-free regions between cut points into single transitions,
+/// see EncodeLargeBlocks.
+std::unique_ptr<CfaPass> createLargeBlockEncodingPass(ExprBuilder& builder);
+
+} // end namespace gazer
+
+#endif
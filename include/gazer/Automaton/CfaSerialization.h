@@ -0,0 +1,66 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+//
+/// \file This file declares functions for writing automata systems into
+/// a compact binary format and reading them back.
+///
+/// The format consists of a header (magic and version number) followed by
+/// the following sections, each of them starting with its number of records:
+///     - automata names,
+///     - types,
+///     - variables, each of them either belonging to an automaton as an input
+///       or local, or being a free variable of the context,
+///     - expressions, in post-order, each distinct node written exactly once,
+///     - automata outputs,
+///     - automata bodies: locations, error codes and transitions.
+///
+/// Records refer to each other by their index within their section. Numbers
+/// are LEB128-encoded. The reader decodes the input buffer in a single pass,
+/// without copying it, thus it works efficiently on memory-mapped files.
+//
+//===----------------------------------------------------------------------===//
+#ifndef GAZER_AUTOMATON_CFASERIALIZATION_H
+#define GAZER_AUTOMATON_CFASERIALIZATION_H
+
+#include "gazer/Automaton/Cfa.h"
+
+#include <llvm/Support/MemoryBuffer.h>
+
+namespace gazer
+{
+
+/// The version of the binary format. It must be increased on each
+/// incompatible change, files of other versions are rejected by the reader.
+constexpr unsigned CfaSerializationVersion = 2;
+
+/// Writes \p system into \p os in gazer's binary model format.
+void WriteAutomataSystem(AutomataSystem& system, llvm::raw_ostream& os);
+
+/// Reads an automata system written by WriteAutomataSystem from \p buffer,
+/// creating its types, variables and expressions in \p context.
+/// Location identifiers are not preserved, locations are renumbered in the
+/// order of their creation.
+///
+/// \return The automata system, or nullptr if the buffer is malformed.
+///     In the latter case, \p errorMessage describes the problem.
+std::unique_ptr<AutomataSystem> ReadAutomataSystem(
+    llvm::MemoryBufferRef buffer, GazerContext& context, std::string& errorMessage);
+
+} // end namespace gazer
+
+#endif
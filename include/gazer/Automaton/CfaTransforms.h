@@ -30,6 +30,8 @@
 namespace gazer
 {
 
+class ExprBuilder;
+
 //===----------------------------------------------------------------------===//
 /// Creates a clone of the given CFA with the given name.
 /// Note that the clone shall be shallow one: automata called by the source
@@ -52,6 +54,17 @@ struct RecursiveToCyclicResult
 /// transformed into the input format of a different verifier.
 RecursiveToCyclicResult TransformRecursiveToCyclic(Cfa* cfa);
 
+//===----------------------------------------------------------------------===//
+/// Collapses the loop-free regions of \p cfa between cut points into single
+/// transitions. Cut points are the entry, exit and error locations, loop heads
+/// and the endpoints of call transitions. The transition of a region from one
+/// cut point to another is guarded by the disjunction of its path conditions,
+/// and assigns the values of the variables live at the target, selected by the
+/// path they were computed on.
+///
+/// \return True if \p cfa was changed.
+bool EncodeLargeBlocks(Cfa& cfa, ExprBuilder& builder);
+
 //===----------------------------------------------------------------------===//
 struct InlineResult
 {
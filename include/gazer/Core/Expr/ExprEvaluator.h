@@ -22,6 +22,10 @@
 #include "gazer/Core/Expr/ExprBuilder.h"
 #include "gazer/Core/Valuation.h"
 
+#include <llvm/ADT/ArrayRef.h>
+
+#include <unordered_map>
+
 namespace gazer
 {
 
@@ -44,9 +48,22 @@ public:
     }
 
 protected:
+    using ResultCacheT = std::unordered_map<ExprPtr, ExprRef<AtomicExpr>>;
+
     virtual ExprRef<AtomicExpr> getVariableValue(Variable& variable) = 0;
 
+    /// Memoizes the results of all evaluated non-nullary subexpressions
+    /// in \p cache, or disables memoization if \p cache is null.
+    void setResultCache(ResultCacheT* cache) { mResultCache = cache; }
+
 private:
+    bool shouldSkip(const ExprPtr& expr, ExprRef<AtomicExpr>* ret);
+    void handleResult(const ExprPtr& expr, ExprRef<AtomicExpr>& ret);
+
+    /// Evaluates the operands of Boolean connectives and selects lazily:
+    /// operands which cannot change the result are never evaluated.
+    size_t getNextOperand(const ExprRef<NonNullaryExpr>& expr, size_t i);
+
     ExprRef<AtomicExpr> visitExpr(const ExprPtr& expr);
 
     // Nullary
@@ -126,6 +143,9 @@ private:
     // Arrays
     ExprRef<AtomicExpr> visitArrayRead(const ExprRef<ArrayReadExpr>& expr);
     ExprRef<AtomicExpr> visitArrayWrite(const ExprRef<ArrayWriteExpr>& expr);
+
+private:
+    ResultCacheT* mResultCache = nullptr;
 };
 
 /// Evaluates expressions based on a Valuation object
@@ -143,6 +163,45 @@ private:
     const Valuation& mValuation;
 };
 
+/// Evaluates expressions against a fixed model, memoizing the value of each
+/// variable and evaluated subexpression. Clients which evaluate many related
+/// expressions against the same model (e.g. trace builders) should use a
+/// single instance, so shared subexpressions are only evaluated once and
+/// the walker stack is reused between queries.
+///
+/// If the values in the underlying model change, clients must call
+/// invalidate() before further evaluations.
+class CachingExprEvaluator : public ExprEvaluatorBase
+{
+public:
+    explicit CachingExprEvaluator(ExprEvaluator& model)
+        : mModel(model)
+    {
+        this->setResultCache(&mResults);
+    }
+
+    CachingExprEvaluator(const CachingExprEvaluator&) = delete;
+    CachingExprEvaluator& operator=(const CachingExprEvaluator&) = delete;
+
+    /// Evaluates each variable of \p variables, placing their values into
+    /// \p values in the same order. Variables not present in the model are
+    /// evaluated to undef.
+    void evaluateAll(
+        llvm::ArrayRef<Variable*> variables,
+        llvm::SmallVectorImpl<ExprRef<AtomicExpr>>& values);
+
+    /// Drops all memoized values.
+    void invalidate();
+
+protected:
+    ExprRef<AtomicExpr> getVariableValue(Variable& variable) override;
+
+private:
+    ExprEvaluator& mModel;
+    llvm::DenseMap<const Variable*, ExprRef<AtomicExpr>> mVariables;
+    ResultCacheT mResults;
+};
+
 }
 
 #endif
\ No newline at end of file
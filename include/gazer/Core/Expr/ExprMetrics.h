@@ -0,0 +1,122 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+//
+/// \file This file declares utilities for measuring the size and shape
+/// of expression DAGs.
+//
+//===----------------------------------------------------------------------===//
+#ifndef GAZER_CORE_EXPR_EXPRMETRICS_H
+#define GAZER_CORE_EXPR_EXPRMETRICS_H
+
+#include "gazer/Core/Expr.h"
+
+#include <llvm/ADT/ArrayRef.h>
+#include <llvm/ADT/DenseMap.h>
+
+#include <array>
+#include <vector>
+
+namespace gazer
+{
+
+/// Size and shape statistics of one or more expressions.
+///
+/// All metrics are calculated in a single iterative post-order traversal,
+/// visiting each distinct node of the DAG once. Per-node results are stored
+/// in a vector indexed by the discovery number of the node, thus the metrics
+/// of any visited subexpression are available in constant time.
+///
+/// Expressions may be added incrementally, nodes shared between them
+/// are only visited once.
+class ExprMetrics
+{
+public:
+    static constexpr size_t NumExprKinds = Expr::LastExprKind + 1;
+
+    ExprMetrics() = default;
+    explicit ExprMetrics(const ExprPtr& expr) { this->add(expr); }
+
+    /// Adds \p expr and all of its subexpressions to the measured set.
+    void add(const ExprPtr& expr);
+
+    /// Returns the length of the longest path from a root to a leaf,
+    /// counted in nodes. Nullary expressions have depth 1.
+    unsigned getDepth() const { return mDepth; }
+
+    /// Returns the number of distinct nodes.
+    size_t getDagSize() const { return mNodes.size(); }
+
+    /// Returns the number of nodes if no subexpressions were shared.
+    /// The result saturates at the maximum value of uint64_t.
+    uint64_t getTreeSize() const { return mTreeSize; }
+
+    /// Returns the tree size where each node is counted with the weight of
+    /// its operator (see getOperatorWeight). It estimates the cost of the
+    /// measured expressions for a solver if no subexpressions were shared.
+    /// The result saturates at the maximum value of uint64_t.
+    uint64_t getTreeCost() const { return mTreeCost; }
+
+    /// Returns the variables referenced by the measured expressions,
+    /// in the order of their first occurrence.
+    llvm::ArrayRef<Variable*> getSupport() const { return mSupport; }
+
+    /// Returns the number of distinct nodes of kind \p kind.
+    unsigned getNumNodesOfKind(Expr::ExprKind kind) const { return mKindCounts[kind]; }
+
+    /// Returns the depth of an already measured subexpression \p expr,
+    /// or zero if \p expr was not visited.
+    unsigned getDepthOf(const ExprPtr& expr) const;
+
+    /// Returns the tree size of an already measured subexpression \p expr,
+    /// or zero if \p expr was not visited.
+    uint64_t getTreeSizeOf(const ExprPtr& expr) const;
+
+    /// Returns the tree cost of an already measured subexpression \p expr,
+    /// or zero if \p expr was not visited.
+    uint64_t getTreeCostOf(const ExprPtr& expr) const;
+
+    /// Returns the relative cost of an operator of kind \p kind for solvers.
+    /// Multiplication, division and remainder operators are the most
+    /// expensive, followed by array reads and writes. All other kinds
+    /// have a weight of one.
+    static unsigned getOperatorWeight(Expr::ExprKind kind);
+
+    void print(llvm::raw_ostream& os) const;
+
+private:
+    struct NodeInfo
+    {
+        unsigned depth;
+        uint64_t treeSize;
+        uint64_t treeCost;
+    };
+
+    // The measured roots are kept alive, so node addresses stay valid.
+    std::vector<ExprPtr> mRoots;
+    llvm::DenseMap<const Expr*, unsigned> mIndex;
+    std::vector<NodeInfo> mNodes;
+    std::vector<Variable*> mSupport;
+    std::array<unsigned, NumExprKinds> mKindCounts = {};
+    unsigned mDepth = 0;
+    uint64_t mTreeSize = 0;
+    uint64_t mTreeCost = 0;
+};
+
+} // end namespace gazer
+
+#endif
@@ -21,6 +21,8 @@
 #include "gazer/Core/Expr/ExprWalker.h"
 #include "gazer/Core/Expr/ExprBuilder.h"
 
+#include <unordered_map>
+
 namespace gazer
 {
 
@@ -63,6 +65,10 @@ protected:
 
 /// An expression rewriter that replaces certain variables with some
 /// given expression, according to the values set by operator[].
+///
+/// The rewritten form of each non-nullary subexpression is memoized, thus
+/// subexpressions shared between the walked expressions are only rewritten
+/// once. Changing the mapping through operator[] clears the memoized results.
 class VariableExprRewrite : public ExprRewrite<VariableExprRewrite>
 {
     friend class ExprWalker<VariableExprRewrite, ExprPtr>;
@@ -76,8 +82,60 @@ public:
 protected:
     ExprPtr visitVarRef(const ExprRef<VarRefExpr>& expr);
 
+private:
+    bool shouldSkip(const ExprPtr& expr, ExprPtr* ret);
+    void handleResult(const ExprPtr& expr, ExprPtr& ret);
+
 private:
     llvm::DenseMap<Variable*, ExprPtr> mRewriteMap;
+    std::unordered_map<ExprPtr, ExprPtr> mCache;
+};
+
+/// Rebuilds expressions of another context in the context of the given
+/// builder. Types and literals are translated structurally, variable
+/// references are replaced by the variables set through operator[].
+/// Every variable referenced by an imported expression must be mapped.
+///
+/// The imported form of each subexpression is memoized. The mapping of
+/// a variable must not be changed after it was used by an import.
+class ExprImporter : public ExprRewrite<ExprImporter>
+{
+    friend class ExprWalker<ExprImporter, ExprPtr>;
+public:
+    explicit ExprImporter(ExprBuilder& builder)
+        : ExprRewrite(builder)
+    {}
+
+    Variable*& operator[](Variable* variable) { return mVariableMap[variable]; }
+
+    ExprPtr import(const ExprPtr& expr) { return this->walk(expr); }
+    Type& importType(Type& type);
+
+protected:
+    ExprPtr visitExpr(const ExprPtr& expr);
+    ExprPtr visitUndef(const ExprRef<UndefExpr>& expr);
+    ExprPtr visitLiteral(const ExprRef<LiteralExpr>& expr);
+    ExprPtr visitVarRef(const ExprRef<VarRefExpr>& expr);
+
+    // Casts carry their result type.
+    ExprPtr visitZExt(const ExprRef<ZExtExpr>& expr);
+    ExprPtr visitSExt(const ExprRef<SExtExpr>& expr);
+    ExprPtr visitFCast(const ExprRef<FCastExpr>& expr);
+    ExprPtr visitSignedToFp(const ExprRef<SignedToFpExpr>& expr);
+    ExprPtr visitUnsignedToFp(const ExprRef<UnsignedToFpExpr>& expr);
+    ExprPtr visitFpToSigned(const ExprRef<FpToSignedExpr>& expr);
+    ExprPtr visitFpToUnsigned(const ExprRef<FpToUnsignedExpr>& expr);
+
+private:
+    ExprRef<LiteralExpr> importLiteral(const ExprRef<LiteralExpr>& expr);
+
+    bool shouldSkip(const ExprPtr& expr, ExprPtr* ret);
+    void handleResult(const ExprPtr& expr, ExprPtr& ret);
+
+private:
+    llvm::DenseMap<Variable*, Variable*> mVariableMap;
+    llvm::DenseMap<Type*, Type*> mTypeMap;
+    std::unordered_map<ExprPtr, ExprPtr> mCache;
 };
 
 }
@@ -0,0 +1,228 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+//
+/// \file This file defines a generic base class for expression printers
+/// which write their output directly into a stream.
+//
+//===----------------------------------------------------------------------===//
+#ifndef GAZER_CORE_EXPR_EXPRSTREAMPRINTER_H
+#define GAZER_CORE_EXPR_EXPRSTREAMPRINTER_H
+
+#include "gazer/Core/Expr.h"
+
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/SmallVector.h>
+#include <llvm/Support/raw_ostream.h>
+
+namespace gazer
+{
+
+/// Generic streaming printer for expressions.
+///
+/// Unlike an ExprWalker returning strings, this class writes the text of each
+/// node into the output stream as soon as it is known, using an explicit stack
+/// instead of recursion. Thus printing is linear in the size of the output.
+///
+/// Derived classes describe the syntax of each expression kind through the
+/// following functions:
+///     - printAtom(expr, os): prints a nullary expression.
+///     - printPrefix(expr, os): prints the text before the first operand.
+///       If it returns false, the operands and the suffix are not printed.
+///     - printSeparator(expr, i, os): prints the text before operand i > 0.
+///     - printSuffix(expr, os): prints the text after the last operand.
+///     - parenthesizeOperand(expr, i): returns true if operand i should be
+///       wrapped in parentheses, if it is not an atom.
+///
+/// If let-bindings are enabled, each non-nullary subexpression which occurs
+/// more than once in the expression DAG is printed once in a binding and
+/// referred to by its name afterwards.
+///
+/// \tparam DerivedT A Curiously Recurring Template Pattern (CRTP) parameter of
+///     the derived class.
+template<class DerivedT>
+class ExprStreamPrinter
+{
+    struct Frame
+    {
+        const NonNullaryExpr* mExpr;
+        size_t mNext;
+    };
+public:
+    explicit ExprStreamPrinter(llvm::raw_ostream& os, bool useLetBindings = false)
+        : mOS(os), mUseLetBindings(useLetBindings)
+    {}
+
+    ExprStreamPrinter(const ExprStreamPrinter&) = delete;
+    ExprStreamPrinter& operator=(const ExprStreamPrinter&) = delete;
+
+    void print(const ExprPtr& expr)
+    {
+        mBindings.clear();
+
+        if (mUseLetBindings) {
+            llvm::SmallVector<const NonNullaryExpr*, 8> shared;
+            this->collectSharedNodes(expr.get(), shared);
+
+            for (const NonNullaryExpr* node : shared) {
+                unsigned id = mBindings.size();
+                derived()->printBindingBegin(id, mOS);
+                this->printTerm(node);
+                derived()->printBindingEnd(id, mOS);
+
+                // Subsequent occurrences are referred to by their name.
+                mBindings[node] = id;
+            }
+        }
+
+        this->printTerm(expr.get());
+    }
+
+public:
+    // Default syntax
+    //===------------------------------------------------------------------===//
+    bool parenthesizeOperand(const ExprRef<NonNullaryExpr>& expr, size_t i) { return false; }
+
+    void printBoundName(unsigned id, llvm::raw_ostream& os) { os << "t" << id; }
+
+    void printBindingBegin(unsigned id, llvm::raw_ostream& os)
+    {
+        os << "let ";
+        derived()->printBoundName(id, os);
+        os << " = ";
+    }
+
+    void printBindingEnd(unsigned id, llvm::raw_ostream& os) { os << " in\n"; }
+
+private:
+    DerivedT* derived() { return static_cast<DerivedT*>(this); }
+
+    /// Prints \p root, replacing its bound subexpressions with their names.
+    void printTerm(const Expr* root)
+    {
+        llvm::SmallVector<Frame, 16> stack;
+
+        // Prints the beginning of expr, returns true if its operands should be printed.
+        auto open = [this, root, &stack](const Expr* expr) -> bool {
+            if (expr != root) {
+                auto it = mBindings.find(expr);
+                if (it != mBindings.end()) {
+                    derived()->printBoundName(it->second, mOS);
+                    return false;
+                }
+            }
+
+            if (expr->isNullary()) {
+                derived()->printAtom(ExprPtr(const_cast<Expr*>(expr)), mOS);
+                return false;
+            }
+
+            auto nn = llvm::cast<NonNullaryExpr>(expr);
+            if (!derived()->printPrefix(ExprRef<NonNullaryExpr>(const_cast<NonNullaryExpr*>(nn)), mOS)) {
+                return false;
+            }
+
+            stack.push_back({nn, 0});
+            return true;
+        };
+
+        open(root);
+
+        while (!stack.empty()) {
+            ExprRef<NonNullaryExpr> expr(const_cast<NonNullaryExpr*>(stack.back().mExpr));
+            size_t i = stack.back().mNext;
+
+            if (i == expr->getNumOperands()) {
+                derived()->printSuffix(expr, mOS);
+                stack.pop_back();
+
+                if (!stack.empty()) {
+                    const Frame& parent = stack.back();
+                    ExprRef<NonNullaryExpr> parentExpr(const_cast<NonNullaryExpr*>(parent.mExpr));
+                    if (derived()->parenthesizeOperand(parentExpr, parent.mNext - 1)) {
+                        mOS << ")";
+                    }
+                }
+                continue;
+            }
+
+            stack.back().mNext = i + 1;
+            if (i != 0) {
+                derived()->printSeparator(expr, i, mOS);
+            }
+
+            const Expr* operand = expr->getOperand(i).get();
+            bool isAtom = operand->isNullary() || mBindings.count(operand) != 0;
+            bool parens = !isAtom && derived()->parenthesizeOperand(expr, i);
+
+            if (parens) {
+                mOS << "(";
+            }
+
+            if (!open(operand) && parens) {
+                mOS << ")";
+            }
+        }
+    }
+
+    /// Finds all non-nullary nodes with multiple occurrences in the DAG of
+    /// \p root, in post-order, thus the operands of a node precede it.
+    void collectSharedNodes(const Expr* root, llvm::SmallVectorImpl<const NonNullaryExpr*>& shared)
+    {
+        llvm::DenseMap<const Expr*, unsigned> occurrences;
+        llvm::SmallVector<const NonNullaryExpr*, 16> postOrder;
+        llvm::SmallVector<Frame, 16> stack;
+
+        if (auto nn = llvm::dyn_cast<NonNullaryExpr>(root)) {
+            occurrences[nn] = 1;
+            stack.push_back({nn, 0});
+        }
+
+        while (!stack.empty()) {
+            Frame& top = stack.back();
+            if (top.mNext == top.mExpr->getNumOperands()) {
+                postOrder.push_back(top.mExpr);
+                stack.pop_back();
+                continue;
+            }
+
+            const Expr* operand = top.mExpr->getOperand(top.mNext++).get();
+            if (operand->isNullary()) {
+                continue;
+            }
+
+            if (occurrences[operand]++ == 0) {
+                stack.push_back({llvm::cast<NonNullaryExpr>(operand), 0});
+            }
+        }
+
+        for (const NonNullaryExpr* node : postOrder) {
+            if (node != root && occurrences[node] > 1) {
+                shared.push_back(node);
+            }
+        }
+    }
+
+private:
+    llvm::raw_ostream& mOS;
+    bool mUseLetBindings;
+    llvm::DenseMap<const Expr*, unsigned> mBindings;
+};
+
+} // end namespace gazer
+
+#endif
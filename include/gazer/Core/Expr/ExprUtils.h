@@ -23,11 +23,17 @@
 namespace gazer
 {
 
+/// Returns the depth of \p expr, see ExprMetrics for more measurements.
 unsigned ExprDepth(const ExprPtr& expr);
 
 void FormatPrintExpr(const ExprPtr& expr, llvm::raw_ostream& os);
 
-void InfixPrintExpr(const ExprPtr& expr, llvm::raw_ostream& os, unsigned bvRadix = 10);
+/// Prints \p expr into \p os in a human-readable infix format.
+/// If \p useLetBindings is set, subexpressions occurring multiple times
+/// are bound to a name once and referred to by that name later.
+void InfixPrintExpr(
+    const ExprPtr& expr, llvm::raw_ostream& os,
+    unsigned bvRadix = 10, bool useLetBindings = false);
 
 }
 
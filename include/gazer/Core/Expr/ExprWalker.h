@@ -42,6 +42,11 @@ namespace gazer
 /// handleResult() functions. The former should return true if the cache
 /// was hit and set the found value. The latter should be used to insert
 /// new entries into the cache.
+///
+/// Operands are visited from left to right by default. Walkers which do not
+/// need all operands of an expression (e.g. short-circuiting evaluators) may
+/// override getNextOperand() to request operands one at a time. Operands which
+/// were not requested hold a default-constructed value in the visit method.
 /// 
 /// \tparam DerivedT A Curiously Recurring Template Pattern (CRTP) parameter of
 ///     the derived class.
@@ -144,11 +149,18 @@ public:
             }
 
             auto nn = llvm::cast<NonNullaryExpr>(current->mExpr);
-            size_t i = current->mState;
+            size_t i = static_cast<DerivedT*>(this)->getNextOperand(nn, current->mState);
+            assert(i >= current->mState && "Operands must be requested in increasing order!");
+
+            if (i >= nn->getNumOperands()) {
+                // The rest of the operands are not needed, visit the node.
+                current->mState = nn->getNumOperands();
+                continue;
+            }
 
             auto frame = createFrame(nn->getOperand(i), i, current);
             mTop = frame;
-            current->mState++;
+            current->mState = i + 1;
         }
 
         llvm_unreachable("Invalid walker state!");
@@ -172,6 +184,13 @@ public:
     /// for \p expr. The visit result is contained in \p ret.
     void handleResult(const ExprPtr& expr, ReturnT& ret) {}
 
+    /// Returns the index of the next operand of \p expr to visit, given that
+    /// all operands before index \p i were either visited or skipped.
+    /// The results of the visited operands are available through getOperand().
+    /// Returning an index past the last operand finishes the operand traversal
+    /// and visits \p expr itself.
+    size_t getNextOperand(const ExprRef<NonNullaryExpr>& expr, size_t i) { return i; }
+
     ReturnT doVisit(const ExprPtr& expr)
     {
         #define GAZER_EXPR_KIND(KIND)                                       \
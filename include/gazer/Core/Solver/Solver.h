@@ -123,6 +123,9 @@ class SolverFactory
 public:
     /// Creates a new solver instance with a given symbol table.
     virtual std::unique_ptr<Solver> createSolver(GazerContext& symbols) = 0;
+
+    /// Prints the name and version of the underlying solver.
+    virtual void printVersion(llvm::raw_ostream& os) const = 0;
 };
 
 }
@@ -18,11 +18,14 @@
 #ifndef GAZER_LLVM_ANALYSIS_PDG_H
 #define GAZER_LLVM_ANALYSIS_PDG_H
 
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/iterator.h>
+#include <llvm/Analysis/AliasAnalysis.h>
+#include <llvm/Analysis/MemorySSA.h>
 #include <llvm/Analysis/PostDominators.h>
 #include <llvm/Pass.h>
 
 #include <memory>
-#include <unordered_map>
 
 namespace gazer
 {
@@ -40,10 +43,12 @@ private:
         : mSource(source), mTarget(target), mKind(kind)
     {}
 
+public:
     PDGEdge(const PDGEdge&) = delete;
     PDGEdge& operator=(const PDGEdge&) = delete;
 
-public:
+    PDGEdge(PDGEdge&&) = default;
+
     PDGNode* getSource() const { return mSource; }
     PDGNode* getTarget() const { return mTarget; }
     Kind getKind() const { return mKind; }
@@ -62,9 +67,12 @@ private:
         : mInst(inst)
     {}
 
+public:
     PDGNode(const PDGNode&) = delete;
     PDGNode& operator=(const PDGNode&) = delete;
-public:
+
+    PDGNode(PDGNode&&) = default;
+
     using edge_iterator = std::vector<PDGEdge*>::iterator;
     edge_iterator incoming_begin() { return mIncoming.begin(); }
     edge_iterator incoming_end() { return mIncoming.end(); }
@@ -90,46 +98,55 @@ private:
     std::vector<PDGEdge*> mOutgoing;
 };
 
+/// Represents the control, data flow and memory dependencies between
+/// the instructions of a function.
+///
+/// Nodes and edges are stored in flat arrays, nodes are indexed by the
+/// position of their instruction within the function. Memory dependencies
+/// are computed from MemorySSA: each instruction reading memory depends on
+/// the definitions which may clobber the location it reads and reach it
+/// without being overwritten by a must-alias store.
 class ProgramDependenceGraph final
 {
-    using NodeMapTy = std::unordered_map<llvm::Instruction*, std::unique_ptr<PDGNode>>;
 private:
-    ProgramDependenceGraph(
-        llvm::Function& function,
-        std::unordered_map<llvm::Instruction*, std::unique_ptr<PDGNode>> nodes,
-        std::vector<std::unique_ptr<PDGEdge>> edges
-    ) : mFunction(function), mNodes(std::move(nodes)), mEdges(std::move(edges))
+    ProgramDependenceGraph(llvm::Function& function)
+        : mFunction(function)
     {}
 
-private:
-    static PDGNode* getNodeFromIterator(NodeMapTy::value_type& pair) {
-        return &*pair.second;
-    }
-
 public:
     static std::unique_ptr<ProgramDependenceGraph> Create(
         llvm::Function& function,
-        llvm::PostDominatorTree& pdt
+        llvm::PostDominatorTree& pdt,
+        llvm::MemorySSA& mssa,
+        llvm::AAResults& aa
     );
 
-    PDGNode* getNode(llvm::Instruction* inst) const {
-        return &*mNodes.at(inst);
+    PDGNode* getNode(llvm::Instruction* inst) {
+        auto it = mIndex.find(inst);
+        assert(it != mIndex.end() && "The instruction must be in the function of the PDG!");
+
+        return &mNodes[it->second];
     }
 
-    using node_iterator = llvm::mapped_iterator<NodeMapTy::iterator, decltype(&getNodeFromIterator)>;
-    node_iterator node_begin() { return node_iterator(mNodes.begin(), &getNodeFromIterator); }
-    node_iterator node_end()   { return node_iterator(mNodes.end(), &getNodeFromIterator); }
+    using node_iterator = llvm::pointer_iterator<std::vector<PDGNode>::iterator>;
+    node_iterator node_begin() { return node_iterator(mNodes.begin()); }
+    node_iterator node_end()   { return node_iterator(mNodes.end()); }
 
     unsigned node_size() const { return mNodes.size(); }
+    unsigned edge_size() const { return mEdges.size(); }
 
     llvm::Function& getFunction() const { return mFunction; }
     
     void view() const;
 
+private:
+    void addEdge(unsigned source, unsigned target, PDGEdge::Kind kind);
+
 private:
     llvm::Function& mFunction;
-    NodeMapTy mNodes;
-    std::vector<std::unique_ptr<PDGEdge>> mEdges;
+    std::vector<PDGNode> mNodes;
+    llvm::DenseMap<const llvm::Instruction*, unsigned> mIndex;
+    std::vector<PDGEdge> mEdges;
 };
 
 class ProgramDependenceWrapperPass final : public llvm::FunctionPass
@@ -232,6 +232,10 @@ llvm::Pass* createCfaPrinterPass();
 
 llvm::Pass* createCfaViewerPass();
 
+/// Writes the translated automata system into \p os in the binary format
+/// of WriteAutomataSystem.
+llvm::Pass* createCfaWriterPass(llvm::raw_ostream& os);
+
 }
 
 #endif //GAZER_MODULETOAUTOMATA_H
@@ -164,6 +164,19 @@ private:
     std::unique_ptr<llvm::ToolOutputFile> mModuleOutput = nullptr;
 };
 
+/// Runs \p algorithm on the automata system stored in \p filename in gazer's
+/// binary model format (see createCfaWriterPass) and prints the result.
+/// As the system is not translated from LLVM, failures are reported by their
+/// error codes and error traces are not available.
+///
+/// \return False if the model could not be read.
+bool VerifyModelFile(
+    llvm::StringRef filename,
+    GazerContext& context,
+    VerificationAlgorithm& algorithm,
+    const LLVMFrontendSettings& settings
+);
+
 }
 
 #endif
\ No newline at end of file
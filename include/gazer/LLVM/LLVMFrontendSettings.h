@@ -55,14 +55,14 @@ enum class FloatRepresentation
 enum class LoopRepresentation
 {
     Recursion,  ///< Represent loops as recursive functions.
-    Cycle       ///< Represent loops as cycles.
+    Cycle       ///< Represent loops as cycles within the automaton of their function.
 };
 
 enum class ElimVarsLevel
 {
     Off,       ///< Do not try to eliminate variables
-    Normal,    ///< Inline variables which have only one use
-    Aggressive ///< Inline all suitable variables
+    Normal,    ///< Inline variables if it does not increase the encoding size
+    Aggressive ///< Inline variables if it increases the encoding size by a bounded amount
 };
 
 enum class MemoryModelSetting
@@ -103,7 +103,12 @@ public:
     IntRepresentation ints = IntRepresentation::BitVectors;
     FloatRepresentation floats = FloatRepresentation::Fpa;
     bool simplifyExpr = true;
+    bool pruneCfa = true;
+    bool simplifyCfa = true;
+    bool largeBlockEncoding = false;
+    bool printCfaPassStats = false;
     bool strict = false;
+    unsigned translationThreads = 1;
 
     std::string function = "main";
 
@@ -111,6 +116,9 @@ public:
     bool debugDumpMemorySSA = false;
     MemoryModelSetting memoryModel = MemoryModelSetting::Flat;
 
+    // Result caching
+    std::string cacheDirectory;
+
 public:
     /// Returns true if the current settings can be applied to the given module.
     bool validate(const llvm::Module& module, llvm::raw_ostream& os) const;
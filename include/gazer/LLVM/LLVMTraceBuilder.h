@@ -30,6 +30,7 @@ namespace gazer
 {
 
 class CfaToLLVMTrace;
+class ExprEvaluator;
 
 class LLVMTraceBuilder : public CfaTraceBuilder
 {
@@ -46,13 +47,13 @@ public:
 private:
     void handleDbgValueInst(
         const Location* loc, const llvm::DbgValueInst* dvi,
-        std::vector<std::unique_ptr<TraceEvent>>& events, Valuation& currentVals
+        std::vector<std::unique_ptr<TraceEvent>>& events, ExprEvaluator& evaluator
     );
 
     Type* preferredTypeFromDIType(llvm::DIType* diTy);
     ExprRef<AtomicExpr> getLiteralFromLLVMConst(const llvm::ConstantData* value, Type* preferredType = nullptr);
     ExprRef<AtomicExpr> getLiteralFromValue(
-        Cfa* cfa, const llvm::Value* value, Valuation& model, Type* preferredType = nullptr
+        Cfa* cfa, const llvm::Value* value, ExprEvaluator& evaluator, Type* preferredType = nullptr
     );
 
     static TraceVariable traceVarFromDIVar(const llvm::DIVariable* diVar);
@@ -46,6 +46,13 @@ public:
     /// Returns the type translator of this memory model.
     virtual MemoryTypeTranslator& getMemoryTypeTranslator() = 0;
 
+    /// Creates an independent instance of this memory model in \p context,
+    /// which may be used on another thread than this one. The instances must
+    /// share their memory objects, so the automata translated with either of
+    /// them refer to the same ones. Returns nullptr if the model cannot be
+    /// instantiated independently.
+    virtual std::unique_ptr<MemoryModel> cloneInContext(GazerContext& context) { return nullptr; }
+
     virtual ~MemoryModel() = default;
 };
 
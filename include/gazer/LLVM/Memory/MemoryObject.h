@@ -220,7 +220,7 @@ private:
     MemoryObjectType mObjectType;
     MemoryObjectSize mSize;
 
-    gazer::Type* mTypeHint;
+    gazer::Type* mTypeHint = nullptr;
 
     llvm::Type* mValueType;
     std::string mName;
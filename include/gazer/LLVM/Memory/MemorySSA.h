@@ -35,16 +35,26 @@ class MemorySSA
 
     using ValueToDefSetMap = llvm::DenseMap<const llvm::Value*, std::vector<MemoryObjectDef*>>;
     using ValueToUseSetMap = llvm::DenseMap<const llvm::Value*, std::vector<MemoryObjectUse*>>;
+
+    // Indexes the annotations of a value by their memory object. If a value has
+    // multiple annotations for the same object, the mapped access is nullptr.
+    using AccessKey = std::pair<const llvm::Value*, const MemoryObject*>;
+    using UniqueDefMap = llvm::DenseMap<AccessKey, MemoryObjectDef*>;
+    using UniqueUseMap = llvm::DenseMap<AccessKey, MemoryObjectUse*>;
 private:
     MemorySSA(
         llvm::Function& function,
         std::vector<std::unique_ptr<MemoryObject>> objects,
         ValueToDefSetMap valueDefAnnotations,
-        ValueToUseSetMap valueUseAnnotations
+        ValueToUseSetMap valueUseAnnotations,
+        UniqueDefMap uniqueDefs,
+        UniqueUseMap uniqueUses
     ) : mFunction(function),
         mObjects(std::move(objects)),
         mValueDefs(std::move(valueDefAnnotations)),
-        mValueUses(std::move(valueUseAnnotations))
+        mValueUses(std::move(valueUseAnnotations)),
+        mUniqueDefs(std::move(uniqueDefs)),
+        mUniqueUses(std::move(uniqueUses))
     {}
 
 public:
@@ -105,6 +115,8 @@ private:
     // MemorySSA annotations
     ValueToDefSetMap mValueDefs;
     ValueToUseSetMap mValueUses;
+    UniqueDefMap mUniqueDefs;
+    UniqueUseMap mUniqueUses;
 };
 
 /// Helper class for building memory SSA form.
@@ -112,8 +124,8 @@ class MemorySSABuilder
 {
     struct MemoryObjectInfo
     {
-        MemoryObject* object;
         llvm::SmallPtrSet<llvm::BasicBlock*, 32> defBlocks;
+        llvm::SmallPtrSet<llvm::BasicBlock*, 32> useBlocks;
         llvm::SmallVector<MemoryObjectDef*, 8> renameStack;
 
         MemoryObjectDef* getCurrentTopDefinition() {
@@ -153,9 +165,16 @@ public:
     std::unique_ptr<MemorySSA> build();
 
 private:
+    void addDefAnnotation(const llvm::Value* value, MemoryObjectDef* def);
+    void addUseAnnotation(const llvm::Value* value, MemoryObjectUse* use);
+
     void calculatePHINodes();
+    void calculateLiveInBlocks(
+        MemoryObject* object,
+        MemoryObjectInfo& info,
+        llvm::SmallPtrSetImpl<llvm::BasicBlock*>& liveInBlocks);
     void renamePass();
-    void renameBlock(llvm::BasicBlock* block);
+    void renameBlock(llvm::BasicBlock* block, llvm::SmallVectorImpl<MemoryObject*>& pushed);
 
 private:
     llvm::Function& mFunction;
@@ -166,6 +185,8 @@ private:
     llvm::DenseMap<MemoryObject*, MemoryObjectInfo> mObjectInfo;
     MemorySSA::ValueToDefSetMap mValueDefs;
     MemorySSA::ValueToUseSetMap mValueUses;
+    MemorySSA::UniqueDefMap mUniqueDefs;
+    MemorySSA::UniqueUseMap mUniqueUses;
 
     unsigned mVersionNumber = 0;
 };
@@ -20,6 +20,7 @@
 
 namespace llvm {
     class GlobalVariable;
+    class Value;
 }
 
 namespace gazer::memory
@@ -28,6 +29,15 @@ namespace gazer::memory
 /// Returns true if the given global variable is used as a pointer.
 bool isGlobalUsedAsPointer(llvm::GlobalVariable& gv);
 
+/// Returns true if the address of \p gv (or an address derived from it) may
+/// escape, i.e. it is used by something else than the pointer operand of a
+/// non-volatile load or store, possibly through casts and address calculations.
+bool isGlobalAddressEscaping(llvm::GlobalVariable& gv);
+
+/// If \p ptr is derived from a global variable only through pointer casts
+/// and address calculations, returns said global. Returns nullptr otherwise.
+llvm::GlobalVariable* getBaseGlobalVariable(const llvm::Value* ptr);
+
 }
 
 #endif
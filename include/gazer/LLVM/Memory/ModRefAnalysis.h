@@ -0,0 +1,101 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+//
+/// \file This file declares an interprocedural analysis which summarizes
+/// the memory locations read and written by each function.
+//
+//===----------------------------------------------------------------------===//
+#ifndef GAZER_LLVM_MEMORY_MODREFANALYSIS_H
+#define GAZER_LLVM_MEMORY_MODREFANALYSIS_H
+
+#include <llvm/ADT/BitVector.h>
+#include <llvm/ADT/DenseMap.h>
+
+#include <functional>
+#include <vector>
+
+namespace llvm {
+    class CallGraph;
+    class CallGraphNode;
+    class Function;
+    class Value;
+}
+
+namespace gazer::memory
+{
+
+/// Lists the memory locations read or written by a function, including
+/// the accesses of its (transitive) callees.
+struct ModRefSummary
+{
+    llvm::BitVector mod;
+    llvm::BitVector ref;
+
+    /// Locations clobbered by the allocations of the function itself.
+    /// These are not propagated to the callers, as the stack frame of
+    /// the function is invalid after it returns.
+    llvm::BitVector local;
+
+    bool accesses(unsigned location) const {
+        return mod.test(location) || ref.test(location);
+    }
+};
+
+/// Computes mod/ref summaries bottom-up over the strongly connected components
+/// of the call graph, visiting each function and call edge exactly once.
+/// Functions which are not reachable from the external calling node (such
+/// as internal functions without callers) are summarized as well.
+///
+/// The memory is abstracted into a fixed number of locations, each pointer
+/// operand is mapped onto one of them by a client-supplied function.
+/// Calls to declarations are assumed not to access the memory, while
+/// indirect calls may access any location.
+class ModRefAnalysis
+{
+public:
+    using LocationFuncTy = std::function<unsigned(const llvm::Value*)>;
+
+    ModRefAnalysis(llvm::CallGraph& cg, unsigned numLocations, LocationFuncTy locationOf);
+
+    ModRefAnalysis(const ModRefAnalysis&) = delete;
+    ModRefAnalysis& operator=(const ModRefAnalysis&) = delete;
+
+    /// Returns the summary of \p function, which must have a definition.
+    const ModRefSummary& getSummary(const llvm::Function* function) const
+    {
+        auto it = mSummaries.find(function);
+        assert(it != mSummaries.end() && "Summaries are only available for defined functions!");
+
+        return it->second;
+    }
+
+    unsigned getNumLocations() const { return mNumLocations; }
+
+private:
+    void summarizeComponent(const std::vector<llvm::CallGraphNode*>& scc);
+    void calculateLocalEffects(llvm::Function& function, ModRefSummary& summary);
+
+private:
+    unsigned mNumLocations;
+    LocationFuncTy mLocationOf;
+    llvm::DenseMap<const llvm::Function*, ModRefSummary> mSummaries;
+};
+
+} // namespace gazer::memory
+
+#endif
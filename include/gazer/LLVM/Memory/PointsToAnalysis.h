@@ -0,0 +1,123 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+//
+/// \file This file declares a unification-based (Steensgaard-style) points-to
+/// analysis, used to partition the memory into regions which never alias.
+//
+//===----------------------------------------------------------------------===//
+#ifndef GAZER_LLVM_MEMORY_POINTSTOANALYSIS_H
+#define GAZER_LLVM_MEMORY_POINTSTOANALYSIS_H
+
+#include <llvm/ADT/DenseMap.h>
+
+#include <vector>
+
+namespace llvm {
+    class Module;
+    class Value;
+    class Constant;
+    class Function;
+    class Instruction;
+    class Type;
+    class raw_ostream;
+}
+
+namespace gazer::memory
+{
+
+/// Partitions the memory of a module into disjoint regions.
+///
+/// Each pointer value belongs to an equivalence class, and each class points
+/// to at most one other class. The pointed-to classes are the regions of
+/// the memory: two pointers may only alias if they point into the same region.
+/// Pointers escaping into unknown code (or created from integers) all point
+/// into the unknown region, which always has the identifier zero. As pointers
+/// may also be stored and loaded as integers, the pointees of memory accessed
+/// through pointer-sized integers are merged into the unknown region as well.
+///
+/// The analysis is field-insensitive, and runs in almost linear time with
+/// respect to the size of the module.
+class PointsToAnalysis
+{
+    static constexpr unsigned InvalidNode = ~0u;
+
+    struct Node
+    {
+        unsigned parent;
+        unsigned rank = 0;
+        unsigned pointee = InvalidNode;
+
+        explicit Node(unsigned parent)
+            : parent(parent)
+        {}
+    };
+public:
+    static constexpr unsigned UnknownRegion = 0;
+
+    explicit PointsToAnalysis(llvm::Module& module);
+
+    PointsToAnalysis(const PointsToAnalysis&) = delete;
+    PointsToAnalysis& operator=(const PointsToAnalysis&) = delete;
+
+    /// Returns the region of the memory pointed by \p ptr.
+    unsigned getRegionFor(const llvm::Value* ptr) const {
+        auto it = mRegions.find(ptr);
+        return it != mRegions.end() ? it->second : UnknownRegion;
+    }
+
+    /// Returns the number of distinct regions, including the unknown region.
+    unsigned getNumRegions() const { return mNumRegions; }
+
+    void print(llvm::raw_ostream& os) const;
+
+private:
+    unsigned createNode();
+    unsigned find(unsigned node);
+    void unify(unsigned lhs, unsigned rhs);
+    unsigned deref(unsigned node);
+
+    unsigned getNode(const llvm::Value* value);
+    unsigned getReturnNode(const llvm::Function* function);
+    unsigned createConstantNode(const llvm::Constant* constant);
+
+    void pointsToUnknown(unsigned node) { this->unify(this->deref(node), mUnknown); }
+
+    /// Returns true if values of \p type are wide enough to hold a pointer.
+    bool mayHoldPointer(const llvm::Type* type) const;
+
+    void visitInstruction(llvm::Instruction& inst);
+    void visitCall(llvm::Instruction& inst);
+    void visitGlobalInitializer(unsigned objectNode, const llvm::Constant* init);
+
+    void calculateRegions(llvm::Module& module);
+    void assignRegion(const llvm::Value* value, llvm::DenseMap<unsigned, unsigned>& regionIds);
+
+private:
+    unsigned mPointerSizeInBits;
+    std::vector<Node> mNodes;
+    llvm::DenseMap<const llvm::Value*, unsigned> mValueNodes;
+    llvm::DenseMap<const llvm::Function*, unsigned> mReturnNodes;
+    unsigned mUnknown;
+
+    llvm::DenseMap<const llvm::Value*, unsigned> mRegions;
+    unsigned mNumRegions = 0;
+};
+
+} // namespace gazer::memory
+
+#endif
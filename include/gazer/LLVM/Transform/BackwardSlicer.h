@@ -32,7 +32,9 @@ class BackwardSlicer
 public:
     BackwardSlicer(
         llvm::Function& function,
-        std::function<bool(llvm::Instruction*)> criterion
+        std::function<bool(llvm::Instruction*)> criterion,
+        llvm::MemorySSA& mssa,
+        llvm::AAResults& aa
     );
 
     /// Slices the given function according to the given criteria.
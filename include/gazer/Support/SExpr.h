@@ -15,63 +15,164 @@
 // limitations under the License.
 //
 //===----------------------------------------------------------------------===//
+//
+/// \file This file defines a simple S-expression representation and
+/// a non-recursive parser for it.
+//
+//===----------------------------------------------------------------------===//
 #ifndef GAZER_SUPPORT_SEXPR_H
 #define GAZER_SUPPORT_SEXPR_H
 
+#include <llvm/ADT/ArrayRef.h>
+#include <llvm/ADT/SmallVector.h>
 #include <llvm/ADT/StringRef.h>
-#include <llvm/Support/Casting.h>
+#include <llvm/ADT/Twine.h>
+#include <llvm/Support/Allocator.h>
 
-#include <variant>
-#include <vector>
+#include <string>
+
+namespace llvm {
+    class raw_ostream;
+}
 
 namespace gazer::sexpr
 {
 
-class Atom;
-class List;
+class Arena;
 
+/// An S-expression node, which is either an atom or a list of nodes.
+///
+/// Nodes are immutable and are always allocated in an Arena. Atoms may
+/// refer to the parsed input buffer directly, thus they are only valid
+/// as long as both the arena and the input buffer are alive.
 class Value
 {
-    using ListTy = std::vector<Value*>;
-    using VariantTy = std::variant<std::string, ListTy>;
-public:
-    explicit Value(std::string str)
-        : mData(str)
-    {}
+    friend class Arena;
 
-    explicit Value(std::vector<Value*> vec)
-        : mData(std::move(vec))
+    Value(const void* data, size_t size, bool isList)
+        : mData(data), mSize(size), mIsList(isList)
     {}
-
+public:
     Value(const Value&) = delete;
     Value& operator=(const Value&) = delete;
 
-    [[nodiscard]] bool isAtom() const { return mData.index() == 0; }
-    [[nodiscard]] bool isList() const { return mData.index() == 1; }
+    [[nodiscard]] bool isAtom() const { return !mIsList; }
+    [[nodiscard]] bool isList() const { return mIsList; }
 
-    [[nodiscard]] llvm::StringRef asAtom() const { return std::get<0>(mData); }
-    [[nodiscard]] const std::vector<Value*>& asList() const { return std::get<1>(mData); }
+    [[nodiscard]] llvm::StringRef asAtom() const
+    {
+        assert(isAtom() && "Cannot get the atom data of a list!");
+        return llvm::StringRef(static_cast<const char*>(mData), mSize);
+    }
+
+    [[nodiscard]] llvm::ArrayRef<const Value*> asList() const
+    {
+        assert(isList() && "Cannot get the elements of an atom!");
+        return llvm::makeArrayRef(static_cast<const Value* const*>(mData), mSize);
+    }
 
     bool operator==(const Value& rhs) const;
+    bool operator!=(const Value& rhs) const { return !operator==(rhs); }
 
     void print(llvm::raw_ostream& os) const;
 
-    ~Value();
+private:
+    const void* mData;
+    size_t mSize;
+    bool mIsList;
+};
+
+/// Owns a set of S-expression nodes, which are freed together when the arena
+/// is destroyed.
+class Arena
+{
+public:
+    Arena() = default;
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    /// Creates an atom referring to \p data, without copying it.
+    const Value* atom(llvm::StringRef data);
+
+    /// Creates an atom with a copy of \p data owned by the arena.
+    const Value* atomCopy(llvm::StringRef data);
+
+    /// Creates a list with the given elements.
+    const Value* list(llvm::ArrayRef<const Value*> elements);
 
 private:
-    VariantTy mData;
+    llvm::BumpPtrAllocator mAllocator;
 };
 
-/// Creates a simple SExpr atom and returns a pointer to it.
-/// It is the caller's responsibility to free the resulting SExpr node.
-[[nodiscard]] Value* atom(llvm::StringRef data);
+/// A non-recursive S-expression parser.
+///
+/// The parser may be used in two ways. In one-shot mode, parse() parses
+/// a complete input buffer and returns atoms referring into that buffer.
+/// In streaming mode, the input is passed in arbitrarily split chunks
+/// through feed(), and the result is retrieved by calling finish(). As the
+/// chunks need not outlive the parser, streamed atoms are copied into the
+/// arena.
+///
+/// Parsing stops after the first complete expression, trailing input is
+/// ignored. On failure, a null pointer is returned and the reason is
+/// available through getError().
+class Parser
+{
+public:
+    explicit Parser(Arena& arena)
+        : mArena(arena)
+    {}
 
-/// Creates an SExpr list and returns a pointer to it.
-/// It is the caller's responsibility to free the resulting SExpr node.
-[[nodiscard]] Value* list(std::vector<Value*> data);
+    Parser(const Parser&) = delete;
+    Parser& operator=(const Parser&) = delete;
 
-std::unique_ptr<Value> parse(llvm::StringRef input);
+    /// Parses the first expression of \p input.
+    const Value* parse(llvm::StringRef input);
 
-}
+    /// Consumes the next chunk of the input. Returns false on error.
+    bool feed(llvm::StringRef chunk);
+
+    /// Finishes a streamed parse and returns the parsed expression.
+    const Value* finish();
+
+    /// Returns the message of the last error, including its position
+    /// in the line:column format.
+    llvm::StringRef getError() const { return mError; }
+
+    /// Resets the parser state, so it may parse a new input.
+    void reset();
+
+private:
+    bool consume(llvm::StringRef input, bool copyAtoms, bool isLast);
+    void addValue(const Value* value);
+    bool error(size_t offset, const llvm::Twine& message);
+
+private:
+    Arena& mArena;
+
+    // Elements of the currently open lists, and the index of the first
+    // element of each open list.
+    llvm::SmallVector<const Value*, 32> mElements;
+    llvm::SmallVector<size_t, 16> mListStarts;
+
+    // An atom which was split between streamed chunks.
+    std::string mAtomBuffer;
+    bool mInAtom = false;
+
+    const Value* mResult = nullptr;
+    bool mFailed = false;
+    std::string mError;
+
+    // Position information for error reporting.
+    size_t mOffset = 0;
+    size_t mLine = 1;
+    size_t mLineStart = 0;
+};
+
+/// Parses \p input, allocating the resulting nodes in \p arena.
+/// Returns nullptr and reports the error to llvm::errs() on failure.
+const Value* parse(llvm::StringRef input, Arena& arena);
+
+} // end namespace gazer::sexpr
 
 #endif
@@ -63,6 +63,8 @@ public:
         CfaTraceBuilder& traceBuilder
     ) override;
 
+    void printSettings(llvm::raw_ostream& os) const override;
+
 private:
     SolverFactory& mSolverFactory;
     BmcSettings mSettings;
@@ -37,6 +37,11 @@ public:
         CfaTraceBuilder& traceBuilder
     ) = 0;
 
+    /// Prints the settings of this algorithm which may affect the result
+    /// of check(), including the version of the solvers or external tools it
+    /// uses. Cached results are only reused if these are unchanged.
+    virtual void printSettings(llvm::raw_ostream& os) const = 0;
+
     virtual ~VerificationAlgorithm() = default;
 };
 
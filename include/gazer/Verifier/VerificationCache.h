@@ -0,0 +1,72 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+//
+/// \file This file declares a persistent, on-disk cache of verification
+/// results.
+//
+//===----------------------------------------------------------------------===//
+#ifndef GAZER_VERIFIER_VERIFICATIONCACHE_H
+#define GAZER_VERIFIER_VERIFICATIONCACHE_H
+
+#include "gazer/Verifier/VerificationAlgorithm.h"
+
+namespace gazer
+{
+
+/// Stores the results of verification algorithms in a directory, and reuses
+/// them when the same automata system is verified again with the same settings.
+///
+/// Entries are keyed by the hash of the binary serialization of the system
+/// (see WriteAutomataSystem), the settings printed by the algorithm, which
+/// include the version of the solver, and the revision of gazer itself.
+/// Successful, failed and bound reached results are stored, along with the
+/// locations and variable values of the counterexample, thus the trace of a
+/// cached failure is rebuilt by the trace builder of the current run.
+/// Timeouts, unknown results and internal errors are never cached.
+class VerificationCache
+{
+public:
+    explicit VerificationCache(std::string directory)
+        : mDirectory(std::move(directory))
+    {}
+
+    VerificationCache(const VerificationCache&) = delete;
+    VerificationCache& operator=(const VerificationCache&) = delete;
+
+    /// Returns the cached result of verifying \p system with \p algorithm,
+    /// or runs \p algorithm and stores its result if there is none.
+    std::unique_ptr<VerificationResult> check(
+        VerificationAlgorithm& algorithm,
+        AutomataSystem& system,
+        CfaTraceBuilder& traceBuilder
+    );
+
+    unsigned getNumHits() const { return mNumHits; }
+    unsigned getNumMisses() const { return mNumMisses; }
+
+    void printStats(llvm::raw_ostream& os) const;
+
+private:
+    std::string mDirectory;
+    unsigned mNumHits = 0;
+    unsigned mNumMisses = 0;
+};
+
+} // end namespace gazer
+
+#endif
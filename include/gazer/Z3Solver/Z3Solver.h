@@ -35,6 +35,7 @@ public:
     Z3SolverFactory() = default;
 
     std::unique_ptr<Solver> createSolver(GazerContext& context) override;
+    void printVersion(llvm::raw_ostream& os) const override;
 };
 
 /// Utility function which transforms an arbitrary Z3 bitvector into LLVM's APInt.
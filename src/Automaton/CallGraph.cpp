@@ -20,6 +20,8 @@
 
 #include <llvm/Support/raw_ostream.h>
 
+#include <algorithm>
+
 using namespace gazer;
 
 CallGraph::CallGraph(AutomataSystem& system)
@@ -41,24 +43,60 @@ CallGraph::CallGraph(AutomataSystem& system)
     }
 }
 
-bool CallGraph::isTailRecursive(Cfa* cfa)
+void CallGraph::Node::addCall(CallTransition* call, Node* node)
 {
-    auto& node = mNodes[cfa];
+    assert(call != nullptr);
+    assert(node != nullptr);
 
-    bool isRecursive = false;
-    bool isTail = true;
+    mCallsToOthers.emplace_back(call, node);
+    node->mCallsToThis.emplace_back(call);
 
-    for (auto& call : node->mCallsToOthers) {
-        if (call.first->getCalledAutomaton() == cfa) {
-            isRecursive = true;
-            if (call.first->getTarget() != cfa->getExit()) {
-                isTail = false;
-                break;
-            }
+    if (node == this) {
+        ++mNumSelfCalls;
+        if (call->getTarget() != mCfa->getExit()) {
+            ++mNumNonTailSelfCalls;
+        }
+    }
+}
+
+void CallGraph::Node::removeCall(CallTransition* call)
+{
+    auto it = std::find_if(mCallsToOthers.begin(), mCallsToOthers.end(), [call](const CallSite& cs) {
+        return cs.first == call;
+    });
+    assert(it != mCallsToOthers.end() && "The call must be present in the call graph!");
+
+    Node* node = it->second;
+    mCallsToOthers.erase(it);
+    node->mCallsToThis.erase(
+        std::find(node->mCallsToThis.begin(), node->mCallsToThis.end(), call)
+    );
+
+    if (node == this) {
+        --mNumSelfCalls;
+        if (call->getTarget() != mCfa->getExit()) {
+            --mNumNonTailSelfCalls;
         }
     }
+}
+
+bool CallGraph::isTailRecursive(Cfa* cfa)
+{
+    Node* node = mNodes[cfa].get();
+
+    return node->mNumSelfCalls != 0 && node->mNumNonTailSelfCalls == 0;
+}
 
-    return isRecursive && isTail;
+void CallGraph::addCall(CallTransition* call)
+{
+    Node* caller = mNodes[call->getSource()->getAutomaton()].get();
+    caller->addCall(call, mNodes[call->getCalledAutomaton()].get());
+}
+
+void CallGraph::removeCall(CallTransition* call)
+{
+    Node* caller = mNodes[call->getSource()->getAutomaton()].get();
+    caller->removeCall(call);
 }
 
 auto CallGraph::lookupNode(Cfa* cfa) -> Node*
@@ -149,6 +149,13 @@ void Cfa::addOutput(Variable* variable)
     mOutputs.push_back(variable);
 }
 
+void Cfa::addLocal(Variable* variable)
+{
+    assert(std::find(mLocals.begin(), mLocals.end(), variable) == mLocals.end()
+        && "The variable must not be a local of this automaton already!");
+    mLocals.push_back(variable);
+}
+
 Variable *Cfa::createLocal(const std::string& name, Type& type)
 {
     Variable* variable = this->createMemberVariable(name, type);
@@ -238,13 +245,26 @@ void Cfa::removeUnreachableLocations()
         // The DFS algorithm is executed by running the iterators.
     }
 
+    // Automata must stay connected graphs: if the exit location is
+    // unreachable, keep it with an 'assume false' transition.
+    if (visited.count(mExit) == 0) {
+        this->createAssignTransition(mEntry, mExit, BoolLiteralExpr::False(mContext));
+        visited.insert(mExit);
+    }
+
     std::vector<Location*> unreachable;
     for (Location* loc : nodes()) {
         if (visited.count(loc) == 0) {
             this->disconnectNode(loc);
+            mErrorFieldExprs.erase(loc);
+            mLocationNumbers.erase(loc->getId());
         }
     }
 
+    mErrorLocations.erase(llvm::remove_if(mErrorLocations, [&visited](Location* loc) {
+        return visited.count(loc) == 0;
+    }), mErrorLocations.end());
+
     this->clearDisconnectedElements();
 }
 
@@ -0,0 +1,1052 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+#include "gazer/Automaton/CfaAbstractInterpretation.h"
+#include "gazer/Automaton/CfaUtils.h"
+#include "gazer/Core/Expr/ExprBuilder.h"
+#include "gazer/Core/Expr/ExprRewrite.h"
+#include "gazer/Core/Expr/ExprWalker.h"
+
+#include <llvm/ADT/DenseSet.h>
+#include <llvm/IR/InstrTypes.h>
+
+#include <set>
+
+using namespace gazer;
+
+namespace
+{
+
+/// Returns the width of the abstract values of \p type, or zero if
+/// variables of this type are not tracked.
+unsigned getTrackedWidth(Type& type)
+{
+    if (type.isBoolType()) {
+        return 1;
+    }
+
+    if (auto bvTy = llvm::dyn_cast<BvType>(&type)) {
+        return bvTy->getWidth();
+    }
+
+    return 0;
+}
+
+bool isComparison(Expr::ExprKind kind)
+{
+    switch (kind) {
+        case Expr::Eq: case Expr::NotEq:
+        case Expr::BvSLt: case Expr::BvSLtEq: case Expr::BvSGt: case Expr::BvSGtEq:
+        case Expr::BvULt: case Expr::BvULtEq: case Expr::BvUGt: case Expr::BvUGtEq:
+            return true;
+        default:
+            return false;
+    }
+}
+
+llvm::CmpInst::Predicate getPredicate(Expr::ExprKind kind)
+{
+    switch (kind) {
+        case Expr::Eq:      return llvm::CmpInst::ICMP_EQ;
+        case Expr::NotEq:   return llvm::CmpInst::ICMP_NE;
+        case Expr::BvSLt:   return llvm::CmpInst::ICMP_SLT;
+        case Expr::BvSLtEq: return llvm::CmpInst::ICMP_SLE;
+        case Expr::BvSGt:   return llvm::CmpInst::ICMP_SGT;
+        case Expr::BvSGtEq: return llvm::CmpInst::ICMP_SGE;
+        case Expr::BvULt:   return llvm::CmpInst::ICMP_ULT;
+        case Expr::BvULtEq: return llvm::CmpInst::ICMP_ULE;
+        case Expr::BvUGt:   return llvm::CmpInst::ICMP_UGT;
+        case Expr::BvUGtEq: return llvm::CmpInst::ICMP_UGE;
+        default:
+            llvm_unreachable("Unknown comparison kind!");
+    }
+}
+
+/// Returns the comparison which holds iff \p kind does not.
+Expr::ExprKind getNegatedComparison(Expr::ExprKind kind)
+{
+    switch (kind) {
+        case Expr::Eq:      return Expr::NotEq;
+        case Expr::NotEq:   return Expr::Eq;
+        case Expr::BvSLt:   return Expr::BvSGtEq;
+        case Expr::BvSLtEq: return Expr::BvSGt;
+        case Expr::BvSGt:   return Expr::BvSLtEq;
+        case Expr::BvSGtEq: return Expr::BvSLt;
+        case Expr::BvULt:   return Expr::BvUGtEq;
+        case Expr::BvULtEq: return Expr::BvUGt;
+        case Expr::BvUGt:   return Expr::BvULtEq;
+        case Expr::BvUGtEq: return Expr::BvULt;
+        default:
+            llvm_unreachable("Unknown comparison kind!");
+    }
+}
+
+/// Returns the comparison which holds for (b, a) iff \p kind holds for (a, b).
+Expr::ExprKind getSwappedComparison(Expr::ExprKind kind)
+{
+    switch (kind) {
+        case Expr::Eq:      return Expr::Eq;
+        case Expr::NotEq:   return Expr::NotEq;
+        case Expr::BvSLt:   return Expr::BvSGt;
+        case Expr::BvSLtEq: return Expr::BvSGtEq;
+        case Expr::BvSGt:   return Expr::BvSLt;
+        case Expr::BvSGtEq: return Expr::BvSLtEq;
+        case Expr::BvULt:   return Expr::BvUGt;
+        case Expr::BvULtEq: return Expr::BvUGtEq;
+        case Expr::BvUGt:   return Expr::BvULt;
+        case Expr::BvUGtEq: return Expr::BvULtEq;
+        default:
+            llvm_unreachable("Unknown comparison kind!");
+    }
+}
+
+bool compareConstants(Expr::ExprKind kind, const llvm::APInt& left, const llvm::APInt& right)
+{
+    switch (kind) {
+        case Expr::Eq:      return left.eq(right);
+        case Expr::NotEq:   return left.ne(right);
+        case Expr::BvSLt:   return left.slt(right);
+        case Expr::BvSLtEq: return left.sle(right);
+        case Expr::BvSGt:   return left.sgt(right);
+        case Expr::BvSGtEq: return left.sge(right);
+        case Expr::BvULt:   return left.ult(right);
+        case Expr::BvULtEq: return left.ule(right);
+        case Expr::BvUGt:   return left.ugt(right);
+        case Expr::BvUGtEq: return left.uge(right);
+        default:
+            llvm_unreachable("Unknown comparison kind!");
+    }
+}
+
+llvm::APInt concatConstants(const llvm::APInt& high, const llvm::APInt& low)
+{
+    unsigned width = high.getBitWidth() + low.getBitWidth();
+    return high.zext(width).shl(low.getBitWidth()) | low.zext(width);
+}
+
+} // end anonymous namespace
+
+// Interval domain
+//===----------------------------------------------------------------------===//
+
+std::optional<llvm::APInt> IntervalDomain::getSingleElement(const ValueTy& value)
+{
+    if (const llvm::APInt* element = value.getSingleElement()) {
+        return *element;
+    }
+
+    return std::nullopt;
+}
+
+auto IntervalDomain::widen(const ValueTy& previous, const ValueTy& next) -> ValueTy
+{
+    llvm::ConstantRange result = previous.unionWith(next);
+    if (result == previous) {
+        return previous;
+    }
+
+    unsigned width = result.getBitWidth();
+    if (previous.isEmptySet()) {
+        return result;
+    }
+
+    if (previous.isWrappedSet() || result.isWrappedSet()) {
+        return getTop(width);
+    }
+
+    llvm::APInt lower = result.getUnsignedMin();
+    llvm::APInt upper = result.getUnsignedMax();
+
+    if (lower == previous.getUnsignedMin() && !lower.isNullValue()) {
+        return llvm::ConstantRange(lower, llvm::APInt::getNullValue(width));
+    }
+
+    if (upper == previous.getUnsignedMax() && !upper.isMaxValue()) {
+        return llvm::ConstantRange(llvm::APInt::getNullValue(width), upper + 1);
+    }
+
+    return getTop(width);
+}
+
+auto IntervalDomain::transfer(const ExprRef<NonNullaryExpr>& expr, llvm::ArrayRef<ValueTy> operands) -> ValueTy
+{
+    unsigned width = getTrackedWidth(expr->getType());
+
+    if (isComparison(expr->getKind())) {
+        llvm::CmpInst::Predicate pred = getPredicate(expr->getKind());
+        const ValueTy& left = operands[0];
+        const ValueTy& right = operands[1];
+
+        if (llvm::ConstantRange::makeSatisfyingICmpRegion(pred, right).contains(left)) {
+            return getConstant(llvm::APInt(1, 1));
+        }
+
+        auto inverse = llvm::CmpInst::getInversePredicate(pred);
+        if (llvm::ConstantRange::makeSatisfyingICmpRegion(inverse, right).contains(left)) {
+            return getConstant(llvm::APInt(1, 0));
+        }
+
+        return getTop(1);
+    }
+
+    switch (expr->getKind()) {
+        case Expr::ZExt:
+            return operands[0].zeroExtend(width);
+        case Expr::SExt:
+            return operands[0].signExtend(width);
+        case Expr::Extract: {
+            auto extract = llvm::cast<ExtractExpr>(expr);
+            llvm::ConstantRange shifted = operands[0];
+            if (extract->getOffset() != 0) {
+                llvm::APInt offset(shifted.getBitWidth(), extract->getOffset());
+                shifted = shifted.lshr(llvm::ConstantRange(offset));
+            }
+            return shifted.truncate(width);
+        }
+        case Expr::BvConcat: {
+            auto high = getSingleElement(operands[0]);
+            auto low = getSingleElement(operands[1]);
+            if (high && low) {
+                return getConstant(concatConstants(*high, *low));
+            }
+            return getTop(width);
+        }
+        case Expr::Add:
+            return operands[0].add(operands[1]);
+        case Expr::Sub:
+            return operands[0].sub(operands[1]);
+        case Expr::Mul:
+            return operands[0].multiply(operands[1]);
+        case Expr::BvUDiv:
+            // Division by zero is defined in the SMT semantics, but not in LLVM's.
+            if (operands[1].contains(llvm::APInt::getNullValue(width))) {
+                return getTop(width);
+            }
+            return operands[0].udiv(operands[1]);
+        case Expr::Shl:
+        case Expr::LShr:
+        case Expr::AShr:
+            // The same goes for shifts by at least the bit width.
+            if (operands[1].getUnsignedMax().uge(width)) {
+                return getTop(width);
+            }
+            if (expr->getKind() == Expr::Shl) {
+                return operands[0].shl(operands[1]);
+            }
+            if (expr->getKind() == Expr::LShr) {
+                return operands[0].lshr(operands[1]);
+            }
+            return operands[0].ashr(operands[1]);
+        case Expr::BvAnd:
+            return operands[0].binaryAnd(operands[1]);
+        case Expr::BvOr:
+            return operands[0].binaryOr(operands[1]);
+        default:
+            return getTop(width);
+    }
+}
+
+auto IntervalDomain::refine(Expr::ExprKind kind, const ValueTy& lhs, const ValueTy& rhs) -> ValueTy
+{
+    return lhs.intersectWith(llvm::ConstantRange::makeAllowedICmpRegion(getPredicate(kind), rhs));
+}
+
+// Known bits domain
+//===----------------------------------------------------------------------===//
+
+auto KnownBitsDomain::getConstant(const llvm::APInt& value) -> ValueTy
+{
+    llvm::KnownBits result(value.getBitWidth());
+    result.One = value;
+    result.Zero = ~value;
+
+    return result;
+}
+
+std::optional<llvm::APInt> KnownBitsDomain::getSingleElement(const ValueTy& value)
+{
+    if (!value.hasConflict() && (value.Zero | value.One).isAllOnesValue()) {
+        return value.One;
+    }
+
+    return std::nullopt;
+}
+
+auto KnownBitsDomain::join(const ValueTy& left, const ValueTy& right) -> ValueTy
+{
+    llvm::KnownBits result(left.getBitWidth());
+    result.Zero = left.Zero & right.Zero;
+    result.One = left.One & right.One;
+
+    return result;
+}
+
+auto KnownBitsDomain::meet(const ValueTy& left, const ValueTy& right) -> ValueTy
+{
+    llvm::KnownBits result(left.getBitWidth());
+    result.Zero = left.Zero | right.Zero;
+    result.One = left.One | right.One;
+
+    return result;
+}
+
+auto KnownBitsDomain::transfer(const ExprRef<NonNullaryExpr>& expr, llvm::ArrayRef<ValueTy> operands) -> ValueTy
+{
+    unsigned width = getTrackedWidth(expr->getType());
+    Expr::ExprKind kind = expr->getKind();
+
+    if (isComparison(kind)) {
+        auto left = getSingleElement(operands[0]);
+        auto right = getSingleElement(operands[1]);
+        if (left && right) {
+            return getConstant(llvm::APInt(1, compareConstants(kind, *left, *right)));
+        }
+
+        const ValueTy& lhs = operands[0];
+        const ValueTy& rhs = operands[1];
+        std::optional<bool> result;
+
+        switch (kind) {
+            case Expr::Eq:
+            case Expr::NotEq:
+                // The operands differ if a bit is known to be zero in one and one in the other.
+                if (!((lhs.Zero & rhs.One) | (lhs.One & rhs.Zero)).isNullValue()) {
+                    result = kind == Expr::NotEq;
+                }
+                break;
+            case Expr::BvULt:
+            case Expr::BvUGtEq:
+                // The unsigned minimum is the value of the known ones, the maximum is the complement of the known zeros.
+                if ((~lhs.Zero).ult(rhs.One)) {
+                    result = kind == Expr::BvULt;
+                } else if (lhs.One.uge(~rhs.Zero)) {
+                    result = kind == Expr::BvUGtEq;
+                }
+                break;
+            case Expr::BvUGt:
+            case Expr::BvULtEq:
+                if (lhs.One.ugt(~rhs.Zero)) {
+                    result = kind == Expr::BvUGt;
+                } else if ((~lhs.Zero).ule(rhs.One)) {
+                    result = kind == Expr::BvULtEq;
+                }
+                break;
+            default:
+                break;
+        }
+
+        if (result) {
+            return getConstant(llvm::APInt(1, *result));
+        }
+        return getTop(1);
+    }
+
+    switch (kind) {
+        case Expr::ZExt: {
+            llvm::KnownBits result(width);
+            unsigned operandWidth = operands[0].getBitWidth();
+            result.Zero = operands[0].Zero.zext(width) | llvm::APInt::getBitsSetFrom(width, operandWidth);
+            result.One = operands[0].One.zext(width);
+            return result;
+        }
+        case Expr::SExt: {
+            llvm::KnownBits result(width);
+            result.Zero = operands[0].Zero.sext(width);
+            result.One = operands[0].One.sext(width);
+            return result;
+        }
+        case Expr::Extract: {
+            auto extract = llvm::cast<ExtractExpr>(expr);
+            llvm::KnownBits result(width);
+            result.Zero = operands[0].Zero.extractBits(width, extract->getOffset());
+            result.One = operands[0].One.extractBits(width, extract->getOffset());
+            return result;
+        }
+        case Expr::BvConcat: {
+            llvm::KnownBits result(width);
+            result.Zero = concatConstants(operands[0].Zero, operands[1].Zero);
+            result.One = concatConstants(operands[0].One, operands[1].One);
+            return result;
+        }
+        case Expr::Add:
+        case Expr::Sub:
+            return llvm::KnownBits::computeForAddSub(kind == Expr::Add, false, operands[0], operands[1]);
+        case Expr::Mul: {
+            auto left = getSingleElement(operands[0]);
+            auto right = getSingleElement(operands[1]);
+            if (left && right) {
+                return getConstant(*left * *right);
+            }
+
+            // The trailing zeros of the factors add up in the product.
+            unsigned trailingZeros = std::min(
+                width, operands[0].Zero.countTrailingOnes() + operands[1].Zero.countTrailingOnes()
+            );
+            llvm::KnownBits result(width);
+            result.Zero.setLowBits(trailingZeros);
+            return result;
+        }
+        case Expr::Shl:
+        case Expr::LShr:
+        case Expr::AShr: {
+            auto amount = getSingleElement(operands[1]);
+            if (!amount || amount->uge(width)) {
+                return getTop(width);
+            }
+
+            unsigned shift = amount->getZExtValue();
+            llvm::KnownBits result(width);
+            if (kind == Expr::Shl) {
+                result.Zero = operands[0].Zero.shl(shift);
+                result.Zero.setLowBits(shift);
+                result.One = operands[0].One.shl(shift);
+            } else if (kind == Expr::LShr) {
+                result.Zero = operands[0].Zero.lshr(shift);
+                result.Zero.setHighBits(shift);
+                result.One = operands[0].One.lshr(shift);
+            } else {
+                result.Zero = operands[0].Zero.ashr(shift);
+                result.One = operands[0].One.ashr(shift);
+            }
+            return result;
+        }
+        case Expr::BvAnd: {
+            llvm::KnownBits result(width);
+            result.Zero = operands[0].Zero | operands[1].Zero;
+            result.One = operands[0].One & operands[1].One;
+            return result;
+        }
+        case Expr::BvOr: {
+            llvm::KnownBits result(width);
+            result.Zero = operands[0].Zero & operands[1].Zero;
+            result.One = operands[0].One | operands[1].One;
+            return result;
+        }
+        case Expr::BvXor: {
+            const ValueTy& left = operands[0];
+            const ValueTy& right = operands[1];
+            llvm::KnownBits result(width);
+            result.Zero = (left.Zero & right.Zero) | (left.One & right.One);
+            result.One = (left.Zero & right.One) | (left.One & right.Zero);
+            return result;
+        }
+        default:
+            return getTop(width);
+    }
+}
+
+auto KnownBitsDomain::refine(Expr::ExprKind kind, const ValueTy& lhs, const ValueTy& rhs) -> ValueTy
+{
+    if (kind == Expr::Eq) {
+        return meet(lhs, rhs);
+    }
+
+    if (kind == Expr::NotEq) {
+        auto left = getSingleElement(lhs);
+        auto right = getSingleElement(rhs);
+        if (left && right && *left == *right) {
+            // Return a conflicting value.
+            return meet(getConstant(*left), getConstant(~*left));
+        }
+    }
+
+    return lhs;
+}
+
+// Abstract states
+//===----------------------------------------------------------------------===//
+
+template<class Domain>
+void AbstractState<Domain>::set(Variable* variable, const ValueTy& value)
+{
+    if (mIsBottom) {
+        return;
+    }
+
+    if (Domain::isBottom(value)) {
+        mIsBottom = true;
+        mValues.clear();
+        return;
+    }
+
+    if (Domain::isTop(value)) {
+        mValues.erase(variable);
+        return;
+    }
+
+    auto result = mValues.try_emplace(variable, value);
+    if (!result.second) {
+        result.first->second = value;
+    }
+}
+
+template<class Domain>
+void AbstractState<Domain>::refine(Variable* variable, const ValueTy& value)
+{
+    auto it = mValues.find(variable);
+    if (it == mValues.end()) {
+        this->set(variable, value);
+    } else {
+        this->set(variable, Domain::meet(it->second, value));
+    }
+}
+
+template<class Domain>
+auto AbstractState<Domain>::join(const AbstractState& other) const -> AbstractState
+{
+    if (mIsBottom) {
+        return other;
+    }
+
+    if (other.mIsBottom) {
+        return *this;
+    }
+
+    // Variables which are only present in one of the states may take any value.
+    AbstractState result;
+    for (auto& [variable, value] : mValues) {
+        auto it = other.mValues.find(variable);
+        if (it != other.mValues.end()) {
+            result.set(variable, Domain::join(value, it->second));
+        }
+    }
+
+    return result;
+}
+
+template<class Domain>
+auto AbstractState<Domain>::widen(const AbstractState& next) const -> AbstractState
+{
+    if (mIsBottom) {
+        return next;
+    }
+
+    if (next.mIsBottom) {
+        return *this;
+    }
+
+    AbstractState result;
+    for (auto& [variable, value] : mValues) {
+        auto it = next.mValues.find(variable);
+        if (it != next.mValues.end()) {
+            result.set(variable, Domain::widen(value, it->second));
+        }
+    }
+
+    return result;
+}
+
+template<class Domain>
+bool AbstractState<Domain>::equals(const AbstractState& other) const
+{
+    if (mIsBottom != other.mIsBottom || mValues.size() != other.mValues.size()) {
+        return false;
+    }
+
+    for (auto& [variable, value] : mValues) {
+        auto it = other.mValues.find(variable);
+        if (it == other.mValues.end() || !Domain::equals(value, it->second)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Expression evaluation
+//===----------------------------------------------------------------------===//
+
+namespace gazer
+{
+
+/// Evaluates expressions in an abstract state. Boolean connectives and selects
+/// are evaluated here, all other operations are handled by the domain.
+template<class Domain>
+class AbstractExprEvaluator :
+    public ExprWalker<AbstractExprEvaluator<Domain>, std::optional<typename Domain::ValueTy>>
+{
+    using ValueTy = typename Domain::ValueTy;
+    using ResultTy = std::optional<ValueTy>;
+public:
+    ResultTy evaluate(const ExprPtr& expr, const AbstractState<Domain>& state)
+    {
+        mState = &state;
+        return this->walk(expr);
+    }
+
+    ResultTy visitExpr(const ExprPtr& expr);
+
+private:
+    std::optional<bool> getBoolOperand(size_t i) const
+    {
+        ResultTy value = this->getOperand(i);
+        if (!value) {
+            return std::nullopt;
+        }
+
+        if (auto element = Domain::getSingleElement(*value)) {
+            return element->getBoolValue();
+        }
+
+        return std::nullopt;
+    }
+
+    static ResultTy makeBool(bool value) { return Domain::getConstant(llvm::APInt(1, value)); }
+
+private:
+    const AbstractState<Domain>* mState = nullptr;
+};
+
+} // end namespace gazer
+
+template<class Domain>
+auto AbstractExprEvaluator<Domain>::visitExpr(const ExprPtr& expr) -> ResultTy
+{
+    unsigned width = getTrackedWidth(expr->getType());
+    if (width == 0) {
+        return std::nullopt;
+    }
+
+    switch (expr->getKind()) {
+        case Expr::Undef:
+            return std::nullopt;
+        case Expr::Literal:
+            if (auto boolLit = llvm::dyn_cast<BoolLiteralExpr>(expr)) {
+                return makeBool(boolLit->getValue());
+            }
+            return Domain::getConstant(llvm::cast<BvLiteralExpr>(expr)->getValue());
+        case Expr::VarRef:
+            return mState->lookup(&llvm::cast<VarRefExpr>(expr)->getVariable());
+        case Expr::Not: {
+            auto value = this->getBoolOperand(0);
+            return value ? makeBool(!*value) : std::nullopt;
+        }
+        case Expr::And:
+        case Expr::Or: {
+            bool isAnd = expr->getKind() == Expr::And;
+            bool allKnown = true;
+            for (size_t i = 0; i < llvm::cast<NonNullaryExpr>(expr)->getNumOperands(); ++i) {
+                auto value = this->getBoolOperand(i);
+                if (!value) {
+                    allKnown = false;
+                } else if (*value != isAnd) {
+                    return makeBool(!isAnd);
+                }
+            }
+            return allKnown ? makeBool(isAnd) : std::nullopt;
+        }
+        case Expr::Imply: {
+            auto left = this->getBoolOperand(0);
+            auto right = this->getBoolOperand(1);
+            if ((left && !*left) || (right && *right)) {
+                return makeBool(true);
+            }
+            if (left && right) {
+                return makeBool(false);
+            }
+            return std::nullopt;
+        }
+        case Expr::Select: {
+            if (auto condition = this->getBoolOperand(0)) {
+                return this->getOperand(*condition ? 1 : 2);
+            }
+            ResultTy then = this->getOperand(1);
+            ResultTy elze = this->getOperand(2);
+            if (then && elze) {
+                return Domain::join(*then, *elze);
+            }
+            return std::nullopt;
+        }
+        default:
+            break;
+    }
+
+    auto nn = llvm::dyn_cast<NonNullaryExpr>(expr);
+    if (nn == nullptr) {
+        return std::nullopt;
+    }
+
+    llvm::SmallVector<ValueTy, 2> operands;
+    for (size_t i = 0; i < nn->getNumOperands(); ++i) {
+        unsigned operandWidth = getTrackedWidth(nn->getOperand(i)->getType());
+        if (operandWidth == 0) {
+            return std::nullopt;
+        }
+
+        ResultTy value = this->getOperand(i);
+        operands.push_back(value ? *value : Domain::getTop(operandWidth));
+    }
+
+    ValueTy result = Domain::transfer(nn, operands);
+    if (Domain::isBottom(result)) {
+        // Operations on non-empty values must not be empty.
+        return std::nullopt;
+    }
+
+    return result;
+}
+
+// Fixpoint computation
+//===----------------------------------------------------------------------===//
+
+template<class Domain>
+CfaAbstractInterpreter<Domain>::CfaAbstractInterpreter(Cfa& cfa, unsigned widenDelay)
+    : mCfa(cfa), mEvaluator(new AbstractExprEvaluator<Domain>())
+{
+    this->run(widenDelay);
+}
+
+template<class Domain>
+CfaAbstractInterpreter<Domain>::~CfaAbstractInterpreter() = default;
+
+template<class Domain>
+void CfaAbstractInterpreter<Domain>::run(unsigned widenDelay)
+{
+    std::vector<Location*> topo;
+    llvm::DenseMap<Location*, size_t> locNumbers;
+    createTopologicalSort(mCfa, topo, &locNumbers);
+
+    // It is enough to widen at the targets of back edges, as each cycle contains one.
+    llvm::DenseSet<Location*> wideningPoints;
+    for (Location* location : topo) {
+        for (Transition* edge : location->outgoing()) {
+            if (locNumbers[edge->getTarget()] <= locNumbers[location]) {
+                wideningPoints.insert(edge->getTarget());
+            }
+        }
+    }
+
+    llvm::DenseMap<Location*, unsigned> numUpdates;
+    std::set<size_t> worklist;
+
+    mStates.try_emplace(mCfa.getEntry(), StateTy());
+    worklist.insert(locNumbers[mCfa.getEntry()]);
+
+    while (!worklist.empty()) {
+        Location* location = topo[*worklist.begin()];
+        worklist.erase(worklist.begin());
+
+        // Copy the state, as inserting new states may invalidate references into the map.
+        StateTy state = mStates.find(location)->second;
+
+        for (Transition* edge : location->outgoing()) {
+            StateTy post = this->getPostState(edge, state);
+            if (post.isBottom()) {
+                continue;
+            }
+
+            Location* target = edge->getTarget();
+            auto it = mStates.find(target);
+            if (it == mStates.end()) {
+                mStates.try_emplace(target, std::move(post));
+                worklist.insert(locNumbers[target]);
+                continue;
+            }
+
+            StateTy joined = it->second.join(post);
+            if (joined.equals(it->second)) {
+                continue;
+            }
+
+            if (wideningPoints.count(target) != 0 && ++numUpdates[target] > widenDelay) {
+                joined = it->second.widen(joined);
+            }
+
+            it->second = std::move(joined);
+            worklist.insert(locNumbers[target]);
+        }
+    }
+}
+
+template<class Domain>
+auto CfaAbstractInterpreter<Domain>::getState(Location* location) const -> const StateTy&
+{
+    auto it = mStates.find(location);
+    assert(it != mStates.end() && "The location must be reachable!");
+
+    return it->second;
+}
+
+template<class Domain>
+auto CfaAbstractInterpreter<Domain>::getGuardedState(Transition* edge) -> StateTy
+{
+    if (!this->isReachable(edge->getSource())) {
+        return StateTy::getBottom();
+    }
+
+    return this->assume(edge->getGuard(), this->getState(edge->getSource()));
+}
+
+template<class Domain>
+auto CfaAbstractInterpreter<Domain>::evaluate(const ExprPtr& expr, const StateTy& state) -> std::optional<ValueTy>
+{
+    return mEvaluator->evaluate(expr, state);
+}
+
+template<class Domain>
+auto CfaAbstractInterpreter<Domain>::assume(const ExprPtr& guard, const StateTy& state) -> StateTy
+{
+    if (auto value = this->evaluate(guard, state)) {
+        auto element = Domain::getSingleElement(*value);
+        if (element && element->isNullValue()) {
+            return StateTy::getBottom();
+        }
+    }
+
+    StateTy result = state;
+    this->refine(guard, true, result);
+
+    return result;
+}
+
+template<class Domain>
+void CfaAbstractInterpreter<Domain>::refine(const ExprPtr& expr, bool positive, StateTy& state)
+{
+    if (state.isBottom()) {
+        return;
+    }
+
+    Expr::ExprKind kind = expr->getKind();
+    switch (kind) {
+        case Expr::Not:
+            this->refine(llvm::cast<NotExpr>(expr)->getOperand(0), !positive, state);
+            return;
+        case Expr::And:
+        case Expr::Or:
+            // Conjunctions (and negated disjunctions) restrict the state by each operand.
+            if ((kind == Expr::And) == positive) {
+                for (const ExprPtr& operand : llvm::cast<NonNullaryExpr>(expr)->operands()) {
+                    this->refine(operand, positive, state);
+                }
+            }
+            return;
+        case Expr::VarRef:
+            state.refine(
+                &llvm::cast<VarRefExpr>(expr)->getVariable(),
+                Domain::getConstant(llvm::APInt(1, positive))
+            );
+            return;
+        default:
+            break;
+    }
+
+    if (!isComparison(kind)) {
+        return;
+    }
+
+    auto comparison = llvm::cast<NonNullaryExpr>(expr);
+    unsigned width = getTrackedWidth(comparison->getOperand(0)->getType());
+    if (width == 0) {
+        return;
+    }
+
+    auto refineOperand = [this, width, &state](const ExprPtr& operand, const ExprPtr& other, Expr::ExprKind cmp) {
+        auto varRef = llvm::dyn_cast<VarRefExpr>(operand);
+        if (varRef == nullptr || state.isBottom()) {
+            return;
+        }
+
+        auto current = this->evaluate(operand, state);
+        auto otherValue = this->evaluate(other, state);
+
+        state.refine(&varRef->getVariable(), Domain::refine(
+            cmp,
+            current ? *current : Domain::getTop(width),
+            otherValue ? *otherValue : Domain::getTop(width)
+        ));
+    };
+
+    Expr::ExprKind cmp = positive ? kind : getNegatedComparison(kind);
+    refineOperand(comparison->getOperand(0), comparison->getOperand(1), cmp);
+    refineOperand(comparison->getOperand(1), comparison->getOperand(0), getSwappedComparison(cmp));
+}
+
+template<class Domain>
+auto CfaAbstractInterpreter<Domain>::getPostState(Transition* edge, const StateTy& state) -> StateTy
+{
+    StateTy result = this->assume(edge->getGuard(), state);
+    if (result.isBottom()) {
+        return result;
+    }
+
+    if (auto assign = llvm::dyn_cast<AssignTransition>(edge)) {
+        // Assignments are parallel: evaluate all values before updating the state.
+        llvm::SmallVector<std::optional<ValueTy>, 4> values;
+        for (const VariableAssignment& assignment : *assign) {
+            values.push_back(this->evaluate(assignment.getValue(), result));
+        }
+
+        size_t i = 0;
+        for (const VariableAssignment& assignment : *assign) {
+            if (values[i]) {
+                result.set(assignment.getVariable(), *values[i]);
+            } else {
+                result.forget(assignment.getVariable());
+            }
+            ++i;
+        }
+    } else if (auto call = llvm::dyn_cast<CallTransition>(edge)) {
+        for (const VariableAssignment& output : call->outputs()) {
+            result.forget(output.getVariable());
+        }
+    }
+
+    return result;
+}
+
+namespace gazer
+{
+    template class AbstractState<IntervalDomain>;
+    template class AbstractState<KnownBitsDomain>;
+    template class CfaAbstractInterpreter<IntervalDomain>;
+    template class CfaAbstractInterpreter<KnownBitsDomain>;
+} // end namespace gazer
+
+// Simplification
+//===----------------------------------------------------------------------===//
+
+namespace
+{
+
+/// Substitutes the variables which have a constant value in either of the
+/// given states. Returns a null pointer if there are no such variables.
+std::unique_ptr<VariableExprRewrite> createConstantRewrite(
+    const AbstractState<IntervalDomain>& intervals,
+    const AbstractState<KnownBitsDomain>& knownBits,
+    ExprBuilder& builder)
+{
+    std::unique_ptr<VariableExprRewrite> rewrite;
+
+    auto addConstant = [&rewrite, &builder](Variable* variable, const std::optional<llvm::APInt>& value) {
+        if (!value) {
+            return;
+        }
+
+        if (rewrite == nullptr) {
+            rewrite = std::make_unique<VariableExprRewrite>(builder);
+        }
+
+        if (variable->getType().isBoolType()) {
+            (*rewrite)[variable] = builder.BoolLit(value->getBoolValue());
+        } else {
+            (*rewrite)[variable] = builder.BvLit(*value);
+        }
+    };
+
+    for (auto& [variable, value] : intervals.values()) {
+        addConstant(variable, IntervalDomain::getSingleElement(value));
+    }
+
+    for (auto& [variable, value] : knownBits.values()) {
+        addConstant(variable, KnownBitsDomain::getSingleElement(value));
+    }
+
+    return rewrite;
+}
+
+} // end anonymous namespace
+
+bool gazer::SimplifyCfaWithInvariants(Cfa& cfa, ExprBuilder& builder)
+{
+    CfaAbstractInterpreter<IntervalDomain> intervals(cfa);
+    CfaAbstractInterpreter<KnownBitsDomain> knownBits(cfa);
+
+    bool changed = false;
+
+    std::vector<Transition*> edges(cfa.edge_begin(), cfa.edge_end());
+    for (Transition* edge : edges) {
+        Location* source = edge->getSource();
+        if (!intervals.isReachable(source) || !knownBits.isReachable(source)) {
+            cfa.disconnectEdge(edge);
+            changed = true;
+            continue;
+        }
+
+        auto guardedIntervals = intervals.getGuardedState(edge);
+        auto guardedKnownBits = knownBits.getGuardedState(edge);
+        if (guardedIntervals.isBottom() || guardedKnownBits.isBottom()) {
+            cfa.disconnectEdge(edge);
+            changed = true;
+            continue;
+        }
+
+        // The guard is evaluated in the state of the source location, while the
+        // assignments and arguments may also use the information from the guard.
+        auto guardRewrite = createConstantRewrite(
+            intervals.getState(source), knownBits.getState(source), builder
+        );
+        auto bodyRewrite = createConstantRewrite(guardedIntervals, guardedKnownBits, builder);
+        if (bodyRewrite == nullptr) {
+            continue;
+        }
+
+        ExprPtr guard = guardRewrite != nullptr ? guardRewrite->walk(edge->getGuard()) : edge->getGuard();
+        bool edgeChanged = guard != edge->getGuard();
+
+        auto rewriteAssignments = [&bodyRewrite, &edgeChanged](auto&& assignments) {
+            std::vector<VariableAssignment> result;
+            for (const VariableAssignment& assignment : assignments) {
+                ExprPtr value = bodyRewrite->walk(assignment.getValue());
+                edgeChanged |= value != assignment.getValue();
+                result.emplace_back(assignment.getVariable(), value);
+            }
+            return result;
+        };
+
+        if (auto assign = llvm::dyn_cast<AssignTransition>(edge)) {
+            auto assignments = rewriteAssignments(*assign);
+            if (edgeChanged) {
+                cfa.createAssignTransition(source, edge->getTarget(), guard, assignments);
+            }
+        } else if (auto call = llvm::dyn_cast<CallTransition>(edge)) {
+            auto inputs = rewriteAssignments(call->inputs());
+            if (edgeChanged) {
+                std::vector<VariableAssignment> outputs(call->output_begin(), call->output_end());
+                cfa.createCallTransition(
+                    source, edge->getTarget(), guard, call->getCalledAutomaton(), inputs, outputs
+                );
+            }
+        }
+
+        if (edgeChanged) {
+            cfa.disconnectEdge(edge);
+            changed = true;
+        }
+    }
+
+    std::vector<std::pair<Location*, ExprPtr>> errors(cfa.error_begin(), cfa.error_end());
+    for (auto& [location, errorExpr] : errors) {
+        if (!intervals.isReachable(location) || !knownBits.isReachable(location)) {
+            continue;
+        }
+
+        auto rewrite = createConstantRewrite(
+            intervals.getState(location), knownBits.getState(location), builder
+        );
+        if (rewrite != nullptr) {
+            cfa.addErrorCode(location, rewrite->walk(errorExpr));
+        }
+    }
+
+    if (!changed) {
+        return false;
+    }
+
+    cfa.removeUnreachableLocations();
+
+    return true;
+}
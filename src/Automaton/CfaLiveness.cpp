@@ -0,0 +1,205 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+#include "gazer/Automaton/CfaLiveness.h"
+#include "gazer/Automaton/CfaUtils.h"
+#include "gazer/Core/Expr/ExprMetrics.h"
+
+#include <set>
+
+using namespace gazer;
+
+namespace
+{
+
+struct TransitionEffect
+{
+    std::vector<Variable*> reads;
+    std::vector<Variable*> writes;
+};
+
+TransitionEffect getTransitionEffect(Transition* edge)
+{
+    TransitionEffect effect;
+    ExprMetrics reads(edge->getGuard());
+
+    if (auto assign = llvm::dyn_cast<AssignTransition>(edge)) {
+        for (const VariableAssignment& assignment : *assign) {
+            reads.add(assignment.getValue());
+            effect.writes.push_back(assignment.getVariable());
+        }
+    } else if (auto call = llvm::dyn_cast<CallTransition>(edge)) {
+        for (const VariableAssignment& input : call->inputs()) {
+            reads.add(input.getValue());
+        }
+        for (const VariableAssignment& output : call->outputs()) {
+            effect.writes.push_back(output.getVariable());
+        }
+    }
+
+    effect.reads.assign(reads.getSupport().begin(), reads.getSupport().end());
+    return effect;
+}
+
+} // end anonymous namespace
+
+CfaLiveness::CfaLiveness(Cfa& cfa)
+{
+    std::vector<Location*> topo;
+    llvm::DenseMap<Location*, size_t> locNumbers;
+    createTopologicalSort(cfa, topo, &locNumbers);
+
+    // Only the variables which are read somewhere may be live, thus the
+    // variables which are only assigned do not need a number.
+    auto getNumber = [this](Variable* variable) {
+        auto [it, inserted] = mVariableNumbers.try_emplace(variable, mVariables.size());
+        if (inserted) {
+            mVariables.push_back(variable);
+        }
+        return it->second;
+    };
+
+    llvm::DenseMap<Transition*, TransitionEffect> effects;
+    for (Location* location : topo) {
+        for (Transition* edge : location->outgoing()) {
+            auto& effect = effects[edge] = getTransitionEffect(edge);
+            for (Variable* variable : effect.reads) {
+                getNumber(variable);
+            }
+        }
+    }
+
+    for (Variable& output : cfa.outputs()) {
+        getNumber(&output);
+    }
+
+    std::vector<std::pair<Location*, std::vector<Variable*>>> initialReads;
+    for (auto& [location, errorExpr] : cfa.errors()) {
+        ExprMetrics metrics(errorExpr);
+        auto& reads = initialReads.emplace_back(location, std::vector<Variable*>{}).second;
+        for (Variable* variable : metrics.getSupport()) {
+            getNumber(variable);
+            reads.push_back(variable);
+        }
+    }
+
+    unsigned numVariables = mVariableNumbers.size();
+    for (Location* location : topo) {
+        mLiveVariables.try_emplace(location, numVariables);
+    }
+
+    auto setInitial = [this](Location* location, Variable* variable) {
+        auto it = mLiveVariables.find(location);
+        if (it != mLiveVariables.end()) {
+            it->second.set(mVariableNumbers[variable]);
+        }
+    };
+
+    for (Variable& output : cfa.outputs()) {
+        setInitial(cfa.getExit(), &output);
+    }
+
+    for (auto& [location, reads] : initialReads) {
+        for (Variable* variable : reads) {
+            setInitial(location, variable);
+        }
+    }
+
+    // The analysis flows backwards, thus successors are visited first.
+    std::set<size_t, std::greater<>> worklist;
+    for (size_t i = 0; i < topo.size(); ++i) {
+        worklist.insert(i);
+    }
+
+    while (!worklist.empty()) {
+        Location* location = topo[*worklist.begin()];
+        worklist.erase(worklist.begin());
+
+        llvm::BitVector& live = mLiveVariables.find(location)->second;
+        bool changed = false;
+
+        for (Transition* edge : location->outgoing()) {
+            llvm::BitVector flow = mLiveVariables.find(edge->getTarget())->second;
+            auto& effect = effects.find(edge)->second;
+
+            for (Variable* variable : effect.writes) {
+                auto it = mVariableNumbers.find(variable);
+                if (it != mVariableNumbers.end()) {
+                    flow.reset(it->second);
+                }
+            }
+
+            for (Variable* variable : effect.reads) {
+                flow.set(mVariableNumbers[variable]);
+            }
+
+            if (flow.test(live)) {
+                live |= flow;
+                changed = true;
+            }
+        }
+
+        if (changed) {
+            for (Transition* edge : location->incoming()) {
+                auto it = locNumbers.find(edge->getSource());
+                if (it != locNumbers.end()) {
+                    worklist.insert(it->second);
+                }
+            }
+        }
+    }
+
+    mLiveAnywhere.resize(numVariables);
+    for (auto& [location, live] : mLiveVariables) {
+        mLiveAnywhere |= live;
+    }
+}
+
+bool CfaLiveness::isLiveAt(Variable* variable, Location* location) const
+{
+    auto locIt = mLiveVariables.find(location);
+    if (locIt == mLiveVariables.end()) {
+        return true;
+    }
+
+    auto varIt = mVariableNumbers.find(variable);
+    if (varIt == mVariableNumbers.end()) {
+        return false;
+    }
+
+    return locIt->second.test(varIt->second);
+}
+
+bool CfaLiveness::isLiveAnywhere(Variable* variable) const
+{
+    auto it = mVariableNumbers.find(variable);
+    return it != mVariableNumbers.end() && mLiveAnywhere.test(it->second);
+}
+
+bool CfaLiveness::getLiveVariables(Location* location, llvm::SmallVectorImpl<Variable*>& result) const
+{
+    auto it = mLiveVariables.find(location);
+    if (it == mLiveVariables.end()) {
+        return false;
+    }
+
+    for (unsigned idx : it->second.set_bits()) {
+        result.push_back(mVariables[idx]);
+    }
+
+    return true;
+}
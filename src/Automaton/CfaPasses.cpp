@@ -0,0 +1,617 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+#include "gazer/Automaton/CfaPasses.h"
+#include "gazer/Automaton/CfaAbstractInterpretation.h"
+#include "gazer/Automaton/CfaLiveness.h"
+#include "gazer/Automaton/CfaTransforms.h"
+#include "gazer/Automaton/CfaUtils.h"
+#include "gazer/Core/LiteralExpr.h"
+#include "gazer/Core/Expr/ExprBuilder.h"
+#include "gazer/Core/Expr/ExprMetrics.h"
+#include "gazer/Core/Expr/ExprRewrite.h"
+
+#include <llvm/ADT/DepthFirstIterator.h>
+#include <llvm/ADT/SmallPtrSet.h>
+#include <llvm/Support/Debug.h>
+#include <llvm/Support/MathExtras.h>
+#include <llvm/Support/raw_ostream.h>
+
+#define DEBUG_TYPE "CfaPasses"
+
+using namespace gazer;
+
+/// The maximum increase of the tree cost of the expressions of two transitions
+/// allowed for composing them. Values which are still live after the composed
+/// transition are both assigned and substituted, thus a small increase is
+/// expected, but chains of duplicated subterms must not grow without bounds.
+static constexpr uint64_t SequentialMergeCostBudget = 16;
+
+// Pass manager
+//===----------------------------------------------------------------------===//
+
+void CfaPassManager::addPass(std::unique_ptr<CfaPass> pass)
+{
+    mPasses.emplace_back().pass = std::move(pass);
+}
+
+bool CfaPassManager::run(AutomataSystem& system)
+{
+    bool changed = false;
+    for (Cfa& cfa : system) {
+        changed |= this->run(cfa);
+    }
+
+    return changed;
+}
+
+bool CfaPassManager::run(Cfa& cfa)
+{
+    mNumBeginLocs += cfa.getNumLocations();
+    mNumBeginTransitions += cfa.getNumTransitions();
+    mNumBeginLocals += cfa.getNumLocals();
+
+    bool changed = false;
+    for (PassInfo& info : mPasses) {
+        LLVM_DEBUG(llvm::dbgs() << "Running pass " << info.pass->getName() << " on " << cfa.getName() << "\n");
+
+        auto numLocs = static_cast<int64_t>(cfa.getNumLocations());
+        auto numTransitions = static_cast<int64_t>(cfa.getNumTransitions());
+        auto numLocals = static_cast<int64_t>(cfa.getNumLocals());
+
+        info.numRuns++;
+        if (info.pass->run(cfa)) {
+            info.numChanged++;
+            changed = true;
+        }
+
+        info.removedLocations += numLocs - static_cast<int64_t>(cfa.getNumLocations());
+        info.removedTransitions += numTransitions - static_cast<int64_t>(cfa.getNumTransitions());
+        info.removedLocals += numLocals - static_cast<int64_t>(cfa.getNumLocals());
+    }
+
+    mNumEndLocs += cfa.getNumLocations();
+    mNumEndTransitions += cfa.getNumTransitions();
+    mNumEndLocals += cfa.getNumLocals();
+
+    return changed;
+}
+
+void CfaPassManager::printStats(llvm::raw_ostream& os) const
+{
+    os << "--------- CFA pass statistics ---------\n";
+    os << "Number of locations on start: " << mNumBeginLocs << "\n";
+    os << "Number of locations on finish: " << mNumEndLocs << "\n";
+    os << "Number of transitions on start: " << mNumBeginTransitions << "\n";
+    os << "Number of transitions on finish: " << mNumEndTransitions << "\n";
+    os << "Number of locals on start: " << mNumBeginLocals << "\n";
+    os << "Number of locals on finish: " << mNumEndLocals << "\n";
+    for (const PassInfo& info : mPasses) {
+        os << "Pass " << info.pass->getName() << ": changed "
+            << info.numChanged << " of " << info.numRuns << " automata, removed "
+            << info.removedLocations << " locations, "
+            << info.removedTransitions << " transitions and "
+            << info.removedLocals << " locals\n";
+    }
+    os << "---------------------------------------\n";
+}
+
+// Helpers
+//===----------------------------------------------------------------------===//
+
+namespace
+{
+
+/// Returns true if \p location may be removed from \p cfa.
+bool isInnerLocation(Cfa& cfa, Location* location)
+{
+    return location != cfa.getEntry() && location != cfa.getExit() && !location->isError();
+}
+
+/// Returns true if \p edge has no effect besides moving between its locations.
+bool isEmptyTransition(Transition* edge)
+{
+    auto assign = llvm::dyn_cast<AssignTransition>(edge);
+    return assign != nullptr
+        && assign->getNumAssignments() == 0
+        && assign->getGuard() == BoolLiteralExpr::True(assign->getGuard()->getContext());
+}
+
+/// Creates a copy of \p edge between \p source and \p target.
+void copyTransition(Cfa& cfa, Transition* edge, Location* source, Location* target, const ExprPtr& guard)
+{
+    if (auto assign = llvm::dyn_cast<AssignTransition>(edge)) {
+        std::vector<VariableAssignment> assignments(assign->begin(), assign->end());
+        cfa.createAssignTransition(source, target, guard, assignments);
+        return;
+    }
+
+    auto call = llvm::cast<CallTransition>(edge);
+    std::vector<VariableAssignment> inputs(call->input_begin(), call->input_end());
+    std::vector<VariableAssignment> outputs(call->output_begin(), call->output_end());
+    cfa.createCallTransition(source, target, guard, call->getCalledAutomaton(), inputs, outputs);
+}
+
+// Invariant pruning
+//===----------------------------------------------------------------------===//
+
+class InvariantPruningPass final : public CfaPass
+{
+public:
+    explicit InvariantPruningPass(ExprBuilder& builder)
+        : CfaPass("invariant-pruning"), mBuilder(builder)
+    {}
+
+    bool run(Cfa& cfa) override {
+        return SimplifyCfaWithInvariants(cfa, mBuilder);
+    }
+
+private:
+    ExprBuilder& mBuilder;
+};
+
+// Location compaction
+//===----------------------------------------------------------------------===//
+
+class LocationCompactionPass final : public CfaPass
+{
+public:
+    explicit LocationCompactionPass(ExprBuilder& builder)
+        : CfaPass("location-compaction"), mBuilder(builder)
+    {}
+
+    bool run(Cfa& cfa) override;
+
+private:
+    bool removeDeadEnds(Cfa& cfa);
+    bool bypass(Cfa& cfa, Location* location);
+
+private:
+    ExprBuilder& mBuilder;
+};
+
+bool LocationCompactionPass::run(Cfa& cfa)
+{
+    bool changed = this->removeDeadEnds(cfa);
+
+    std::vector<Location*> locations(cfa.node_begin(), cfa.node_end());
+    for (Location* location : locations) {
+        if (isInnerLocation(cfa, location)) {
+            changed |= this->bypass(cfa, location);
+        }
+    }
+
+    if (changed) {
+        cfa.removeUnreachableLocations();
+    }
+
+    return changed;
+}
+
+bool LocationCompactionPass::removeDeadEnds(Cfa& cfa)
+{
+    // Paths which cannot reach the exit or an error location do not
+    // contribute to the behavior of the automaton.
+    llvm::df_iterator_default_set<Location*> visited;
+    auto visitBackwards = [&visited](Location* location) {
+        for (Location* pred : llvm::inverse_depth_first_ext(location, visited)) {
+            (void) pred;
+        }
+    };
+
+    visitBackwards(cfa.getExit());
+    for (auto& [location, errorExpr] : cfa.errors()) {
+        (void) errorExpr;
+        visitBackwards(location);
+    }
+
+    // Called automata may reach an error without ever returning, as calls
+    // to loops without exits do. Their call sites must be kept along with
+    // the call transitions, thus the search also starts from the targets.
+    for (Transition* edge : cfa.edges()) {
+        if (edge->isCall()) {
+            visitBackwards(edge->getTarget());
+        }
+    }
+
+    bool changed = false;
+    for (Location* location : cfa.nodes()) {
+        if (visited.count(location) == 0 && isInnerLocation(cfa, location)) {
+            cfa.disconnectNode(location);
+            changed = true;
+        }
+    }
+
+    return changed;
+}
+
+bool LocationCompactionPass::bypass(Cfa& cfa, Location* location)
+{
+    // If the only outgoing transition is empty, the incoming transitions may
+    // go directly to its target.
+    if (location->getNumOutgoing() == 1 && isEmptyTransition(*location->outgoing_begin())) {
+        Transition* empty = *location->outgoing_begin();
+        Location* target = empty->getTarget();
+        if (target == location) {
+            return false;
+        }
+
+        std::vector<Transition*> incoming(location->incoming_begin(), location->incoming_end());
+        for (Transition* edge : incoming) {
+            copyTransition(cfa, edge, edge->getSource(), target, edge->getGuard());
+            cfa.disconnectEdge(edge);
+        }
+        cfa.disconnectEdge(empty);
+
+        return true;
+    }
+
+    // Symmetrically, if the only incoming transition is empty, the outgoing
+    // transitions may start from its source.
+    if (location->getNumIncoming() == 1 && isEmptyTransition(*location->incoming_begin())) {
+        Transition* empty = *location->incoming_begin();
+        Location* source = empty->getSource();
+        if (source == location) {
+            return false;
+        }
+
+        std::vector<Transition*> outgoing(location->outgoing_begin(), location->outgoing_end());
+        for (Transition* edge : outgoing) {
+            copyTransition(cfa, edge, source, edge->getTarget(), edge->getGuard());
+            cfa.disconnectEdge(edge);
+        }
+        cfa.disconnectEdge(empty);
+
+        return true;
+    }
+
+    return false;
+}
+
+// Sequential composition
+//===----------------------------------------------------------------------===//
+
+class SequentialMergePass final : public CfaPass
+{
+public:
+    explicit SequentialMergePass(ExprBuilder& builder)
+        : CfaPass("sequential-merge"), mBuilder(builder)
+    {}
+
+    bool run(Cfa& cfa) override;
+
+private:
+    bool tryMerge(Cfa& cfa, Location* location, const CfaLiveness& liveness);
+
+    template<class Range>
+    uint64_t getCost(const ExprPtr& guard, Range&& assignments);
+
+private:
+    ExprBuilder& mBuilder;
+    ExprMetrics mCosts;
+};
+
+bool SequentialMergePass::run(Cfa& cfa)
+{
+    // The liveness information is not updated during the merges. Merging
+    // only replaces the reads of variables with reads of variables which were
+    // already live, thus the stale information is conservative.
+    CfaLiveness liveness(cfa);
+
+    std::vector<Location*> topo;
+    createTopologicalSort(cfa, topo);
+
+    bool changed = false;
+    for (Location* location : topo) {
+        if (isInnerLocation(cfa, location)) {
+            changed |= this->tryMerge(cfa, location, liveness);
+        }
+    }
+
+    // The measured expressions are only kept alive for the current automaton.
+    mCosts = ExprMetrics();
+
+    if (changed) {
+        cfa.removeUnreachableLocations();
+    }
+
+    return changed;
+}
+
+bool SequentialMergePass::tryMerge(Cfa& cfa, Location* location, const CfaLiveness& liveness)
+{
+    if (location->getNumIncoming() != 1 || location->getNumOutgoing() != 1) {
+        return false;
+    }
+
+    auto first = llvm::dyn_cast<AssignTransition>(*location->incoming_begin());
+    auto second = llvm::dyn_cast<AssignTransition>(*location->outgoing_begin());
+    if (first == nullptr || second == nullptr || first == second) {
+        return false;
+    }
+
+    // Substitution is only valid if the first transition does not read the
+    // variables it assigns, and the second transition does not assign the
+    // variables read or assigned by the first one. This way the composed
+    // transition has the same effect with parallel and sequential assignments.
+    ExprMetrics firstReads;
+    llvm::SmallPtrSet<Variable*, 8> firstWrites;
+    VariableExprRewrite rewrite(mBuilder);
+    for (const VariableAssignment& assignment : *first) {
+        firstReads.add(assignment.getValue());
+        firstWrites.insert(assignment.getVariable());
+        rewrite[assignment.getVariable()] = assignment.getValue();
+    }
+
+    // Each occurrence of an undef expression denotes an independent
+    // nondeterministic value, thus substituting them would lose the
+    // connection between the reads of the assigned variable.
+    if (firstReads.getNumNodesOfKind(Expr::Undef) != 0) {
+        return false;
+    }
+    firstReads.add(first->getGuard());
+
+    llvm::SmallPtrSet<Variable*, 8> firstAccesses(firstWrites.begin(), firstWrites.end());
+    for (Variable* variable : firstReads.getSupport()) {
+        if (!firstAccesses.insert(variable).second) {
+            return false;
+        }
+    }
+
+    for (const VariableAssignment& assignment : *second) {
+        if (firstAccesses.count(assignment.getVariable()) != 0) {
+            return false;
+        }
+    }
+
+    Location* target = second->getTarget();
+    ExprPtr guard = mBuilder.And(first->getGuard(), rewrite.walk(second->getGuard()));
+
+    std::vector<VariableAssignment> assignments;
+    for (const VariableAssignment& assignment : *first) {
+        if (liveness.isLiveAt(assignment.getVariable(), target)) {
+            assignments.push_back(assignment);
+        }
+    }
+
+    for (const VariableAssignment& assignment : *second) {
+        assignments.emplace_back(assignment.getVariable(), rewrite.walk(assignment.getValue()));
+    }
+
+    uint64_t oldCost = llvm::SaturatingAdd(
+        this->getCost(first->getGuard(), *first),
+        this->getCost(second->getGuard(), *second)
+    );
+    if (this->getCost(guard, assignments) > llvm::SaturatingAdd(oldCost, SequentialMergeCostBudget)) {
+        return false;
+    }
+
+    cfa.createAssignTransition(first->getSource(), target, guard, assignments);
+    cfa.disconnectEdge(first);
+    cfa.disconnectEdge(second);
+
+    return true;
+}
+
+template<class Range>
+uint64_t SequentialMergePass::getCost(const ExprPtr& guard, Range&& assignments)
+{
+    mCosts.add(guard);
+    uint64_t cost = mCosts.getTreeCostOf(guard);
+
+    // Each assignment costs a variable reference besides its value.
+    for (const VariableAssignment& assignment : assignments) {
+        mCosts.add(assignment.getValue());
+        cost = llvm::SaturatingAdd(cost, mCosts.getTreeCostOf(assignment.getValue()));
+        cost = llvm::SaturatingAdd(cost, uint64_t(1));
+    }
+
+    return cost;
+}
+
+// Parallel merging
+//===----------------------------------------------------------------------===//
+
+class ParallelMergePass final : public CfaPass
+{
+public:
+    explicit ParallelMergePass(ExprBuilder& builder)
+        : CfaPass("parallel-merge"), mBuilder(builder)
+    {}
+
+    bool run(Cfa& cfa) override;
+
+private:
+    ExprBuilder& mBuilder;
+};
+
+bool ParallelMergePass::run(Cfa& cfa)
+{
+    bool changed = false;
+
+    std::vector<Location*> locations(cfa.node_begin(), cfa.node_end());
+    for (Location* location : locations) {
+        llvm::SmallVector<AssignTransition*, 4> candidates;
+        for (Transition* edge : location->outgoing()) {
+            if (auto assign = llvm::dyn_cast<AssignTransition>(edge)) {
+                candidates.push_back(assign);
+            }
+        }
+
+        // Locations only have a few outgoing transitions,
+        // thus comparing each pair of them is cheap.
+        std::vector<bool> merged(candidates.size(), false);
+        for (size_t i = 0; i < candidates.size(); ++i) {
+            if (merged[i]) {
+                continue;
+            }
+
+            AssignTransition* edge = candidates[i];
+            ExprVector guards = { edge->getGuard() };
+            for (size_t j = i + 1; j < candidates.size(); ++j) {
+                AssignTransition* other = candidates[j];
+                if (!merged[j] && other->getTarget() == edge->getTarget()
+                    && std::equal(edge->begin(), edge->end(), other->begin(), other->end())
+                ) {
+                    guards.push_back(other->getGuard());
+                    merged[j] = true;
+                }
+            }
+
+            if (guards.size() == 1) {
+                continue;
+            }
+
+            merged[i] = true;
+            std::vector<VariableAssignment> assignments(edge->begin(), edge->end());
+            cfa.createAssignTransition(location, edge->getTarget(), mBuilder.Or(guards), assignments);
+            changed = true;
+        }
+
+        for (size_t i = 0; i < candidates.size(); ++i) {
+            if (merged[i]) {
+                cfa.disconnectEdge(candidates[i]);
+            }
+        }
+    }
+
+    if (changed) {
+        cfa.removeUnreachableLocations();
+    }
+
+    return changed;
+}
+
+// Dead assignment elimination
+//===----------------------------------------------------------------------===//
+
+class DeadAssignmentEliminationPass final : public CfaPass
+{
+public:
+    DeadAssignmentEliminationPass()
+        : CfaPass("dead-assignment-elimination")
+    {}
+
+    bool run(Cfa& cfa) override;
+};
+
+bool DeadAssignmentEliminationPass::run(Cfa& cfa)
+{
+    CfaLiveness liveness(cfa);
+
+    bool changed = false;
+    for (Transition* edge : cfa.edges()) {
+        auto assign = llvm::dyn_cast<AssignTransition>(edge);
+        if (assign == nullptr) {
+            continue;
+        }
+
+        Location* target = assign->getTarget();
+        size_t numAssignments = assign->getNumAssignments();
+        assign->removeAssignmentsIf([&liveness, target](const VariableAssignment& assignment) {
+            Variable* variable = assignment.getVariable();
+            return !liveness.isLiveAt(variable, target) || assignment.getValue() == variable->getRefExpr();
+        });
+
+        changed |= assign->getNumAssignments() != numAssignments;
+    }
+
+    // Remove the locals which are not referenced anymore.
+    llvm::SmallPtrSet<Variable*, 32> used;
+    auto addSupport = [&used](const ExprPtr& expr) {
+        ExprMetrics metrics(expr);
+        used.insert(metrics.getSupport().begin(), metrics.getSupport().end());
+    };
+
+    for (Transition* edge : cfa.edges()) {
+        addSupport(edge->getGuard());
+        if (auto assign = llvm::dyn_cast<AssignTransition>(edge)) {
+            for (const VariableAssignment& assignment : *assign) {
+                used.insert(assignment.getVariable());
+                addSupport(assignment.getValue());
+            }
+        } else if (auto call = llvm::dyn_cast<CallTransition>(edge)) {
+            for (const VariableAssignment& input : call->inputs()) {
+                addSupport(input.getValue());
+            }
+            for (const VariableAssignment& output : call->outputs()) {
+                used.insert(output.getVariable());
+            }
+        }
+    }
+
+    for (auto& [location, errorExpr] : cfa.errors()) {
+        addSupport(errorExpr);
+    }
+
+    size_t numLocals = cfa.getNumLocals();
+    cfa.removeLocalsIf([&cfa, &used](Variable* variable) {
+        return used.count(variable) == 0 && !cfa.isOutput(variable);
+    });
+
+    return changed || cfa.getNumLocals() != numLocals;
+}
+
+// Large-block encoding
+//===----------------------------------------------------------------------===//
+
+class LargeBlockEncodingPass final : public CfaPass
+{
+public:
+    explicit LargeBlockEncodingPass(ExprBuilder& builder)
+        : CfaPass("large-block-encoding"), mBuilder(builder)
+    {}
+
+    bool run(Cfa& cfa) override {
+        return EncodeLargeBlocks(cfa, mBuilder);
+    }
+
+private:
+    ExprBuilder& mBuilder;
+};
+
+} // end anonymous namespace
+
+std::unique_ptr<CfaPass> gazer::createInvariantPruningPass(ExprBuilder& builder)
+{
+    return std::make_unique<InvariantPruningPass>(builder);
+}
+
+std::unique_ptr<CfaPass> gazer::createLocationCompactionPass(ExprBuilder& builder)
+{
+    return std::make_unique<LocationCompactionPass>(builder);
+}
+
+std::unique_ptr<CfaPass> gazer::createSequentialMergePass(ExprBuilder& builder)
+{
+    return std::make_unique<SequentialMergePass>(builder);
+}
+
+std::unique_ptr<CfaPass> gazer::createParallelMergePass(ExprBuilder& builder)
+{
+    return std::make_unique<ParallelMergePass>(builder);
+}
+
+std::unique_ptr<CfaPass> gazer::createDeadAssignmentEliminationPass()
+{
+    return std::make_unique<DeadAssignmentEliminationPass>();
+}
+
+std::unique_ptr<CfaPass> gazer::createLargeBlockEncodingPass(ExprBuilder& builder)
+{
+    return std::make_unique<LargeBlockEncodingPass>(builder);
+}
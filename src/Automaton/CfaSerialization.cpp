@@ -0,0 +1,1395 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+#include "gazer/Automaton/CfaSerialization.h"
+#include "gazer/Core/LiteralExpr.h"
+#include "gazer/Core/ExprTypes.h"
+#include "gazer/Core/Expr/ExprBuilder.h"
+
+#include <llvm/ADT/STLExtras.h>
+#include <llvm/ADT/SmallString.h>
+#include <llvm/Support/LEB128.h>
+
+#include <array>
+#include <limits>
+
+using namespace gazer;
+
+namespace
+{
+
+constexpr llvm::StringLiteral Magic = "GZCF";
+
+enum VariableRole : unsigned
+{
+    Var_Free = 0,
+    Var_Input,
+    Var_Local
+};
+
+bool hasRoundingMode(Expr::ExprKind kind)
+{
+    return (Expr::FCast <= kind && kind <= Expr::FpToUnsigned)
+        || (Expr::FAdd <= kind && kind <= Expr::FDiv);
+}
+
+constexpr std::array RoundingModes = {
+    llvm::APFloat::rmNearestTiesToEven,
+    llvm::APFloat::rmTowardPositive,
+    llvm::APFloat::rmTowardNegative,
+    llvm::APFloat::rmTowardZero,
+    llvm::APFloat::rmNearestTiesToAway
+};
+
+llvm::APFloat::roundingMode getRoundingMode(const Expr* expr)
+{
+    switch (expr->getKind()) {
+        case Expr::FCast: return llvm::cast<FCastExpr>(expr)->getRoundingMode();
+        case Expr::SignedToFp: return llvm::cast<SignedToFpExpr>(expr)->getRoundingMode();
+        case Expr::UnsignedToFp: return llvm::cast<UnsignedToFpExpr>(expr)->getRoundingMode();
+        case Expr::FpToSigned: return llvm::cast<FpToSignedExpr>(expr)->getRoundingMode();
+        case Expr::FpToUnsigned: return llvm::cast<FpToUnsignedExpr>(expr)->getRoundingMode();
+        case Expr::FAdd: return llvm::cast<FAddExpr>(expr)->getRoundingMode();
+        case Expr::FSub: return llvm::cast<FSubExpr>(expr)->getRoundingMode();
+        case Expr::FMul: return llvm::cast<FMulExpr>(expr)->getRoundingMode();
+        case Expr::FDiv: return llvm::cast<FDivExpr>(expr)->getRoundingMode();
+        default:
+            llvm_unreachable("Expression kind has no rounding mode!");
+    }
+}
+
+// Writer
+//===----------------------------------------------------------------------===//
+
+/// Serializes an automata system. Types, variables and expressions are
+/// numbered on their first use and written into separate section buffers,
+/// which are concatenated at the end.
+class SystemWriter
+{
+public:
+    explicit SystemWriter(AutomataSystem& system)
+        : mSystem(system),
+        mTypesOS(mTypesBuffer), mVariablesOS(mVariablesBuffer),
+        mExprsOS(mExprsBuffer), mAutomataOS(mAutomataBuffer)
+    {}
+
+    void write(llvm::raw_ostream& os);
+
+private:
+    unsigned addType(Type& type);
+    unsigned addVariable(Variable* variable, unsigned owner = 0, VariableRole role = Var_Free);
+    unsigned addExpr(const ExprPtr& root);
+    void writeExprNode(const Expr* expr);
+    void writeAutomaton(Cfa& cfa);
+    void writeAssignments(llvm::iterator_range<std::vector<VariableAssignment>::const_iterator> assigns);
+
+    static void writeString(llvm::StringRef str, llvm::raw_ostream& os)
+    {
+        llvm::encodeULEB128(str.size(), os);
+        os << str;
+    }
+
+    static void writeAPInt(const llvm::APInt& value, llvm::raw_ostream& os)
+    {
+        llvm::encodeULEB128(value.getNumWords(), os);
+        for (unsigned i = 0; i < value.getNumWords(); ++i) {
+            llvm::encodeULEB128(value.getRawData()[i], os);
+        }
+    }
+
+private:
+    AutomataSystem& mSystem;
+
+    llvm::DenseMap<const Type*, unsigned> mTypes;
+    llvm::DenseMap<const Variable*, unsigned> mVariables;
+    llvm::DenseMap<const Expr*, unsigned> mExprs;
+    llvm::DenseMap<const Cfa*, unsigned> mAutomata;
+
+    llvm::SmallString<256> mTypesBuffer;
+    llvm::SmallString<1024> mVariablesBuffer;
+    llvm::SmallString<4096> mExprsBuffer;
+    llvm::SmallString<4096> mAutomataBuffer;
+
+    llvm::raw_svector_ostream mTypesOS;
+    llvm::raw_svector_ostream mVariablesOS;
+    llvm::raw_svector_ostream mExprsOS;
+    llvm::raw_svector_ostream mAutomataOS;
+};
+
+} // end anonymous namespace
+
+unsigned SystemWriter::addType(Type& type)
+{
+    auto it = mTypes.find(&type);
+    if (it != mTypes.end()) {
+        return it->second;
+    }
+
+    unsigned indexId = 0;
+    unsigned elementId = 0;
+    if (auto arrTy = llvm::dyn_cast<ArrayType>(&type)) {
+        indexId = addType(arrTy->getIndexType());
+        elementId = addType(arrTy->getElementType());
+    }
+
+    llvm::encodeULEB128(type.getTypeID(), mTypesOS);
+    switch (type.getTypeID()) {
+        case Type::BoolTypeID:
+        case Type::IntTypeID:
+        case Type::RealTypeID:
+            break;
+        case Type::BvTypeID:
+            llvm::encodeULEB128(llvm::cast<BvType>(type).getWidth(), mTypesOS);
+            break;
+        case Type::FloatTypeID:
+            llvm::encodeULEB128(llvm::cast<FloatType>(type).getPrecision(), mTypesOS);
+            break;
+        case Type::ArrayTypeID:
+            llvm::encodeULEB128(indexId, mTypesOS);
+            llvm::encodeULEB128(elementId, mTypesOS);
+            break;
+        default:
+            llvm::report_fatal_error("Cannot serialize tuple and function types!");
+    }
+
+    unsigned id = mTypes.size();
+    mTypes[&type] = id;
+
+    return id;
+}
+
+unsigned SystemWriter::addVariable(Variable* variable, unsigned owner, VariableRole role)
+{
+    auto it = mVariables.find(variable);
+    if (it != mVariables.end()) {
+        return it->second;
+    }
+
+    unsigned typeId = addType(variable->getType());
+
+    writeString(variable->getName(), mVariablesOS);
+    llvm::encodeULEB128(typeId, mVariablesOS);
+    llvm::encodeULEB128(owner, mVariablesOS);
+    if (owner != 0) {
+        llvm::encodeULEB128(role, mVariablesOS);
+    }
+
+    unsigned id = mVariables.size();
+    mVariables[variable] = id;
+
+    return id;
+}
+
+unsigned SystemWriter::addExpr(const ExprPtr& root)
+{
+    auto it = mExprs.find(root.get());
+    if (it != mExprs.end()) {
+        return it->second;
+    }
+
+    // Operands are written before their users, using an explicit stack
+    // to support arbitrarily deep expressions.
+    llvm::SmallVector<std::pair<const Expr*, size_t>, 16> stack;
+    stack.emplace_back(root.get(), 0);
+
+    while (!stack.empty()) {
+        auto& [expr, next] = stack.back();
+        auto nn = llvm::dyn_cast<NonNullaryExpr>(expr);
+
+        if (nn != nullptr && next != nn->getNumOperands()) {
+            const Expr* operand = nn->getOperand(next++).get();
+            if (mExprs.count(operand) == 0) {
+                stack.emplace_back(operand, 0);
+            }
+            continue;
+        }
+
+        this->writeExprNode(expr);
+        stack.pop_back();
+    }
+
+    return mExprs[root.get()];
+}
+
+void SystemWriter::writeExprNode(const Expr* expr)
+{
+    // The elements of array literals are literals themselves, their nesting
+    // depth is bounded by the depth of the array type.
+    if (auto arrayLit = llvm::dyn_cast<ArrayLiteralExpr>(expr)) {
+        for (auto& [index, element] : arrayLit->getMap()) {
+            addExpr(index);
+            addExpr(element);
+        }
+
+        if (arrayLit->hasDefault()) {
+            addExpr(arrayLit->getDefault());
+        }
+    }
+
+    unsigned typeId = addType(expr->getType());
+    unsigned varId = 0;
+    if (auto varRef = llvm::dyn_cast<VarRefExpr>(expr)) {
+        varId = addVariable(&varRef->getVariable());
+    }
+
+    llvm::raw_ostream& os = mExprsOS;
+    llvm::encodeULEB128(expr->getKind(), os);
+    llvm::encodeULEB128(typeId, os);
+
+    switch (expr->getKind()) {
+        case Expr::Undef:
+            break;
+        case Expr::VarRef:
+            llvm::encodeULEB128(varId, os);
+            break;
+        case Expr::Literal:
+            if (auto boolLit = llvm::dyn_cast<BoolLiteralExpr>(expr)) {
+                llvm::encodeULEB128(boolLit->getValue(), os);
+            } else if (auto intLit = llvm::dyn_cast<IntLiteralExpr>(expr)) {
+                llvm::encodeSLEB128(intLit->getValue(), os);
+            } else if (auto realLit = llvm::dyn_cast<RealLiteralExpr>(expr)) {
+                llvm::encodeSLEB128(realLit->getValue().numerator(), os);
+                llvm::encodeSLEB128(realLit->getValue().denominator(), os);
+            } else if (auto bvLit = llvm::dyn_cast<BvLiteralExpr>(expr)) {
+                writeAPInt(bvLit->getValue(), os);
+            } else if (auto fltLit = llvm::dyn_cast<FloatLiteralExpr>(expr)) {
+                writeAPInt(fltLit->getValue().bitcastToAPInt(), os);
+            } else if (auto arrayLit = llvm::dyn_cast<ArrayLiteralExpr>(expr)) {
+                llvm::encodeULEB128(arrayLit->getMap().size(), os);
+                for (auto& [index, element] : arrayLit->getMap()) {
+                    llvm::encodeULEB128(mExprs[index.get()], os);
+                    llvm::encodeULEB128(mExprs[element.get()], os);
+                }
+                llvm::encodeULEB128(arrayLit->hasDefault() ? mExprs[arrayLit->getDefault().get()] + 1 : 0, os);
+            } else {
+                llvm_unreachable("Unknown literal expression!");
+            }
+            break;
+        case Expr::TupleSelect:
+        case Expr::TupleConstruct:
+            llvm::report_fatal_error("Cannot serialize tuple expressions!");
+        default: {
+            auto nn = llvm::cast<NonNullaryExpr>(expr);
+            llvm::encodeULEB128(nn->getNumOperands(), os);
+            for (const ExprPtr& operand : nn->operands()) {
+                llvm::encodeULEB128(mExprs[operand.get()], os);
+            }
+
+            if (auto extract = llvm::dyn_cast<ExtractExpr>(expr)) {
+                llvm::encodeULEB128(extract->getOffset(), os);
+                llvm::encodeULEB128(extract->getExtractedWidth(), os);
+            } else if (hasRoundingMode(expr->getKind())) {
+                llvm::encodeULEB128(static_cast<unsigned>(getRoundingMode(expr)), os);
+            }
+            break;
+        }
+    }
+
+    unsigned id = mExprs.size();
+    mExprs[expr] = id;
+}
+
+void SystemWriter::writeAssignments(
+    llvm::iterator_range<std::vector<VariableAssignment>::const_iterator> assigns)
+{
+    llvm::encodeULEB128(std::distance(assigns.begin(), assigns.end()), mAutomataOS);
+    for (const VariableAssignment& assign : assigns) {
+        llvm::encodeULEB128(addVariable(assign.getVariable()), mAutomataOS);
+        llvm::encodeULEB128(addExpr(assign.getValue()), mAutomataOS);
+    }
+}
+
+void SystemWriter::writeAutomaton(Cfa& cfa)
+{
+    llvm::raw_ostream& os = mAutomataOS;
+
+    llvm::DenseMap<const Location*, unsigned> locations;
+    llvm::encodeULEB128(cfa.getNumLocations(), os);
+    for (Location* loc : cfa.nodes()) {
+        unsigned id = locations.size();
+        locations[loc] = id;
+        llvm::encodeULEB128(loc->isError(), os);
+    }
+    llvm::encodeULEB128(locations[cfa.getEntry()], os);
+    llvm::encodeULEB128(locations[cfa.getExit()], os);
+
+    llvm::encodeULEB128(cfa.getNumErrors(), os);
+    for (auto& [loc, errorExpr] : cfa.errors()) {
+        llvm::encodeULEB128(locations[loc], os);
+        llvm::encodeULEB128(addExpr(errorExpr), os);
+    }
+
+    llvm::encodeULEB128(cfa.getNumTransitions(), os);
+    for (Transition* edge : cfa.edges()) {
+        llvm::encodeULEB128(edge->getKind(), os);
+        llvm::encodeULEB128(locations[edge->getSource()], os);
+        llvm::encodeULEB128(locations[edge->getTarget()], os);
+        llvm::encodeULEB128(addExpr(edge->getGuard()), os);
+
+        if (auto assign = llvm::dyn_cast<AssignTransition>(edge)) {
+            writeAssignments(llvm::make_range(assign->begin(), assign->end()));
+        } else {
+            auto call = llvm::cast<CallTransition>(edge);
+            llvm::encodeULEB128(mAutomata[call->getCalledAutomaton()], os);
+            writeAssignments(call->inputs());
+            writeAssignments(call->outputs());
+        }
+    }
+}
+
+void SystemWriter::write(llvm::raw_ostream& os)
+{
+    llvm::SmallString<256> namesBuffer;
+    llvm::raw_svector_ostream namesOS(namesBuffer);
+
+    for (Cfa& cfa : mSystem) {
+        unsigned id = mAutomata.size();
+        mAutomata[&cfa] = id;
+        writeString(cfa.getName(), namesOS);
+    }
+
+    // Member variables are numbered first, so their order is preserved.
+    for (Cfa& cfa : mSystem) {
+        unsigned owner = mAutomata[&cfa] + 1;
+        for (Variable& input : cfa.inputs()) {
+            addVariable(&input, owner, Var_Input);
+        }
+        for (Variable& local : cfa.locals()) {
+            addVariable(&local, owner, Var_Local);
+        }
+    }
+
+    // Outputs are written before the bodies, thus calls can be checked against
+    // the interface of automata which are read later.
+    for (Cfa& cfa : mSystem) {
+        llvm::encodeULEB128(cfa.getNumOutputs(), mAutomataOS);
+        for (Variable& output : cfa.outputs()) {
+            llvm::encodeULEB128(mVariables[&output], mAutomataOS);
+        }
+    }
+
+    for (Cfa& cfa : mSystem) {
+        this->writeAutomaton(cfa);
+    }
+
+    Cfa* main = mSystem.getMainAutomaton();
+
+    os << Magic;
+    llvm::encodeULEB128(CfaSerializationVersion, os);
+    llvm::encodeULEB128(mAutomata.size(), os);
+    os << namesOS.str();
+    llvm::encodeULEB128(mTypes.size(), os);
+    os << mTypesOS.str();
+    llvm::encodeULEB128(mVariables.size(), os);
+    os << mVariablesOS.str();
+    llvm::encodeULEB128(mExprs.size(), os);
+    os << mExprsOS.str();
+    os << mAutomataOS.str();
+    llvm::encodeULEB128(main != nullptr ? mAutomata[main] + 1 : 0, os);
+}
+
+void gazer::WriteAutomataSystem(AutomataSystem& system, llvm::raw_ostream& os)
+{
+    SystemWriter writer(system);
+    writer.write(os);
+}
+
+// Reader
+//===----------------------------------------------------------------------===//
+
+namespace
+{
+
+class SystemReader
+{
+public:
+    SystemReader(llvm::MemoryBufferRef buffer, GazerContext& context)
+        : mContext(context),
+        mCurrent(reinterpret_cast<const uint8_t*>(buffer.getBufferStart())),
+        mStart(mCurrent),
+        mEnd(reinterpret_cast<const uint8_t*>(buffer.getBufferEnd())),
+        mBuilder(CreateExprBuilder(context))
+    {}
+
+    std::unique_ptr<AutomataSystem> read();
+
+    const std::string& getError() const { return mError; }
+
+private:
+    bool readTypes();
+    bool readVariables();
+    bool readExprs();
+    bool readExprNode(Expr::ExprKind kind, Type& type);
+    bool readOutputs(Cfa& cfa);
+    bool readAutomaton(Cfa& cfa);
+    bool readAssignments(std::vector<VariableAssignment>& assigns);
+    ExprPtr createNonNullary(Expr::ExprKind kind, Type& type, const ExprVector& ops);
+    bool checkOperandTypes(Expr::ExprKind kind, Type& type, const ExprVector& ops);
+
+    bool error(const llvm::Twine& message)
+    {
+        if (mError.empty()) {
+            mError = ("offset " + llvm::Twine(mCurrent - mStart) + ": " + message).str();
+        }
+        return false;
+    }
+
+    bool readNumber(uint64_t& value)
+    {
+        const char* errorMsg = nullptr;
+        unsigned length = 0;
+        value = llvm::decodeULEB128(mCurrent, &length, mEnd, &errorMsg);
+        if (errorMsg != nullptr) {
+            return error(errorMsg);
+        }
+
+        mCurrent += length;
+        return true;
+    }
+
+    bool readSigned(int64_t& value)
+    {
+        const char* errorMsg = nullptr;
+        unsigned length = 0;
+        value = llvm::decodeSLEB128(mCurrent, &length, mEnd, &errorMsg);
+        if (errorMsg != nullptr) {
+            return error(errorMsg);
+        }
+
+        mCurrent += length;
+        return true;
+    }
+
+    /// Reads a number which must be less than \p limit.
+    bool readIndex(unsigned& value, size_t limit, llvm::StringRef what)
+    {
+        uint64_t number;
+        if (!readNumber(number)) {
+            return false;
+        }
+
+        if (number >= limit) {
+            return error("invalid " + what + " index " + llvm::Twine(number));
+        }
+
+        value = static_cast<unsigned>(number);
+        return true;
+    }
+
+    bool readString(llvm::StringRef& str)
+    {
+        uint64_t length;
+        if (!readNumber(length)) {
+            return false;
+        }
+
+        if (length > static_cast<uint64_t>(mEnd - mCurrent)) {
+            return error("unexpected end of input");
+        }
+
+        str = llvm::StringRef(reinterpret_cast<const char*>(mCurrent), length);
+        mCurrent += length;
+        return true;
+    }
+
+    bool readAPInt(unsigned width, llvm::APInt& value)
+    {
+        uint64_t numWords;
+        if (!readNumber(numWords)) {
+            return false;
+        }
+
+        if (numWords != llvm::APInt::getNumWords(width)) {
+            return error("literal size does not match its type");
+        }
+
+        llvm::SmallVector<uint64_t, 2> words(numWords);
+        for (uint64_t& word : words) {
+            if (!readNumber(word)) {
+                return false;
+            }
+        }
+
+        value = llvm::APInt(width, words);
+        return true;
+    }
+
+    bool readExprIndex(ExprPtr& expr)
+    {
+        unsigned id;
+        if (!readIndex(id, mExprs.size(), "expression")) {
+            return false;
+        }
+
+        expr = mExprs[id];
+        return true;
+    }
+
+private:
+    GazerContext& mContext;
+    const uint8_t* mCurrent;
+    const uint8_t* mStart;
+    const uint8_t* mEnd;
+    std::unique_ptr<ExprBuilder> mBuilder;
+    std::string mError;
+
+    std::unique_ptr<AutomataSystem> mSystem;
+    std::vector<Cfa*> mAutomata;
+    std::vector<Type*> mTypes;
+    std::vector<Variable*> mVariables;
+    std::vector<ExprPtr> mExprs;
+};
+
+} // end anonymous namespace
+
+std::unique_ptr<AutomataSystem> SystemReader::read()
+{
+    if (static_cast<size_t>(mEnd - mCurrent) < Magic.size()
+        || llvm::StringRef(reinterpret_cast<const char*>(mCurrent), Magic.size()) != Magic
+    ) {
+        error("not a gazer model file");
+        return nullptr;
+    }
+    mCurrent += Magic.size();
+
+    uint64_t version, numAutomata;
+    if (!readNumber(version)) {
+        return nullptr;
+    }
+
+    if (version != CfaSerializationVersion) {
+        error("unsupported format version " + llvm::Twine(version));
+        return nullptr;
+    }
+
+    mSystem = std::make_unique<AutomataSystem>(mContext);
+    if (!readNumber(numAutomata)) {
+        return nullptr;
+    }
+
+    for (uint64_t i = 0; i < numAutomata; ++i) {
+        llvm::StringRef name;
+        if (!readString(name)) {
+            return nullptr;
+        }
+        mAutomata.push_back(mSystem->createCfa(name.str()));
+    }
+
+    if (!readTypes() || !readVariables() || !readExprs()) {
+        return nullptr;
+    }
+
+    for (Cfa* cfa : mAutomata) {
+        if (!readOutputs(*cfa)) {
+            return nullptr;
+        }
+    }
+
+    for (Cfa* cfa : mAutomata) {
+        if (!readAutomaton(*cfa)) {
+            return nullptr;
+        }
+    }
+
+    unsigned main;
+    if (!readIndex(main, mAutomata.size() + 1, "automaton")) {
+        return nullptr;
+    }
+
+    if (main != 0) {
+        mSystem->setMainAutomaton(mAutomata[main - 1]);
+    }
+
+    if (mCurrent != mEnd) {
+        error("unexpected data after the end of the model");
+        return nullptr;
+    }
+
+    return std::move(mSystem);
+}
+
+bool SystemReader::readTypes()
+{
+    uint64_t numTypes;
+    if (!readNumber(numTypes)) {
+        return false;
+    }
+
+    for (uint64_t i = 0; i < numTypes; ++i) {
+        uint64_t typeId, param;
+        if (!readNumber(typeId)) {
+            return false;
+        }
+
+        switch (typeId) {
+            case Type::BoolTypeID:
+                mTypes.push_back(&BoolType::Get(mContext));
+                break;
+            case Type::IntTypeID:
+                mTypes.push_back(&IntType::Get(mContext));
+                break;
+            case Type::RealTypeID:
+                mTypes.push_back(&RealType::Get(mContext));
+                break;
+            case Type::BvTypeID:
+                if (!readNumber(param)) {
+                    return false;
+                }
+                if (param == 0 || param > std::numeric_limits<unsigned>::max()) {
+                    return error("invalid bit-vector width");
+                }
+                mTypes.push_back(&BvType::Get(mContext, static_cast<unsigned>(param)));
+                break;
+            case Type::FloatTypeID:
+                if (!readNumber(param)) {
+                    return false;
+                }
+                if (param != FloatType::Half && param != FloatType::Single
+                    && param != FloatType::Double && param != FloatType::Quad
+                ) {
+                    return error("invalid floating-point precision");
+                }
+                mTypes.push_back(&FloatType::Get(mContext, static_cast<FloatType::FloatPrecision>(param)));
+                break;
+            case Type::ArrayTypeID: {
+                unsigned index, element;
+                if (!readIndex(index, mTypes.size(), "type") || !readIndex(element, mTypes.size(), "type")) {
+                    return false;
+                }
+                mTypes.push_back(&ArrayType::Get(*mTypes[index], *mTypes[element]));
+                break;
+            }
+            default:
+                return error("invalid type identifier " + llvm::Twine(typeId));
+        }
+    }
+
+    return true;
+}
+
+bool SystemReader::readVariables()
+{
+    uint64_t numVariables;
+    if (!readNumber(numVariables)) {
+        return false;
+    }
+
+    for (uint64_t i = 0; i < numVariables; ++i) {
+        llvm::StringRef name;
+        unsigned typeId, owner;
+        if (!readString(name)
+            || !readIndex(typeId, mTypes.size(), "type")
+            || !readIndex(owner, mAutomata.size() + 1, "automaton")
+        ) {
+            return false;
+        }
+
+        Type& type = *mTypes[typeId];
+
+        if (owner == 0) {
+            Variable* variable = mContext.getVariable(name);
+            if (variable == nullptr) {
+                variable = mContext.createVariable(name.str(), type);
+            } else if (variable->getType() != type) {
+                return error("type mismatch for variable '" + name + "'");
+            }
+
+            mVariables.push_back(variable);
+            continue;
+        }
+
+        uint64_t role;
+        if (!readNumber(role)) {
+            return false;
+        }
+
+        // Member variables are named '<automaton>/<name>' by their parent.
+        Cfa* cfa = mAutomata[owner - 1];
+        std::string prefix = (cfa->getName() + "/").str();
+        if (name.startswith(prefix)) {
+            name = name.drop_front(prefix.size());
+        }
+
+        switch (role) {
+            case Var_Input:
+                mVariables.push_back(cfa->createInput(name.str(), type));
+                break;
+            case Var_Local:
+                mVariables.push_back(cfa->createLocal(name.str(), type));
+                break;
+            default:
+                return error("invalid variable role");
+        }
+    }
+
+    return true;
+}
+
+bool SystemReader::readExprs()
+{
+    uint64_t numExprs;
+    if (!readNumber(numExprs)) {
+        return false;
+    }
+
+    // Each expression takes at least two bytes (its kind and type), thus a
+    // larger count is certainly invalid and must not be used for allocation.
+    if (numExprs > static_cast<uint64_t>(mEnd - mCurrent) / 2) {
+        return error("invalid number of expressions");
+    }
+
+    mExprs.reserve(numExprs);
+    for (uint64_t i = 0; i < numExprs; ++i) {
+        uint64_t kind;
+        unsigned typeId;
+        if (!readNumber(kind) || !readIndex(typeId, mTypes.size(), "type")) {
+            return false;
+        }
+
+        if (kind > Expr::LastExprKind) {
+            return error("invalid expression kind " + llvm::Twine(kind));
+        }
+
+        if (!readExprNode(static_cast<Expr::ExprKind>(kind), *mTypes[typeId])) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool SystemReader::readExprNode(Expr::ExprKind kind, Type& type)
+{
+    switch (kind) {
+        case Expr::Undef:
+            mExprs.push_back(UndefExpr::Get(type));
+            return true;
+        case Expr::VarRef: {
+            unsigned varId;
+            if (!readIndex(varId, mVariables.size(), "variable")) {
+                return false;
+            }
+            if (mVariables[varId]->getType() != type) {
+                return error("type mismatch for variable reference");
+            }
+            mExprs.push_back(mVariables[varId]->getRefExpr());
+            return true;
+        }
+        case Expr::Literal:
+            break;
+        case Expr::TupleSelect:
+        case Expr::TupleConstruct:
+            return error("tuple expressions are not supported");
+        default: {
+            uint64_t numOps;
+            if (!readNumber(numOps)) {
+                return false;
+            }
+
+            if (numOps == 0 || numOps > static_cast<uint64_t>(mEnd - mCurrent)) {
+                return error("invalid number of operands");
+            }
+
+            ExprVector ops(numOps);
+            for (ExprPtr& op : ops) {
+                if (!readExprIndex(op)) {
+                    return false;
+                }
+            }
+
+            ExprPtr expr = this->createNonNullary(kind, type, ops);
+            if (expr == nullptr) {
+                return false;
+            }
+
+            mExprs.push_back(expr);
+            return true;
+        }
+    }
+
+    switch (type.getTypeID()) {
+        case Type::BoolTypeID: {
+            uint64_t value;
+            if (!readNumber(value)) {
+                return false;
+            }
+            mExprs.push_back(BoolLiteralExpr::Get(llvm::cast<BoolType>(type), value != 0));
+            return true;
+        }
+        case Type::IntTypeID: {
+            int64_t value;
+            if (!readSigned(value)) {
+                return false;
+            }
+            mExprs.push_back(IntLiteralExpr::Get(llvm::cast<IntType>(type), value));
+            return true;
+        }
+        case Type::RealTypeID: {
+            int64_t num, denom;
+            if (!readSigned(num) || !readSigned(denom)) {
+                return false;
+            }
+            if (denom <= 0) {
+                return error("invalid real literal");
+            }
+            mExprs.push_back(RealLiteralExpr::Get(llvm::cast<RealType>(type), num, denom));
+            return true;
+        }
+        case Type::BvTypeID: {
+            auto& bvTy = llvm::cast<BvType>(type);
+            llvm::APInt value;
+            if (!readAPInt(bvTy.getWidth(), value)) {
+                return false;
+            }
+            mExprs.push_back(BvLiteralExpr::Get(bvTy, value));
+            return true;
+        }
+        case Type::FloatTypeID: {
+            auto& fltTy = llvm::cast<FloatType>(type);
+            llvm::APInt bits;
+            if (!readAPInt(fltTy.getWidth(), bits)) {
+                return false;
+            }
+            mExprs.push_back(FloatLiteralExpr::Get(fltTy, llvm::APFloat(fltTy.getLLVMSemantics(), bits)));
+            return true;
+        }
+        case Type::ArrayTypeID: {
+            uint64_t numElements;
+            if (!readNumber(numElements)) {
+                return false;
+            }
+
+            ArrayLiteralExpr::MappingT mapping;
+            for (uint64_t i = 0; i < numElements; ++i) {
+                ExprPtr index, element;
+                if (!readExprIndex(index) || !readExprIndex(element)) {
+                    return false;
+                }
+
+                if (!llvm::isa<LiteralExpr>(index) || !llvm::isa<LiteralExpr>(element)) {
+                    return error("array literal elements must be literals");
+                }
+
+                auto& arrTy = llvm::cast<ArrayType>(type);
+                if (index->getType() != arrTy.getIndexType() || element->getType() != arrTy.getElementType()) {
+                    return error("array literal element type mismatch");
+                }
+
+                mapping[llvm::cast<LiteralExpr>(index)] = llvm::cast<LiteralExpr>(element);
+            }
+
+            unsigned defaultId;
+            if (!readIndex(defaultId, mExprs.size() + 1, "expression")) {
+                return false;
+            }
+
+            ExprRef<LiteralExpr> elze = nullptr;
+            if (defaultId != 0) {
+                elze = llvm::dyn_cast<LiteralExpr>(mExprs[defaultId - 1]);
+                if (elze == nullptr) {
+                    return error("array literal elements must be literals");
+                }
+                if (elze->getType() != llvm::cast<ArrayType>(type).getElementType()) {
+                    return error("array literal element type mismatch");
+                }
+            }
+
+            mExprs.push_back(ArrayLiteralExpr::Get(llvm::cast<ArrayType>(type), mapping, elze));
+            return true;
+        }
+        default:
+            return error("invalid literal type");
+    }
+}
+
+ExprPtr SystemReader::createNonNullary(Expr::ExprKind kind, Type& type, const ExprVector& ops)
+{
+    ExprBuilder& b = *mBuilder;
+
+    size_t arity = ops.size();
+    bool isUnary = (Expr::FirstUnary <= kind && kind <= Expr::LastUnary)
+        || (Expr::FirstFpUnary <= kind && kind <= Expr::LastFpUnary);
+    bool isTernary = kind == Expr::Select || kind == Expr::ArrayWrite;
+    bool isMultiary = kind == Expr::And || kind == Expr::Or;
+
+    if ((isUnary && arity != 1) || (isTernary && arity != 3) || (!isUnary && !isTernary && !isMultiary && arity != 2)) {
+        error("invalid number of operands for " + Expr::getKindName(kind));
+        return nullptr;
+    }
+
+    if (!this->checkOperandTypes(kind, type, ops)) {
+        return nullptr;
+    }
+
+    llvm::APFloat::roundingMode rm = llvm::APFloat::rmNearestTiesToEven;
+    if (hasRoundingMode(kind)) {
+        uint64_t value;
+        if (!readNumber(value)) {
+            return nullptr;
+        }
+
+        auto it = llvm::find_if(RoundingModes, [value](llvm::APFloat::roundingMode mode) {
+            return static_cast<uint64_t>(mode) == value;
+        });
+        if (it == RoundingModes.end()) {
+            error("invalid rounding mode " + llvm::Twine(value));
+            return nullptr;
+        }
+        rm = *it;
+    }
+
+    switch (kind) {
+        case Expr::Not: return b.Not(ops[0]);
+        case Expr::ZExt: return b.ZExt(ops[0], llvm::cast<BvType>(type));
+        case Expr::SExt: return b.SExt(ops[0], llvm::cast<BvType>(type));
+        case Expr::Extract: {
+            uint64_t offset, width;
+            if (!readNumber(offset) || !readNumber(width)) {
+                return nullptr;
+            }
+
+            unsigned opWidth = llvm::cast<BvType>(ops[0]->getType()).getWidth();
+            if (width == 0 || offset > opWidth || width > opWidth - offset) {
+                error("invalid bit range for Extract");
+                return nullptr;
+            }
+            if (llvm::cast<BvType>(type).getWidth() != width) {
+                error("type mismatch for Extract");
+                return nullptr;
+            }
+            return b.Extract(ops[0], static_cast<unsigned>(offset), static_cast<unsigned>(width));
+        }
+        case Expr::Add: return b.Add(ops[0], ops[1]);
+        case Expr::Sub: return b.Sub(ops[0], ops[1]);
+        case Expr::Mul: return b.Mul(ops[0], ops[1]);
+        case Expr::Div: return b.Div(ops[0], ops[1]);
+        case Expr::Mod: return b.Mod(ops[0], ops[1]);
+        case Expr::Rem: return b.Rem(ops[0], ops[1]);
+        case Expr::BvSDiv: return b.BvSDiv(ops[0], ops[1]);
+        case Expr::BvUDiv: return b.BvUDiv(ops[0], ops[1]);
+        case Expr::BvSRem: return b.BvSRem(ops[0], ops[1]);
+        case Expr::BvURem: return b.BvURem(ops[0], ops[1]);
+        case Expr::Shl: return b.Shl(ops[0], ops[1]);
+        case Expr::LShr: return b.LShr(ops[0], ops[1]);
+        case Expr::AShr: return b.AShr(ops[0], ops[1]);
+        case Expr::BvAnd: return b.BvAnd(ops[0], ops[1]);
+        case Expr::BvOr: return b.BvOr(ops[0], ops[1]);
+        case Expr::BvXor: return b.BvXor(ops[0], ops[1]);
+        case Expr::BvConcat: return b.BvConcat(ops[0], ops[1]);
+        case Expr::And: return b.And(ops);
+        case Expr::Or: return b.Or(ops);
+        case Expr::Imply: return b.Imply(ops[0], ops[1]);
+        case Expr::Eq: return b.Eq(ops[0], ops[1]);
+        case Expr::NotEq: return b.NotEq(ops[0], ops[1]);
+        case Expr::Lt: return b.Lt(ops[0], ops[1]);
+        case Expr::LtEq: return b.LtEq(ops[0], ops[1]);
+        case Expr::Gt: return b.Gt(ops[0], ops[1]);
+        case Expr::GtEq: return b.GtEq(ops[0], ops[1]);
+        case Expr::BvSLt: return b.BvSLt(ops[0], ops[1]);
+        case Expr::BvSLtEq: return b.BvSLtEq(ops[0], ops[1]);
+        case Expr::BvSGt: return b.BvSGt(ops[0], ops[1]);
+        case Expr::BvSGtEq: return b.BvSGtEq(ops[0], ops[1]);
+        case Expr::BvULt: return b.BvULt(ops[0], ops[1]);
+        case Expr::BvULtEq: return b.BvULtEq(ops[0], ops[1]);
+        case Expr::BvUGt: return b.BvUGt(ops[0], ops[1]);
+        case Expr::BvUGtEq: return b.BvUGtEq(ops[0], ops[1]);
+        case Expr::FIsNan: return b.FIsNan(ops[0]);
+        case Expr::FIsInf: return b.FIsInf(ops[0]);
+        case Expr::FCast: return b.FCast(ops[0], llvm::cast<FloatType>(type), rm);
+        case Expr::SignedToFp: return b.SignedToFp(ops[0], llvm::cast<FloatType>(type), rm);
+        case Expr::UnsignedToFp: return b.UnsignedToFp(ops[0], llvm::cast<FloatType>(type), rm);
+        case Expr::FpToSigned: return b.FpToSigned(ops[0], llvm::cast<BvType>(type), rm);
+        case Expr::FpToUnsigned: return b.FpToUnsigned(ops[0], llvm::cast<BvType>(type), rm);
+        case Expr::FAdd: return b.FAdd(ops[0], ops[1], rm);
+        case Expr::FSub: return b.FSub(ops[0], ops[1], rm);
+        case Expr::FMul: return b.FMul(ops[0], ops[1], rm);
+        case Expr::FDiv: return b.FDiv(ops[0], ops[1], rm);
+        case Expr::FEq: return b.FEq(ops[0], ops[1]);
+        case Expr::FGt: return b.FGt(ops[0], ops[1]);
+        case Expr::FGtEq: return b.FGtEq(ops[0], ops[1]);
+        case Expr::FLt: return b.FLt(ops[0], ops[1]);
+        case Expr::FLtEq: return b.FLtEq(ops[0], ops[1]);
+        case Expr::Select: return b.Select(ops[0], ops[1], ops[2]);
+        case Expr::ArrayRead: return b.Read(ops[0], ops[1]);
+        case Expr::ArrayWrite: return b.Write(ops[0], ops[1], ops[2]);
+        default:
+            break;
+    }
+
+    llvm_unreachable("Invalid non-nullary expression kind.");
+}
+
+bool SystemReader::checkOperandTypes(Expr::ExprKind kind, Type& type, const ExprVector& ops)
+{
+    auto mismatch = [this, kind]() {
+        return error("operand type mismatch for " + Expr::getKindName(kind));
+    };
+
+    Type& opTy = ops[0]->getType();
+    auto hasType = [](const ExprPtr& op, const Type& expected) { return op->getType() == expected; };
+    bool isHomogeneous = llvm::all_of(ops, [&opTy](const ExprPtr& op) { return op->getType() == opTy; });
+
+    // The type of the result, as defined by the expression kind.
+    Type* resultTy = nullptr;
+    switch (kind) {
+        case Expr::Not:
+        case Expr::And:
+        case Expr::Or:
+        case Expr::Imply:
+            if (!isHomogeneous || !opTy.isBoolType()) {
+                return mismatch();
+            }
+            resultTy = &opTy;
+            break;
+        case Expr::ZExt:
+        case Expr::SExt:
+            if (!opTy.isBvType() || !type.isBvType()
+                || llvm::cast<BvType>(type).getWidth() <= llvm::cast<BvType>(opTy).getWidth()
+            ) {
+                return mismatch();
+            }
+            resultTy = &type;
+            break;
+        case Expr::Extract:
+            // The width of the result is checked together with the bit range.
+            if (!opTy.isBvType() || !type.isBvType()) {
+                return mismatch();
+            }
+            resultTy = &type;
+            break;
+        case Expr::Add:
+        case Expr::Sub:
+        case Expr::Mul:
+        case Expr::Mod:
+        case Expr::Rem:
+            if (!isHomogeneous || !(opTy.isBvType() || opTy.isArithmetic())) {
+                return mismatch();
+            }
+            resultTy = &opTy;
+            break;
+        case Expr::Div:
+            if (!isHomogeneous || !opTy.isArithmetic()) {
+                return mismatch();
+            }
+            resultTy = &opTy;
+            break;
+        case Expr::BvSDiv:
+        case Expr::BvUDiv:
+        case Expr::BvSRem:
+        case Expr::BvURem:
+        case Expr::Shl:
+        case Expr::LShr:
+        case Expr::AShr:
+        case Expr::BvAnd:
+        case Expr::BvOr:
+        case Expr::BvXor:
+            if (!isHomogeneous || !opTy.isBvType()) {
+                return mismatch();
+            }
+            resultTy = &opTy;
+            break;
+        case Expr::BvConcat:
+            if (!opTy.isBvType() || !ops[1]->getType().isBvType()) {
+                return mismatch();
+            }
+            resultTy = &BvType::Get(mContext,
+                llvm::cast<BvType>(opTy).getWidth() + llvm::cast<BvType>(ops[1]->getType()).getWidth());
+            break;
+        case Expr::Eq:
+        case Expr::NotEq:
+            if (!isHomogeneous) {
+                return mismatch();
+            }
+            resultTy = &BoolType::Get(mContext);
+            break;
+        case Expr::Lt:
+        case Expr::LtEq:
+        case Expr::Gt:
+        case Expr::GtEq:
+            if (!isHomogeneous || !(opTy.isBvType() || opTy.isArithmetic())) {
+                return mismatch();
+            }
+            resultTy = &BoolType::Get(mContext);
+            break;
+        case Expr::BvSLt:
+        case Expr::BvSLtEq:
+        case Expr::BvSGt:
+        case Expr::BvSGtEq:
+        case Expr::BvULt:
+        case Expr::BvULtEq:
+        case Expr::BvUGt:
+        case Expr::BvUGtEq:
+            if (!isHomogeneous || !opTy.isBvType()) {
+                return mismatch();
+            }
+            resultTy = &BoolType::Get(mContext);
+            break;
+        case Expr::FIsNan:
+        case Expr::FIsInf:
+            if (!opTy.isFloatType()) {
+                return mismatch();
+            }
+            resultTy = &BoolType::Get(mContext);
+            break;
+        case Expr::FCast:
+            if (!opTy.isFloatType() || !type.isFloatType() || opTy == type) {
+                return mismatch();
+            }
+            resultTy = &type;
+            break;
+        case Expr::SignedToFp:
+        case Expr::UnsignedToFp:
+            if (!opTy.isBvType() || !type.isFloatType()) {
+                return mismatch();
+            }
+            resultTy = &type;
+            break;
+        case Expr::FpToSigned:
+        case Expr::FpToUnsigned:
+            if (!opTy.isFloatType() || !type.isBvType()) {
+                return mismatch();
+            }
+            resultTy = &type;
+            break;
+        case Expr::FAdd:
+        case Expr::FSub:
+        case Expr::FMul:
+        case Expr::FDiv:
+            if (!isHomogeneous || !opTy.isFloatType()) {
+                return mismatch();
+            }
+            resultTy = &opTy;
+            break;
+        case Expr::FEq:
+        case Expr::FGt:
+        case Expr::FGtEq:
+        case Expr::FLt:
+        case Expr::FLtEq:
+            if (!isHomogeneous || !opTy.isFloatType()) {
+                return mismatch();
+            }
+            resultTy = &BoolType::Get(mContext);
+            break;
+        case Expr::Select:
+            if (!opTy.isBoolType() || ops[1]->getType() != ops[2]->getType()) {
+                return mismatch();
+            }
+            resultTy = &ops[1]->getType();
+            break;
+        case Expr::ArrayRead:
+        case Expr::ArrayWrite: {
+            auto arrTy = llvm::dyn_cast<ArrayType>(&opTy);
+            if (arrTy == nullptr || !hasType(ops[1], arrTy->getIndexType())) {
+                return mismatch();
+            }
+            if (kind == Expr::ArrayWrite && !hasType(ops[2], arrTy->getElementType())) {
+                return mismatch();
+            }
+            resultTy = kind == Expr::ArrayRead ? &arrTy->getElementType() : arrTy;
+            break;
+        }
+        default:
+            llvm_unreachable("Invalid non-nullary expression kind.");
+    }
+
+    if (*resultTy != type) {
+        return error("result type mismatch for " + Expr::getKindName(kind));
+    }
+
+    return true;
+}
+
+bool SystemReader::readAssignments(std::vector<VariableAssignment>& assigns)
+{
+    uint64_t numAssigns;
+    if (!readNumber(numAssigns)) {
+        return false;
+    }
+
+    for (uint64_t i = 0; i < numAssigns; ++i) {
+        unsigned varId;
+        ExprPtr value;
+        if (!readIndex(varId, mVariables.size(), "variable") || !readExprIndex(value)) {
+            return false;
+        }
+
+        if (mVariables[varId]->getType() != value->getType()) {
+            return error("type mismatch in assignment to '" + mVariables[varId]->getName() + "'");
+        }
+
+        assigns.emplace_back(mVariables[varId], value);
+    }
+
+    return true;
+}
+
+bool SystemReader::readOutputs(Cfa& cfa)
+{
+    uint64_t numOutputs;
+    if (!readNumber(numOutputs)) {
+        return false;
+    }
+
+    for (uint64_t i = 0; i < numOutputs; ++i) {
+        unsigned varId;
+        if (!readIndex(varId, mVariables.size(), "variable")) {
+            return false;
+        }
+        cfa.addOutput(mVariables[varId]);
+    }
+
+    return true;
+}
+
+bool SystemReader::readAutomaton(Cfa& cfa)
+{
+    // The entry and exit locations are created together with the automaton,
+    // thus their kinds are read first and the locations are created afterwards.
+    uint64_t numLocations;
+    if (!readNumber(numLocations)) {
+        return false;
+    }
+
+    if (numLocations < 2 || numLocations > static_cast<uint64_t>(mEnd - mCurrent)) {
+        return error("invalid number of locations");
+    }
+
+    std::vector<bool> isError(numLocations);
+    for (uint64_t i = 0; i < numLocations; ++i) {
+        uint64_t kind;
+        if (!readNumber(kind)) {
+            return false;
+        }
+        isError[i] = kind != 0;
+    }
+
+    unsigned entry, exit;
+    if (!readIndex(entry, numLocations, "location") || !readIndex(exit, numLocations, "location")) {
+        return false;
+    }
+
+    if (entry == exit || isError[entry] || isError[exit]) {
+        return error("invalid entry or exit location");
+    }
+
+    std::vector<Location*> locations(numLocations);
+    for (uint64_t i = 0; i < numLocations; ++i) {
+        if (i == entry) {
+            locations[i] = cfa.getEntry();
+        } else if (i == exit) {
+            locations[i] = cfa.getExit();
+        } else {
+            locations[i] = isError[i] ? cfa.createErrorLocation() : cfa.createLocation();
+        }
+    }
+
+    uint64_t numErrors;
+    if (!readNumber(numErrors)) {
+        return false;
+    }
+
+    for (uint64_t i = 0; i < numErrors; ++i) {
+        unsigned loc;
+        ExprPtr errorExpr;
+        if (!readIndex(loc, numLocations, "location") || !readExprIndex(errorExpr)) {
+            return false;
+        }
+
+        if (!isError[loc]) {
+            return error("error code for a non-error location");
+        }
+
+        cfa.addErrorCode(locations[loc], errorExpr);
+    }
+
+    uint64_t numEdges;
+    if (!readNumber(numEdges)) {
+        return false;
+    }
+
+    for (uint64_t i = 0; i < numEdges; ++i) {
+        uint64_t kind;
+        unsigned source, target;
+        ExprPtr guard;
+
+        if (!readNumber(kind)
+            || !readIndex(source, numLocations, "location")
+            || !readIndex(target, numLocations, "location")
+            || !readExprIndex(guard)
+        ) {
+            return false;
+        }
+
+        if (!guard->getType().isBoolType()) {
+            return error("transition guards must be booleans");
+        }
+
+        if (kind == Transition::Edge_Assign) {
+            std::vector<VariableAssignment> assigns;
+            if (!readAssignments(assigns)) {
+                return false;
+            }
+
+            cfa.createAssignTransition(locations[source], locations[target], guard, assigns);
+        } else if (kind == Transition::Edge_Call) {
+            unsigned callee;
+            std::vector<VariableAssignment> inputs, outputs;
+            if (!readIndex(callee, mAutomata.size(), "automaton")
+                || !readAssignments(inputs)
+                || !readAssignments(outputs)
+            ) {
+                return false;
+            }
+
+            Cfa* calledCfa = mAutomata[callee];
+            if (inputs.size() != calledCfa->getNumInputs() || outputs.size() != calledCfa->getNumOutputs()) {
+                return error("invalid number of call arguments");
+            }
+
+            bool isValidCall = llvm::all_of(inputs, [calledCfa](const VariableAssignment& input) {
+                return llvm::any_of(calledCfa->inputs(), [&input](Variable& variable) {
+                    return &variable == input.getVariable();
+                });
+            }) && llvm::all_of(outputs, [calledCfa](const VariableAssignment& output) {
+                auto ref = llvm::dyn_cast<VarRefExpr>(output.getValue());
+                return ref != nullptr && calledCfa->isOutput(&ref->getVariable());
+            });
+            if (!isValidCall) {
+                return error("call arguments do not match the called automaton");
+            }
+
+            cfa.createCallTransition(
+                locations[source], locations[target], guard, calledCfa, inputs, outputs);
+        } else {
+            return error("invalid transition kind");
+        }
+    }
+
+    return true;
+}
+
+std::unique_ptr<AutomataSystem> gazer::ReadAutomataSystem(
+    llvm::MemoryBufferRef buffer, GazerContext& context, std::string& errorMessage)
+{
+    SystemReader reader(buffer, context);
+    auto system = reader.read();
+    if (system == nullptr) {
+        errorMessage = reader.getError();
+    }
+
+    return system;
+}
@@ -0,0 +1,445 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file This file implements large-block encoding: the loop-free regions
+/// between cut points are collapsed into single transitions.
+///
+//===----------------------------------------------------------------------===//
+#include "gazer/Automaton/CfaTransforms.h"
+#include "gazer/Automaton/CfaLiveness.h"
+#include "gazer/Automaton/CfaUtils.h"
+#include "gazer/Core/ExprTypes.h"
+#include "gazer/Core/Expr/ExprBuilder.h"
+#include "gazer/Core/Expr/ExprMetrics.h"
+#include "gazer/Core/Expr/ExprRewrite.h"
+
+#include <llvm/ADT/DenseSet.h>
+#include <llvm/ADT/MapVector.h>
+#include <llvm/ADT/SmallPtrSet.h>
+#include <llvm/Support/Debug.h>
+
+#define DEBUG_TYPE "LargeBlockEncoding"
+
+using namespace gazer;
+
+/// The maximum tree cost of the path condition and the variable values computed
+/// for a location inside a block. Locations exceeding it become cut points, so
+/// the values reaching them are stored in their variables instead of being
+/// duplicated into the expressions of the following transitions.
+static constexpr uint64_t LargeBlockCostLimit = 1024;
+
+namespace
+{
+
+/// The symbolic state of a location inside a block: the condition of reaching
+/// it from the cut point starting the block, and the values of the variables
+/// assigned on the way, in terms of the values of the variables at the cut point.
+struct BlockState
+{
+    ExprPtr condition;
+    llvm::MapVector<Variable*, ExprPtr> values;
+};
+
+struct PendingTransition
+{
+    Location* source;
+    Location* target;
+    ExprPtr guard;
+    std::vector<VariableAssignment> assignments;
+};
+
+class LargeBlockEncoder
+{
+public:
+    LargeBlockEncoder(Cfa& cfa, ExprBuilder& builder)
+        : mCfa(cfa), mBuilder(builder)
+    {}
+
+    bool encode();
+
+private:
+    /// Creates the transitions of the blocks starting at \p start.
+    /// Returns the first location of the region which must become a cut point,
+    /// because its state exceeded the cost limit or its incoming states cannot
+    /// be joined. In this case no transitions were created.
+    Location* encodeRegion(Location* start, const CfaLiveness& liveness, std::vector<PendingTransition>& blocks);
+
+    BlockState getPostState(const BlockState& pre, AssignTransition* edge);
+
+    /// Returns true if \p states can be represented by a single state.
+    bool canJoin(const std::vector<BlockState>& states) const;
+    BlockState join(std::vector<BlockState>& states);
+
+    ExprPtr lookup(const BlockState& state, Variable* variable) const;
+
+private:
+    Cfa& mCfa;
+    ExprBuilder& mBuilder;
+    llvm::DenseSet<Location*> mCutPoints;
+};
+
+bool LargeBlockEncoder::encode()
+{
+    std::vector<Location*> topo;
+    llvm::DenseMap<Location*, size_t> locNumbers;
+    createTopologicalSort(mCfa, topo, &locNumbers);
+
+    // Each cycle contains a loop head, thus the regions between cut points
+    // are acyclic. Calls are not inlined, so they remain on their own.
+    mCutPoints.insert(mCfa.getEntry());
+    mCutPoints.insert(mCfa.getExit());
+    for (Location* location : topo) {
+        if (location->isError()) {
+            mCutPoints.insert(location);
+        }
+
+        for (Transition* edge : location->outgoing()) {
+            if (locNumbers[edge->getTarget()] <= locNumbers[location]) {
+                mCutPoints.insert(edge->getTarget());
+            }
+
+            if (edge->isCall()) {
+                mCutPoints.insert(location);
+                mCutPoints.insert(edge->getTarget());
+            }
+
+            // Each occurrence of an undef expression is an independent value,
+            // thus nondeterministic values must be stored in their variables
+            // instead of being substituted into the following transitions.
+            if (auto assign = llvm::dyn_cast<AssignTransition>(edge)) {
+                bool isNondet = llvm::any_of(*assign, [](const VariableAssignment& assignment) {
+                    return ExprMetrics(assignment.getValue()).getNumNodesOfKind(Expr::Undef) != 0;
+                });
+                if (isNondet) {
+                    mCutPoints.insert(edge->getTarget());
+                }
+            }
+        }
+    }
+
+    CfaLiveness liveness(mCfa);
+
+    std::vector<PendingTransition> blocks;
+    for (;;) {
+        blocks.clear();
+        Location* split = nullptr;
+        for (Location* location : topo) {
+            if (mCutPoints.count(location) != 0) {
+                split = this->encodeRegion(location, liveness, blocks);
+                if (split != nullptr) {
+                    break;
+                }
+            }
+        }
+
+        if (split == nullptr) {
+            break;
+        }
+
+        LLVM_DEBUG(llvm::dbgs() << "Location " << split->getId() << " becomes a cut point.\n");
+        mCutPoints.insert(split);
+    }
+
+    bool hasInnerLocations = llvm::any_of(topo, [this](Location* location) {
+        return mCutPoints.count(location) == 0;
+    });
+    if (!hasInnerLocations) {
+        return false;
+    }
+
+    std::vector<Transition*> oldEdges;
+    for (Location* location : topo) {
+        for (Transition* edge : location->outgoing()) {
+            if (edge->isAssign()) {
+                oldEdges.push_back(edge);
+            }
+        }
+    }
+
+    for (PendingTransition& block : blocks) {
+        mCfa.createAssignTransition(block.source, block.target, block.guard, block.assignments);
+    }
+
+    for (Transition* edge : oldEdges) {
+        mCfa.disconnectEdge(edge);
+    }
+
+    // The inner locations of the blocks are not reachable anymore.
+    mCfa.removeUnreachableLocations();
+
+    return true;
+}
+
+Location* LargeBlockEncoder::encodeRegion(
+    Location* start, const CfaLiveness& liveness, std::vector<PendingTransition>& blocks)
+{
+    auto isRegionEdge = [this](Transition* edge) {
+        return edge->isAssign() && mCutPoints.count(edge->getTarget()) == 0;
+    };
+
+    // Find the locations of the region in post-order. The region is
+    // acyclic, thus its reverse post-order is a topological sort.
+    std::vector<Location*> order;
+    llvm::DenseSet<Location*> visited;
+    std::vector<std::pair<Location*, size_t>> stack;
+
+    visited.insert(start);
+    stack.emplace_back(start, 0);
+    while (!stack.empty()) {
+        Location* location = stack.back().first;
+        size_t idx = stack.back().second++;
+        if (idx == location->getNumOutgoing()) {
+            order.push_back(location);
+            stack.pop_back();
+            continue;
+        }
+
+        Transition* edge = *std::next(location->outgoing_begin(), idx);
+        if (isRegionEdge(edge) && visited.insert(edge->getTarget()).second) {
+            stack.emplace_back(edge->getTarget(), 0);
+        }
+    }
+
+    llvm::DenseMap<Location*, BlockState> states;
+    states[start].condition = mBuilder.True();
+
+    llvm::MapVector<Location*, std::vector<BlockState>> exits;
+    for (Location* location : llvm::reverse(order)) {
+        if (location != start) {
+            std::vector<BlockState> incoming;
+            for (Transition* edge : location->incoming()) {
+                auto it = states.find(edge->getSource());
+                if (it != states.end()) {
+                    incoming.push_back(this->getPostState(it->second, llvm::cast<AssignTransition>(edge)));
+                }
+            }
+
+            if (!this->canJoin(incoming)) {
+                return location;
+            }
+
+            BlockState state = this->join(incoming);
+
+            ExprMetrics metrics(state.condition);
+            for (auto& [variable, value] : state.values) {
+                metrics.add(value);
+            }
+            if (metrics.getTreeCost() > LargeBlockCostLimit) {
+                return location;
+            }
+
+            states[location] = std::move(state);
+        }
+
+        const BlockState& state = states[location];
+        for (Transition* edge : location->outgoing()) {
+            if (edge->isAssign() && mCutPoints.count(edge->getTarget()) != 0) {
+                exits[edge->getTarget()].push_back(
+                    this->getPostState(state, llvm::cast<AssignTransition>(edge))
+                );
+            }
+        }
+    }
+
+    auto addBlock = [&blocks, &liveness, start](Location* target, const BlockState& state) {
+        std::vector<VariableAssignment> assignments;
+        for (auto& [variable, value] : state.values) {
+            if (value != variable->getRefExpr() && liveness.isLiveAt(variable, target)) {
+                assignments.emplace_back(variable, value);
+            }
+        }
+
+        blocks.push_back({start, target, state.condition, std::move(assignments)});
+    };
+
+    // Paths to a cut point which cannot be joined remain separate transitions.
+    for (auto& [target, incoming] : exits) {
+        if (this->canJoin(incoming)) {
+            addBlock(target, this->join(incoming));
+        } else {
+            for (BlockState& state : incoming) {
+                addBlock(target, state);
+            }
+        }
+    }
+
+    return nullptr;
+}
+
+BlockState LargeBlockEncoder::getPostState(const BlockState& pre, AssignTransition* edge)
+{
+    VariableExprRewrite rewrite(mBuilder);
+    for (auto& [variable, value] : pre.values) {
+        rewrite[variable] = value;
+    }
+
+    BlockState post;
+
+    ExprPtr guard = rewrite.walk(edge->getGuard());
+    if (guard == mBuilder.True()) {
+        post.condition = pre.condition;
+    } else if (pre.condition == mBuilder.True()) {
+        post.condition = guard;
+    } else {
+        post.condition = mBuilder.And(pre.condition, guard);
+    }
+
+    // The assignments of a transition are parallel, thus all values
+    // must be computed before the state is updated.
+    std::vector<VariableAssignment> updates;
+    for (const VariableAssignment& assignment : *edge) {
+        updates.emplace_back(assignment.getVariable(), rewrite.walk(assignment.getValue()));
+    }
+
+    post.values = pre.values;
+    for (VariableAssignment& update : updates) {
+        post.values[update.getVariable()] = update.getValue();
+    }
+
+    return post;
+}
+
+/// Collects the conjuncts of \p expr, flattening nested conjunctions.
+static void collectConjuncts(const ExprPtr& expr, llvm::SmallPtrSetImpl<Expr*>& conjuncts)
+{
+    if (expr->getKind() == Expr::And) {
+        for (const ExprPtr& operand : llvm::cast<AndExpr>(expr)->operands()) {
+            collectConjuncts(operand, conjuncts);
+        }
+        return;
+    }
+
+    conjuncts.insert(expr.get());
+}
+
+/// Returns true if the conjunctions \p left and \p right contain a conjunct
+/// and its negation. This is the case for the two branches of a condition.
+static bool areDisjoint(const ExprPtr& left, const ExprPtr& right)
+{
+    llvm::SmallPtrSet<Expr*, 8> leftConjuncts;
+    llvm::SmallPtrSet<Expr*, 8> rightConjuncts;
+    collectConjuncts(left, leftConjuncts);
+    collectConjuncts(right, rightConjuncts);
+
+    auto hasNegationIn = [](Expr* expr, const llvm::SmallPtrSetImpl<Expr*>& conjuncts) {
+        auto negation = llvm::dyn_cast<NotExpr>(expr);
+        return negation != nullptr && conjuncts.count(negation->getOperand().get()) != 0;
+    };
+
+    return llvm::any_of(leftConjuncts, [&](Expr* expr) { return hasNegationIn(expr, rightConjuncts); })
+        || llvm::any_of(rightConjuncts, [&](Expr* expr) { return hasNegationIn(expr, leftConjuncts); });
+}
+
+bool LargeBlockEncoder::canJoin(const std::vector<BlockState>& states) const
+{
+    // If each path assigns the same values, the joined state only needs
+    // the disjunction of the path conditions.
+    llvm::SmallPtrSet<Variable*, 8> differing;
+    for (const BlockState& state : states) {
+        for (auto& [variable, value] : state.values) {
+            ExprPtr first = this->lookup(states.front(), variable);
+            bool isSame = llvm::all_of(states, [this, variable, &first](const BlockState& other) {
+                return this->lookup(other, variable) == first;
+            });
+            if (!isSame) {
+                differing.insert(variable);
+            }
+        }
+    }
+
+    if (differing.empty()) {
+        return true;
+    }
+
+    // Otherwise the values are selected by the path conditions, which is only
+    // correct if at most one path can be taken. Selecting nondeterministic
+    // values would nest undef expressions, which may not be shared either.
+    for (const BlockState& state : states) {
+        for (Variable* variable : differing) {
+            if (ExprMetrics(this->lookup(state, variable)).getNumNodesOfKind(Expr::Undef) != 0) {
+                return false;
+            }
+        }
+    }
+
+    for (size_t i = 0; i < states.size(); ++i) {
+        for (size_t j = i + 1; j < states.size(); ++j) {
+            if (!areDisjoint(states[i].condition, states[j].condition)) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+BlockState LargeBlockEncoder::join(std::vector<BlockState>& states)
+{
+    assert(!states.empty() && "Locations inside a region must have a predecessor in the region!");
+    if (states.size() == 1) {
+        return std::move(states.front());
+    }
+
+    BlockState result;
+
+    ExprVector conditions;
+    for (BlockState& state : states) {
+        conditions.push_back(state.condition);
+        for (auto& [variable, value] : state.values) {
+            result.values.insert({variable, nullptr});
+        }
+    }
+    result.condition = mBuilder.Or(conditions);
+
+    // The value of a variable is selected by the condition of the path it
+    // came from, see canJoin. Paths which did not assign the variable keep
+    // its value.
+    for (auto& [variable, joined] : result.values) {
+        joined = this->lookup(states.back(), variable);
+        bool isSame = llvm::all_of(states, [this, variable, &joined](const BlockState& state) {
+            return this->lookup(state, variable) == joined;
+        });
+        if (isSame) {
+            continue;
+        }
+
+        for (size_t i = states.size() - 1; i > 0; --i) {
+            joined = mBuilder.Select(states[i - 1].condition, this->lookup(states[i - 1], variable), joined);
+        }
+    }
+
+    return result;
+}
+
+ExprPtr LargeBlockEncoder::lookup(const BlockState& state, Variable* variable) const
+{
+    ExprPtr value = state.values.lookup(variable);
+    if (value == nullptr) {
+        return variable->getRefExpr();
+    }
+
+    return value;
+}
+
+} // end anonymous namespace
+
+bool gazer::EncodeLargeBlocks(Cfa& cfa, ExprBuilder& builder)
+{
+    LargeBlockEncoder encoder(cfa, builder);
+    return encoder.encode();
+}
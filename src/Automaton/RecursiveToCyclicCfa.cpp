@@ -22,6 +22,7 @@
 #include "gazer/Core/Expr/ExprRewrite.h"
 #include "gazer/Core/Expr/ExprBuilder.h"
 
+#include <llvm/ADT/STLExtras.h>
 #include <llvm/ADT/Twine.h>
 #include <llvm/ADT/DenseSet.h>
 #include <llvm/Support/raw_ostream.h>
@@ -43,12 +44,13 @@ public:
 
 private:
     void addUniqueErrorLocation();
-    void inlineCallIntoRoot(CallTransition* call, llvm::Twine suffix);
+    void inlineCallIntoRoot(CallTransition* call);
 
 private:
     Cfa* mRoot;
     CallGraph mCallGraph;
     llvm::SmallVector<CallTransition*, 8> mTailRecursiveCalls;
+    llvm::DenseSet<Cfa*> mSplicedAutomata;
     Location* mError;
     Variable* mErrorFieldVariable;;
     llvm::DenseMap<Location*, Location*> mInlinedLocations;
@@ -76,13 +78,10 @@ RecursiveToCyclicResult RecursiveToCyclicTransformer::transform()
         CallTransition* call = mTailRecursiveCalls.back();
         mTailRecursiveCalls.pop_back();
 
-        this->inlineCallIntoRoot(call, "_inlined" + llvm::Twine(mInlineCnt++));
+        this->inlineCallIntoRoot(call);
     }
     mRoot->clearDisconnectedElements();
 
-    // Calculate the new call graph and remove unneeded automata.
-    //mCallGraph = CallGraph(mRoot->getParent());
-
     return {
         mError,
         mErrorFieldVariable,
@@ -91,48 +90,54 @@ RecursiveToCyclicResult RecursiveToCyclicTransformer::transform()
     };
 }
 
-void RecursiveToCyclicTransformer::inlineCallIntoRoot(CallTransition* call, llvm::Twine suffix)
+void RecursiveToCyclicTransformer::inlineCallIntoRoot(CallTransition* call)
 {
     Cfa* callee = call->getCalledAutomaton();
     Location* before = call->getSource();
     Location* after  = call->getTarget();
 
+    // The first call of each automaton is spliced in place: the root takes over the
+    // variables of the callee, thus its guards and assignments are reused as they are.
+    // This is the only call of loop automata, as each loop has a single preheader.
+    // Automata called from multiple locations get a renamed copy for other calls.
+    bool inPlace = mSplicedAutomata.insert(callee).second;
+
     VariableExprRewrite rewrite(*mExprBuilder);
     llvm::DenseMap<Location*, Location*> locToLocMap;
     llvm::DenseMap<Variable*, Variable*> oldVarToNew;
 
-    // Clone all local variables into the parent
-    for (Variable& local : callee->locals()) {
-        if (!callee->isOutput(&local)) {
-            auto varname = (local.getName() + suffix).str();
-            auto newLocal = mRoot->createLocal(varname, local.getType());
-            oldVarToNew[&local] = newLocal;
-            mInlinedVariables[newLocal] = &local;
-            rewrite[&local] = newLocal->getRefExpr();
+    auto translate = [inPlace, &rewrite](const ExprPtr& expr) -> ExprPtr {
+        return inPlace ? expr : rewrite.walk(expr);
+    };
+
+    if (inPlace) {
+        for (Variable& variable : llvm::concat<Variable>(callee->inputs(), callee->locals())) {
+            mRoot->addLocal(&variable);
+            oldVarToNew[&variable] = &variable;
         }
-    }
-    
-    // Clone input variables as well; we will insert an assign transition
-    // with the initial values later.
-    for (Variable& input : callee->inputs()) {
-        if (!callee->isOutput(&input)) {
-            auto varname = (input.getName() + suffix).str();
-            auto newInput = mRoot->createLocal(varname, input.getType());
-            oldVarToNew[&input] = newInput;
-            mInlinedVariables[newInput] = &input;
-            //rewrite[input] = call->getInputArgument(i);
-            rewrite[&input] = newInput->getRefExpr();
+    } else {
+        std::string suffix = ("_inlined" + llvm::Twine(mInlineCnt++)).str();
+
+        // Clone the input and local variables into the parent. The inputs will
+        // receive their initial values on the transition entering the callee.
+        for (Variable& variable : llvm::concat<Variable>(callee->inputs(), callee->locals())) {
+            if (!callee->isOutput(&variable)) {
+                auto newLocal = mRoot->createLocal(variable.getName() + suffix, variable.getType());
+                oldVarToNew[&variable] = newLocal;
+                mInlinedVariables[newLocal] = &variable;
+                rewrite[&variable] = newLocal->getRefExpr();
+            }
         }
-    }
 
-    for (Variable& output : callee->outputs()) {
-        auto argument = call->getOutputArgument(output);
-        assert(argument.has_value() && "Every callee output should be assigned in a call transition!");
+        for (Variable& output : callee->outputs()) {
+            auto argument = call->getOutputArgument(output);
+            assert(argument.has_value() && "Every callee output should be assigned in a call transition!");
 
-        auto newOutput = argument->getVariable();
-        oldVarToNew[&output] = newOutput;
-        mInlinedVariables[newOutput] = &output;
-        rewrite[&output] = newOutput->getRefExpr();
+            auto newOutput = argument->getVariable();
+            oldVarToNew[&output] = newOutput;
+            mInlinedVariables[newOutput] = &output;
+            rewrite[&output] = newOutput->getRefExpr();
+        }
     }
 
     // Insert all locations
@@ -142,7 +147,7 @@ void RecursiveToCyclicTransformer::inlineCallIntoRoot(CallTransition* call, llvm
         mInlinedLocations[newLoc] = origLoc;
         if (origLoc->isError()) {
             mRoot->createAssignTransition(newLoc, mError, mExprBuilder->True(), {
-                { mErrorFieldVariable, callee->getErrorFieldExpr(origLoc) }
+                { mErrorFieldVariable, translate(callee->getErrorFieldExpr(origLoc)) }
             });
         }
     }
@@ -156,16 +161,16 @@ void RecursiveToCyclicTransformer::inlineCallIntoRoot(CallTransition* call, llvm
             std::vector<VariableAssignment> newAssigns;
             std::transform(
                 assign->begin(), assign->end(), std::back_inserter(newAssigns),
-                [&oldVarToNew, &rewrite] (const VariableAssignment& origAssign) {
+                [&oldVarToNew, &translate] (const VariableAssignment& origAssign) {
                     return VariableAssignment {
                         oldVarToNew[origAssign.getVariable()],
-                        rewrite.walk(origAssign.getValue())
+                        translate(origAssign.getValue())
                     };
                 }
             );
 
             mRoot->createAssignTransition(
-                source, target, rewrite.walk(assign->getGuard()), newAssigns
+                source, target, translate(assign->getGuard()), newAssigns
             );
         } else if (auto nestedCall = llvm::dyn_cast<CallTransition>(&*origEdge)) {
             if (nestedCall->getCalledAutomaton() == callee) {
@@ -177,12 +182,12 @@ void RecursiveToCyclicTransformer::inlineCallIntoRoot(CallTransition* call, llvm
                     Variable* input = callee->getInput(i);
 
                     auto variable = oldVarToNew[input];
-                    auto value = rewrite.walk(nestedCall->getInputArgument(*input)->getValue());
+                    auto value = translate(nestedCall->getInputArgument(*input)->getValue());
 
                     if (variable->getRefExpr() != value) {
                         // Do not add unneeded assignments (X := X).
                         recursiveInputArgs.push_back({
-                            oldVarToNew[input],
+                            variable,
                             value
                         });
                     }
@@ -191,7 +196,7 @@ void RecursiveToCyclicTransformer::inlineCallIntoRoot(CallTransition* call, llvm
                 // Create the assignment back-edge.
                 mRoot->createAssignTransition(
                     source, locToLocMap[callee->getEntry()],
-                    nestedCall->getGuard(), recursiveInputArgs
+                    translate(nestedCall->getGuard()), recursiveInputArgs
                 );
             } else {
                 // Inline it as a normal call.
@@ -201,8 +206,8 @@ void RecursiveToCyclicTransformer::inlineCallIntoRoot(CallTransition* call, llvm
                 std::transform(
                     nestedCall->input_begin(), nestedCall->input_end(),
                     std::back_inserter(newArgs),
-                    [&rewrite](const VariableAssignment& assign) {
-                        return VariableAssignment{assign.getVariable(), rewrite.walk(assign.getValue())};
+                    [&translate](const VariableAssignment& assign) {
+                        return VariableAssignment{assign.getVariable(), translate(assign.getValue())};
                     }
                 );
                 std::transform(
@@ -222,10 +227,11 @@ void RecursiveToCyclicTransformer::inlineCallIntoRoot(CallTransition* call, llvm
 
                 auto newCall = mRoot->createCallTransition(
                     source, target,
-                    rewrite.walk(nestedCall->getGuard()),
+                    translate(nestedCall->getGuard()),
                     nestedCall->getCalledAutomaton(),
                     newArgs, newOuts
                 );
+                mCallGraph.addCall(newCall);
 
                 if (mCallGraph.isTailRecursive(nestedCall->getCalledAutomaton())) {
                     // If the call is to another tail-recursive automaton, we add it
@@ -251,11 +257,19 @@ void RecursiveToCyclicTransformer::inlineCallIntoRoot(CallTransition* call, llvm
         before, locToLocMap[callee->getEntry()], call->getGuard(), inputArgs
     );
 
+    // If the variables of the callee were taken over, its outputs are copied
+    // into the variables of the caller on exit.
+    std::vector<VariableAssignment> outputArgs;
+    if (inPlace) {
+        outputArgs.assign(call->output_begin(), call->output_end());
+    }
+
     mRoot->createAssignTransition(
-        locToLocMap[callee->getExit()], after , mExprBuilder->True()
+        locToLocMap[callee->getExit()], after, mExprBuilder->True(), outputArgs
     );
 
     // Remove the original call edge
+    mCallGraph.removeCall(call);
     mRoot->disconnectEdge(call);
 }
 
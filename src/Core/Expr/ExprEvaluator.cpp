@@ -37,6 +37,103 @@ auto ValuationExprEvaluator::getVariableValue(Variable& variable)
     return result->second;
 }
 
+auto CachingExprEvaluator::getVariableValue(Variable& variable)
+    -> ExprRef<AtomicExpr>
+{
+    auto& value = mVariables[&variable];
+    if (value == nullptr) {
+        value = mModel.evaluate(variable.getRefExpr());
+        if (value == nullptr) {
+            value = UndefExpr::Get(variable.getType());
+        }
+    }
+
+    return value;
+}
+
+void CachingExprEvaluator::evaluateAll(
+    llvm::ArrayRef<Variable*> variables,
+    llvm::SmallVectorImpl<ExprRef<AtomicExpr>>& values)
+{
+    values.reserve(values.size() + variables.size());
+    for (Variable* variable : variables) {
+        values.push_back(this->getVariableValue(*variable));
+    }
+}
+
+void CachingExprEvaluator::invalidate()
+{
+    mVariables.clear();
+    mResults.clear();
+}
+
+bool ExprEvaluatorBase::shouldSkip(const ExprPtr& expr, ExprRef<AtomicExpr>* ret)
+{
+    if (mResultCache == nullptr || expr->isNullary()) {
+        return false;
+    }
+
+    auto it = mResultCache->find(expr);
+    if (it == mResultCache->end()) {
+        return false;
+    }
+
+    *ret = it->second;
+    return true;
+}
+
+void ExprEvaluatorBase::handleResult(const ExprPtr& expr, ExprRef<AtomicExpr>& ret)
+{
+    if (mResultCache != nullptr && !expr->isNullary()) {
+        mResultCache->emplace(expr, ret);
+    }
+}
+
+size_t ExprEvaluatorBase::getNextOperand(const ExprRef<NonNullaryExpr>& expr, size_t i)
+{
+    if (i == 0) {
+        return 0;
+    }
+
+    size_t numOps = expr->getNumOperands();
+
+    switch (expr->getKind()) {
+        case Expr::And:
+        case Expr::Or: {
+            // Stop at the first operand which decides the result.
+            auto prev = dyn_cast<BoolLiteralExpr>(getOperand(i - 1));
+            bool dominating = expr->getKind() == Expr::Or;
+            if (prev != nullptr && prev->getValue() == dominating) {
+                return numOps;
+            }
+            return i;
+        }
+        case Expr::Imply: {
+            auto left = dyn_cast<BoolLiteralExpr>(getOperand(0));
+            if (left != nullptr && left->isFalse()) {
+                return numOps;
+            }
+            return i;
+        }
+        case Expr::Select: {
+            // Evaluate only the selected branch. Undefined conditions yield
+            // an undefined result, thus no branches are needed in that case.
+            auto cond = dyn_cast<BoolLiteralExpr>(getOperand(0));
+            if (cond == nullptr) {
+                return numOps;
+            }
+
+            if (cond->isTrue()) {
+                return i == 1 ? 1 : numOps;
+            }
+
+            return 2;
+        }
+        default:
+            return i;
+    }
+}
+
 ExprRef<AtomicExpr> ExprEvaluatorBase::visitUndef(const ExprRef<UndefExpr>& expr)
 {
     return expr;
@@ -273,8 +370,9 @@ ExprRef<AtomicExpr> ExprEvaluatorBase::visitAnd(const ExprRef<AndExpr>& expr)
         auto operand = getOperand(i);
         if (operand->isUndef()) {
             isUndef = true;
+            continue;
         }
-        
+
         bool value = cast<BoolLiteralExpr>(operand)->getValue();
         if (!value) {
             return BoolLiteralExpr::False(expr->getContext());
@@ -296,8 +394,9 @@ ExprRef<AtomicExpr> ExprEvaluatorBase::visitOr(const ExprRef<OrExpr>& expr)
         auto operand = getOperand(i);
         if (operand->isUndef()) {
             isUndef = true;
+            continue;
         }
-        
+
         bool value = cast<BoolLiteralExpr>(operand)->getValue();
         if (value) {
             return BoolLiteralExpr::True(expr->getContext());
@@ -318,6 +417,11 @@ ExprRef<AtomicExpr> ExprEvaluatorBase::visitImply(const ExprRef<ImplyExpr>& expr
 
     ExprRef<BoolLiteralExpr> leftBl, rightBl;
 
+    if (right == nullptr) {
+        // The right side was skipped, as the left side was false.
+        return BoolLiteralExpr::True(expr->getContext());
+    }
+
     if (left->isUndef()) {
         // If the right side is true, then the whole expression is true.
         if ((rightBl = dyn_cast<BoolLiteralExpr>(right)) && rightBl->isTrue()) {
@@ -492,39 +596,16 @@ ExprRef<AtomicExpr> ExprEvaluatorBase::visitFLtEq(const ExprRef<FLtEqExpr>& expr
     return this->visitNonNullary(expr);
 }
 
-template<class Type, class ExprTy>
-ExprRef<AtomicExpr> EvalSelect(
-    const ExprRef<BoolLiteralExpr>& cond,
-    const ExprRef<AtomicExpr>& then,
-    const ExprRef<AtomicExpr>& elze
-) {
-    return ExprTy::Get(
-        *cast<Type>(&then->getType()),
-        cond->getValue() ? cast<ExprTy>(then)->getValue() : cast<ExprTy>(elze)->getValue()
-    );
-}
-
 // Ternary
 ExprRef<AtomicExpr> ExprEvaluatorBase::visitSelect(const ExprRef<SelectExpr>& expr)
 {
-    auto cond = cast<BoolLiteralExpr>(getOperand(0));
-    auto then = getOperand(1);
-    auto elze = getOperand(2);
-
-    switch (expr->getType().getTypeID()) {
-        case Type::BoolTypeID:
-            return EvalSelect<BoolType, BoolLiteralExpr>(cond, then, elze);
-        case Type::BvTypeID:
-            return EvalSelect<BvType, BvLiteralExpr>(cond, then, elze);
-        case Type::IntTypeID:
-            return EvalSelect<IntType, IntLiteralExpr>(cond, then, elze);
-        case Type::FloatTypeID:
-            return EvalSelect<FloatType, FloatLiteralExpr>(cond, then, elze);
-        case Type::RealTypeID:
-            return EvalSelect<RealType, RealLiteralExpr>(cond, then, elze);
+    auto cond = getOperand(0);
+    if (cond->isUndef()) {
+        return UndefExpr::Get(expr->getType());
     }
-    
-    llvm_unreachable("Invalid SelectExpr type!");
+
+    // Only the selected operand was evaluated, see getNextOperand().
+    return cast<BoolLiteralExpr>(cond)->getValue() ? getOperand(1) : getOperand(2);
 }
 
 // Arrays
@@ -0,0 +1,147 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+#include "gazer/Core/Expr/ExprMetrics.h"
+
+#include <llvm/ADT/SmallVector.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include <limits>
+
+using namespace gazer;
+
+static uint64_t saturatingAdd(uint64_t a, uint64_t b)
+{
+    uint64_t result = a + b;
+    return result < a ? std::numeric_limits<uint64_t>::max() : result;
+}
+
+void ExprMetrics::add(const ExprPtr& expr)
+{
+    mRoots.push_back(expr);
+
+    struct Frame
+    {
+        const Expr* expr;
+        size_t next;
+    };
+
+    llvm::SmallVector<Frame, 16> stack;
+
+    auto visit = [this, &stack](const Expr* node) {
+        auto result = mIndex.try_emplace(node, mNodes.size());
+        if (!result.second) {
+            return;
+        }
+
+        // Reserve the slot, it is filled in when the node is finished.
+        mNodes.push_back({0, 0, 0});
+        stack.push_back({node, 0});
+    };
+
+    visit(expr.get());
+
+    while (!stack.empty()) {
+        Frame& top = stack.back();
+        const Expr* node = top.expr;
+
+        if (auto nn = llvm::dyn_cast<NonNullaryExpr>(node)) {
+            if (top.next != nn->getNumOperands()) {
+                visit(nn->getOperand(top.next++).get());
+                continue;
+            }
+        }
+
+        stack.pop_back();
+
+        NodeInfo info = { 1, 1, getOperatorWeight(node->getKind()) };
+        if (auto nn = llvm::dyn_cast<NonNullaryExpr>(node)) {
+            for (const ExprPtr& op : nn->operands()) {
+                const NodeInfo& opInfo = mNodes[mIndex[op.get()]];
+                info.depth = std::max(info.depth, opInfo.depth + 1);
+                info.treeSize = saturatingAdd(info.treeSize, opInfo.treeSize);
+                info.treeCost = saturatingAdd(info.treeCost, opInfo.treeCost);
+            }
+        } else if (auto varRef = llvm::dyn_cast<VarRefExpr>(node)) {
+            mSupport.push_back(&varRef->getVariable());
+        }
+
+        mNodes[mIndex[node]] = info;
+        mKindCounts[node->getKind()]++;
+    }
+
+    const NodeInfo& rootInfo = mNodes[mIndex[expr.get()]];
+    mDepth = std::max(mDepth, rootInfo.depth);
+    mTreeSize = saturatingAdd(mTreeSize, rootInfo.treeSize);
+    mTreeCost = saturatingAdd(mTreeCost, rootInfo.treeCost);
+}
+
+unsigned ExprMetrics::getDepthOf(const ExprPtr& expr) const
+{
+    auto it = mIndex.find(expr.get());
+    return it == mIndex.end() ? 0 : mNodes[it->second].depth;
+}
+
+uint64_t ExprMetrics::getTreeSizeOf(const ExprPtr& expr) const
+{
+    auto it = mIndex.find(expr.get());
+    return it == mIndex.end() ? 0 : mNodes[it->second].treeSize;
+}
+
+uint64_t ExprMetrics::getTreeCostOf(const ExprPtr& expr) const
+{
+    auto it = mIndex.find(expr.get());
+    return it == mIndex.end() ? 0 : mNodes[it->second].treeCost;
+}
+
+unsigned ExprMetrics::getOperatorWeight(Expr::ExprKind kind)
+{
+    switch (kind) {
+        case Expr::Mul:
+        case Expr::Div:
+        case Expr::Mod:
+        case Expr::Rem:
+        case Expr::BvSDiv:
+        case Expr::BvUDiv:
+        case Expr::BvSRem:
+        case Expr::BvURem:
+        case Expr::FMul:
+        case Expr::FDiv:
+            return 8;
+        case Expr::ArrayRead:
+        case Expr::ArrayWrite:
+            return 4;
+        default:
+            return 1;
+    }
+}
+
+void ExprMetrics::print(llvm::raw_ostream& os) const
+{
+    os << "depth: " << mDepth
+        << ", dag size: " << this->getDagSize()
+        << ", tree size: " << mTreeSize
+        << ", tree cost: " << mTreeCost
+        << ", support: " << mSupport.size() << "\n";
+
+    for (size_t i = 0; i < NumExprKinds; ++i) {
+        if (mKindCounts[i] != 0) {
+            os << "  " << Expr::getKindName(static_cast<Expr::ExprKind>(i))
+                << ": " << mKindCounts[i] << "\n";
+        }
+    }
+}
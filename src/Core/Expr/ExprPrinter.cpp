@@ -16,16 +16,14 @@
 //
 //===----------------------------------------------------------------------===//
 #include "gazer/Core/Expr/ExprUtils.h"
-#include "gazer/Core/Expr/ExprWalker.h"
-#include "gazer/ADT/StringUtils.h"
+#include "gazer/Core/Expr/ExprStreamPrinter.h"
+#include "gazer/Core/ExprTypes.h"
+#include "gazer/Core/LiteralExpr.h"
 
-#include <llvm/ADT/Twine.h>
+#include <llvm/ADT/SmallString.h>
 #include <llvm/Support/raw_ostream.h>
 
-#include <boost/algorithm/string.hpp>
-#include <boost/range/irange.hpp>
-
-#include <algorithm>
+#include <cctype>
 
 using namespace gazer;
 using llvm::dyn_cast;
@@ -66,237 +64,206 @@ llvm::raw_ostream& gazer::operator<<(llvm::raw_ostream& os, const Expr& expr)
 namespace
 {
 
-using llvm::Twine;
-
-std::string castTypeName(const llvm::Twine& name, const Type& from, const Type& to)
+void printLowerCase(llvm::raw_ostream& os, llvm::StringRef str)
 {
-    std::string fromStr = from.getName();
-    std::string toStr = to.getName();
-
-    boost::to_lower(fromStr);
-    boost::to_lower(toStr);
+    for (char c : str) {
+        os << static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+}
 
-    return (name + "." + Twine(fromStr) + "." + Twine(toStr)).str();
+void printCastName(llvm::raw_ostream& os, llvm::StringRef name, const Type& from, const Type& to)
+{
+    os << name << ".";
+    printLowerCase(os, from.getName());
+    os << ".";
+    printLowerCase(os, to.getName());
 }
 
-class InfixPrintVisitor : public ExprWalker<InfixPrintVisitor, std::string>
+class InfixPrinter : public ExprStreamPrinter<InfixPrinter>
 {
-    friend class ExprWalker<InfixPrintVisitor, std::string>;
 public:
-    InfixPrintVisitor(unsigned radix)
-        : mRadix(radix)
+    InfixPrinter(llvm::raw_ostream& os, unsigned radix, bool useLetBindings)
+        : ExprStreamPrinter(os, useLetBindings), mRadix(radix)
     {
         assert(mRadix == 2 || mRadix == 8 || mRadix == 16 || mRadix == 10);
     }
-private:
-    std::string printOp(const ExprRef<NonNullaryExpr>& expr, size_t idx)
+
+    void printAtom(const ExprPtr& expr, llvm::raw_ostream& os)
     {
-        std::string opStr = getOperand(idx);
-        if (expr->getOperand(idx)->isNullary()) {
-            return opStr;
+        if (auto varRef = llvm::dyn_cast<VarRefExpr>(expr)) {
+            os << varRef->getVariable().getName();
+            return;
         }
 
-        return (Twine("(") + Twine(opStr) + ")").str();
-    }
-
-private:
-    std::string visitExpr(const ExprPtr& expr) { llvm_unreachable("Unknown expression kind!"); }
-    std::string visitUndef(const ExprRef<UndefExpr>& expr) { return "undef"; }
-    std::string visitVarRef(const ExprRef<VarRefExpr>& expr)
-    {
-        return expr->getVariable().getName();
-    }
+        if (expr->isUndef()) {
+            os << "undef";
+            return;
+        }
 
-    std::string visitLiteral(const ExprRef<LiteralExpr>& expr)
-    {        
-        llvm::SmallVector<char, 32> buffer;
+        llvm::SmallString<32> buffer;
 
         switch (expr->getType().getTypeID()) {
-            case Type::BoolTypeID: {
-                auto bl = llvm::cast<BoolLiteralExpr>(expr);
-                return bl->getValue() ? "true" : "false";
-            }
+            case Type::BoolTypeID:
+                os << (llvm::cast<BoolLiteralExpr>(expr)->getValue() ? "true" : "false");
+                return;
             case Type::BvTypeID: {
                 auto bv = llvm::cast<BvLiteralExpr>(expr);
                 bv->getValue().toStringSigned(buffer, mRadix);
-
-                return (
-                    getRadixPrefix() + Twine{buffer}
-                    + "bv" + Twine{bv->getType().getWidth()}
-                ).str();
+                os << getRadixPrefix() << buffer << "bv" << bv->getType().getWidth();
+                return;
             }
             case Type::FloatTypeID: {
                 auto fl = llvm::cast<FloatLiteralExpr>(expr);
                 fl->getValue().toString(buffer);
-
-                return (Twine{buffer} + "fp" + Twine{fl->getType().getWidth()}).str();
-            }
-            case Type::IntTypeID: {
-                auto il = llvm::cast<IntLiteralExpr>(expr);
-                return std::to_string(il->getValue());
+                os << buffer << "fp" << fl->getType().getWidth();
+                return;
             }
+            case Type::IntTypeID:
+                os << llvm::cast<IntLiteralExpr>(expr)->getValue();
+                return;
             case Type::RealTypeID: {
                 auto rl = llvm::cast<RealLiteralExpr>(expr);
-
-                return (Twine(rl->getValue().numerator()) + "%" + Twine(rl->getValue().denominator())).str();
+                os << rl->getValue().numerator() << "%" << rl->getValue().denominator();
+                return;
             }
-            // TODO: Tuples, ArrayType
+            default:
+                // TODO: Tuples, ArrayType
+                break;
         }
 
         llvm_unreachable("Unknown literal expression kind.");
     }
 
-    // Define some helper macros
-    #define PRINT_UNARY_PREFIX(NAME, OPERATOR)                                  \
-    std::string visit##NAME(const ExprRef<NAME##Expr>& expr)                    \
-    {                                                                           \
-        return (Twine{OPERATOR} + "(" + getOperand(0) + ")").str();             \
-    }
-
-    #define PRINT_UNARY_CAST(NAME, OPERATOR)                                    \
-    std::string visit##NAME(const ExprRef<NAME##Expr>& expr)                    \
-    {                                                                           \
-        auto fname = castTypeName(                                              \
-            OPERATOR, expr->getOperand()->getType(), expr->getType());          \
-        return fname + "(" + getOperand(0) + ")";                               \
-    }
-
-    #define PRINT_BINARY_INFIX(NAME, OPERATOR)                                  \
-    std::string visit##NAME(const ExprRef<NAME##Expr>& expr)                    \
-    {                                                                           \
-        return (getOperand(0)) + (OPERATOR) + (getOperand(1));                  \
-    }
+    bool printPrefix(const ExprRef<NonNullaryExpr>& expr, llvm::raw_ostream& os)
+    {
+        switch (expr->getKind()) {
+            case Expr::Not: os << "not "; break;
+            case Expr::Select: os << "if "; break;
+            case Expr::ZExt: printCast(expr, "zext", os); break;
+            case Expr::SExt: printCast(expr, "sext", os); break;
+            case Expr::Extract: printCast(expr, "extract", os); break;
+            case Expr::FCast: printCast(expr, "fcast", os); break;
+            case Expr::SignedToFp: printCast(expr, "si_to_fp", os); break;
+            case Expr::UnsignedToFp: printCast(expr, "ui_to_fp", os); break;
+            case Expr::FpToSigned: printCast(expr, "fp_to_si", os); break;
+            case Expr::FpToUnsigned: printCast(expr, "fp_to_ui", os); break;
+            default:
+                if (getInfixOperator(expr->getKind()).empty()) {
+                    os << getPrefixOperator(expr->getKind()) << "(";
+                }
+                break;
+        }
 
-    #define PRINT_BINARY_PREFIX(NAME, OPERATOR)                                 \
-    std::string visit##NAME(const ExprRef<NAME##Expr>& expr)                    \
-    {                                                                           \
-        return (Twine{OPERATOR} + "("                                           \
-            + (getOperand(0)) + "," + (getOperand(1)) + ")"                     \
-        ).str();                                                                \
+        return true;
     }
 
-    // Unary
-    std::string visitNot(const ExprRef<NotExpr>& expr)
+    void printSeparator(const ExprRef<NonNullaryExpr>& expr, size_t i, llvm::raw_ostream& os)
     {
-        return "not " + printOp(expr, 0);
-    }
-
-    PRINT_UNARY_CAST(ZExt, "zext")
-    PRINT_UNARY_CAST(SExt, "sext")
+        if (expr->getKind() == Expr::Select) {
+            os << (i == 1 ? " then " : " else ");
+            return;
+        }
 
-    std::string visitExtract(const ExprRef<ExtractExpr>& expr)
-    {
-        auto fname = castTypeName("extract", expr->getOperand()->getType(), expr->getType());
-        return (fname + "(" + getOperand(0)
-                     + ", " + Twine(expr->getOffset())
-                     + ", " + Twine(expr->getWidth()) + ")").str();
+        llvm::StringRef infix = getInfixOperator(expr->getKind());
+        os << (infix.empty() ? "," : infix);
     }
 
-    PRINT_BINARY_INFIX(Add,     " + ")
-    PRINT_BINARY_INFIX(Sub,     " - ")
-    PRINT_BINARY_INFIX(Mul,     " * ")
-    PRINT_BINARY_INFIX(Div,     " / ")
-    PRINT_BINARY_INFIX(BvSDiv,  " sdiv ")
-    PRINT_BINARY_INFIX(BvUDiv,  " udiv ")
-    PRINT_BINARY_INFIX(BvSRem,  " srem ")
-    PRINT_BINARY_INFIX(BvURem,  " urem ")
-
-    PRINT_BINARY_PREFIX(Shl,    "bv.shl")
-    PRINT_BINARY_PREFIX(LShr,   "bv.lhsr")
-    PRINT_BINARY_PREFIX(AShr,   "bv.ashr")
-    PRINT_BINARY_PREFIX(BvAnd,  "bv.and")
-    PRINT_BINARY_PREFIX(BvOr,   "bv.or")
-    PRINT_BINARY_PREFIX(BvXor,  "bv.xor")
-
-    // Logic
-    PRINT_BINARY_INFIX(Imply,   "imply")
-
-    std::string visitAnd(const ExprRef<AndExpr>& expr)
+    void printSuffix(const ExprRef<NonNullaryExpr>& expr, llvm::raw_ostream& os)
     {
-        std::string buffer;
-        llvm::raw_string_ostream rso{buffer};
-
-        auto r = boost::irange<size_t>(0, expr->getNumOperands());
-
-        join_print_as(rso, r.begin(), r.end(), " and ", [this, &expr](auto& rso, size_t i) {
-            rso << this->printOp(expr, i);
-        });
-
-        return rso.str();
+        switch (expr->getKind()) {
+            case Expr::Not:
+            case Expr::Select:
+                return;
+            case Expr::Extract: {
+                auto extract = llvm::cast<ExtractExpr>(expr);
+                os << ", " << extract->getOffset() << ", " << extract->getWidth() << ")";
+                return;
+            }
+            default:
+                if (getInfixOperator(expr->getKind()).empty()) {
+                    os << ")";
+                }
+                return;
+        }
     }
 
-    std::string visitOr(const ExprRef<OrExpr>& expr)
+    bool parenthesizeOperand(const ExprRef<NonNullaryExpr>& expr, size_t i)
     {
-        std::string buffer;
-        llvm::raw_string_ostream rso{buffer};
-
-        auto r = boost::irange<size_t>(0, expr->getNumOperands());
-
-        join_print_as(rso, r.begin(), r.end(), " or ", [this, &expr](auto& rso, size_t i) {
-            rso << this->printOp(expr, i);
-        });
-
-        return rso.str();
+        switch (expr->getKind()) {
+            case Expr::Not:
+            case Expr::And:
+            case Expr::Or:
+            case Expr::Select:
+                return true;
+            default:
+                return false;
+        }
     }
 
-    // Compare
-    PRINT_BINARY_INFIX(Eq,            " = ");
-    PRINT_BINARY_INFIX(NotEq,         " <> ");
-    PRINT_BINARY_INFIX(Lt,            " < ");
-    PRINT_BINARY_INFIX(LtEq,          " <= ");
-    PRINT_BINARY_INFIX(Gt,            " > ");
-    PRINT_BINARY_INFIX(GtEq,          " >= ");
-
-    PRINT_BINARY_PREFIX(BvSLt,        "slt")
-    PRINT_BINARY_PREFIX(BvSLtEq,      "sle")
-    PRINT_BINARY_PREFIX(BvSGt,        "sgt")
-    PRINT_BINARY_PREFIX(BvSGtEq,      "sge")
-    PRINT_BINARY_PREFIX(BvULt,        "ult")
-    PRINT_BINARY_PREFIX(BvULtEq,      "ule")
-    PRINT_BINARY_PREFIX(BvUGt,        "ugt")
-    PRINT_BINARY_PREFIX(BvUGtEq,      "uge")
-
-    // Floating-point queries
-    PRINT_UNARY_PREFIX(FIsNan, "fp.is_nan")
-    PRINT_UNARY_PREFIX(FIsInf, "fp.is_inf")
-
-    // Floating-point casts
-    PRINT_UNARY_CAST(FCast,         "fcast")
-    PRINT_UNARY_CAST(SignedToFp,    "si_to_fp")
-    PRINT_UNARY_CAST(UnsignedToFp,  "ui_to_fp")
-    PRINT_UNARY_CAST(FpToSigned,    "fp_to_si")
-    PRINT_UNARY_CAST(FpToUnsigned,  "fp_to_ui")
-
-    // Floating-point arithmetic
-    PRINT_BINARY_PREFIX(FAdd,   "fp.add")
-    PRINT_BINARY_PREFIX(FSub,   "fp.sub")
-    PRINT_BINARY_PREFIX(FMul,   "fp.mul")
-    PRINT_BINARY_PREFIX(FDiv,   "fp.div")
-
-    // Floating-point compare
-    PRINT_BINARY_PREFIX(FEq,   "fp.eq")
-    PRINT_BINARY_PREFIX(FGt,   "fp.gt")
-    PRINT_BINARY_PREFIX(FGtEq, "fp.ge")
-    PRINT_BINARY_PREFIX(FLt,   "fp.lt")
-    PRINT_BINARY_PREFIX(FLtEq, "fp.le")
-
-    // Ternary
-    std::string visitSelect(const ExprRef<SelectExpr>& expr)
+private:
+    void printCast(const ExprRef<NonNullaryExpr>& expr, llvm::StringRef name, llvm::raw_ostream& os)
     {
-        return (Twine("if ") + printOp(expr, 0)
-            + Twine(" then ") + printOp(expr, 1)
-            + Twine(" else ") + printOp(expr, 2)).str();
+        printCastName(os, name, expr->getOperand(0)->getType(), expr->getType());
+        os << "(";
     }
 
-    // Arrays
-    std::string visitArrayRead(const ExprRef<ArrayReadExpr>& expr) 
+    static llvm::StringRef getInfixOperator(Expr::ExprKind kind)
     {
-        return this->visitNonNullary(expr);
+        switch (kind) {
+            case Expr::Add: return " + ";
+            case Expr::Sub: return " - ";
+            case Expr::Mul: return " * ";
+            case Expr::Div: return " / ";
+            case Expr::BvSDiv: return " sdiv ";
+            case Expr::BvUDiv: return " udiv ";
+            case Expr::BvSRem: return " srem ";
+            case Expr::BvURem: return " urem ";
+            case Expr::And: return " and ";
+            case Expr::Or: return " or ";
+            case Expr::Imply: return " imply ";
+            case Expr::Eq: return " = ";
+            case Expr::NotEq: return " <> ";
+            case Expr::Lt: return " < ";
+            case Expr::LtEq: return " <= ";
+            case Expr::Gt: return " > ";
+            case Expr::GtEq: return " >= ";
+            default:
+                return "";
+        }
     }
 
-    std::string visitArrayWrite(const ExprRef<ArrayWriteExpr>& expr)
+    static llvm::StringRef getPrefixOperator(Expr::ExprKind kind)
     {
-        return this->visitNonNullary(expr);
+        switch (kind) {
+            case Expr::Shl: return "bv.shl";
+            case Expr::LShr: return "bv.lhsr";
+            case Expr::AShr: return "bv.ashr";
+            case Expr::BvAnd: return "bv.and";
+            case Expr::BvOr: return "bv.or";
+            case Expr::BvXor: return "bv.xor";
+            case Expr::BvSLt: return "slt";
+            case Expr::BvSLtEq: return "sle";
+            case Expr::BvSGt: return "sgt";
+            case Expr::BvSGtEq: return "sge";
+            case Expr::BvULt: return "ult";
+            case Expr::BvULtEq: return "ule";
+            case Expr::BvUGt: return "ugt";
+            case Expr::BvUGtEq: return "uge";
+            case Expr::FIsNan: return "fp.is_nan";
+            case Expr::FIsInf: return "fp.is_inf";
+            case Expr::FAdd: return "fp.add";
+            case Expr::FSub: return "fp.sub";
+            case Expr::FMul: return "fp.mul";
+            case Expr::FDiv: return "fp.div";
+            case Expr::FEq: return "fp.eq";
+            case Expr::FGt: return "fp.gt";
+            case Expr::FGtEq: return "fp.ge";
+            case Expr::FLt: return "fp.lt";
+            case Expr::FLtEq: return "fp.le";
+            default:
+                // Use the kind name for everything else, e.g. array reads and writes.
+                return Expr::getKindName(kind);
+        }
     }
 
     llvm::StringRef getRadixPrefix() const
@@ -323,14 +290,14 @@ namespace gazer
 void FormatPrintExpr(const ExprPtr& expr, llvm::raw_ostream& os)
 {
     // TODO
-    InfixPrintVisitor visitor{10};
-    os << visitor.walk(expr);
+    InfixPrinter printer{os, 10, false};
+    printer.print(expr);
 }
 
-void InfixPrintExpr(const ExprPtr& expr, llvm::raw_ostream& os, unsigned bvRadix)
+void InfixPrintExpr(const ExprPtr& expr, llvm::raw_ostream& os, unsigned bvRadix, bool useLetBindings)
 {
-    InfixPrintVisitor visitor{bvRadix};
-    os << visitor.walk(expr);
+    InfixPrinter printer{os, bvRadix, useLetBindings};
+    printer.print(expr);
 }
 
-} // end namespace gazer
\ No newline at end of file
+} // end namespace gazer
@@ -129,7 +129,7 @@ ExprPtr ExprRewriteBase::rewriteNonNullary(const ExprRef<NonNullaryExpr>& expr,
 
 ExprPtr VariableExprRewrite::visitVarRef(const ExprRef<VarRefExpr>& expr)
 {
-    auto result = mRewriteMap[&expr->getVariable()];
+    auto result = mRewriteMap.lookup(&expr->getVariable());
     if (result != nullptr) {
         return result;
     }
@@ -137,7 +137,179 @@ ExprPtr VariableExprRewrite::visitVarRef(const ExprRef<VarRefExpr>& expr)
     return expr;
 }
 
+bool VariableExprRewrite::shouldSkip(const ExprPtr& expr, ExprPtr* ret)
+{
+    if (expr->isNullary()) {
+        return false;
+    }
+
+    auto it = mCache.find(expr);
+    if (it == mCache.end()) {
+        return false;
+    }
+
+    *ret = it->second;
+    return true;
+}
+
+void VariableExprRewrite::handleResult(const ExprPtr& expr, ExprPtr& ret)
+{
+    if (!expr->isNullary()) {
+        mCache.emplace(expr, ret);
+    }
+}
+
 ExprPtr& VariableExprRewrite::operator[](Variable* variable)
 {
+    mCache.clear();
     return mRewriteMap[variable];
 }
+
+// Expression importer
+//===----------------------------------------------------------------------===//
+
+Type& ExprImporter::importType(Type& type)
+{
+    if (Type* result = mTypeMap.lookup(&type)) {
+        return *result;
+    }
+
+    GazerContext& context = mExprBuilder.getContext();
+    Type* result = nullptr;
+    switch (type.getTypeID()) {
+        case Type::BoolTypeID: result = &BoolType::Get(context); break;
+        case Type::IntTypeID: result = &IntType::Get(context); break;
+        case Type::RealTypeID: result = &RealType::Get(context); break;
+        case Type::BvTypeID:
+            result = &BvType::Get(context, llvm::cast<BvType>(type).getWidth());
+            break;
+        case Type::FloatTypeID:
+            result = &FloatType::Get(context, llvm::cast<FloatType>(type).getPrecision());
+            break;
+        case Type::ArrayTypeID: {
+            auto& arrTy = llvm::cast<ArrayType>(type);
+            result = &ArrayType::Get(importType(arrTy.getIndexType()), importType(arrTy.getElementType()));
+            break;
+        }
+        case Type::TupleTypeID:
+        case Type::FunctionTypeID:
+            llvm_unreachable("Tuple and function types cannot be imported!");
+    }
+
+    mTypeMap[&type] = result;
+    return *result;
+}
+
+ExprRef<LiteralExpr> ExprImporter::importLiteral(const ExprRef<LiteralExpr>& expr)
+{
+    Type& type = importType(expr->getType());
+    switch (type.getTypeID()) {
+        case Type::BoolTypeID:
+            return BoolLiteralExpr::Get(llvm::cast<BoolType>(type), llvm::cast<BoolLiteralExpr>(expr)->getValue());
+        case Type::IntTypeID:
+            return IntLiteralExpr::Get(llvm::cast<IntType>(type), llvm::cast<IntLiteralExpr>(expr)->getValue());
+        case Type::RealTypeID:
+            return RealLiteralExpr::Get(llvm::cast<RealType>(type), llvm::cast<RealLiteralExpr>(expr)->getValue());
+        case Type::BvTypeID:
+            return BvLiteralExpr::Get(llvm::cast<BvType>(type), llvm::cast<BvLiteralExpr>(expr)->getValue());
+        case Type::FloatTypeID:
+            return FloatLiteralExpr::Get(llvm::cast<FloatType>(type), llvm::cast<FloatLiteralExpr>(expr)->getValue());
+        case Type::ArrayTypeID: {
+            auto array = llvm::cast<ArrayLiteralExpr>(expr);
+            ArrayLiteralExpr::Builder builder(llvm::cast<ArrayType>(type));
+            for (auto& [index, elem] : array->getMap()) {
+                builder.addValue(importLiteral(index), importLiteral(elem));
+            }
+
+            if (array->hasDefault()) {
+                builder.setDefault(importLiteral(array->getDefault()));
+            }
+
+            return builder.build();
+        }
+        default:
+            break;
+    }
+
+    llvm_unreachable("Unknown literal expression kind!");
+}
+
+ExprPtr ExprImporter::visitExpr(const ExprPtr& expr)
+{
+    llvm_unreachable("Unknown expression kind!");
+}
+
+ExprPtr ExprImporter::visitUndef(const ExprRef<UndefExpr>& expr)
+{
+    return mExprBuilder.Undef(importType(expr->getType()));
+}
+
+ExprPtr ExprImporter::visitLiteral(const ExprRef<LiteralExpr>& expr)
+{
+    return importLiteral(expr);
+}
+
+ExprPtr ExprImporter::visitVarRef(const ExprRef<VarRefExpr>& expr)
+{
+    Variable* variable = mVariableMap.lookup(&expr->getVariable());
+    assert(variable != nullptr && "Imported variables must be mapped!");
+    assert(variable->getType() == importType(expr->getType()) && "Mapped variables must have the same type!");
+
+    return variable->getRefExpr();
+}
+
+ExprPtr ExprImporter::visitZExt(const ExprRef<ZExtExpr>& expr)
+{
+    return mExprBuilder.ZExt(getOperand(0), llvm::cast<BvType>(importType(expr->getType())));
+}
+
+ExprPtr ExprImporter::visitSExt(const ExprRef<SExtExpr>& expr)
+{
+    return mExprBuilder.SExt(getOperand(0), llvm::cast<BvType>(importType(expr->getType())));
+}
+
+ExprPtr ExprImporter::visitFCast(const ExprRef<FCastExpr>& expr)
+{
+    return mExprBuilder.FCast(
+        getOperand(0), llvm::cast<FloatType>(importType(expr->getType())), expr->getRoundingMode());
+}
+
+ExprPtr ExprImporter::visitSignedToFp(const ExprRef<SignedToFpExpr>& expr)
+{
+    return mExprBuilder.SignedToFp(
+        getOperand(0), llvm::cast<FloatType>(importType(expr->getType())), expr->getRoundingMode());
+}
+
+ExprPtr ExprImporter::visitUnsignedToFp(const ExprRef<UnsignedToFpExpr>& expr)
+{
+    return mExprBuilder.UnsignedToFp(
+        getOperand(0), llvm::cast<FloatType>(importType(expr->getType())), expr->getRoundingMode());
+}
+
+ExprPtr ExprImporter::visitFpToSigned(const ExprRef<FpToSignedExpr>& expr)
+{
+    return mExprBuilder.FpToSigned(
+        getOperand(0), llvm::cast<BvType>(importType(expr->getType())), expr->getRoundingMode());
+}
+
+ExprPtr ExprImporter::visitFpToUnsigned(const ExprRef<FpToUnsignedExpr>& expr)
+{
+    return mExprBuilder.FpToUnsigned(
+        getOperand(0), llvm::cast<BvType>(importType(expr->getType())), expr->getRoundingMode());
+}
+
+bool ExprImporter::shouldSkip(const ExprPtr& expr, ExprPtr* ret)
+{
+    auto it = mCache.find(expr);
+    if (it == mCache.end()) {
+        return false;
+    }
+
+    *ret = it->second;
+    return true;
+}
+
+void ExprImporter::handleResult(const ExprPtr& expr, ExprPtr& ret)
+{
+    mCache.emplace(expr, ret);
+}
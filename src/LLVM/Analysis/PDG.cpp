@@ -19,24 +19,111 @@
 
 #include <llvm/IR/InstIterator.h>
 #include <llvm/IR/Instructions.h>
+#include <llvm/Analysis/MemoryLocation.h>
 #include <llvm/Analysis/PostDominators.h>
 #include <llvm/Support/GraphWriter.h>
 
+#include <unordered_map>
+
 using namespace gazer;
 
+namespace
+{
+
+struct EdgeInfo
+{
+    unsigned source;
+    unsigned target;
+    PDGEdge::Kind kind;
+};
+
+/// Collects the memory definitions which the instruction \p inst, reading
+/// memory, may depend on.
+void collectReachingDefs(
+    llvm::Instruction* inst,
+    llvm::MemorySSA& mssa,
+    llvm::AAResults& aa,
+    llvm::SmallVectorImpl<llvm::Instruction*>& defs)
+{
+    llvm::MemoryUseOrDef* access = mssa.getMemoryAccess(inst);
+    if (access == nullptr) {
+        return;
+    }
+
+    llvm::Optional<llvm::MemoryLocation> loc = llvm::MemoryLocation::getOrNone(inst);
+    llvm::MemorySSAWalker* walker = mssa.getWalker();
+
+    llvm::SmallVector<llvm::MemoryAccess*, 8> worklist;
+    llvm::SmallPtrSet<llvm::MemoryAccess*, 8> visited;
+    worklist.push_back(access->getDefiningAccess());
+
+    while (!worklist.empty()) {
+        llvm::MemoryAccess* current = worklist.pop_back_val();
+        if (!visited.insert(current).second) {
+            continue;
+        }
+
+        // If the accessed location is known, skip the definitions
+        // which do not alias with it.
+        if (loc && !mssa.isLiveOnEntryDef(current)) {
+            llvm::MemoryAccess* clobber = walker->getClobberingMemoryAccess(current, *loc);
+            if (clobber != current && !visited.insert(clobber).second) {
+                continue;
+            }
+            current = clobber;
+        }
+
+        if (mssa.isLiveOnEntryDef(current)) {
+            continue;
+        }
+
+        if (auto phi = llvm::dyn_cast<llvm::MemoryPhi>(current)) {
+            for (llvm::Use& incoming : phi->incoming_values()) {
+                worklist.push_back(llvm::cast<llvm::MemoryAccess>(incoming));
+            }
+            continue;
+        }
+
+        auto def = llvm::cast<llvm::MemoryDef>(current);
+        defs.push_back(def->getMemoryInst());
+
+        // A store which overwrites the entire location hides all earlier definitions.
+        if (loc) {
+            if (auto store = llvm::dyn_cast<llvm::StoreInst>(def->getMemoryInst())) {
+                llvm::MemoryLocation storeLoc = llvm::MemoryLocation::get(store);
+                if (storeLoc.Size == loc->Size && aa.isMustAlias(storeLoc, *loc)) {
+                    continue;
+                }
+            }
+        }
+
+        worklist.push_back(def->getDefiningAccess());
+    }
+}
+
+} // end anonymous namespace
+
 auto ProgramDependenceGraph::Create(
-    llvm::Function& function, llvm::PostDominatorTree& pdt
+    llvm::Function& function,
+    llvm::PostDominatorTree& pdt,
+    llvm::MemorySSA& mssa,
+    llvm::AAResults& aa
 )
     -> std::unique_ptr<ProgramDependenceGraph>
 {
-    std::unordered_map<llvm::Instruction*, std::unique_ptr<PDGNode>> nodes;
-    std::vector<std::unique_ptr<PDGEdge>> edges;
+    std::unique_ptr<ProgramDependenceGraph> pdg(new ProgramDependenceGraph(function));
+    auto& nodes = pdg->mNodes;
+    auto& index = pdg->mIndex;
 
     // Create a node for each instruction.
     for (llvm::Instruction& inst : llvm::instructions(function)) {
-        nodes.try_emplace(&inst, new PDGNode(&inst));
+        index[&inst] = nodes.size();
+        nodes.push_back(PDGNode(&inst));
     }
 
+    // Edges are collected first, so that they can be stored in a single array.
+    std::vector<EdgeInfo> edges;
+
     // Collect control dependencies.
     std::unordered_map<llvm::BasicBlock*, llvm::DenseSet<llvm::BasicBlock*>> controlDeps;
 
@@ -69,42 +156,25 @@ auto ProgramDependenceGraph::Create(
     // If a block B control depends on a block A, then all of B's instructions
     // will depend on A's terminator in the PDG.
     for (auto& [block, deps] : controlDeps) {
-        llvm::Instruction* terminator = block->getTerminator();
-        
-        auto& source = nodes[terminator];
+        unsigned source = index[block->getTerminator()];
         for (llvm::BasicBlock* dependentBlock : deps) {
             for (llvm::Instruction& inst : *dependentBlock) {
-                auto& target = nodes[&inst];
-                auto& edge = edges.emplace_back(new PDGEdge(&*source, &*target, PDGEdge::Control));
-                source->addOutgoing(&*edge);
-                target->addIncoming(&*edge);
+                edges.push_back({source, index[&inst], PDGEdge::Control});
             }
         }
     }
 
-    // Insert data flow dependencies
-
-    // Collect all memory-access instructions. In order to be conservative, we will
-    // assume that all memory-access instructions depend on every call, store and load.
-    std::vector<llvm::Instruction*> memoryAccesses;
+    // Insert data flow and memory dependencies
+    llvm::SmallVector<llvm::Instruction*, 8> reachingDefs;
     for (llvm::Instruction& inst : llvm::instructions(function)) {
-        if (inst.mayReadFromMemory()) {
-            memoryAccesses.push_back(&inst);
-        }
-    }
+        unsigned target = index[&inst];
 
-    for (llvm::Instruction& inst : llvm::instructions(function)) {
         // All uses of an instruction 'I' flow depend on 'I'
         for (auto& use_it : inst.operands()) {
             if (llvm::isa<llvm::Instruction>(&use_it)) {
                 auto use = llvm::dyn_cast<llvm::Instruction>(&use_it);
                 if (use != &inst) {
-                    auto& source = nodes[use];
-                    auto& target = nodes[&inst];
-                    auto& edge = edges.emplace_back(new PDGEdge(&*source, &*target, PDGEdge::DataFlow));
-
-                    source->addOutgoing(&*edge);
-                    target->addIncoming(&*edge);
+                    edges.push_back({index[use], target, PDGEdge::DataFlow});
                 }
             }
         }
@@ -113,31 +183,37 @@ auto ProgramDependenceGraph::Create(
             // PHI nodes may also depend on their incoming blocks
             for (unsigned i = 0; i < phi->getNumIncomingValues(); ++i) {
                 llvm::BasicBlock* incoming = phi->getIncomingBlock(i);
-                auto& source = nodes[incoming->getTerminator()];
-                auto& target = nodes[phi];
-                auto& edge = edges.emplace_back(new PDGEdge(&*source, &*target, PDGEdge::DataFlow));
-
-                source->addOutgoing(&*edge);
-                target->addIncoming(&*edge);
+                edges.push_back({index[incoming->getTerminator()], target, PDGEdge::DataFlow});
             }
         }
 
-        // TODO: We could be smarter with some alias analysis here.
-        if (inst.mayWriteToMemory()) {
-            for (llvm::Instruction* memRead : memoryAccesses) {
-                auto& source = nodes[&inst];
-                auto& target = nodes[memRead];
-                auto& edge = edges.emplace_back(new PDGEdge(&*source, &*target, PDGEdge::Memory));
-
-                source->addOutgoing(&*edge);
-                target->addIncoming(&*edge);
+        if (inst.mayReadFromMemory()) {
+            reachingDefs.clear();
+            collectReachingDefs(&inst, mssa, aa, reachingDefs);
+            for (llvm::Instruction* def : reachingDefs) {
+                edges.push_back({index[def], target, PDGEdge::Memory});
             }
         }
     }
 
-    return std::unique_ptr<ProgramDependenceGraph>(new ProgramDependenceGraph(
-        function, std::move(nodes), std::move(edges)
-    ));
+    pdg->mEdges.reserve(edges.size());
+    for (const EdgeInfo& edge : edges) {
+        pdg->addEdge(edge.source, edge.target, edge.kind);
+    }
+
+    return pdg;
+}
+
+void ProgramDependenceGraph::addEdge(unsigned source, unsigned target, PDGEdge::Kind kind)
+{
+    assert(mEdges.size() < mEdges.capacity() && "Adding an edge must not invalidate edge pointers!");
+
+    PDGNode* sourceNode = &mNodes[source];
+    PDGNode* targetNode = &mNodes[target];
+    PDGEdge* edge = &mEdges.emplace_back(PDGEdge(sourceNode, targetNode, kind));
+
+    sourceNode->addOutgoing(edge);
+    targetNode->addIncoming(edge);
 }
 
 void ProgramDependenceGraph::view() const
@@ -185,11 +261,11 @@ void ProgramDependenceGraph::view() const
 
     for (auto& edge : mEdges) {
         os
-            << "node_" << static_cast<void*>(edge->getSource()->getInstruction())
+            << "node_" << static_cast<void*>(edge.getSource()->getInstruction())
             << " -> "
-            << "node_" << static_cast<void*>(edge->getTarget()->getInstruction())
+            << "node_" << static_cast<void*>(edge.getTarget()->getInstruction())
             << "[color=\"";
-        switch (edge->getKind()) {
+        switch (edge.getKind()) {
             case PDGEdge::DataFlow: os << "green"; break;
             case PDGEdge::Control:  os << "blue"; break;
             case PDGEdge::Memory:   os << "red"; break;
@@ -202,4 +278,34 @@ void ProgramDependenceGraph::view() const
     llvm::errs() << " done. \n";
 
     llvm::DisplayGraph(filename, false, llvm::GraphProgram::DOT);    
-}
\ No newline at end of file
+}
+
+// LLVM pass implementation
+//===----------------------------------------------------------------------===//
+
+char ProgramDependenceWrapperPass::ID;
+
+void ProgramDependenceWrapperPass::getAnalysisUsage(llvm::AnalysisUsage& au) const
+{
+    au.addRequired<llvm::PostDominatorTreeWrapperPass>();
+    au.addRequired<llvm::MemorySSAWrapperPass>();
+    au.addRequired<llvm::AAResultsWrapperPass>();
+    au.setPreservesAll();
+}
+
+bool ProgramDependenceWrapperPass::runOnFunction(llvm::Function& function)
+{
+    mResult = ProgramDependenceGraph::Create(
+        function,
+        getAnalysis<llvm::PostDominatorTreeWrapperPass>().getPostDomTree(),
+        getAnalysis<llvm::MemorySSAWrapperPass>().getMSSA(),
+        getAnalysis<llvm::AAResultsWrapperPass>().getAAResults()
+    );
+
+    return false;
+}
+
+llvm::FunctionPass* gazer::createProgramDependenceWrapperPass()
+{
+    return new ProgramDependenceWrapperPass();
+}
@@ -22,7 +22,7 @@
 
 #include "FunctionToCfa.h"
 
-#include "gazer/Automaton/CfaTransforms.h"
+#include "gazer/Automaton/CfaSerialization.h"
 #include "gazer/LLVM/Automaton/ModuleToAutomata.h"
 #include "gazer/LLVM/Automaton/SpecialFunctions.h"
 #include "gazer/LLVM/Memory/MemoryModel.h"
@@ -88,16 +88,6 @@ bool ModuleToAutomataPass::runOnModule(llvm::Module& module)
     mSystem = translateModuleToAutomata(
         module, mSettings, loops, mContext, memoryModel, mVariables, mTraceInfo, specialFunctions.get());
 
-    if (mSettings.loops == LoopRepresentation::Cycle) {
-        // Transform the main automaton into a cyclic CFA if requested.
-        // Note: This yields an invalid CFA, which will not be recognizable by
-        // most built-in analysis algorithms. Use it only if you are going to
-        // translate it to the format of another verifier immediately.
-
-        // TODO: We should translate automata other than the main in this case.
-        TransformRecursiveToCyclic(mSystem->getMainAutomaton());
-    }
-
     return false;
 }
 
@@ -153,10 +143,39 @@ class ViewCfaPass : public llvm::ModulePass
     }
 };
 
+class WriteCfaPass : public llvm::ModulePass
+{
+public:
+    static char ID;
+
+    explicit WriteCfaPass(llvm::raw_ostream& os)
+        : ModulePass(ID), mOS(os)
+    {}
+
+    void getAnalysisUsage(llvm::AnalysisUsage& au) const override
+    {
+        au.addRequired<ModuleToAutomataPass>();
+        au.setPreservesAll();
+    }
+
+    bool runOnModule(llvm::Module& module) override
+    {
+        auto& moduleToCfa = getAnalysis<ModuleToAutomataPass>();
+        WriteAutomataSystem(moduleToCfa.getSystem(), mOS);
+        mOS.flush();
+
+        return false;
+    }
+
+private:
+    llvm::raw_ostream& mOS;
+};
+
 } // end anonymous namespace
 
 char PrintCfaPass::ID;
 char ViewCfaPass::ID;
+char WriteCfaPass::ID;
 
 llvm::Pass* gazer::createCfaPrinterPass()
 {
@@ -167,6 +186,11 @@ llvm::Pass* gazer::createCfaViewerPass()
     return new ViewCfaPass();
 }
 
+llvm::Pass* gazer::createCfaWriterPass(llvm::raw_ostream& os)
+{
+    return new WriteCfaPass(os);
+}
+
 // Traceability support
 //-----------------------------------------------------------------------------
 
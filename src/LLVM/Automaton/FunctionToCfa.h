@@ -22,6 +22,7 @@
 #include "gazer/LLVM/Automaton/SpecialFunctions.h"
 #include "gazer/Core/GazerContext.h"
 #include "gazer/Core/Expr/ExprBuilder.h"
+#include "gazer/Core/Expr/ExprMetrics.h"
 #include "gazer/Automaton/Cfa.h"
 
 #include "gazer/LLVM/Memory/MemoryObject.h"
@@ -42,9 +43,13 @@ namespace gazer
 
 extern llvm::cl::opt<bool> PrintTrace;
 
+class ExprImporter;
+
 namespace llvm2cfa
 {
 
+class LoopUseInfo;
+
 using ValueToVariableMap = llvm::DenseMap<llvm::Value*, Variable*>;
 
 /// Stores information about loops which were transformed to automata.
@@ -201,12 +206,14 @@ public:
     CfaGenInfo& createLoopCfaInfo(Cfa* cfa, llvm::Loop* loop)
     {
         CfaGenInfo& info = mProcedures.try_emplace(loop, *this, cfa, loop).first->second;
+        mProcedureOrder.push_back(&info);
         return info;
     }
 
     CfaGenInfo& createFunctionCfaInfo(Cfa* cfa, llvm::Function* function)
     {
         CfaGenInfo& info = mProcedures.try_emplace(function, *this, cfa, function).first->second;
+        mProcedureOrder.push_back(&info);
         return info;
     }
 
@@ -228,11 +235,22 @@ public:
     CfaGenInfo& getLoopCfa(llvm::Loop* loop) { return getInfoFor(loop); }
     CfaGenInfo& getFunctionCfa(llvm::Function* function) { return getInfoFor(function); }
 
-    llvm::iterator_range<typename std::unordered_map<VariantT, CfaGenInfo>::iterator> procedures()
+    /// Returns the generation information of all procedures, in the order of
+    /// their creation. Unlike the iteration order of the procedure map, this
+    /// order does not depend on pointer values, thus the names created while
+    /// encoding the procedures are the same in each run.
+    using procedure_iterator = llvm::pointee_iterator<std::vector<CfaGenInfo*>::iterator>;
+    llvm::iterator_range<procedure_iterator> procedures()
     {
-        return llvm::make_range(mProcedures.begin(), mProcedures.end());
+        return llvm::make_range(
+            procedure_iterator(mProcedureOrder.begin()),
+            procedure_iterator(mProcedureOrder.end())
+        );
     }
 
+    size_t getNumProcedures() const { return mProcedureOrder.size(); }
+    CfaGenInfo& getProcedure(size_t idx) { return *mProcedureOrder[idx]; }
+
     llvm::LoopInfo* getLoopInfoFor(const llvm::Function* function)
     {
         return mLoopInfos(function);
@@ -245,6 +263,10 @@ public:
     LLVMTypeTranslator& getTypes() const { return mTypes; }
     const LLVMFrontendSettings& getSettings() { return mSettings; }
     CfaToLLVMTrace& getTraceInfo() { return mTraceInfo; }
+
+    /// Copies the values recorded for the automaton \p source of another
+    /// generation context into the trace information of \p target.
+    void importTraceInfo(GenerationContext& other, Cfa* source, Cfa* target, ExprImporter& importer);
     const SpecialFunctions& getSpecialFunctions() const { return mSpecialFunctions; }
 
 private:
@@ -264,6 +286,7 @@ private:
     const SpecialFunctions& mSpecialFunctions;
     const LLVMFrontendSettings& mSettings;
     std::unordered_map<VariantT, CfaGenInfo> mProcedures;
+    std::vector<CfaGenInfo*> mProcedureOrder;
     CfaToLLVMTrace mTraceInfo;
     unsigned mTmp = 0;
 };
@@ -292,12 +315,32 @@ public:
 protected:
     void createAutomata();
 
+    /// Encodes the blocks of all procedures declared by createAutomata.
+    void encodeAutomata();
+    void encodeProcedure(CfaGenInfo& genInfo);
+
+    /// Encodes the procedures on \p numThreads threads. Each thread declares
+    /// all automata in a private context and encodes the procedures it takes
+    /// from a shared counter. The results are then linked into this system in
+    /// the order of their creation. Returns false if the memory model does not
+    /// support translation on multiple threads.
+    bool encodeAutomataInParallel(unsigned numThreads);
+
+    /// Copies the encoding of \p source, created by a worker in another context,
+    /// into the declaration \p target of the same procedure in this system.
+    /// The locals of \p source right after its declaration are given in
+    /// \p declaredLocals, they are mapped onto the locals of \p target.
+    void linkProcedure(
+        GenerationContext& sourceCtx, CfaGenInfo& source, llvm::ArrayRef<Variable*> declaredLocals,
+        CfaGenInfo& target, ExprImporter& importer);
+
+    /// Runs the enabled simplification passes on the generated automata.
+    void simplifyAutomata();
+
     void declareLoopVariables(
         llvm::Loop* loop, CfaGenInfo& loopGenInfo,
         MemoryInstructionHandler& memoryInstHandler,
-        llvm::ArrayRef<llvm::BasicBlock*> loopBlocks,
-        llvm::ArrayRef<llvm::BasicBlock*> loopOnlyBlocks,
-        llvm::DenseSet<llvm::BasicBlock*>& visitedBlocks
+        const LoopUseInfo& useInfo
     );
 
 private:
@@ -368,12 +411,22 @@ private:
 private:
     bool tryToEliminate(ValueOrMemoryObject val, Variable* variable, const ExprPtr& expr);
 
+    /// Returns true if substituting \p expr into its \p numUses uses results
+    /// in a cheaper encoding than assigning it to a variable.
+    bool isCheaperToInline(const ExprPtr& expr, size_t numUses);
+
     void insertOutputAssignments(CfaGenInfo& callee, std::vector<VariableAssignment>& outputArgs);
     void insertPhiAssignments(const llvm::BasicBlock* source, const llvm::BasicBlock* target, std::vector<VariableAssignment>& phiAssignments);
 
     bool handleCall(const llvm::CallInst* call, Location** entry, Location* exit, std::vector<VariableAssignment>& previousAssignments);
     void handleTerminator(const llvm::BasicBlock* bb, Location* entry, Location* exit);
 
+    /// Returns a condition which holds if the switch condition \p condition
+    /// is equal to one of \p values. Consecutive values are merged into intervals,
+    /// thus the size of the result is linear in the number of values.
+    ExprPtr getSwitchCaseCondition(
+        const ExprPtr& condition, llvm::SmallVectorImpl<const llvm::ConstantInt*>& values);
+
     void handleSuccessor(
         const llvm::BasicBlock* succ,
         const ExprPtr& succCondition,
@@ -382,6 +435,13 @@ private:
     );
 
     void createExitTransition(const llvm::BasicBlock* target, Location* pred, const ExprPtr& succCondition);
+
+    /// Creates a transition performing the PHI assignments of a CFG edge. If a value
+    /// depends on another PHI variable assigned on the same edge, which may happen on
+    /// the back-edges of cyclic automata, the assignment is done through a temporary.
+    void createPhiTransition(
+        Location* source, Location* target, const ExprPtr& guard,
+        std::vector<VariableAssignment>& phiAssignments);
     void createCallToLoop(
         llvm::Loop* loop, const llvm::BasicBlock* source, const llvm::BasicBlock* target,
         const ExprPtr& condition, Location* exit);
@@ -399,6 +459,7 @@ private:
     unsigned mCounter = 0;
     llvm::DenseMap<ValueOrMemoryObject, ExprPtr> mInlinedVars;
     llvm::DenseSet<Variable*> mEliminatedVarsSet;
+    ExprMetrics mExprCosts;
     llvm::BasicBlock* mEntryBlock;
 };
 
@@ -0,0 +1,143 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+#include "LoopUseInfo.h"
+
+#include <llvm/IR/Instructions.h>
+
+#include <limits>
+
+using namespace gazer::llvm2cfa;
+
+LoopUseInfo::LoopUseInfo(llvm::Function& function, llvm::LoopInfo& loopInfo)
+{
+    OwnBlockMap ownBlocks;
+    unsigned next = 0;
+
+    // Blocks outside of all loops come first, then the loop nests.
+    for (llvm::BasicBlock& bb : function) {
+        if (llvm::Loop* loop = loopInfo.getLoopFor(&bb)) {
+            ownBlocks[loop].push_back(&bb);
+        } else {
+            mBlockNumbers[&bb] = next++;
+        }
+    }
+
+    for (llvm::Loop* loop : loopInfo) {
+        this->numberLoop(loop, ownBlocks, next);
+    }
+
+    for (llvm::BasicBlock& bb : function) {
+        for (llvm::Instruction& inst : bb) {
+            auto range = std::make_pair(std::numeric_limits<unsigned>::max(), 0u);
+            bool hasUsers = false;
+
+            for (llvm::User* user : inst.users()) {
+                auto userInst = llvm::dyn_cast<llvm::Instruction>(user);
+                if (userInst == nullptr) {
+                    continue;
+                }
+
+                llvm::BasicBlock* parent = userInst->getParent();
+                unsigned number = mBlockNumbers.lookup(parent);
+                range.first = std::min(range.first, number);
+                range.second = std::max(range.second, number);
+                hasUsers = true;
+
+                mUsingLoops.insert({&inst, loopInfo.getLoopFor(parent)});
+            }
+
+            if (hasUsers) {
+                mUseRanges[&inst] = range;
+            }
+        }
+    }
+}
+
+void LoopUseInfo::numberLoop(llvm::Loop* loop, const OwnBlockMap& ownBlocks, unsigned& next)
+{
+    LoopRange range;
+    range.Begin = next;
+
+    auto it = ownBlocks.find(loop);
+    if (it != ownBlocks.end()) {
+        for (llvm::BasicBlock* bb : it->second) {
+            mBlockNumbers[bb] = next++;
+        }
+    }
+    range.OwnEnd = next;
+
+    for (llvm::Loop* subLoop : loop->getSubLoops()) {
+        this->numberLoop(subLoop, ownBlocks, next);
+    }
+    range.End = next;
+
+    mLoopRanges[loop] = range;
+}
+
+auto LoopUseInfo::getRange(const llvm::Loop* loop) const -> LoopRange
+{
+    auto it = mLoopRanges.find(loop);
+    assert(it != mLoopRanges.end() && "The loop must be part of the analyzed function!");
+
+    return it->second;
+}
+
+bool LoopUseInfo::contains(const llvm::Loop* loop, const llvm::BasicBlock* bb) const
+{
+    LoopRange range = this->getRange(loop);
+    unsigned number = mBlockNumbers.lookup(bb);
+
+    return range.Begin <= number && number < range.End;
+}
+
+bool LoopUseInfo::containsDirectly(const llvm::Loop* loop, const llvm::BasicBlock* bb) const
+{
+    LoopRange range = this->getRange(loop);
+    unsigned number = mBlockNumbers.lookup(bb);
+
+    return range.Begin <= number && number < range.OwnEnd;
+}
+
+bool LoopUseInfo::isDefinedOutside(const llvm::Loop* loop, const llvm::Value* value) const
+{
+    if (llvm::isa<llvm::Argument>(value)) {
+        return true;
+    }
+
+    if (auto inst = llvm::dyn_cast<llvm::Instruction>(value)) {
+        return !this->contains(loop, inst->getParent());
+    }
+
+    return false;
+}
+
+bool LoopUseInfo::hasUsesOutside(const llvm::Loop* loop, const llvm::Instruction* inst) const
+{
+    auto it = mUseRanges.find(inst);
+    if (it == mUseRanges.end()) {
+        return false;
+    }
+
+    LoopRange range = this->getRange(loop);
+    return it->second.first < range.Begin || it->second.second >= range.End;
+}
+
+bool LoopUseInfo::hasUsesDirectlyIn(const llvm::Loop* loop, const llvm::Instruction* inst) const
+{
+    return mUsingLoops.count({inst, loop}) != 0;
+}
@@ -0,0 +1,90 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file This file declares an analysis which classifies the values of
+/// a function as inputs, outputs or locals of its loop procedures.
+///
+//===----------------------------------------------------------------------===//
+#ifndef GAZER_SRC_LLVM_AUTOMATON_LOOPUSEINFO_H
+#define GAZER_SRC_LLVM_AUTOMATON_LOOPUSEINFO_H
+
+#include <llvm/Analysis/LoopInfo.h>
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/DenseSet.h>
+
+namespace gazer::llvm2cfa
+{
+
+/// Numbers the blocks of a function in loop nest preorder and records where
+/// each instruction is used.
+///
+/// Each loop owns the blocks for which it is the innermost loop. These blocks
+/// are numbered right before the blocks of the subloops, thus the blocks of a
+/// loop and its subloops form a contiguous range. Blocks outside of all loops
+/// come first. For each instruction, the analysis stores the smallest and
+/// largest number of its using blocks, and the innermost loops of its users.
+/// All queries take constant time, the analysis itself is linear in the size
+/// of the function.
+class LoopUseInfo
+{
+    struct LoopRange
+    {
+        unsigned Begin;
+        unsigned OwnEnd;
+        unsigned End;
+    };
+
+    using OwnBlockMap = llvm::DenseMap<llvm::Loop*, llvm::SmallVector<llvm::BasicBlock*, 8>>;
+
+public:
+    LoopUseInfo(llvm::Function& function, llvm::LoopInfo& loopInfo);
+
+    LoopUseInfo(const LoopUseInfo&) = delete;
+    LoopUseInfo& operator=(const LoopUseInfo&) = delete;
+
+    /// Returns true if \p bb is part of \p loop or one of its subloops.
+    bool contains(const llvm::Loop* loop, const llvm::BasicBlock* bb) const;
+
+    /// Returns true if \p loop is the innermost loop containing \p bb.
+    bool containsDirectly(const llvm::Loop* loop, const llvm::BasicBlock* bb) const;
+
+    /// Returns true if \p value must be passed into \p loop as an input,
+    /// that is, it is an argument or an instruction defined outside of the loop.
+    bool isDefinedOutside(const llvm::Loop* loop, const llvm::Value* value) const;
+
+    /// Returns true if \p inst is used outside of \p loop and its subloops.
+    bool hasUsesOutside(const llvm::Loop* loop, const llvm::Instruction* inst) const;
+
+    /// Returns true if \p inst is used in a block directly owned by \p loop.
+    /// If \p loop is null, checks the blocks which are not part of any loop.
+    bool hasUsesDirectlyIn(const llvm::Loop* loop, const llvm::Instruction* inst) const;
+
+private:
+    void numberLoop(llvm::Loop* loop, const OwnBlockMap& ownBlocks, unsigned& next);
+    LoopRange getRange(const llvm::Loop* loop) const;
+
+private:
+    llvm::DenseMap<const llvm::BasicBlock*, unsigned> mBlockNumbers;
+    llvm::DenseMap<const llvm::Loop*, LoopRange> mLoopRanges;
+    llvm::DenseMap<const llvm::Instruction*, std::pair<unsigned, unsigned>> mUseRanges;
+    llvm::DenseSet<std::pair<const llvm::Instruction*, const llvm::Loop*>> mUsingLoops;
+};
+
+} // end namespace gazer::llvm2cfa
+
+#endif
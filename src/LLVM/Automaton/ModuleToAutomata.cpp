@@ -21,16 +21,20 @@
 ///
 //===----------------------------------------------------------------------===//
 #include "FunctionToCfa.h"
+#include "LoopUseInfo.h"
 #include "gazer/LLVM/Automaton/ModuleToAutomata.h"
 
 #include "gazer/LLVM/Memory/MemoryModel.h"
 #include "gazer/LLVM/Instrumentation/Check.h"
 
 #include "gazer/Automaton/Cfa.h"
+#include "gazer/Automaton/CfaPasses.h"
 #include "gazer/Core/Expr/ExprBuilder.h"
+#include "gazer/Core/Expr/ExprRewrite.h"
 #include "gazer/Core/Expr/ExprUtils.h"
 
 #include "gazer/ADT/StringUtils.h"
+#include "gazer/Support/Warnings.h"
 
 #include <llvm/IR/Module.h>
 #include <llvm/IR/Instructions.h>
@@ -39,29 +43,19 @@
 #include <llvm/IR/InstIterator.h>
 #include <llvm/ADT/StringExtras.h>
 
+#include <atomic>
+#include <limits>
+#include <thread>
+
 #define DEBUG_TYPE "ModuleToCfa"
 
 using namespace gazer;
 using namespace gazer::llvm2cfa;
 using namespace llvm;
 
-static bool isDefinedInCaller(llvm::Value* value, llvm::ArrayRef<llvm::BasicBlock*> blocks)
-{
-    if (isa<Argument>(value)) {
-        return true;
-    }
-
-    if (auto i = dyn_cast<Instruction>(value)) {
-        if (std::find(blocks.begin(), blocks.end(), i->getParent()) != blocks.end()) {
-            return false; // NOLINT
-        }
-
-        return true;
-    }
-
-    // TODO: Is this always correct?
-    return false;
-}
+/// The maximum increase of the encoding cost allowed for eliminating
+/// a single variable on the aggressive elimination level.
+static constexpr uint64_t AggressiveElimCostBudget = 64;
 
 template<class AccessKind, class Range>
 static void memoryAccessOfKind(Range&& range, llvm::SmallVectorImpl<AccessKind*>& vec)
@@ -89,56 +83,6 @@ size_t BlocksToCfa::getNumUsesInBlocks(const llvm::Instruction* inst) const
     return cnt;
 }
 
-template<class Range>
-static bool hasUsesInBlockRange(const llvm::Instruction* inst, Range&& range)
-{
-    for (auto user : inst->users()) {
-        if (auto i = llvm::dyn_cast<Instruction>(user)) {
-            if (std::find(std::begin(range), std::end(range), i->getParent()) != std::end(range)) {
-                return true;
-            }
-        }
-    }
-
-    return false;
-}
-
-template<class Range>
-static bool checkUsesInBlockRange(const MemoryObjectDef* def, Range&& range, bool searchInside)
-{
-    // Currently the memory object interface does not support querying the uses of a particular def.
-    // What we do instead is we query all uses of the underlying abstract memory object, and check
-    // whether their reaching definition is 'def'.
-    for (MemoryObjectUse& use : def->getObject()->uses()) {
-        if (use.getReachingDef() != def) {
-            continue;
-        }
-
-        llvm::BasicBlock* bb = use.getInstruction()->getParent();
-        if (
-            (searchInside && std::find(std::begin(range), std::end(range), bb) != std::end(range))
-                ||
-            (!searchInside && std::find(std::begin(range), std::end(range), bb) == std::end(range))
-        ) {
-            return true;
-        }
-    }
-
-    return false;
-}
-
-template<class Range>
-static bool hasUsesInBlockRange(const MemoryObjectDef* def, Range&& range)
-{
-    return checkUsesInBlockRange(def, range, true);
-}
-
-template<class Range>
-static bool hasUsesOutsideOfBlockRange(const MemoryObjectDef* def, Range&& range)
-{
-    return checkUsesInBlockRange(def, range, false);
-}
-
 static bool isErrorBlock(llvm::BasicBlock* bb)
 {
     // In error blocks, the last instruction before a terminator should be the
@@ -247,26 +191,16 @@ std::unique_ptr<AutomataSystem> ModuleToCfa::generate(
     // Create all automata and interfaces.
     this->createAutomata();
 
-    // Encode all loops and functions
-    for (auto& [source, genInfo] : mGenCtx.procedures()) {
-        LLVM_DEBUG(llvm::dbgs() << "Encoding function CFA " << genInfo.Automaton->getName() << "\n");
-
-        BlocksToCfa blocksToCfa(mGenCtx, genInfo, *mExprBuilder);
-
-        // Do the actual encoding.
-        blocksToCfa.encode();
-    }
+    // Encode all loops and functions.
+    this->encodeAutomata();
 
     // CFAs must be connected graphs. Remove unreachable components now.
     for (auto& cfa : *mSystem) {
-        // We do not want to remove the exit location - if it is unreachable,
-        // create a dummy 'false' edge from the entry location to the exit.
-        if (cfa.getExit()->getNumIncoming() == 0) {
-            cfa.createAssignTransition(cfa.getEntry(), cfa.getExit(), mExprBuilder->False());
-        }
         cfa.removeUnreachableLocations();
     }
 
+    this->simplifyAutomata();
+
     // If there is a procedure called 'main', set it as the entry automaton.
     Cfa* main = mSystem->getAutomatonByName(mSettings.function);
     assert(main != nullptr && "The main automaton must exist!");
@@ -277,6 +211,280 @@ std::unique_ptr<AutomataSystem> ModuleToCfa::generate(
     return std::move(mSystem);
 }
 
+namespace
+{
+
+/// The state of a thread translating the module in a private context.
+struct TranslationWorker
+{
+    GazerContext context;
+    std::unique_ptr<MemoryModel> memoryModel;
+    std::unique_ptr<LLVMTypeTranslator> types;
+    std::unique_ptr<ModuleToCfa> translator;
+
+    // The locals of each procedure right after their declaration.
+    std::vector<std::vector<Variable*>> declaredLocals;
+};
+
+} // end anonymous namespace
+
+void ModuleToCfa::encodeAutomata()
+{
+    size_t numThreads = std::min<size_t>(mSettings.translationThreads, mGenCtx.getNumProcedures());
+    if (numThreads > 1 && this->encodeAutomataInParallel(numThreads)) {
+        return;
+    }
+
+    // Each procedure is encoded independently, but in the fixed order of their
+    // creation, so the output is deterministic.
+    for (CfaGenInfo& genInfo : mGenCtx.procedures()) {
+        this->encodeProcedure(genInfo);
+    }
+}
+
+void ModuleToCfa::encodeProcedure(CfaGenInfo& genInfo)
+{
+    LLVM_DEBUG(llvm::dbgs() << "Encoding function CFA " << genInfo.Automaton->getName() << "\n");
+
+    BlocksToCfa blocksToCfa(mGenCtx, genInfo, *mExprBuilder);
+
+    // Do the actual encoding.
+    blocksToCfa.encode();
+}
+
+bool ModuleToCfa::encodeAutomataInParallel(unsigned numThreads)
+{
+    // The loop information is shared. It is queried on this thread, so the
+    // workers only read the already computed results.
+    llvm::DenseMap<const llvm::Function*, llvm::LoopInfo*> loopInfos;
+    for (llvm::Function& function : mModule) {
+        if (!function.isDeclaration()) {
+            loopInfos[&function] = mGenCtx.getLoopInfoFor(&function);
+        }
+    }
+
+    auto loops = [&loopInfos](const llvm::Function* function) {
+        return loopInfos.lookup(function);
+    };
+
+    // Expressions and variables of a context cannot be created concurrently,
+    // thus each worker has its own context, memory model and expression builder.
+    std::vector<std::unique_ptr<TranslationWorker>> workers;
+    for (unsigned i = 0; i < numThreads; ++i) {
+        auto worker = std::make_unique<TranslationWorker>();
+        worker->memoryModel = mMemoryModel.cloneInContext(worker->context);
+        if (worker->memoryModel == nullptr) {
+            emit_warning("the memory model does not support translation on multiple threads, "
+                "using a single thread instead");
+            return false;
+        }
+
+        worker->types = std::make_unique<LLVMTypeTranslator>(
+            worker->memoryModel->getMemoryTypeTranslator(), mSettings);
+        worker->translator = std::make_unique<ModuleToCfa>(
+            mModule, loops, worker->context, *worker->memoryModel, *worker->types,
+            mGenCtx.getSpecialFunctions(), mSettings);
+        workers.push_back(std::move(worker));
+    }
+
+    // Declaring the automata is cheap compared to encoding them, so each worker
+    // declares all of them. This way every procedure can be encoded by any of the
+    // workers, and they may take the next one as soon as they are finished.
+    size_t numProcedures = mGenCtx.getNumProcedures();
+    std::vector<unsigned> owners(numProcedures);
+    std::atomic<size_t> next{0};
+
+    std::vector<std::thread> threads;
+    for (unsigned i = 0; i < numThreads; ++i) {
+        threads.emplace_back([&workers, &owners, &next, numProcedures, i]() {
+            ModuleToCfa& translator = *workers[i]->translator;
+            translator.createAutomata();
+            assert(translator.mGenCtx.getNumProcedures() == numProcedures
+                && "Workers must declare the same procedures!");
+
+            auto& declaredLocals = workers[i]->declaredLocals;
+            for (CfaGenInfo& genInfo : translator.mGenCtx.procedures()) {
+                auto& locals = declaredLocals.emplace_back();
+                for (Variable& local : genInfo.Automaton->locals()) {
+                    locals.push_back(&local);
+                }
+            }
+
+            for (size_t idx = next++; idx < numProcedures; idx = next++) {
+                translator.encodeProcedure(translator.mGenCtx.getProcedure(idx));
+                owners[idx] = i;
+            }
+        });
+    }
+
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    // Link the procedures in the order of their creation, so the result does not
+    // depend on the number of threads or on which worker encoded a procedure.
+    auto builder = CreateExprBuilder(mContext);
+    std::vector<std::unique_ptr<ExprImporter>> importers;
+    for (unsigned i = 0; i < numThreads; ++i) {
+        importers.push_back(std::make_unique<ExprImporter>(*builder));
+    }
+
+    for (size_t idx = 0; idx < numProcedures; ++idx) {
+        TranslationWorker& worker = *workers[owners[idx]];
+        GenerationContext& workerCtx = worker.translator->mGenCtx;
+        this->linkProcedure(
+            workerCtx, workerCtx.getProcedure(idx), worker.declaredLocals[idx],
+            mGenCtx.getProcedure(idx), *importers[owners[idx]]);
+    }
+
+    return true;
+}
+
+void ModuleToCfa::linkProcedure(
+    GenerationContext& sourceCtx, CfaGenInfo& source, llvm::ArrayRef<Variable*> declaredLocals,
+    CfaGenInfo& target, ExprImporter& importer)
+{
+    Cfa* from = source.Automaton;
+    Cfa* to = target.Automaton;
+
+    assert(from->getName() == to->getName() && to->getNumTransitions() == 0
+        && "The target must be the declaration of the same procedure!");
+    assert(from->getNumInputs() == to->getNumInputs() && from->getNumOutputs() == to->getNumOutputs()
+        && "Encoding must not change the interface of an automaton!");
+
+    // Inputs and declared locals are created in the same order in both automata,
+    // so they are mapped by their position.
+    for (size_t i = 0; i < from->getNumInputs(); ++i) {
+        importer[from->getInput(i)] = to->getInput(i);
+    }
+
+    assert(declaredLocals.size() == to->getNumLocals()
+        && "The target must only contain the declared locals!");
+    for (auto [declared, local] : llvm::zip(declaredLocals, to->locals())) {
+        assert(&importer.importType(declared->getType()) == &local.getType());
+        importer[declared] = &local;
+    }
+
+    // Encoding may create auxiliary locals and remove eliminated ones, which is
+    // replayed here in the same order.
+    size_t prefixLength = from->getName().size() + 1;
+    llvm::DenseSet<Variable*> locals;
+    for (Variable& variable : from->locals()) {
+        Variable*& local = importer[&variable];
+        if (local == nullptr) {
+            std::string name = variable.getName().substr(prefixLength);
+            local = to->createLocal(name, importer.importType(variable.getType()));
+        }
+
+        locals.insert(local);
+    }
+
+    to->removeLocalsIf([&locals](Variable* v) {
+        return locals.count(v) == 0;
+    });
+
+    // Locations are numbered in the order of their creation, which is the same
+    // for the declared ones.
+    llvm::DenseMap<Location*, Location*> locations;
+    for (Location* loc : from->nodes()) {
+        Location* mapped = to->findLocationById(loc->getId());
+        if (mapped == nullptr) {
+            mapped = loc->isError() ? to->createErrorLocation() : to->createLocation();
+        }
+
+        assert(mapped->getId() == loc->getId() && mapped->isError() == loc->isError());
+        locations[loc] = mapped;
+    }
+
+    for (auto& [loc, errorCode] : from->errors()) {
+        to->addErrorCode(locations[loc], importer.import(errorCode));
+    }
+
+    auto importAssignments = [&importer](auto&& range) {
+        std::vector<VariableAssignment> result;
+        for (const VariableAssignment& assign : range) {
+            result.emplace_back(importer[assign.getVariable()], importer.import(assign.getValue()));
+        }
+
+        return result;
+    };
+
+    for (Transition* edge : from->edges()) {
+        Location* source = locations[edge->getSource()];
+        Location* target = locations[edge->getTarget()];
+        ExprPtr guard = importer.import(edge->getGuard());
+
+        if (auto assign = llvm::dyn_cast<AssignTransition>(edge)) {
+            to->createAssignTransition(source, target, guard, importAssignments(*assign));
+        } else if (auto call = llvm::dyn_cast<CallTransition>(edge)) {
+            Cfa* calledCfa = call->getCalledAutomaton();
+            Cfa* callee = mSystem->getAutomatonByName(calledCfa->getName());
+            assert(callee != nullptr && "Called automata must be declared in both systems!");
+
+            for (size_t i = 0; i < calledCfa->getNumInputs(); ++i) {
+                importer[calledCfa->getInput(i)] = callee->getInput(i);
+            }
+            for (size_t i = 0; i < calledCfa->getNumOutputs(); ++i) {
+                importer[calledCfa->getOutput(i)] = callee->getOutput(i);
+            }
+
+            to->createCallTransition(
+                source, target, guard, callee, importAssignments(call->inputs()), importAssignments(call->outputs()));
+        } else {
+            llvm_unreachable("Unknown transition kind!");
+        }
+    }
+
+    mGenCtx.importTraceInfo(sourceCtx, from, to, importer);
+}
+
+void GenerationContext::importTraceInfo(GenerationContext& other, Cfa* source, Cfa* target, ExprImporter& importer)
+{
+    if (!mSettings.trace) {
+        return;
+    }
+
+    // The LLVM values and the memory objects are shared by the contexts,
+    // only the recorded expressions need to be imported.
+    for (auto& [value, expr] : other.mTraceInfo.mValueMaps[source].values) {
+        mTraceInfo.mValueMaps[target].values[value] = importer.import(expr);
+    }
+}
+
+void ModuleToCfa::simplifyAutomata()
+{
+    CfaPassManager passManager;
+
+    // Remove the transitions and error locations which are unreachable
+    // according to simple invariants, and fold the constant variables.
+    if (mSettings.pruneCfa) {
+        passManager.addPass(createInvariantPruningPass(*mExprBuilder));
+    }
+
+    // Merging locations and removing assignments would make counterexample
+    // traces coarser and less precise, thus it is skipped if they are needed.
+    bool needsTrace = mSettings.trace || !mSettings.testHarnessFile.empty();
+
+    if (mSettings.simplifyCfa && !needsTrace) {
+        passManager.addPass(createDeadAssignmentEliminationPass());
+        passManager.addPass(createLocationCompactionPass(*mExprBuilder));
+        passManager.addPass(createSequentialMergePass(*mExprBuilder));
+        passManager.addPass(createParallelMergePass(*mExprBuilder));
+        // Merging parallel transitions may create new chains.
+        passManager.addPass(createSequentialMergePass(*mExprBuilder));
+    }
+
+    if (mSettings.largeBlockEncoding && !needsTrace) {
+        passManager.addPass(createLargeBlockEncodingPass(*mExprBuilder));
+    }
+
+    passManager.run(*mSystem);
+
+    if (mSettings.printCfaPassStats) {
+        passManager.printStats(llvm::outs());
+    }
+}
+
 void ModuleToCfa::createAutomata()
 {
     // Create an automaton for each function definition and set the interfaces.
@@ -289,13 +497,23 @@ void ModuleToCfa::createAutomata()
 
         Cfa* cfa = mSystem->createCfa(function.getName());
         LLVM_DEBUG(llvm::dbgs() << "Created CFA " << cfa->getName() << "\n");
-        DenseSet<BasicBlock*> visitedBlocks;
 
-        // Create a CFA for each loop nested in this function
+        // Create a CFA for each loop nested in this function. If loops are represented
+        // as cycles, their blocks are encoded into the automaton of the function instead,
+        // and back-edges become ordinary transitions into the loop header.
         LoopInfo* loopInfo = mGenCtx.getLoopInfoFor(&function);
+        LoopUseInfo useInfo(function, *loopInfo);
+
+        bool loopsAsProcedures = mSettings.loops == LoopRepresentation::Recursion;
+        auto getProcedureLoopFor = [loopInfo, loopsAsProcedures](BasicBlock* bb) -> Loop* {
+            return loopsAsProcedures ? loopInfo->getLoopFor(bb) : nullptr;
+        };
 
         unsigned loopCount = 0;
-        auto loops = loopInfo->getLoopsInPreorder();
+        SmallVector<Loop*, 4> loops;
+        if (loopsAsProcedures) {
+            loops = loopInfo->getLoopsInPreorder();
+        }
 
         for (Loop* loop : loops) {
             std::string name = getLoopName(loop, loopCount, cfa->getName());
@@ -312,20 +530,15 @@ void ModuleToCfa::createAutomata()
 
             LLVM_DEBUG(llvm::dbgs() << "Translating loop " << loop->getName() << "\n");
 
-            ArrayRef<BasicBlock*> loopBlocks = loop->getBlocks();
-            std::vector<BasicBlock*> loopOnlyBlocks;
-            std::copy_if(
-                loopBlocks.begin(), loopBlocks.end(),
-                std::back_inserter(loopOnlyBlocks),
-                [&visitedBlocks] (BasicBlock* b) { return visitedBlocks.count(b) == 0; }
-            );
-
             // Declare loop variables.
-            this->declareLoopVariables(loop, loopGenInfo, memoryInstHandler,
-                loopBlocks, loopOnlyBlocks, visitedBlocks);
+            this->declareLoopVariables(loop, loopGenInfo, memoryInstHandler, useInfo);
+
+            // Create locations for the blocks which are not part of a subloop.
+            for (BasicBlock* bb : loop->getBlocks()) {
+                if (!useInfo.containsDirectly(loop, bb)) {
+                    continue;
+                }
 
-            // Create locations for the blocks
-            for (BasicBlock* bb : loopOnlyBlocks) {
                 Location* entry = nested->createLocation();
                 Location* exit = isErrorBlock(bb) ? nested->createErrorLocation() : nested->createLocation();
 
@@ -347,8 +560,6 @@ void ModuleToCfa::createAutomata()
                         : mExprBuilder->IntLit(i);
                 }
             }
-
-            visitedBlocks.insert(loop->getBlocks().begin(), loop->getBlocks().end());
         }
 
         // Now that all loops in this function have been dealt with, translate the function itself.
@@ -371,8 +582,8 @@ void ModuleToCfa::createAutomata()
 
         // At this point, the loops are already encoded, we only need to handle the blocks outside of the loops.
         std::vector<BasicBlock*> functionBlocks;
-        std::for_each(function.begin(), function.end(), [&visitedBlocks, &functionBlocks] (auto& bb) {
-            if (visitedBlocks.count(&bb) == 0) {
+        std::for_each(function.begin(), function.end(), [&getProcedureLoopFor, &functionBlocks] (auto& bb) {
+            if (getProcedureLoopFor(&bb) == nullptr) {
                 functionBlocks.push_back(&bb);
             }
         });
@@ -383,10 +594,10 @@ void ModuleToCfa::createAutomata()
         // For the local variables, we only need to add the values not present in any of the loops.
         for (BasicBlock& bb : function) {
             for (Instruction& inst : bb) {
-                if (auto loop = loopInfo->getLoopFor(&bb)) {
+                if (auto loop = getProcedureLoopFor(&bb)) {
                     // If the variable is an output of a loop, add it here as a local variable
                     Variable* output = mGenCtx.getLoopCfa(loop).findOutput(&inst);
-                    if (output == nullptr && !hasUsesInBlockRange(&inst, functionBlocks)) {
+                    if (output == nullptr && !useInfo.hasUsesDirectlyIn(nullptr, &inst)) {
                         LLVM_DEBUG(llvm::dbgs() << "Not adding " << inst << "\n");
                         continue;
                     }
@@ -409,9 +620,7 @@ void ModuleToCfa::createAutomata()
 void ModuleToCfa::declareLoopVariables(
     llvm::Loop* loop, CfaGenInfo& loopGenInfo,
     MemoryInstructionHandler& memoryInstHandler,
-    llvm::ArrayRef<llvm::BasicBlock*> loopBlocks,
-    llvm::ArrayRef<llvm::BasicBlock*> loopOnlyBlocks,
-    llvm::DenseSet<llvm::BasicBlock*>& visitedBlocks)
+    const LoopUseInfo& useInfo)
 {
     // Create the appropriate extension point.
     LoopVarDeclExtensionPoint loopVarDecl(loopGenInfo);
@@ -420,7 +629,7 @@ void ModuleToCfa::declareLoopVariables(
     memoryInstHandler.declareLoopProcedureVariables(loop, loopVarDecl);
 
     // Create loop variables inst-by-inst
-    for (BasicBlock* bb : loopBlocks) {
+    for (BasicBlock* bb : loop->getBlocks()) {
         for (Instruction& inst : *bb) {
             Variable* variable = nullptr;
 
@@ -433,7 +642,7 @@ void ModuleToCfa::declareLoopVariables(
                 // Add operands which were defined in the caller as inputs
                 for (auto oi = inst.op_begin(), oe = inst.op_end(); oi != oe; ++oi) {
                     llvm::Value* value = *oi;
-                    if (isDefinedInCaller(value, loopBlocks) && !loopGenInfo.hasInput(value)) {
+                    if (useInfo.isDefinedOutside(loop, value) && !loopGenInfo.hasInput(value)) {
                         auto argVariable = loopVarDecl.createInput(
                             value, mGenCtx.getTypes().get(value->getType())
                         );
@@ -446,9 +655,9 @@ void ModuleToCfa::declareLoopVariables(
                     continue;
                 }
 
-                // If the instruction is defined in an already visited block, it is a local of
-                // a subloop rather than this loop.
-                if (visitedBlocks.count(bb) == 0 || hasUsesInBlockRange(&inst, loopOnlyBlocks)) {
+                // If the instruction is defined in a subloop, it is a local of the subloop
+                // rather than this loop, unless this loop also uses it.
+                if (useInfo.containsDirectly(loop, bb) || useInfo.hasUsesDirectlyIn(loop, &inst)) {
                     variable = loopVarDecl.createLocal(&inst, mGenCtx.getTypes().get(inst.getType()));
                     LLVM_DEBUG(llvm::dbgs() << "    Added local variable " << *variable << "\n");
                 }
@@ -456,13 +665,8 @@ void ModuleToCfa::declareLoopVariables(
 
             // Check if the instruction has users outside of the loop region.
             // If so, their corresponding variables must be marked as outputs.
-            for (auto user : inst.users()) {
-                if (auto i = llvm::dyn_cast<Instruction>(user)) {
-                    if (std::find(loopBlocks.begin(), loopBlocks.end(), i->getParent()) == loopBlocks.end()) {
-                        loopVarDecl.createLoopOutput(&inst, variable);
-                        break;
-                    }
-                }
+            if (useInfo.hasUsesOutside(loop, &inst)) {
+                loopVarDecl.createLoopOutput(&inst, variable);
             }
         }
     }
@@ -651,21 +855,25 @@ void BlocksToCfa::handleTerminator(const llvm::BasicBlock* bb, Location* entry,
     } else if (auto swi = llvm::dyn_cast<SwitchInst>(terminator)) {
         ExprPtr condition = operand(swi->getCondition());
 
-        ExprPtr prevConds = mExprBuilder.True();
-        for (auto ci = swi->case_begin(); ci != swi->case_end(); ++ci) {
-            auto val = operand(ci->getCaseValue());
-            auto succ = ci->getCaseSuccessor();
-
-            ExprPtr succCondition = mExprBuilder.And(
-                prevConds,
-                mExprBuilder.Eq(condition, val)
-            );
-            prevConds = mExprBuilder.And(prevConds, mExprBuilder.NotEq(condition, val));
+        // Case values are distinct constants, thus the case conditions are disjoint
+        // without negating the previous cases. Cases jumping to the same successor
+        // share a single transition.
+        llvm::MapVector<const BasicBlock*, llvm::SmallVector<const ConstantInt*, 4>> caseValues;
+        llvm::SmallVector<const ConstantInt*, 16> allValues;
+        for (auto& switchCase : swi->cases()) {
+            caseValues[switchCase.getCaseSuccessor()].push_back(switchCase.getCaseValue());
+            allValues.push_back(switchCase.getCaseValue());
+        }
 
-            handleSuccessor(succ, succCondition, bb, exit);
+        for (auto& [succ, values] : caseValues) {
+            handleSuccessor(succ, getSwitchCaseCondition(condition, values), bb, exit);
         }
 
-        handleSuccessor(swi->getDefaultDest(), prevConds, bb, exit);
+        ExprPtr defaultCondition = allValues.empty()
+            ? mExprBuilder.True()
+            : mExprBuilder.Not(getSwitchCaseCondition(condition, allValues));
+
+        handleSuccessor(swi->getDefaultDest(), defaultCondition, bb, exit);
     } else if (auto ret = llvm::dyn_cast<ReturnInst>(terminator)) {
         if (ret->getReturnValue() == nullptr) {
             mCfa->createAssignTransition(exit, mCfa->getExit());
@@ -686,6 +894,55 @@ void BlocksToCfa::handleTerminator(const llvm::BasicBlock* bb, Location* entry,
     }
 }
 
+ExprPtr BlocksToCfa::getSwitchCaseCondition(
+    const ExprPtr& condition, llvm::SmallVectorImpl<const llvm::ConstantInt*>& values)
+{
+    assert(!values.empty() && "A case condition must have at least one value!");
+
+    // Bit-vector literals are translated as unsigned, integer literals as signed values.
+    // Runs of consecutive values in the corresponding order are checked as intervals.
+    bool isBv = condition->getType().isBvType();
+    bool useRanges = isBv || condition->getType().isIntType();
+
+    if (useRanges) {
+        std::sort(values.begin(), values.end(), [isBv](const ConstantInt* a, const ConstantInt* b) {
+            return isBv ? a->getValue().ult(b->getValue()) : a->getValue().slt(b->getValue());
+        });
+    }
+
+    ExprVector conditions;
+    for (size_t first = 0; first < values.size();) {
+        size_t last = first;
+        while (useRanges && last + 1 < values.size()
+            && values[last + 1]->getValue() - values[last]->getValue() == 1
+        ) {
+            ++last;
+        }
+
+        if (first == last) {
+            conditions.push_back(mExprBuilder.Eq(condition, operand(values[first])));
+        } else if (isBv) {
+            conditions.push_back(mExprBuilder.And(
+                mExprBuilder.BvUGtEq(condition, operand(values[first])),
+                mExprBuilder.BvULtEq(condition, operand(values[last]))
+            ));
+        } else {
+            conditions.push_back(mExprBuilder.And(
+                mExprBuilder.GtEq(condition, operand(values[first])),
+                mExprBuilder.LtEq(condition, operand(values[last]))
+            ));
+        }
+
+        first = last + 1;
+    }
+
+    if (conditions.size() == 1) {
+        return conditions[0];
+    }
+
+    return mExprBuilder.Or(conditions);
+}
+
 bool BlocksToCfa::tryToEliminate(ValueOrMemoryObject val, Variable* variable, const ExprPtr& expr)
 {
     if (mGenCtx.getSettings().isElimVarsOff()) {
@@ -709,22 +966,15 @@ bool BlocksToCfa::tryToEliminate(ValueOrMemoryObject val, Variable* variable, co
         return false;
     }
 
+    // Memory object definitions are only used by the next access of the same
+    // object, instructions may have any number of uses in the current region.
+    size_t numUses = 1;
     if (val.isValue() && llvm::isa<llvm::Instruction>(val.asValue())) {
-        auto inst = llvm::cast<llvm::Instruction>(val.asValue());
-        // On 'Normal' level, we do not want to inline expressions which have multiple uses
-        // and have already inlined operands.
-
-        bool hasInlinedOperands = std::any_of(inst->op_begin(), inst->op_end(), [this](const llvm::Use& op) {
-            const llvm::Value* v = &*op;
-            return llvm::isa<Instruction>(v) && mInlinedVars.count(llvm::cast<Instruction>(v)) != 0;
-        });
+        numUses = getNumUsesInBlocks(llvm::cast<llvm::Instruction>(val.asValue()));
+    }
 
-        if (!mGenCtx.getSettings().isElimVarsAggressive()
-            && getNumUsesInBlocks(inst) > 1
-            && hasInlinedOperands
-        ) {
-            return false;
-        }
+    if (!isCheaperToInline(expr, numUses)) {
+        return false;
     }
 
     mInlinedVars[val] = expr;
@@ -733,6 +983,33 @@ bool BlocksToCfa::tryToEliminate(ValueOrMemoryObject val, Variable* variable, co
     return true;
 }
 
+bool BlocksToCfa::isCheaperToInline(const ExprPtr& expr, size_t numUses)
+{
+    // The expression already contains its inlined operands, thus its tree cost
+    // reflects the duplication caused by previous eliminations as well.
+    // The metrics object is shared between all candidates of this automaton,
+    // so each distinct node is only measured once.
+    mExprCosts.add(expr);
+    uint64_t cost = mExprCosts.getTreeCostOf(expr);
+
+    if (numUses != 0 && cost > std::numeric_limits<uint64_t>::max() / numUses) {
+        return false;
+    }
+
+    // Inlining copies the expression into each of its uses, while keeping the
+    // variable costs an assignment and a variable reference in each use.
+    uint64_t inlinedCost = numUses * cost;
+    uint64_t keptCost = cost + 1 + numUses;
+
+    if (mGenCtx.getSettings().isElimVarsAggressive()) {
+        // Trade some growth for fewer variables, but never let duplicated
+        // subterms grow the encoding without bounds.
+        return inlinedCost <= keptCost + AggressiveElimCostBudget;
+    }
+
+    return inlinedCost <= keptCost;
+}
+
 void BlocksToCfa::createExitTransition(const BasicBlock* target, Location* pred, const ExprPtr& succCondition)
 {
     LLVM_DEBUG(llvm::dbgs() << "  Building exit transition for block " << target->getName() << "\n");
@@ -814,7 +1091,7 @@ void BlocksToCfa::handleSuccessor(const BasicBlock* succ, const ExprPtr& succCon
         auto phiEp = this->createExtensionPoint(phiAssignments, &exit, &to);
         mMemoryInstHandler.handleBasicBlockEdge(*parent, *succ, phiEp);
 
-        mCfa->createAssignTransition(exit, to, succCondition, phiAssignments);
+        this->createPhiTransition(exit, to, succCondition, phiAssignments);
     } else if (auto loop = getNestedLoopOf(mGenCtx, mGenInfo, succ)) {
         this->createCallToLoop(loop, parent, succ, succCondition, exit);
     } else {
@@ -822,6 +1099,75 @@ void BlocksToCfa::handleSuccessor(const BasicBlock* succ, const ExprPtr& succCon
     }
 }
 
+/// Returns true if \p expr refers to a variable of \p variables other than \p self.
+static bool refersToOtherVariable(
+    const ExprPtr& expr, const llvm::DenseSet<Variable*>& variables, Variable* self)
+{
+    llvm::SmallVector<Expr*, 16> worklist;
+    llvm::SmallPtrSet<Expr*, 16> visited;
+    worklist.push_back(expr.get());
+
+    while (!worklist.empty()) {
+        Expr* current = worklist.pop_back_val();
+        if (!visited.insert(current).second) {
+            continue;
+        }
+
+        if (auto varRef = llvm::dyn_cast<VarRefExpr>(current)) {
+            Variable* variable = &varRef->getVariable();
+            if (variable != self && variables.count(variable) != 0) {
+                return true;
+            }
+        } else if (auto nonNullary = llvm::dyn_cast<NonNullaryExpr>(current)) {
+            for (const ExprPtr& op : nonNullary->operands()) {
+                worklist.push_back(op.get());
+            }
+        }
+    }
+
+    return false;
+}
+
+void BlocksToCfa::createPhiTransition(
+    Location* source, Location* target, const ExprPtr& guard, std::vector<VariableAssignment>& phiAssignments)
+{
+    // In cyclic automata, the incoming value of a PHI node on a back-edge may refer
+    // to the current value of another PHI node of the loop header. As the assignments
+    // of a transition may be performed in sequence, such values are computed into
+    // temporaries first, and the PHI variables are updated on a separate transition.
+    llvm::DenseSet<Variable*> assigned;
+    for (VariableAssignment& assign : phiAssignments) {
+        assigned.insert(assign.getVariable());
+    }
+
+    std::vector<VariableAssignment> first;
+    std::vector<VariableAssignment> delayed;
+    std::vector<VariableAssignment> independent;
+
+    for (VariableAssignment& assign : phiAssignments) {
+        Variable* variable = assign.getVariable();
+        if (!refersToOtherVariable(assign.getValue(), assigned, variable)) {
+            independent.push_back(assign);
+            continue;
+        }
+
+        Variable* next = mCfa->createLocal("phi_next", variable->getType());
+        first.emplace_back(next, assign.getValue());
+        delayed.emplace_back(variable, next->getRefExpr());
+    }
+
+    if (delayed.empty()) {
+        mCfa->createAssignTransition(source, target, guard, phiAssignments);
+        return;
+    }
+
+    first.insert(first.end(), independent.begin(), independent.end());
+
+    Location* middle = mCfa->createLocation();
+    mCfa->createAssignTransition(source, middle, guard, first);
+    mCfa->createAssignTransition(middle, target, mExprBuilder.True(), delayed);
+}
+
 void BlocksToCfa::createCallToLoop(
     llvm::Loop* loop, const llvm::BasicBlock* source, const llvm::BasicBlock* target,
     const ExprPtr& condition, Location* exit)
@@ -23,6 +23,8 @@
 #include "gazer/LLVM/Transform/UndefToNondet.h"
 #include "gazer/LLVM/Memory/MemoryModel.h"
 #include "gazer/Trace/TraceWriter.h"
+#include "gazer/Automaton/CfaSerialization.h"
+#include "gazer/Verifier/VerificationCache.h"
 #include "gazer/LLVM/Trace/TestHarnessGenerator.h"
 #include "gazer/LLVM/Transform/BackwardSlicer.h"
 #include "gazer/Support/Warnings.h"
@@ -47,6 +49,7 @@
 #include <llvm/IRReader/IRReader.h>
 #include <llvm/Support/raw_ostream.h>
 #include <llvm/Support/SourceMgr.h>
+#include <llvm/Support/MemoryBuffer.h>
 #include <llvm/Bitcode/BitcodeWriter.h>
 
 using namespace gazer;
@@ -99,8 +102,65 @@ namespace
         std::unique_ptr<VerificationResult> mResult;
     };
 
+    /// Builds no traces, used for systems which are not translated from LLVM.
+    class NullTraceBuilder : public CfaTraceBuilder
+    {
+    public:
+        std::unique_ptr<Trace> build(
+            std::vector<Location*>& states,
+            std::vector<std::vector<VariableAssignment>>& actions) override
+        {
+            return nullptr;
+        }
+    };
+
 } // end anonymous namespace
 
+/// Runs \p algorithm on \p system, using the verification cache if enabled.
+static std::unique_ptr<VerificationResult> runVerificationAlgorithm(
+    VerificationAlgorithm& algorithm,
+    AutomataSystem& system,
+    CfaTraceBuilder& traceBuilder,
+    const LLVMFrontendSettings& settings)
+{
+    if (settings.cacheDirectory.empty()) {
+        return algorithm.check(system, traceBuilder);
+    }
+
+    VerificationCache cache(settings.cacheDirectory);
+    auto result = cache.check(algorithm, system, traceBuilder);
+    cache.printStats(llvm::outs());
+
+    return result;
+}
+
+/// Prints the status of \p result, using \p failMessage to describe failures.
+static void printVerificationStatus(const VerificationResult& result, llvm::StringRef failMessage)
+{
+    switch (result.getStatus()) {
+        case VerificationResult::Fail:
+            llvm::outs() << "Verification FAILED.\n";
+            llvm::outs() << "  " << failMessage << "\n";
+            break;
+        case VerificationResult::Success:
+            llvm::outs() << "Verification SUCCESSFUL.\n";
+            break;
+        case VerificationResult::Timeout:
+            llvm::outs() << "Verification TIMEOUT.\n";
+            break;
+        case VerificationResult::BoundReached:
+            llvm::outs() << "Verification BOUND REACHED.\n";
+            break;
+        case VerificationResult::InternalError:
+            llvm::outs() << "Verification INTERNAL ERROR.\n";
+            llvm::outs() << "  " << result.getMessage() << "\n";
+            break;
+        case VerificationResult::Unknown:
+            llvm::outs() << "Verification UNKNOWN.\n";
+            break;
+    }
+}
+
 char RunVerificationBackendPass::ID;
 
 LLVMFrontend::LLVMFrontend(
@@ -205,68 +265,86 @@ bool RunVerificationBackendPass::runOnModule(llvm::Module& module)
     CfaToLLVMTrace cfaToLlvmTrace = moduleToCfa.getTraceInfo();
     LLVMTraceBuilder traceBuilder{system.getContext(), cfaToLlvmTrace};
 
-    mResult = mAlgorithm.check(system, traceBuilder);
-    switch (mResult->getStatus()) {
-        case VerificationResult::Fail: {
-            auto fail = llvm::cast<FailResult>(mResult.get());
-            unsigned ec = fail->getErrorID();
-            std::string msg = mChecks.messageForCode(ec);
+    mResult = runVerificationAlgorithm(mAlgorithm, system, traceBuilder, mSettings);
 
-            llvm::outs() << "Verification FAILED.\n";
-            llvm::outs() << "  " << msg << "\n";
-
-            if (mSettings.trace) {
-                auto writer = trace::CreateTextWriter(llvm::outs(), true);
-                llvm::outs() << "Error trace:\n";
-                llvm::outs() << "------------\n";
-                if (fail->hasTrace()) {
-                    writer->write(fail->getTrace());
-                } else {
-                    llvm::outs() << "Error trace is unavailable.\n";
-                }
-            }
+    auto fail = llvm::dyn_cast<FailResult>(mResult.get());
+    if (fail == nullptr) {
+        printVerificationStatus(*mResult, "");
+        return false;
+    }
 
-            if (!mSettings.testHarnessFile.empty() && fail->hasTrace()) {
-                llvm::outs() << "Generating test harness.\n";
-                auto test = GenerateTestHarnessModuleFromTrace(
-                    fail->getTrace(), 
-                    module.getContext(),
-                    module
-                );
-
-                llvm::StringRef filename(mSettings.testHarnessFile);
-                std::error_code osError;
-                llvm::raw_fd_ostream testOS(filename, osError, llvm::sys::fs::OpenFlags::OF_None);
-
-                if (filename.endswith("ll")) {
-                    testOS << *test;
-                } else {
-                    llvm::WriteBitcodeToFile(*test, testOS);
-                }
-            }
-            break;
+    printVerificationStatus(*fail, mChecks.messageForCode(fail->getErrorID()));
+
+    if (mSettings.trace) {
+        auto writer = trace::CreateTextWriter(llvm::outs(), true);
+        llvm::outs() << "Error trace:\n";
+        llvm::outs() << "------------\n";
+        if (fail->hasTrace()) {
+            writer->write(fail->getTrace());
+        } else {
+            llvm::outs() << "Error trace is unavailable.\n";
+        }
+    }
+
+    if (!mSettings.testHarnessFile.empty() && fail->hasTrace()) {
+        llvm::outs() << "Generating test harness.\n";
+        auto test = GenerateTestHarnessModuleFromTrace(
+            fail->getTrace(), 
+            module.getContext(),
+            module
+        );
+
+        llvm::StringRef filename(mSettings.testHarnessFile);
+        std::error_code osError;
+        llvm::raw_fd_ostream testOS(filename, osError, llvm::sys::fs::OpenFlags::OF_None);
+
+        if (filename.endswith("ll")) {
+            testOS << *test;
+        } else {
+            llvm::WriteBitcodeToFile(*test, testOS);
         }
-        case VerificationResult::Success:
-            llvm::outs() << "Verification SUCCESSFUL.\n";
-            break;
-        case VerificationResult::Timeout:
-            llvm::outs() << "Verification TIMEOUT.\n";
-            break;
-        case VerificationResult::BoundReached:
-            llvm::outs() << "Verification BOUND REACHED.\n";
-            break;
-        case VerificationResult::InternalError:
-            llvm::outs() << "Verification INTERNAL ERROR.\n";
-            llvm::outs() << "  " << mResult->getMessage() << "\n";
-            break;
-        case VerificationResult::Unknown:
-            llvm::outs() << "Verification UNKNOWN.\n";
-            break;
     }
 
     return false;
 }
 
+bool gazer::VerifyModelFile(
+    llvm::StringRef filename,
+    GazerContext& context,
+    VerificationAlgorithm& algorithm,
+    const LLVMFrontendSettings& settings)
+{
+    auto buffer = llvm::MemoryBuffer::getFile(filename);
+    if (!buffer) {
+        llvm::errs() << "ERROR: " << filename << ": " << buffer.getError().message() << "\n";
+        return false;
+    }
+
+    std::string errorMessage;
+    auto system = ReadAutomataSystem((*buffer)->getMemBufferRef(), context, errorMessage);
+    if (system == nullptr) {
+        llvm::errs() << "ERROR: " << filename << ": " << errorMessage << "\n";
+        return false;
+    }
+
+    if (system->getMainAutomaton() == nullptr) {
+        llvm::errs() << "ERROR: " << filename << ": the model has no main automaton\n";
+        return false;
+    }
+
+    NullTraceBuilder traceBuilder;
+    auto result = runVerificationAlgorithm(algorithm, *system, traceBuilder, settings);
+
+    // The checks which inserted the error codes are not known here.
+    std::string failMessage;
+    if (auto fail = llvm::dyn_cast<FailResult>(result.get())) {
+        failMessage = "Error code " + std::to_string(fail->getErrorID());
+    }
+    printVerificationStatus(*result, failMessage);
+
+    return true;
+}
+
 void LLVMFrontend::registerEnabledChecks()
 {
     mChecks.registerPasses(mPassManager);
@@ -62,8 +62,8 @@ namespace
     cl::opt<ElimVarsLevel> ElimVarsLevelOpt("elim-vars", cl::desc("Level for variable elimination:"),
         cl::values(
             clEnumValN(ElimVarsLevel::Off, "off", "Do not eliminate variables"),
-            clEnumValN(ElimVarsLevel::Normal, "normal", "Eliminate variables having only one use"),
-            clEnumValN(ElimVarsLevel::Aggressive, "aggressive", "Eliminate all eligible variables")
+            clEnumValN(ElimVarsLevel::Normal, "normal", "Eliminate variables if it does not increase the encoding size"),
+            clEnumValN(ElimVarsLevel::Aggressive, "aggressive", "Eliminate variables if it increases the encoding size by a bounded amount")
         ),
         cl::init(ElimVarsLevel::Normal),
         cl::cat(IrToCfaCategory)
@@ -75,6 +75,26 @@ namespace
         "no-simplify-expr", cl::desc("Do not simplify expressions"),
         cl::cat(IrToCfaCategory)
     );
+    cl::opt<bool> NoPruneCfa(
+        "no-prune-cfa", cl::desc("Do not prune automata using invariants found by abstract interpretation"),
+        cl::cat(IrToCfaCategory)
+    );
+    cl::opt<bool> NoSimplifyCfa(
+        "no-simplify-cfa", cl::desc("Do not merge transitions and remove dead assignments in automata"),
+        cl::cat(IrToCfaCategory)
+    );
+    cl::opt<bool> LargeBlockEncoding(
+        "large-block-encoding", cl::desc("Collapse the loop-free regions of automata into single transitions"),
+        cl::cat(IrToCfaCategory)
+    );
+    cl::opt<bool> PrintCfaPassStats(
+        "print-cfa-pass-stats", cl::desc("Print the size of automata after each simplification pass"),
+        cl::cat(IrToCfaCategory)
+    );
+    cl::opt<unsigned> TranslationThreads(
+        "translation-threads", cl::desc("Number of threads used for translating functions into automata"),
+        cl::init(1), cl::cat(IrToCfaCategory)
+    );
     cl::opt<std::string> EntryFunctionName(
         "function", cl::desc("Main function name"), cl::cat(IrToCfaCategory), cl::init("main"));
     cl::opt<bool> Strict(
@@ -108,6 +128,14 @@ namespace
         cl::init(""),
         cl::cat(TraceCategory)
     );
+
+    cl::opt<std::string> CacheDirectory(
+        "cache-dir",
+        cl::desc("Reuse verification results stored in the given directory, and store new results there"),
+        cl::value_desc("directory"),
+        cl::init(""),
+        cl::cat(LLVMFrontendCategory)
+    );
 } // end anonymous namespace
 
 bool LLVMFrontendSettings::validate(const llvm::Module& module, llvm::raw_ostream& os) const
@@ -138,8 +166,11 @@ LLVMFrontendSettings LLVMFrontendSettings::initFromCommandLine()
     settings.liftAsserts = !NoAssertLift;
     settings.slicing =!NoSlice;
     settings.simplifyExpr = !NoSimplifyExpr;
+    settings.pruneCfa = !NoPruneCfa;
+    settings.simplifyCfa = !NoSimplifyCfa;
 
     settings.strict = Strict;
+    settings.translationThreads = TranslationThreads;
 
     settings.inlineLevel = InlineLevelOpt;
     settings.elimVars = ElimVarsLevelOpt;
@@ -157,10 +188,14 @@ LLVMFrontendSettings LLVMFrontendSettings::initFromCommandLine()
     }
 
     settings.debugDumpMemorySSA = DebugDumpMemorySSA;
+    settings.largeBlockEncoding = LargeBlockEncoding;
+    settings.printCfaPassStats = PrintCfaPassStats;
 
     settings.trace = PrintTrace;
     settings.testHarnessFile = TestHarnessFile;
 
+    settings.cacheDirectory = CacheDirectory;
+
     return settings;
 }
 
@@ -29,8 +29,10 @@
 using namespace gazer;
 using namespace llvm;
 
-static void updateCurrentValuation(Valuation& val, const std::vector<VariableAssignment>& action)
+/// Applies \p action to \p val, returns true if any of the values has changed.
+static bool updateCurrentValuation(Valuation& val, const std::vector<VariableAssignment>& action)
 {
+    bool changed = false;
     for (auto& assign : action) {
         if (assign.getValue()->getKind() == Expr::Undef) {
             // Ignore undef's at this point -- they are not required.
@@ -38,8 +40,15 @@ static void updateCurrentValuation(Valuation& val, const std::vector<VariableAss
         }
 
         assert(assign.getValue()->getKind() == Expr::Literal);
-        val[assign.getVariable()] = boost::static_pointer_cast<LiteralExpr>(assign.getValue());
+        auto& current = val[assign.getVariable()];
+        auto lit = boost::static_pointer_cast<LiteralExpr>(assign.getValue());
+        if (current != lit) {
+            current = lit;
+            changed = true;
+        }
     }
+
+    return changed;
 }
 
 gazer::Type* LLVMTraceBuilder::preferredTypeFromDIType(llvm::DIType* diTy)
@@ -111,8 +120,17 @@ auto LLVMTraceBuilder::build(
     std::vector<std::unique_ptr<TraceEvent>> events;
     llvm::DenseSet<const llvm::Value*> undefs;
 
+    // All values of the trace are evaluated by the same memoizing evaluator,
+    // its results are only dropped if the current valuation changes.
     Valuation currentVals;
-    ValuationExprEvaluator evaluator(currentVals);
+    ValuationExprEvaluator valuationEval(currentVals);
+    CachingExprEvaluator evaluator(valuationEval);
+
+    auto update = [&currentVals, &evaluator](const std::vector<VariableAssignment>& action) {
+        if (updateCurrentValuation(currentVals, action)) {
+            evaluator.invalidate();
+        }
+    };
 
     auto shouldProcessEntry = [](CfaToLLVMTrace::BlockToLocationInfo info) -> bool {
         return info.block != nullptr && info.kind == CfaToLLVMTrace::Location_Entry;
@@ -133,7 +151,7 @@ auto LLVMTraceBuilder::build(
         // basic blocks. We will have to skip these.
         while (!shouldProcessEntry(entry) && actionIt != actionEnd) {
             entry = mCfaToLlvmTrace.getBlockFromLocation(*stateIt);
-            updateCurrentValuation(currentVals, *actionIt);
+            update(*actionIt);
             ++stateIt;
             ++actionIt;
         }
@@ -144,7 +162,7 @@ auto LLVMTraceBuilder::build(
         }
         
         loc = *stateIt;
-        updateCurrentValuation(currentVals, *actionIt);
+        update(*actionIt);
         const BasicBlock* bb = entry.block;
 
         for (const llvm::Instruction& inst : *bb) {
@@ -175,7 +193,7 @@ auto LLVMTraceBuilder::build(
                                 // TODO: Add location
                             ));
                         } else {
-                            auto expr = this->getLiteralFromValue(loc->getAutomaton(), inst.getOperand(0), currentVals);
+                            auto expr = this->getLiteralFromValue(loc->getAutomaton(), inst.getOperand(0), evaluator);
 
                             // We get undefined value in two cases:
                             //  1) if the condition is true and the use is the 'then' value, or
@@ -204,14 +222,14 @@ auto LLVMTraceBuilder::build(
 
             llvm::Function* callee = call->getCalledFunction();
             if (auto dvi = llvm::dyn_cast<llvm::DbgValueInst>(&inst)) {
-                this->handleDbgValueInst(loc, dvi, events, currentVals);
+                this->handleDbgValueInst(loc, dvi, events, evaluator);
             } else if (callee->getName().startswith(GazerIntrinsic::InlinedGlobalWritePrefix)) {
                 auto value = call->getArgOperand(0);
                 auto mdGlobal = cast<DIGlobalVariable>(
                     cast<MetadataAsValue>(call->getArgOperand(1))->getMetadata()
                 );
 
-                auto lit = this->getLiteralFromValue(loc->getAutomaton(), value, currentVals);
+                auto lit = this->getLiteralFromValue(loc->getAutomaton(), value, evaluator);
 
                 LocationInfo location = { 0, 0 };
                 if (auto& debugLoc = call->getDebugLoc()) {
@@ -231,7 +249,7 @@ auto LLVMTraceBuilder::build(
                 std::vector<ExprRef<AtomicExpr>> args;
                 for (size_t i = 1; i < call->getNumArgOperands(); ++i) {
                     args.push_back(
-                        this->getLiteralFromValue(loc->getAutomaton(), call->getArgOperand(i), currentVals)
+                        this->getLiteralFromValue(loc->getAutomaton(), call->getArgOperand(i), evaluator)
                     );
                 }
 
@@ -253,7 +271,7 @@ auto LLVMTraceBuilder::build(
                     cast<MetadataAsValue>(call->getArgOperand(0))->getMetadata()
                 );
 
-                auto expr = this->getLiteralFromValue(loc->getAutomaton(), call->getArgOperand(1), currentVals);
+                auto expr = this->getLiteralFromValue(loc->getAutomaton(), call->getArgOperand(1), evaluator);
                 events.push_back(std::make_unique<FunctionReturnEvent>(
                     diSP->getName(),
                     expr
@@ -278,7 +296,7 @@ auto LLVMTraceBuilder::build(
                 auto variable = mCfaToLlvmTrace.getVariableForValue(loc->getAutomaton(), call);
                 assert(variable != nullptr && "Call results should be present as variables!");
 
-                ExprRef<AtomicExpr> expr = getLiteralFromValue(loc->getAutomaton(), call, currentVals);
+                ExprRef<AtomicExpr> expr = getLiteralFromValue(loc->getAutomaton(), call, evaluator);
 
                 if (expr == nullptr) {
                     // For variables which are assigned but never read,
@@ -316,7 +334,7 @@ void LLVMTraceBuilder::handleDbgValueInst(
     const Location* loc,
     const llvm::DbgValueInst* dvi,
     std::vector<std::unique_ptr<TraceEvent>>& events,
-    Valuation& currentVals
+    ExprEvaluator& evaluator
 ) {
     if (dvi->getValue() != nullptr && dvi->getVariable() != nullptr) {
         Value* value = dvi->getValue();
@@ -341,7 +359,7 @@ void LLVMTraceBuilder::handleDbgValueInst(
         DIType* diType = diVar->getType();
         gazer::Type* preferredType = this->preferredTypeFromDIType(diType);
 
-        auto lit = getLiteralFromValue(loc->getAutomaton(), value, currentVals, preferredType);
+        auto lit = getLiteralFromValue(loc->getAutomaton(), value, evaluator, preferredType);
         events.push_back(std::make_unique<AssignTraceEvent>(
             traceVarFromDIVar(diVar),
             lit,
@@ -351,17 +369,15 @@ void LLVMTraceBuilder::handleDbgValueInst(
 }
 
 ExprRef<AtomicExpr> LLVMTraceBuilder::getLiteralFromValue(
-    Cfa* cfa, const llvm::Value* value, Valuation& model, gazer::Type* preferredType
+    Cfa* cfa, const llvm::Value* value, ExprEvaluator& evaluator, gazer::Type* preferredType
 ) {
     if (auto cd = dyn_cast<ConstantData>(value)) {
         return this->getLiteralFromLLVMConst(cd, preferredType);
     }
 
-    ValuationExprEvaluator eval(model);
-
     auto expr = mCfaToLlvmTrace.getExpressionForValue(cfa, value);
     if (expr != nullptr) {
-        auto ret = eval.evaluate(expr);
+        auto ret = evaluator.evaluate(expr);
         if (ret != nullptr) {
             return ret;
         }
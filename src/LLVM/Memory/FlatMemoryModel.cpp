@@ -19,11 +19,16 @@
 #include "gazer/LLVM/Memory/MemoryInstructionHandler.h"
 #include "gazer/LLVM/Memory/MemorySSA.h"
 #include "gazer/LLVM/Memory/MemoryUtils.h"
+#include "gazer/LLVM/Memory/PointsToAnalysis.h"
+#include "gazer/LLVM/Memory/ModRefAnalysis.h"
 
 #include "gazer/Core/LiteralExpr.h"
 #include "gazer/Core/Expr/ExprBuilder.h"
 
 #include <llvm/IR/InstIterator.h>
+#include <llvm/Analysis/CallGraph.h>
+#include <llvm/ADT/MapVector.h>
+#include <llvm/ADT/SmallPtrSet.h>
 #include <llvm/IR/GetElementPtrTypeIterator.h>
 #include <llvm/Transforms/Utils/UnifyFunctionExitNodes.h>
 #include <llvm/Support/Debug.h>
@@ -39,6 +44,9 @@ namespace
 {
 
 llvm::cl::opt<bool> FlatMemoryDumpMemSSA("flat-memory-dump-memssa");
+llvm::cl::opt<bool> FlatMemoryNoRegions(
+    "flat-memory-no-regions",
+    llvm::cl::desc("Do not partition the memory into regions using points-to analysis"));
 
 class FlatMemoryModelInstTranslator;
 
@@ -50,21 +58,45 @@ struct CallInfo
 
 struct FlatMemoryFunctionInfo
 {
-    MemoryObject* memory;
     MemoryObject* stackPointer;
     MemoryObject* framePointer;
 
-    MemoryObjectUse* exitUse;
+    bool hasReturn = false;
 
-    // Maps lifted globals onto their corresponding memory objects.
-    llvm::DenseMap<llvm::GlobalVariable*, MemoryObject*> globals;
+    // Maps the memory locations accessed by this function (or its callees)
+    // onto their corresponding memory objects.
+    llvm::MapVector<unsigned, MemoryObject*> objects;
 
-    // Maps non-lifted globals to their addresses in memory.
-    llvm::DenseMap<llvm::GlobalVariable*, ExprRef<LiteralExpr>> globalPointers;
+    // Maps globals which were not lifted into scalars to their addresses in memory.
+    llvm::DenseMap<llvm::GlobalVariable*, unsigned> globalAddresses;
 
     llvm::DenseMap<llvm::CallSite, CallInfo> calls;
 
     std::unique_ptr<memory::MemorySSA> memorySSA;
+
+    MemoryObject* getObject(unsigned location) const
+    {
+        MemoryObject* object = objects.lookup(location);
+        assert(object != nullptr && "Accessed memory locations must have a memory object!");
+
+        return object;
+    }
+};
+
+/// The results of the module-wide analyses of the flat memory model. They do
+/// not depend on the expression context, thus they are shared by all instances
+/// of the model and are only read after their construction.
+struct FlatMemoryModuleInfo
+{
+    std::unordered_map<const llvm::Function*, FlatMemoryFunctionInfo> functions;
+
+    std::unique_ptr<memory::PointsToAnalysis> pointsTo;
+    unsigned numRegions = 1;
+
+    std::vector<llvm::GlobalVariable*> liftedGlobals;
+    llvm::DenseMap<const llvm::GlobalVariable*, unsigned> globalLocations;
+    llvm::SmallPtrSet<const llvm::GlobalVariable*, 8> scalarGlobals;
+    std::unique_ptr<memory::ModRefAnalysis> modRef;
 };
 
 class FlatMemoryModel : public MemoryModel, public MemoryTypeTranslator
@@ -84,9 +116,40 @@ public:
         DominatorTreeFuncTy dominators
     );
 
+    /// Creates a new instance in \p context, sharing the analysis results of \p other.
+    FlatMemoryModel(GazerContext& context, const FlatMemoryModel& other);
+
+    std::unique_ptr<MemoryModel> cloneInContext(GazerContext& context) override {
+        return std::make_unique<FlatMemoryModel>(context, *this);
+    }
+
     void insertCallDefsUses(
         llvm::CallSite call, FlatMemoryFunctionInfo& info, memory::MemorySSABuilder& builder);
 
+    /// Returns true if \p gv was lifted into a scalar memory object.
+    bool isScalarGlobal(const llvm::GlobalVariable* gv) const {
+        return mInfo->scalarGlobals.count(gv) != 0;
+    }
+
+    /// Returns the memory location which holds the value pointed by \p ptr.
+    /// The first locations are the regions of the memory array, followed by
+    /// the lifted global variables.
+    unsigned getLocationFor(const llvm::Value* ptr) const
+    {
+        if (auto gv = memory::getBaseGlobalVariable(ptr)) {
+            auto it = mInfo->globalLocations.find(gv);
+            if (it != mInfo->globalLocations.end()) {
+                return it->second;
+            }
+        }
+
+        return mInfo->pointsTo != nullptr ? mInfo->pointsTo->getRegionFor(ptr) : 0;
+    }
+
+    unsigned getNumLocations() const {
+        return mInfo->numRegions + mInfo->liftedGlobals.size();
+    }
+
     MemoryTypeTranslator& getMemoryTypeTranslator() override { return *this; }
     
     MemoryInstructionHandler& getMemoryInstructionHandler(llvm::Function& function) override;
@@ -116,19 +179,31 @@ public:
         return BvLiteralExpr::Get(ptrType(), addr);
     }
 
-    const FlatMemoryFunctionInfo& getInfoFor(const llvm::Function* function) {
+    const FlatMemoryFunctionInfo& getInfoFor(const llvm::Function* function) const {
         assert(!function->isDeclaration());
-        assert(mFunctions.count(function) != 0);
+        auto it = mInfo->functions.find(function);
+        assert(it != mInfo->functions.end());
 
-        return mFunctions[function];
+        return it->second;
     }
 
     const LLVMFrontendSettings& getSettings() const { return mSettings; }
 
+private:
+    MemoryObject* createLocationObject(unsigned location, memory::MemorySSABuilder& builder);
+
+    /// Returns the callee of \p call if its memory effects should be
+    /// represented in the caller, nullptr otherwise.
+    static llvm::Function* getTranslatedCallee(llvm::CallSite call);
+
 private:
     const LLVMFrontendSettings& mSettings;
-    const llvm::DataLayout& mDataLayout;
-    std::unordered_map<const llvm::Function*, FlatMemoryFunctionInfo> mFunctions;
+
+    // The data layout caches the layout of structures lazily, thus each instance
+    // has its own copy, so they may be used on different threads.
+    llvm::DataLayout mDataLayout;
+    std::shared_ptr<FlatMemoryModuleInfo> mInfo;
+
     std::unordered_map<
         const llvm::Function*, std::unique_ptr<MemoryInstructionHandler>> mTranslators;
     std::unique_ptr<ExprBuilder> mExprBuilder;
@@ -145,25 +220,47 @@ FlatMemoryModel::FlatMemoryModel(
 ) : MemoryTypeTranslator(context),
     mSettings(settings),
     mDataLayout(module.getDataLayout()),
+    mInfo(std::make_shared<FlatMemoryModuleInfo>()),
     mTypes(*this, mSettings)
 {
     // Initialize the expression builder
     mExprBuilder = CreateFoldingExprBuilder(mContext);
 
-    // If the global variable never has its address taken, we can lift it from
+    // Partition the memory array into regions which may never alias.
+    if (!FlatMemoryNoRegions) {
+        mInfo->pointsTo = std::make_unique<memory::PointsToAnalysis>(module);
+        mInfo->numRegions = mInfo->pointsTo->getNumRegions();
+    }
+
+    // If the address of a global variable never escapes, we can lift it from
     // the memory array into its own memory object, as distinct globals never alias.
-    llvm::SmallPtrSet<llvm::GlobalVariable*, 8> liftedGlobals;
-    llvm::SmallPtrSet<llvm::GlobalVariable*, 4> otherGlobals;
+    // Lifted globals of a single value type become scalars, others get their own array.
+    std::vector<llvm::GlobalVariable*> addressedGlobals;
+    llvm::SmallPtrSet<llvm::GlobalVariable*, 8> memoryGlobals;
 
     for (llvm::GlobalVariable& gv : module.globals()) {
-        // FIXME: We currently do not lift globals which have array or struct types.
-        //if (!memory::isGlobalUsedAsPointer(gv) && gv.getType()->isSingleValueType()) {
-        //    liftedGlobals.insert(&gv);
-        //} else {
-            otherGlobals.insert(&gv);
-        //}
+        if (!memory::isGlobalUsedAsPointer(gv) && gv.getValueType()->isSingleValueType()) {
+            mInfo->scalarGlobals.insert(&gv);
+        } else if (!memory::isGlobalAddressEscaping(gv)) {
+            // The global keeps its address, but it is stored in its own array.
+            addressedGlobals.push_back(&gv);
+        } else {
+            addressedGlobals.push_back(&gv);
+            memoryGlobals.insert(&gv);
+            continue;
+        }
+
+        mInfo->globalLocations[&gv] = this->getNumLocations();
+        mInfo->liftedGlobals.push_back(&gv);
     }
 
+    // Summarize the memory locations accessed by each function.
+    llvm::CallGraph cg(module);
+    mInfo->modRef = std::make_unique<memory::ModRefAnalysis>(
+        cg, this->getNumLocations(),
+        [this](const llvm::Value* ptr) { return this->getLocationFor(ptr); }
+    );
+
     for (llvm::Function& function : module) {
         if (function.isDeclaration()) {
             continue;
@@ -172,69 +269,73 @@ FlatMemoryModel::FlatMemoryModel(
         bool isEntryFunction = mSettings.getEntryFunction(module) == &function;
 
         memory::MemorySSABuilder builder(function, mDataLayout, dominators(function));
-        auto& info = mFunctions[&function];
-
-        info.memory = builder.createMemoryObject(
-            0, MemoryObjectType::Unknown, MemoryObject::UnknownSize, nullptr, "Memory");
-        info.memory->setTypeHint(memoryArrayType());
+        auto& info = mInfo->functions[&function];
 
         info.stackPointer = builder.createMemoryObject(
-            1, MemoryObjectType::Unknown, mDataLayout.getPointerSize(), nullptr, "StackPtr");
-        info.stackPointer->setTypeHint(ptrType());
-
+            0, MemoryObjectType::Unknown, mDataLayout.getPointerSize(), nullptr, "StackPtr");
         info.framePointer = builder.createMemoryObject(
-            2, MemoryObjectType::Unknown, mDataLayout.getPointerSize(), nullptr, "FramePtr");
-        info.framePointer->setTypeHint(ptrType());
+            1, MemoryObjectType::Unknown, mDataLayout.getPointerSize(), nullptr, "FramePtr");
 
-        builder.createLiveOnEntryDef(info.memory);
         builder.createLiveOnEntryDef(info.stackPointer);
         builder.createLiveOnEntryDef(info.framePointer);
 
-        // Handle global variables
-        unsigned globalCnt = 2;
-        info.globals.reserve(liftedGlobals.size());
-
-        for (llvm::GlobalVariable* gv : liftedGlobals) {
-            auto gvObj = builder.createMemoryObject(
-                globalCnt++,
-                MemoryObjectType::Scalar,
-                mDataLayout.getTypeAllocSize(gv->getType()->getPointerElementType()),
-                gv->getType()->getPointerElementType(),
-                gv->getName()
-            );
-            info.globals[gv] = gvObj;
+        // Memory locations only get a memory object in functions which may access them.
+        auto& modRef = mInfo->modRef->getSummary(&function);
+        for (unsigned loc = 0, e = this->getNumLocations(); loc != e; ++loc) {
+            if (!modRef.accesses(loc) && !modRef.local.test(loc)) {
+                continue;
+            }
 
-            if (isEntryFunction && gv->hasInitializer()) {
-                builder.createGlobalInitializerDef(gvObj, gv);
+            MemoryObject* object = this->createLocationObject(loc, builder);
+            info.objects[loc] = object;
+            builder.createLiveOnEntryDef(object);
+
+            if (loc >= mInfo->numRegions) {
+                llvm::GlobalVariable* gv = mInfo->liftedGlobals[loc - mInfo->numRegions];
+                if (isEntryFunction && gv->hasInitializer()) {
+                    builder.createGlobalInitializerDef(object, gv);
+                }
             }
         }
 
         unsigned globalAddr = GlobalBegin32;
-        info.globalPointers.reserve(otherGlobals.size());
+        info.globalAddresses.reserve(addressedGlobals.size());
 
-        for (llvm::GlobalVariable* gv : otherGlobals) {
+        for (llvm::GlobalVariable* gv : addressedGlobals) {
             unsigned siz = mDataLayout.getTypeAllocSize(gv->getType()->getPointerElementType());
-            info.globalPointers[gv] = this->ptrConstant(globalAddr);
+            info.globalAddresses[gv] = globalAddr;
             globalAddr += siz;
 
-            if (isEntryFunction && gv->hasInitializer()) {
-                builder.createGlobalInitializerDef(info.memory, gv);
+            if (isEntryFunction && gv->hasInitializer() && memoryGlobals.count(gv) != 0) {
+                // If the entry function does not access the region, nobody does.
+                if (auto object = info.objects.lookup(this->getLocationFor(gv))) {
+                    builder.createGlobalInitializerDef(object, gv);
+                }
             }
         }
 
         // Handle definitions and uses in instructions.
         for (llvm::Instruction& inst : llvm::instructions(function)) {
             if (auto store = llvm::dyn_cast<llvm::StoreInst>(&inst)) {
-                builder.createStoreDef(info.memory, *store);
+                MemoryObject* object = info.getObject(this->getLocationFor(store->getPointerOperand()));
+                builder.createStoreDef(object, *store);
             } else if (auto load = llvm::dyn_cast<llvm::LoadInst>(&inst)) {
-                builder.createLoadUse(info.memory, *load);
+                MemoryObject* object = info.getObject(this->getLocationFor(load->getPointerOperand()));
+                builder.createLoadUse(object, *load);
             } else if (auto call = llvm::dyn_cast<llvm::CallInst>(&inst)) {
                 this->insertCallDefsUses(call, info, builder);
             } else if (auto ret = llvm::dyn_cast<llvm::ReturnInst>(&inst)) {
-                assert(info.exitUse == nullptr && "There must be at most one return use!");
-                info.exitUse = builder.createReturnUse(info.memory, *ret);
+                assert(!info.hasReturn && "There must be at most one return instruction!");
+                info.hasReturn = true;
+
+                // Locations modified by this function are the outputs of the procedure.
+                for (auto& [loc, object] : info.objects) {
+                    if (modRef.mod.test(loc)) {
+                        builder.createReturnUse(object, *ret);
+                    }
+                }
             } else if (auto alloca = llvm::dyn_cast<llvm::AllocaInst>(&inst)) {
-                builder.createAllocaDef(info.memory, *alloca);
+                builder.createAllocaDef(info.getObject(this->getLocationFor(alloca)), *alloca);
                 builder.createAllocaDef(info.stackPointer, *alloca);
             }
         }
@@ -248,31 +349,77 @@ FlatMemoryModel::FlatMemoryModel(
     }
 }
 
-void FlatMemoryModel::insertCallDefsUses(
-    llvm::CallSite call, FlatMemoryFunctionInfo& info, memory::MemorySSABuilder& builder)
+FlatMemoryModel::FlatMemoryModel(GazerContext& context, const FlatMemoryModel& other)
+    : MemoryTypeTranslator(context),
+    mSettings(other.mSettings),
+    mDataLayout(other.mDataLayout),
+    mInfo(other.mInfo),
+    mTypes(*this, mSettings)
 {
-    llvm::Function* callee = call.getCalledFunction();
+    mExprBuilder = CreateFoldingExprBuilder(mContext);
+}
 
-    if (callee == nullptr) {
-        builder.createCallDef(info.memory, call);
-        builder.createCallUse(info.memory, call);
-        return;
+auto FlatMemoryModel::createLocationObject(unsigned location, memory::MemorySSABuilder& builder)
+    -> MemoryObject*
+{
+    // The first two identifiers are used by the stack and frame pointers.
+    unsigned id = location + 2;
+
+    if (location < mInfo->numRegions) {
+        std::string name = location == 0 ? "Memory" : ("Memory" + llvm::Twine(location)).str();
+        return builder.createMemoryObject(
+            id, MemoryObjectType::Unknown, MemoryObject::UnknownSize, nullptr, name);
     }
 
-    llvm::StringRef name = callee->getName();
+    llvm::GlobalVariable* gv = mInfo->liftedGlobals[location - mInfo->numRegions];
+    llvm::Type* valueTy = gv->getValueType();
+
+    if (this->isScalarGlobal(gv)) {
+        return builder.createMemoryObject(
+            id, MemoryObjectType::Scalar,
+            mDataLayout.getTypeAllocSize(valueTy), valueTy, gv->getName()
+        );
+    }
+
+    return builder.createMemoryObject(
+        id, MemoryObjectType::Array,
+        mDataLayout.getTypeAllocSize(valueTy), valueTy, gv->getName()
+    );
+}
+
+auto FlatMemoryModel::getTranslatedCallee(llvm::CallSite call) -> llvm::Function*
+{
+    llvm::Function* callee = call.getCalledFunction();
+    if (callee == nullptr || callee->isDeclaration() || callee->doesNotAccessMemory()) {
+        return nullptr;
+    }
 
+    llvm::StringRef name = callee->getName();
     if (name.startswith("gazer.") || name.startswith("llvm.") || name.startswith("verifier.")) {
-        // TODO: This may need to change in the case of some intrinsics (e.g. llvm.memcpy)
-        return;
+        return nullptr;
     }
 
-    if (callee->doesNotAccessMemory()) {
+    return callee;
+}
+
+void FlatMemoryModel::insertCallDefsUses(
+    llvm::CallSite call, FlatMemoryFunctionInfo& info, memory::MemorySSABuilder& builder)
+{
+    llvm::Function* callee = call.getCalledFunction();
+
+    if (callee == nullptr) {
+        // An unknown callee may clobber anything.
+        for (auto& [loc, object] : info.objects) {
+            builder.createCallDef(object, call);
+            builder.createCallUse(object, call);
+        }
         return;
     }
 
-    if (callee->isDeclaration()) {
-        // TODO: We could handle some know function here or clobber the memory according to
-        // some configuration option.
+    // TODO: Intrinsics may need to be handled differently (e.g. llvm.memcpy).
+    // We could also handle some known external functions here or clobber the
+    // memory according to some configuration option.
+    if (getTranslatedCallee(call) == nullptr) {
         return;
     }
 
@@ -280,15 +427,22 @@ void FlatMemoryModel::insertCallDefsUses(
 
     auto& callInfo = info.calls[call];
 
-    if (definesMemory) {
-        callInfo.defs[info.memory] = builder.createCallDef(info.memory, call);
-    }
-
-    callInfo.uses[info.memory] = builder.createCallUse(info.memory, call);
     callInfo.uses[info.stackPointer] = builder.createCallUse(info.stackPointer, call);
     callInfo.uses[info.framePointer] = builder.createCallUse(info.framePointer, call);
 
-    // FIXME: Add global clobbers
+    // Memory locations are only passed to the callee if it may access them,
+    // and only clobbered if it may modify them.
+    auto& calleeModRef = mInfo->modRef->getSummary(callee);
+    for (auto& [loc, object] : info.objects) {
+        if (!calleeModRef.accesses(loc)) {
+            continue;
+        }
+
+        callInfo.uses[object] = builder.createCallUse(object, call);
+        if (definesMemory && calleeModRef.mod.test(loc)) {
+            callInfo.defs[object] = builder.createCallDef(object, call);
+        }
+    }
 }
 
 // Flat memory model instruction translation
@@ -301,7 +455,7 @@ class FlatMemoryModelInstTranslator : public MemorySSABasedInstructionHandler
 {
 public:
     FlatMemoryModelInstTranslator(
-        FlatMemoryModel& memoryModel, FlatMemoryFunctionInfo& info,
+        FlatMemoryModel& memoryModel, const FlatMemoryFunctionInfo& info,
         ExprBuilder& builder, LLVMTypeTranslator& types, const llvm::DataLayout& dl
     ) : MemorySSABasedInstructionHandler(*info.memorySSA, types),
         mMemoryModel(memoryModel), mInfo(info), mExprBuilder(builder), mDataLayout(dl)
@@ -343,6 +497,9 @@ public:
 
     ExprPtr isValidAccess(llvm::Value* ptr, const ExprPtr& expr) override;
 
+protected:
+    gazer::Type& getMemoryObjectType(MemoryObject* object) override;
+
 private:
     ExprPtr handleGlobalInitializer(
         memory::GlobalInitializerDef* def,
@@ -363,7 +520,7 @@ private:
 
 private:
     FlatMemoryModel& mMemoryModel;
-    FlatMemoryFunctionInfo& mInfo;
+    const FlatMemoryFunctionInfo& mInfo;
     ExprBuilder& mExprBuilder;
     const llvm::DataLayout& mDataLayout;
 };
@@ -375,7 +532,8 @@ auto FlatMemoryModelInstTranslator::handleAlloca(const llvm::AllocaInst& alloc,
     -> ExprPtr
 {
     MemoryObjectDef* spDef = mMemorySSA.getUniqueDefinitionFor(&alloc, mInfo.stackPointer);
-    MemoryObjectDef* memDef = mMemorySSA.getUniqueDefinitionFor(&alloc, mInfo.memory);
+    MemoryObject* object = mInfo.getObject(mMemoryModel.getLocationFor(&alloc));
+    MemoryObjectDef* memDef = mMemorySSA.getUniqueDefinitionFor(&alloc, object);
 
     assert(memDef != nullptr && "There must be exactly one Memory definition for an alloca!");
     assert(spDef != nullptr && "There must be exactly one StackPtr definition for an alloca!");
@@ -415,8 +573,9 @@ auto FlatMemoryModelInstTranslator::handlePointerValue(const llvm::Value* value)
     -> ExprPtr
 {
     if (auto gv = llvm::dyn_cast<llvm::GlobalVariable>(value)) {
-        if (auto globalPtr = mInfo.globalPointers.lookup(gv)) {
-            return globalPtr;
+        auto it = mInfo.globalAddresses.find(gv);
+        if (it != mInfo.globalAddresses.end()) {
+            return mMemoryModel.ptrConstant(it->second);
         }
     }
 
@@ -546,8 +705,17 @@ void FlatMemoryModelInstTranslator::handleBlock(const llvm::BasicBlock& bb, llvm
     for (MemoryObjectDef& def : mMemorySSA.definitionAnnotationsFor(&bb)) {
         Variable* defVariable = ep.getVariableFor(&def);
         if (auto globalInit = llvm::dyn_cast<memory::GlobalInitializerDef>(&def)) {
-            ExprPtr pointer = ep.getAsOperand(globalInit->getGlobalVariable());
-            ExprPtr globalValue = this->handleGlobalInitializer(globalInit, pointer, ep);
+            llvm::GlobalVariable* gv = globalInit->getGlobalVariable();
+            ExprPtr globalValue;
+            if (mMemoryModel.isScalarGlobal(gv)) {
+                globalValue = gv->hasInitializer()
+                    ? ep.getAsOperand(gv->getInitializer())
+                    : mExprBuilder.Undef(defVariable->getType());
+            } else {
+                ExprPtr pointer = ep.getAsOperand(gv);
+                globalValue = this->handleGlobalInitializer(globalInit, pointer, ep);
+            }
+
             if (!ep.tryToEliminate(&def, defVariable, globalValue)) {
                 ep.insertAssignment(defVariable, globalValue);
             }
@@ -574,17 +742,24 @@ void FlatMemoryModelInstTranslator::handleStore(
     const llvm::StoreInst& store,
     llvm2cfa::GenerationStepExtensionPoint& ep)
 {
-    MemoryObjectDef* memoryDef = mMemorySSA.getUniqueDefinitionFor(&store, mInfo.memory);
+    MemoryObject* object = mInfo.getObject(mMemoryModel.getLocationFor(store.getPointerOperand()));
+    MemoryObjectDef* memoryDef = mMemorySSA.getUniqueDefinitionFor(&store, object);
     assert(memoryDef != nullptr && "There must be exactly one definition for Memory on a store!");
 
-    unsigned size = mDataLayout.getTypeAllocSize(store.getValueOperand()->getType());
-
-    ExprPtr array = ep.getAsOperand(memoryDef->getReachingDef());
+    Variable* defVariable = ep.getVariableFor(memoryDef);
     ExprPtr value = ep.getAsOperand(store.getValueOperand());
-    ExprPtr pointer = ep.getAsOperand(store.getPointerOperand());
 
-    Variable* defVariable = ep.getVariableFor(memoryDef);
-    ExprPtr write = this->buildMemoryWrite(array, value, pointer, size);
+    ExprPtr write;
+    if (object->getObjectType() == MemoryObjectType::Scalar) {
+        // Scalar globals are only accessed directly, the stored value is the new definition.
+        write = value;
+    } else {
+        unsigned size = mDataLayout.getTypeAllocSize(store.getValueOperand()->getType());
+
+        ExprPtr array = ep.getAsOperand(memoryDef->getReachingDef());
+        ExprPtr pointer = ep.getAsOperand(store.getPointerOperand());
+        write = this->buildMemoryWrite(array, value, pointer, size);
+    }
 
     if (!ep.tryToEliminate(memoryDef, defVariable, write)) {
         ep.insertAssignment(defVariable, write);
@@ -595,10 +770,14 @@ ExprPtr FlatMemoryModelInstTranslator::handleLoad(
     const llvm::LoadInst& load,
     llvm2cfa::GenerationStepExtensionPoint& ep)
 {
-    MemoryObjectUse* use = mMemorySSA.getUniqueUseFor(&load, mInfo.memory);
+    MemoryObject* object = mInfo.getObject(mMemoryModel.getLocationFor(load.getPointerOperand()));
+    MemoryObjectUse* use = mMemorySSA.getUniqueUseFor(&load, object);
     assert(use != nullptr && "Each load must have a valid use for Memory!");
 
     MemoryObjectDef* def = use->getReachingDef();
+    if (object->getObjectType() == MemoryObjectType::Scalar) {
+        return ep.getAsOperand(def);
+    }
 
     Type& loadTy = mTypes.get(load.getType());
     ExprPtr array = ep.getAsOperand(def);
@@ -622,32 +801,47 @@ void FlatMemoryModelInstTranslator::handleCall(
     assert(callee != nullptr);
 
     auto& calleeInfo = mMemoryModel.getInfoFor(callee);
-    auto& callInstInfo = mInfo.calls[call];
+    auto callIt = mInfo.calls.find(call);
+    assert(callIt != mInfo.calls.end() && "Translated calls must have memory annotations!");
+    auto& callInstInfo = callIt->second;
 
-    // Map the memory call definition to its return use.
-    // We only define memory, as the stack pointer should be back to its
+    // Map the stack pointer and frame pointer to the inputs.
+    // We do not define them, as the stack pointer should be back to its
     // "original" position when the call returns.
-    MemoryObjectUse* use = calleeInfo.memory->getExitUse();
-    if (use != nullptr) {
-        // It is possible that the return use is ommited if the function
-        // does not return.
-        outputAssignments.emplace_back(
-            parentEp.getVariableFor(callInstInfo.defs[mInfo.memory]),
-            calleeEp.getOutputVariableFor(use->getReachingDef())->getRefExpr()
-        );
-    }
-
-    // Map the memory, stack pointer and frame pointer to the inputs.
-    for (auto [actual, formal] : std::initializer_list<std::pair<MemoryObject*, MemoryObject*>>{ 
-        { mInfo.memory, calleeInfo.memory },
+    for (auto [actual, formal] : std::initializer_list<std::pair<MemoryObject*, MemoryObject*>>{
         { mInfo.stackPointer, calleeInfo.stackPointer },
         { mInfo.framePointer, calleeInfo.framePointer }})
     {
         inputAssignments.emplace_back(
             calleeEp.getInputVariableFor(formal->getEntryDef()),
-            parentEp.getAsOperand(callInstInfo.uses[actual]->getReachingDef())
+            parentEp.getAsOperand(callInstInfo.uses.lookup(actual)->getReachingDef())
         );
     }
+
+    // Memory locations are passed in and out of the callee based on its mod/ref information.
+    for (auto& [loc, object] : mInfo.objects) {
+        auto useIt = callInstInfo.uses.find(object);
+        if (useIt == callInstInfo.uses.end()) {
+            continue;
+        }
+
+        MemoryObject* formal = calleeInfo.getObject(loc);
+        inputAssignments.emplace_back(
+            calleeEp.getInputVariableFor(formal->getEntryDef()),
+            parentEp.getAsOperand(useIt->second->getReachingDef())
+        );
+
+        // It is possible that the return use is ommited if the function
+        // does not return.
+        auto defIt = callInstInfo.defs.find(object);
+        MemoryObjectUse* exitUse = formal->getExitUse();
+        if (defIt != callInstInfo.defs.end() && exitUse != nullptr) {
+            outputAssignments.emplace_back(
+                parentEp.getVariableFor(defIt->second),
+                calleeEp.getOutputVariableFor(exitUse->getReachingDef())->getRefExpr()
+            );
+        }
+    }
 }
 
 ExprPtr FlatMemoryModelInstTranslator::isValidAccess(llvm::Value* ptr, const ExprPtr& expr)
@@ -655,6 +849,21 @@ ExprPtr FlatMemoryModelInstTranslator::isValidAccess(llvm::Value* ptr, const Exp
     return mExprBuilder.True();
 }
 
+auto FlatMemoryModelInstTranslator::getMemoryObjectType(MemoryObject* object) -> gazer::Type&
+{
+    // The memory objects are shared between the instances of the model, so their
+    // types are determined here instead of setting context-dependent type hints.
+    if (object == mInfo.stackPointer || object == mInfo.framePointer) {
+        return mMemoryModel.ptrType();
+    }
+
+    if (object->getObjectType() == MemoryObjectType::Scalar) {
+        return mTypes.get(object->getValueType());
+    }
+
+    return mMemoryModel.memoryArrayType();
+}
+
 auto FlatMemoryModelInstTranslator::handleGlobalInitializer(
     memory::GlobalInitializerDef* def,
     const ExprPtr& pointer,
@@ -788,7 +997,7 @@ auto FlatMemoryModel::getMemoryInstructionHandler(llvm::Function& function)
     if (it == mTranslators.end()) {
         it = mTranslators.try_emplace(&function,
             std::make_unique<FlatMemoryModelInstTranslator>(
-                *this, mFunctions[&function], *mExprBuilder, mTypes, mDataLayout
+                *this, this->getInfoFor(&function), *mExprBuilder, mTypes, mDataLayout
             )).first;
     }
 
@@ -45,6 +45,10 @@ public:
         return *this;
     }
 
+    std::unique_ptr<MemoryModel> cloneInContext(GazerContext& context) override {
+        return std::make_unique<HavocMemoryModel>(context);
+    }
+
     gazer::Type& handlePointerType(const llvm::PointerType* type) override {
         return this->ptrType();
     }
@@ -20,29 +20,10 @@
 #include "gazer/LLVM/Memory/MemoryObject.h"
 
 #include <llvm/Analysis/LoopInfo.h>
+#include <llvm/ADT/SmallPtrSet.h>
 
 using namespace gazer;
 
-static bool hasUsesOutsideOfBlockRange(
-    const MemoryObjectDef* def, llvm::ArrayRef<llvm::BasicBlock*> blocks)
-{
-    // Currently the memory object interface does not support querying the uses of a particular def.
-    // What we do instead is we query all uses of the underlying abstract memory object, and check
-    // whether their reaching definition is 'def'.
-    for (MemoryObjectUse& use : def->getObject()->uses()) {
-        if (use.getReachingDef() != def) {
-            continue;
-        }
-
-        llvm::BasicBlock* bb = use.getInstruction()->getParent();
-        if (std::find(blocks.begin(), blocks.end(), bb) == blocks.end()) {
-            return true;
-        }
-    }
-
-    return false;
-}
-
 void MemorySSABasedInstructionHandler::declareFunctionVariables(
     llvm2cfa::VariableDeclExtensionPoint& ep)
 {
@@ -77,13 +58,25 @@ void MemorySSABasedInstructionHandler::declareFunctionVariables(
 void MemorySSABasedInstructionHandler::declareLoopProcedureVariables(
     llvm::Loop* loop, llvm2cfa::LoopVarDeclExtensionPoint& ep)
 {
-    llvm::ArrayRef<llvm::BasicBlock*> loopBlocks = loop->getBlocks();
-
     for (MemoryObject& object : mMemorySSA.objects()) {
+        // The memory object interface does not support querying the uses of a particular def,
+        // thus we collect the loop definitions used outside of the loop in a single pass over
+        // the uses of the object.
+        llvm::SmallPtrSet<MemoryObjectDef*, 4> usedOutside;
+        for (MemoryObjectUse& use : object.uses()) {
+            MemoryObjectDef* def = use.getReachingDef();
+            if (
+                !loop->contains(use.getParentBlock())
+                && def != nullptr && loop->contains(def->getParentBlock())
+            ) {
+                usedOutside.insert(def);
+            }
+        }
+
         for (MemoryObjectDef& def : object.defs()) {
             llvm::BasicBlock* bb = def.getParentBlock();
 
-            if (llvm::find(loopBlocks, bb) == loopBlocks.end()) {
+            if (!loop->contains(bb)) {
                 continue;
             }
 
@@ -95,14 +88,14 @@ void MemorySSABasedInstructionHandler::declareLoopProcedureVariables(
             }
 
             // If the definition has uses outside of the loop it should be marked as output
-            if (hasUsesOutsideOfBlockRange(&def, loopBlocks)) {
+            if (usedOutside.count(&def) != 0) {
                 ep.createLoopOutput(&def, memVar);
             }
         }
 
         for (MemoryObjectUse& use : object.uses()) {
             // If we have a use within a loop and its reaching def outside of the loop, it is an input
-            if (llvm::find(loopBlocks, use.getParentBlock()) == loopBlocks.end()) {
+            if (!loop->contains(use.getParentBlock())) {
                 continue;
             }
 
@@ -113,7 +106,7 @@ void MemorySSABasedInstructionHandler::declareLoopProcedureVariables(
             }
 
             llvm::BasicBlock* bb = def->getParentBlock();
-            if (!llvm::isa<memory::PhiDef>(def) && llvm::find(loopBlocks, bb) == loopBlocks.end()) {
+            if (!llvm::isa<memory::PhiDef>(def) && !loop->contains(bb)) {
                 ep.createInput(def, this->getMemoryObjectType(use.getObject()));
             }
         }
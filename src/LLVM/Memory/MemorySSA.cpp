@@ -30,7 +30,10 @@ using gazer::memory::MemorySSABuilderPass;
 
 auto MemorySSA::definitionAnnotationsFor(const llvm::Value* value) -> llvm::iterator_range<def_iterator>
 {
-    auto& range = mValueDefs[value];
+    static ValueToDefSetMap::mapped_type EmptyDefs;
+
+    auto it = mValueDefs.find(value);
+    auto& range = it != mValueDefs.end() ? it->second : EmptyDefs;
     def_iterator begin = boost::make_indirect_iterator(range.begin());
     def_iterator end = boost::make_indirect_iterator(range.end());
 
@@ -39,7 +42,10 @@ auto MemorySSA::definitionAnnotationsFor(const llvm::Value* value) -> llvm::iter
 
 auto MemorySSA::useAnnotationsFor(const llvm::Value* value) -> llvm::iterator_range<use_iterator>
 {
-    auto& range = mValueUses[value];
+    static ValueToUseSetMap::mapped_type EmptyUses;
+
+    auto it = mValueUses.find(value);
+    auto& range = it != mValueUses.end() ? it->second : EmptyUses;
     use_iterator begin = boost::make_indirect_iterator(range.begin());
     use_iterator end = boost::make_indirect_iterator(range.end());
 
@@ -49,41 +55,13 @@ auto MemorySSA::useAnnotationsFor(const llvm::Value* value) -> llvm::iterator_ra
 auto MemorySSA::getUniqueDefinitionFor(const llvm::Value* value, const MemoryObject* object)
     -> MemoryObjectDef*
 {
-    auto range = this->definitionAnnotationsFor(value);
-    MemoryObjectDef* result = nullptr;
-
-    for (MemoryObjectDef& def : range) {
-        if (def.getObject() == object) {
-            if (result != nullptr) {
-                // We have already found a proper object, thus there is no unique definition.
-                return nullptr;
-            }
-
-            result = &def;
-        }
-    }
-
-    return result;
+    return mUniqueDefs.lookup({value, object});
 }
 
 auto MemorySSA::getUniqueUseFor(const llvm::Value* value, const MemoryObject* object)
     -> MemoryObjectUse*
 {
-    auto range = this->useAnnotationsFor(value);
-    MemoryObjectUse* result = nullptr;
-
-    for (MemoryObjectUse& use : range) {
-        if (use.getObject() == object) {
-            if (result != nullptr) {
-                // We have already found a proper object, thus there is no unique definition.
-                return nullptr;
-            }
-
-            result = &use;
-        }
-    }
-
-    return result;
+    return mUniqueUses.lookup({value, object});
 }
 
 // Pass implementation
@@ -131,6 +109,28 @@ MemoryObject* MemorySSABuilder::createMemoryObject(
     return &*ptr;
 }
 
+void MemorySSABuilder::addDefAnnotation(const llvm::Value* value, MemoryObjectDef* def)
+{
+    mValueDefs[value].push_back(def);
+
+    // If there are multiple definitions for the same object, there is no unique definition.
+    auto [it, inserted] = mUniqueDefs.try_emplace({value, def->getObject()}, def);
+    if (!inserted) {
+        it->second = nullptr;
+    }
+}
+
+void MemorySSABuilder::addUseAnnotation(const llvm::Value* value, MemoryObjectUse* use)
+{
+    mValueUses[value].push_back(use);
+    mObjectInfo[use->getObject()].useBlocks.insert(use->getParentBlock());
+
+    auto [it, inserted] = mUniqueUses.try_emplace({value, use->getObject()}, use);
+    if (!inserted) {
+        it->second = nullptr;
+    }
+}
+
 memory::LiveOnEntryDef* MemorySSABuilder::createLiveOnEntryDef(gazer::MemoryObject* object)
 {
     assert(!object->hasEntryDef() && "Attempting to insert two entry definitions for a single object!");
@@ -139,8 +139,7 @@ memory::LiveOnEntryDef* MemorySSABuilder::createLiveOnEntryDef(gazer::MemoryObje
     auto def = new memory::LiveOnEntryDef(object, mVersionNumber++, entryBlock);
     mObjectInfo[object].defBlocks.insert(entryBlock);
 
-    mValueDefs[&mFunction.getEntryBlock()].emplace_back(def);
-
+    this->addDefAnnotation(entryBlock, def);
 
     object->addDefinition(def);
     object->setEntryDef(def);
@@ -155,8 +154,8 @@ memory::GlobalInitializerDef* MemorySSABuilder::createGlobalInitializerDef(
     auto def = new memory::GlobalInitializerDef(object, mVersionNumber++, entryBlock, gv);
     mObjectInfo[object].defBlocks.insert(entryBlock);
 
-    mValueDefs[&mFunction.getEntryBlock()].emplace_back(def);
-    
+    this->addDefAnnotation(entryBlock, def);
+
     object->addDefinition(def);
 
     return def;
@@ -166,7 +165,7 @@ memory::StoreDef* MemorySSABuilder::createStoreDef(MemoryObject* object, llvm::S
 {
     auto def = new memory::StoreDef(object, mVersionNumber++, inst);
     mObjectInfo[object].defBlocks.insert(inst.getParent());
-    mValueDefs[&inst].push_back(def);
+    this->addDefAnnotation(&inst, def);
     object->addDefinition(def);
 
     return def;
@@ -176,7 +175,7 @@ memory::CallDef* MemorySSABuilder::createCallDef(gazer::MemoryObject* object, ll
 {
     auto def = new memory::CallDef(object, mVersionNumber++, call);
     mObjectInfo[object].defBlocks.insert(call.getInstruction()->getParent());
-    mValueDefs[call.getInstruction()].push_back(def);
+    this->addDefAnnotation(call.getInstruction(), def);
     object->addDefinition(def);
 
     return def;
@@ -188,7 +187,7 @@ memory::AllocaDef* MemorySSABuilder::createAllocaDef(
 {
     auto def = new memory::AllocaDef(object, mVersionNumber++, alloca);
     mObjectInfo[object].defBlocks.insert(alloca.getParent());
-    mValueDefs[&alloca].push_back(def);
+    this->addDefAnnotation(&alloca, def);
     object->addDefinition(def);
 
     return def;
@@ -197,7 +196,7 @@ memory::AllocaDef* MemorySSABuilder::createAllocaDef(
 memory::LoadUse* MemorySSABuilder::createLoadUse(MemoryObject* object, llvm::LoadInst& load)
 {
     auto use = new memory::LoadUse(object, load);
-    mValueUses[&load].push_back(use);
+    this->addUseAnnotation(&load, use);
     object->addUse(use);
 
     return use;
@@ -206,7 +205,7 @@ memory::LoadUse* MemorySSABuilder::createLoadUse(MemoryObject* object, llvm::Loa
 memory::CallUse* MemorySSABuilder::createCallUse(MemoryObject* object, llvm::CallSite call)
 {
     auto use = new memory::CallUse(object, call);
-    mValueUses[call.getInstruction()].push_back(use);
+    this->addUseAnnotation(call.getInstruction(), use);
     object->addUse(use);
 
     return use;
@@ -216,7 +215,7 @@ memory::RetUse* MemorySSABuilder::createReturnUse(MemoryObject* object, llvm::Re
 {
     assert(!object->hasExitUse() && "Attempting to add a duplicate exit use!");
     auto use = new memory::RetUse(object, ret);
-    mValueUses[&ret].push_back(use);
+    this->addUseAnnotation(&ret, use);
     object->addUse(use);
     object->setExitUse(use);
 
@@ -229,92 +228,183 @@ auto MemorySSABuilder::build() -> std::unique_ptr<MemorySSA>
     this->renamePass();
 
     return std::unique_ptr<MemorySSA>(new MemorySSA(
-        mFunction, std::move(mObjectStorage), std::move(mValueDefs), std::move(mValueUses)
+        mFunction, std::move(mObjectStorage), std::move(mValueDefs), std::move(mValueUses),
+        std::move(mUniqueDefs), std::move(mUniqueUses)
     ));
 }
 
 void MemorySSABuilder::calculatePHINodes()
 {
+    llvm::ForwardIDFCalculator idf(mDominatorTree);
+    llvm::SmallVector<llvm::BasicBlock*, 32> phiBlocks;
+    llvm::SmallPtrSet<llvm::BasicBlock*, 32> liveInBlocks;
+
     for (auto& object : mObjectStorage) {
-        llvm::ForwardIDFCalculator idf(mDominatorTree);
-        idf.setDefiningBlocks(mObjectInfo[&*object].defBlocks);
+        auto& info = mObjectInfo[&*object];
+
+        // Only place PHI nodes into blocks where the object is live,
+        // otherwise they would have no uses.
+        liveInBlocks.clear();
+        this->calculateLiveInBlocks(&*object, info, liveInBlocks);
 
-        llvm::SmallVector<llvm::BasicBlock*, 32> phiBlocks;
+        idf.setDefiningBlocks(info.defBlocks);
+        idf.setLiveInBlocks(liveInBlocks);
+
+        phiBlocks.clear();
         idf.calculate(phiBlocks);
 
         for (llvm::BasicBlock* bb : phiBlocks) {
             auto phi = new memory::PhiDef(&*object, mVersionNumber++, bb);
             object->addDefinition(phi);
-            mValueDefs[bb].push_back(phi);
+            this->addDefAnnotation(bb, phi);
         }
     }
 }
 
-void MemorySSABuilder::renamePass()
+void MemorySSABuilder::calculateLiveInBlocks(
+    MemoryObject* object,
+    MemoryObjectInfo& info,
+    llvm::SmallPtrSetImpl<llvm::BasicBlock*>& liveInBlocks)
 {
-    llvm::DomTreeNode* root = mDominatorTree.getRootNode();
-    renameBlock(root->getBlock());
+    llvm::SmallVector<llvm::BasicBlock*, 32> worklist;
+
+    for (llvm::BasicBlock* bb : info.useBlocks) {
+        if (info.defBlocks.count(bb) == 0) {
+            worklist.push_back(bb);
+            continue;
+        }
+
+        // The block defines the object as well: it is only live-in if it
+        // has a use before the first definition. Block-level annotations
+        // precede all instructions.
+        if (mUniqueDefs.count({bb, object}) != 0) {
+            continue;
+        }
+
+        for (llvm::Instruction& inst : *bb) {
+            if (mUniqueUses.count({&inst, object}) != 0) {
+                worklist.push_back(bb);
+                break;
+            }
+
+            if (mUniqueDefs.count({&inst, object}) != 0) {
+                break;
+            }
+        }
+    }
+
+    // Propagate liveness backwards until reaching the defining blocks.
+    while (!worklist.empty()) {
+        llvm::BasicBlock* bb = worklist.pop_back_val();
+        if (!liveInBlocks.insert(bb).second) {
+            continue;
+        }
+
+        for (llvm::BasicBlock* pred : llvm::predecessors(bb)) {
+            if (info.defBlocks.count(pred) == 0) {
+                worklist.push_back(pred);
+            }
+        }
+    }
 }
 
-void MemorySSABuilder::renameBlock(llvm::BasicBlock* block)
+void MemorySSABuilder::renamePass()
 {
-    llvm::SmallDenseMap<MemoryObject*, unsigned, 4> defsInThisBlock;
+    // Walk the dominator tree in pre-order with an explicit stack, as deep
+    // dominator trees could overflow the call stack. Each entry records the
+    // objects pushed onto the rename stacks by its block, which are popped
+    // when all of its dominated blocks were visited.
+    struct StackEntry
+    {
+        llvm::DomTreeNode* node;
+        llvm::DomTreeNode::iterator nextChild;
+        llvm::SmallVector<MemoryObject*, 8> pushed;
+    };
+
+    llvm::SmallVector<StackEntry, 32> stack;
+
+    auto visit = [this, &stack](llvm::DomTreeNode* node) {
+        StackEntry& entry = stack.emplace_back();
+        entry.node = node;
+        entry.nextChild = node->begin();
+        this->renameBlock(node->getBlock(), entry.pushed);
+    };
+
+    visit(mDominatorTree.getRootNode());
+
+    while (!stack.empty()) {
+        StackEntry& entry = stack.back();
+        if (entry.nextChild != entry.node->end()) {
+            llvm::DomTreeNode* child = *entry.nextChild;
+            ++entry.nextChild;
+            visit(child);
+            continue;
+        }
 
-    // Handle all block-level annotations first
-    for (auto& def : mValueDefs[block]) {
-        MemoryObject* object = def->getObject();
+        // Unwind the stacks
+        for (MemoryObject* object : entry.pushed) {
+            mObjectInfo[object].renameStack.pop_back();
+        }
+
+        stack.pop_back();
+    }
+}
+
+void MemorySSABuilder::renameBlock(
+    llvm::BasicBlock* block, llvm::SmallVectorImpl<MemoryObject*>& pushed)
+{
+    auto pushDefinition = [this, &pushed](MemoryObjectDef* def) {
+        auto& info = mObjectInfo[def->getObject()];
 
-        MemoryObjectDef* reachingDef = mObjectInfo[object].getCurrentTopDefinition();
-        if (reachingDef != nullptr) {
+        // Set the previously reaching definition for this access
+        if (MemoryObjectDef* reachingDef = info.getCurrentTopDefinition()) {
             def->setReachingDef(reachingDef);
         }
 
-        mObjectInfo[object].renameStack.push_back(&*def);
-        defsInThisBlock[object]++;
+        // Push the new definition to the top of the renaming stack
+        info.renameStack.push_back(def);
+        pushed.push_back(def->getObject());
+    };
+
+    // Handle all block-level annotations first
+    auto blockDefs = mValueDefs.find(block);
+    if (blockDefs != mValueDefs.end()) {
+        for (MemoryObjectDef* def : blockDefs->second) {
+            pushDefinition(def);
+        }
     }
 
     // Handle each instruction in this block
     for (llvm::Instruction& inst : *block) {
-        for (auto& use : mValueUses[&inst]) {
-            MemoryObject* object = use->getObject();
-            MemoryObjectDef* reachingDef = mObjectInfo[object].getCurrentTopDefinition();
-            use->setReachingDef(reachingDef);
+        auto uses = mValueUses.find(&inst);
+        if (uses != mValueUses.end()) {
+            for (MemoryObjectUse* use : uses->second) {
+                use->setReachingDef(mObjectInfo[use->getObject()].getCurrentTopDefinition());
+            }
         }
 
-        for (auto& def : mValueDefs[&inst]) {
-            MemoryObject* object = def->getObject();
-
-            // Set the previously reaching definition for this access
-            MemoryObjectDef* reachingDef = mObjectInfo[object].getCurrentTopDefinition();
-            def->setReachingDef(reachingDef);
-
-            // Push the new definition to the top of the renaming stack
-            mObjectInfo[object].renameStack.push_back(&*def);
-            defsInThisBlock[object]++;
+        auto defs = mValueDefs.find(&inst);
+        if (defs != mValueDefs.end()) {
+            for (MemoryObjectDef* def : defs->second) {
+                pushDefinition(def);
+            }
         }
     }
 
     // Handle successor PHIs
     for (llvm::BasicBlock* child : llvm::successors(block)) {
-        for (auto& def : mValueDefs[child]) {
-            if (auto phi = llvm::dyn_cast<memory::PhiDef>(&*def)) {
+        auto childDefs = mValueDefs.find(child);
+        if (childDefs == mValueDefs.end()) {
+            continue;
+        }
+
+        for (MemoryObjectDef* def : childDefs->second) {
+            if (auto phi = llvm::dyn_cast<memory::PhiDef>(def)) {
                 MemoryObject* object = phi->getObject();
                 phi->addIncoming(mObjectInfo[object].getCurrentTopDefinition(), block);
             }
         }
     }
-
-    // Handle successors
-    for (llvm::DomTreeNode* child : mDominatorTree.getNode(block)->getChildren()) {
-        renameBlock(child->getBlock());
-    }
-
-    // Finally, unwind the stacks
-    for (auto& pair : defsInThisBlock) {
-        MemoryObject* object = pair.first;
-        auto& stack = mObjectInfo[object].renameStack;
-        stack.resize(stack.size() - pair.second);
-    }
 }
 
 // Printing
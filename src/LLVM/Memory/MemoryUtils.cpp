@@ -19,6 +19,8 @@
 
 #include <llvm/IR/GlobalVariable.h>
 #include <llvm/IR/Instructions.h>
+#include <llvm/IR/Operator.h>
+#include <llvm/ADT/SmallVector.h>
 
 using namespace gazer;
 
@@ -47,3 +49,52 @@ bool gazer::memory::isGlobalUsedAsPointer(llvm::GlobalVariable& gv)
 
     return false;
 }
+
+bool gazer::memory::isGlobalAddressEscaping(llvm::GlobalVariable& gv)
+{
+    llvm::SmallVector<const llvm::Value*, 8> wl;
+    wl.push_back(&gv);
+
+    while (!wl.empty()) {
+        const llvm::Value* ptr = wl.pop_back_val();
+
+        for (const llvm::Use& use : ptr->uses()) {
+            const llvm::User* user = use.getUser();
+
+            if (auto store = llvm::dyn_cast<llvm::StoreInst>(user)) {
+                if (store->getValueOperand() == ptr || store->isVolatile()) {
+                    return true;
+                }
+            } else if (auto load = llvm::dyn_cast<llvm::LoadInst>(user)) {
+                if (load->isVolatile()) {
+                    return true;
+                }
+            } else if (llvm::isa<llvm::GEPOperator>(user) || llvm::isa<llvm::BitCastOperator>(user)) {
+                // Derived addresses must also stay within loads and stores.
+                if (use.getOperandNo() != 0) {
+                    return true;
+                }
+                wl.push_back(user);
+            } else {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+llvm::GlobalVariable* gazer::memory::getBaseGlobalVariable(const llvm::Value* ptr)
+{
+    while (true) {
+        if (auto gep = llvm::dyn_cast<llvm::GEPOperator>(ptr)) {
+            ptr = gep->getPointerOperand();
+        } else if (auto bitcast = llvm::dyn_cast<llvm::BitCastOperator>(ptr)) {
+            ptr = bitcast->getOperand(0);
+        } else {
+            break;
+        }
+    }
+
+    return const_cast<llvm::GlobalVariable*>(llvm::dyn_cast<llvm::GlobalVariable>(ptr));
+}
@@ -0,0 +1,125 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+#include "gazer/LLVM/Memory/ModRefAnalysis.h"
+
+#include <llvm/Analysis/CallGraph.h>
+#include <llvm/ADT/SCCIterator.h>
+#include <llvm/ADT/SmallPtrSet.h>
+#include <llvm/IR/InstIterator.h>
+#include <llvm/IR/Instructions.h>
+
+using namespace gazer;
+using namespace gazer::memory;
+
+ModRefAnalysis::ModRefAnalysis(
+    llvm::CallGraph& cg, unsigned numLocations, LocationFuncTy locationOf
+) : mNumLocations(numLocations), mLocationOf(std::move(locationOf))
+{
+    // The SCC iterator visits the components in post-order, thus the
+    // summaries of all callees outside the current component are ready.
+    for (auto it = llvm::scc_begin(&cg), ie = llvm::scc_end(&cg); it != ie; ++it) {
+        this->summarizeComponent(*it);
+    }
+
+    // Internal functions without callers are not reachable from the external
+    // calling node, start a new traversal from each of them. Components which
+    // were already summarized by a previous traversal are skipped.
+    for (llvm::Function& function : cg.getModule()) {
+        if (function.isDeclaration() || mSummaries.count(&function) != 0) {
+            continue;
+        }
+
+        llvm::CallGraphNode* root = cg[&function];
+        for (auto it = llvm::scc_begin(root), ie = llvm::scc_end(root); it != ie; ++it) {
+            this->summarizeComponent(*it);
+        }
+    }
+}
+
+void ModRefAnalysis::summarizeComponent(const std::vector<llvm::CallGraphNode*>& scc)
+{
+    llvm::SmallPtrSet<const llvm::Function*, 4> members;
+    for (llvm::CallGraphNode* node : scc) {
+        llvm::Function* function = node->getFunction();
+        if (function != nullptr && !function->isDeclaration() && mSummaries.count(function) == 0) {
+            members.insert(function);
+        }
+    }
+
+    if (members.empty()) {
+        return;
+    }
+
+    // The functions of a component may call each other, so they all
+    // share the union of their effects.
+    ModRefSummary sccSummary;
+    sccSummary.mod.resize(mNumLocations);
+    sccSummary.ref.resize(mNumLocations);
+
+    for (llvm::CallGraphNode* node : scc) {
+        llvm::Function* function = node->getFunction();
+        if (members.count(function) == 0) {
+            continue;
+        }
+
+        ModRefSummary& summary = mSummaries[function];
+        this->calculateLocalEffects(*function, summary);
+        sccSummary.mod |= summary.mod;
+        sccSummary.ref |= summary.ref;
+
+        for (auto& [call, calleeNode] : *node) {
+            llvm::Function* callee = calleeNode->getFunction();
+            if (callee == nullptr || callee->isDeclaration() || members.count(callee) != 0) {
+                continue;
+            }
+
+            const ModRefSummary& calleeSummary = mSummaries[callee];
+            sccSummary.mod |= calleeSummary.mod;
+            sccSummary.ref |= calleeSummary.ref;
+        }
+    }
+
+    for (const llvm::Function* function : members) {
+        ModRefSummary& summary = mSummaries[function];
+        summary.mod = sccSummary.mod;
+        summary.ref = sccSummary.ref;
+    }
+}
+
+void ModRefAnalysis::calculateLocalEffects(llvm::Function& function, ModRefSummary& summary)
+{
+    summary.mod.resize(mNumLocations);
+    summary.ref.resize(mNumLocations);
+    summary.local.resize(mNumLocations);
+
+    for (llvm::Instruction& inst : llvm::instructions(function)) {
+        if (auto store = llvm::dyn_cast<llvm::StoreInst>(&inst)) {
+            summary.mod.set(mLocationOf(store->getPointerOperand()));
+        } else if (auto load = llvm::dyn_cast<llvm::LoadInst>(&inst)) {
+            summary.ref.set(mLocationOf(load->getPointerOperand()));
+        } else if (auto alloca = llvm::dyn_cast<llvm::AllocaInst>(&inst)) {
+            summary.local.set(mLocationOf(alloca));
+        } else if (auto call = llvm::dyn_cast<llvm::CallInst>(&inst)) {
+            if (call->getCalledFunction() == nullptr) {
+                // Indirect calls may access any memory location.
+                summary.mod.set();
+                summary.ref.set();
+            }
+        }
+    }
+}
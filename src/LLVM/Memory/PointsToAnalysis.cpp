@@ -0,0 +1,462 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+#include "gazer/LLVM/Memory/PointsToAnalysis.h"
+
+#include <llvm/IR/Module.h>
+#include <llvm/IR/Instructions.h>
+#include <llvm/IR/IntrinsicInst.h>
+#include <llvm/IR/InstIterator.h>
+#include <llvm/IR/CallSite.h>
+#include <llvm/IR/Operator.h>
+#include <llvm/ADT/SmallVector.h>
+#include <llvm/Support/raw_ostream.h>
+
+using namespace gazer;
+using namespace gazer::memory;
+
+PointsToAnalysis::PointsToAnalysis(llvm::Module& module)
+    : mPointerSizeInBits(module.getDataLayout().getPointerSizeInBits())
+{
+    // The unknown memory may contain pointers to itself.
+    mUnknown = this->createNode();
+    mNodes[mUnknown].pointee = mUnknown;
+
+    for (llvm::GlobalVariable& gv : module.globals()) {
+        unsigned object = this->deref(this->getNode(&gv));
+        if (gv.hasInitializer()) {
+            this->visitGlobalInitializer(object, gv.getInitializer());
+        }
+    }
+
+    for (llvm::Function& function : module) {
+        if (function.isDeclaration()) {
+            continue;
+        }
+
+        // Functions which may be called indirectly may receive any pointer.
+        if (function.hasAddressTaken()) {
+            for (llvm::Argument& arg : function.args()) {
+                if (arg.getType()->isPointerTy()) {
+                    this->pointsToUnknown(this->getNode(&arg));
+                }
+            }
+
+            if (function.getReturnType()->isPointerTy()) {
+                this->pointsToUnknown(this->getReturnNode(&function));
+            }
+        }
+
+        for (llvm::Instruction& inst : llvm::instructions(function)) {
+            this->visitInstruction(inst);
+        }
+    }
+
+    this->calculateRegions(module);
+}
+
+// Union-find operations
+//==------------------------------------------------------------------------==//
+
+unsigned PointsToAnalysis::createNode()
+{
+    unsigned idx = mNodes.size();
+    mNodes.emplace_back(idx);
+
+    return idx;
+}
+
+unsigned PointsToAnalysis::find(unsigned node)
+{
+    unsigned root = node;
+    while (mNodes[root].parent != root) {
+        root = mNodes[root].parent;
+    }
+
+    // Compress the path to the root.
+    while (mNodes[node].parent != root) {
+        unsigned next = mNodes[node].parent;
+        mNodes[node].parent = root;
+        node = next;
+    }
+
+    return root;
+}
+
+void PointsToAnalysis::unify(unsigned lhs, unsigned rhs)
+{
+    // Merging two classes also merges their pointees, which we handle
+    // with a worklist to avoid deep recursion on long pointer chains.
+    llvm::SmallVector<std::pair<unsigned, unsigned>, 4> wl;
+    wl.emplace_back(lhs, rhs);
+
+    while (!wl.empty()) {
+        auto [first, second] = wl.pop_back_val();
+        unsigned a = this->find(first);
+        unsigned b = this->find(second);
+
+        if (a == b) {
+            continue;
+        }
+
+        if (mNodes[a].rank < mNodes[b].rank) {
+            std::swap(a, b);
+        }
+
+        mNodes[b].parent = a;
+        if (mNodes[a].rank == mNodes[b].rank) {
+            mNodes[a].rank += 1;
+        }
+
+        unsigned pa = mNodes[a].pointee;
+        unsigned pb = mNodes[b].pointee;
+        if (pa == InvalidNode) {
+            mNodes[a].pointee = pb;
+        } else if (pb != InvalidNode) {
+            wl.emplace_back(pa, pb);
+        }
+    }
+}
+
+unsigned PointsToAnalysis::deref(unsigned node)
+{
+    unsigned root = this->find(node);
+    if (mNodes[root].pointee == InvalidNode) {
+        unsigned pointee = this->createNode();
+        mNodes[root].pointee = pointee;
+        return pointee;
+    }
+
+    return this->find(mNodes[root].pointee);
+}
+
+// Constraint generation
+//==------------------------------------------------------------------------==//
+
+unsigned PointsToAnalysis::getNode(const llvm::Value* value)
+{
+    auto it = mValueNodes.find(value);
+    if (it != mValueNodes.end()) {
+        return it->second;
+    }
+
+    if (auto constant = llvm::dyn_cast<llvm::Constant>(value)) {
+        if (!llvm::isa<llvm::GlobalValue>(constant)) {
+            return this->createConstantNode(constant);
+        }
+    }
+
+    unsigned node = this->createNode();
+    mValueNodes[value] = node;
+
+    return node;
+}
+
+unsigned PointsToAnalysis::getReturnNode(const llvm::Function* function)
+{
+    auto it = mReturnNodes.find(function);
+    if (it != mReturnNodes.end()) {
+        return it->second;
+    }
+
+    unsigned node = this->createNode();
+    mReturnNodes[function] = node;
+
+    return node;
+}
+
+unsigned PointsToAnalysis::createConstantNode(const llvm::Constant* constant)
+{
+    unsigned node = this->createNode();
+    mValueNodes[constant] = node;
+
+    if (auto expr = llvm::dyn_cast<llvm::ConstantExpr>(constant)) {
+        switch (expr->getOpcode()) {
+            case llvm::Instruction::GetElementPtr:
+            case llvm::Instruction::BitCast:
+            case llvm::Instruction::AddrSpaceCast:
+                this->unify(node, this->getNode(expr->getOperand(0)));
+                break;
+            case llvm::Instruction::PtrToInt:
+                this->pointsToUnknown(this->getNode(expr->getOperand(0)));
+                break;
+            default:
+                if (expr->getType()->isPointerTy()) {
+                    this->pointsToUnknown(node);
+                }
+                break;
+        }
+    }
+
+    return node;
+}
+
+bool PointsToAnalysis::mayHoldPointer(const llvm::Type* type) const
+{
+    return type->isIntegerTy() && type->getIntegerBitWidth() >= mPointerSizeInBits;
+}
+
+void PointsToAnalysis::visitGlobalInitializer(unsigned objectNode, const llvm::Constant* init)
+{
+    if (init->getType()->isPointerTy()) {
+        this->unify(this->deref(objectNode), this->getNode(init));
+        return;
+    }
+
+    if (auto expr = llvm::dyn_cast<llvm::ConstantExpr>(init)) {
+        // Register the possible pointer-to-integer casts.
+        this->getNode(expr);
+        return;
+    }
+
+    for (const llvm::Use& op : init->operands()) {
+        this->visitGlobalInitializer(objectNode, llvm::cast<llvm::Constant>(op));
+    }
+}
+
+void PointsToAnalysis::visitInstruction(llvm::Instruction& inst)
+{
+    switch (inst.getOpcode()) {
+        case llvm::Instruction::Alloca:
+            // The pointee of an alloca is its own object.
+            this->deref(this->getNode(&inst));
+            return;
+        case llvm::Instruction::Load: {
+            auto load = llvm::cast<llvm::LoadInst>(&inst);
+            unsigned object = this->deref(this->getNode(load->getPointerOperand()));
+            if (load->getType()->isPointerTy()) {
+                this->unify(this->getNode(load), this->deref(object));
+            } else if (this->mayHoldPointer(load->getType())) {
+                // The loaded integer may be a pointer, which can be turned
+                // back with an inttoptr, pointing into the unknown region.
+                this->pointsToUnknown(object);
+            }
+            return;
+        }
+        case llvm::Instruction::Store: {
+            auto store = llvm::cast<llvm::StoreInst>(&inst);
+            unsigned object = this->deref(this->getNode(store->getPointerOperand()));
+            if (store->getValueOperand()->getType()->isPointerTy()) {
+                this->unify(this->deref(object), this->getNode(store->getValueOperand()));
+            } else if (this->mayHoldPointer(store->getValueOperand()->getType())) {
+                // The stored integer may be reloaded as a pointer.
+                this->pointsToUnknown(object);
+            }
+            return;
+        }
+        case llvm::Instruction::GetElementPtr:
+        case llvm::Instruction::BitCast:
+        case llvm::Instruction::AddrSpaceCast:
+            // The analysis is field-insensitive: derived pointers point into the same region.
+            if (inst.getType()->isPointerTy()) {
+                this->unify(this->getNode(&inst), this->getNode(inst.getOperand(0)));
+            }
+            return;
+        case llvm::Instruction::PHI:
+        case llvm::Instruction::Select:
+            if (inst.getType()->isPointerTy()) {
+                unsigned node = this->getNode(&inst);
+                for (llvm::Value* op : inst.operands()) {
+                    if (op->getType()->isPointerTy()) {
+                        this->unify(node, this->getNode(op));
+                    }
+                }
+            }
+            return;
+        case llvm::Instruction::IntToPtr:
+            this->pointsToUnknown(this->getNode(&inst));
+            return;
+        case llvm::Instruction::PtrToInt:
+            this->pointsToUnknown(this->getNode(inst.getOperand(0)));
+            return;
+        case llvm::Instruction::ICmp:
+            return;
+        case llvm::Instruction::Ret: {
+            auto ret = llvm::cast<llvm::ReturnInst>(&inst);
+            llvm::Value* retVal = ret->getReturnValue();
+            if (retVal != nullptr && retVal->getType()->isPointerTy()) {
+                this->unify(this->getReturnNode(inst.getFunction()), this->getNode(retVal));
+            }
+            return;
+        }
+        case llvm::Instruction::Call:
+        case llvm::Instruction::Invoke:
+            this->visitCall(inst);
+            return;
+        default:
+            break;
+    }
+
+    // We do not know anything about other instructions, so the pointers
+    // they produce or consume may point anywhere.
+    if (inst.getType()->isPtrOrPtrVectorTy()) {
+        this->pointsToUnknown(this->getNode(&inst));
+    }
+
+    for (llvm::Value* op : inst.operands()) {
+        if (op->getType()->isPtrOrPtrVectorTy()) {
+            this->pointsToUnknown(this->getNode(op));
+        }
+    }
+}
+
+void PointsToAnalysis::visitCall(llvm::Instruction& inst)
+{
+    llvm::CallSite call(&inst);
+    auto callee = llvm::dyn_cast<llvm::Function>(call.getCalledValue()->stripPointerCasts());
+
+    if (callee != nullptr && !callee->isDeclaration()) {
+        auto formal = callee->arg_begin();
+        for (llvm::Value* actual : call.args()) {
+            if (!actual->getType()->isPointerTy()) {
+                ++formal;
+                continue;
+            }
+
+            if (formal != callee->arg_end() && formal->getType()->isPointerTy()) {
+                this->unify(this->getNode(&*formal), this->getNode(actual));
+            } else {
+                // Variadic arguments or mismatching types through casts.
+                this->pointsToUnknown(this->getNode(actual));
+            }
+
+            if (formal != callee->arg_end()) {
+                ++formal;
+            }
+        }
+
+        if (inst.getType()->isPointerTy()) {
+            this->unify(this->getNode(&inst), this->getReturnNode(callee));
+        }
+        return;
+    }
+
+    if (callee != nullptr) {
+        llvm::StringRef name = callee->getName();
+        if (name == "malloc" || name == "calloc" || name == "realloc") {
+            // Each allocation site is a new object.
+            this->deref(this->getNode(&inst));
+            return;
+        }
+
+        switch (callee->getIntrinsicID()) {
+            case llvm::Intrinsic::memcpy:
+            case llvm::Intrinsic::memmove: {
+                // The pointers stored in the source are copied into the destination.
+                unsigned dst = this->deref(this->getNode(call.getArgument(0)));
+                unsigned src = this->deref(this->getNode(call.getArgument(1)));
+                this->unify(this->deref(dst), this->deref(src));
+                return;
+            }
+            case llvm::Intrinsic::memset:
+                this->deref(this->getNode(call.getArgument(0)));
+                return;
+            case llvm::Intrinsic::not_intrinsic:
+                break;
+            default:
+                // Other intrinsics (e.g. debug info and lifetime markers) do not
+                // introduce new aliasing.
+                return;
+        }
+
+        if (callee->doesNotAccessMemory() && !inst.getType()->isPointerTy()) {
+            return;
+        }
+    }
+
+    // Unknown code may do anything with the pointers passed to it.
+    for (llvm::Value* actual : call.args()) {
+        if (actual->getType()->isPointerTy()) {
+            this->pointsToUnknown(this->getNode(actual));
+        }
+    }
+
+    if (inst.getType()->isPointerTy()) {
+        this->pointsToUnknown(this->getNode(&inst));
+    }
+}
+
+// Region calculation
+//==------------------------------------------------------------------------==//
+
+void PointsToAnalysis::calculateRegions(llvm::Module& module)
+{
+    // Region identifiers are assigned in the order of their first occurrence
+    // in the module, so they are deterministic between runs.
+    llvm::DenseMap<unsigned, unsigned> regionIds;
+    regionIds[this->find(mUnknown)] = UnknownRegion;
+    mNumRegions = 1;
+
+    for (llvm::GlobalVariable& gv : module.globals()) {
+        this->assignRegion(&gv, regionIds);
+    }
+
+    for (llvm::Function& function : module) {
+        for (llvm::Argument& arg : function.args()) {
+            this->assignRegion(&arg, regionIds);
+        }
+
+        for (llvm::Instruction& inst : llvm::instructions(function)) {
+            this->assignRegion(&inst, regionIds);
+            for (llvm::Value* op : inst.operands()) {
+                if (llvm::isa<llvm::Constant>(op)) {
+                    this->assignRegion(op, regionIds);
+                }
+            }
+        }
+    }
+}
+
+void PointsToAnalysis::assignRegion(
+    const llvm::Value* value, llvm::DenseMap<unsigned, unsigned>& regionIds)
+{
+    auto it = mValueNodes.find(value);
+    if (it == mValueNodes.end() || mRegions.count(value) != 0) {
+        return;
+    }
+
+    unsigned root = this->find(it->second);
+    if (mNodes[root].pointee == InvalidNode) {
+        // The value is never dereferenced.
+        return;
+    }
+
+    unsigned pointee = this->find(mNodes[root].pointee);
+    auto result = regionIds.try_emplace(pointee, mNumRegions);
+    if (result.second) {
+        ++mNumRegions;
+    }
+
+    mRegions[value] = result.first->second;
+}
+
+void PointsToAnalysis::print(llvm::raw_ostream& os) const
+{
+    std::vector<std::vector<const llvm::Value*>> regions(mNumRegions);
+    for (auto& [value, region] : mRegions) {
+        regions[region].push_back(value);
+    }
+
+    for (unsigned i = 0; i < mNumRegions; ++i) {
+        os << "Region " << i << (i == UnknownRegion ? " (unknown)" : "") << ":\n";
+        for (const llvm::Value* value : regions[i]) {
+            os << "  ";
+            value->printAsOperand(os);
+            os << "\n";
+        }
+    }
+}
@@ -26,11 +26,13 @@ using namespace llvm;
 
 BackwardSlicer::BackwardSlicer(
     llvm::Function& function,
-    std::function<bool(llvm::Instruction*)> criterion
+    std::function<bool(llvm::Instruction*)> criterion,
+    llvm::MemorySSA& mssa,
+    llvm::AAResults& aa
 ) : mFunction(function), mCriterion(criterion)
 {
     llvm::PostDominatorTree pdt(function);
-    mPDG = ProgramDependenceGraph::Create(function, pdt);
+    mPDG = ProgramDependenceGraph::Create(function, pdt, mssa, aa);
 }
 
 bool BackwardSlicer::collectRequiredNodes(llvm::DenseSet<llvm::Instruction*>& visited)
@@ -172,15 +174,26 @@ namespace
 class BackwardSlicerPass : public llvm::FunctionPass
 {
 public:
-    char ID;
+    static char ID;
 
     BackwardSlicerPass(std::function<bool(llvm::Instruction*)> criteria)
         : FunctionPass(ID), mCriteria(criteria)
     {}
 
+    void getAnalysisUsage(llvm::AnalysisUsage& au) const override
+    {
+        au.addRequired<llvm::MemorySSAWrapperPass>();
+        au.addRequired<llvm::AAResultsWrapperPass>();
+    }
+
     bool runOnFunction(llvm::Function& function) override
     {
-        BackwardSlicer slicer(function, mCriteria);
+        BackwardSlicer slicer(
+            function,
+            mCriteria,
+            getAnalysis<llvm::MemorySSAWrapperPass>().getMSSA(),
+            getAnalysis<llvm::AAResultsWrapperPass>().getAAResults()
+        );
         return slicer.slice();
     }
 
@@ -190,6 +203,8 @@ private:
 
 } // end anonymous namespace
 
+char BackwardSlicerPass::ID;
+
 llvm::Pass* gazer::createBackwardSlicerPass(std::function<bool(llvm::Instruction*)> criteria)
 {
     return new BackwardSlicerPass(criteria);
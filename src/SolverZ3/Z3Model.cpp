@@ -56,6 +56,8 @@ private:
     ExprRef<FloatLiteralExpr> evalFloat(Z3AstHandle ast, FloatType::FloatPrecision prec);
     ExprRef<IntLiteralExpr> evalInt(Z3AstHandle ast);
 
+    llvm::APInt getBitVectorValue(Z3AstHandle ast, unsigned width);
+
     ExprRef<AtomicExpr> evalConstantArray(Z3AstHandle ast, ArrayType& type);
 
     FloatType::FloatPrecision getFloatPrecision(Z3Handle<Z3_sort> sort);
@@ -126,14 +128,36 @@ auto Z3Model::evalBoolean(Z3AstHandle ast) -> ExprRef<BoolLiteralExpr>
 auto Z3Model::evalInt(Z3AstHandle ast) -> ExprRef<IntLiteralExpr> 
 {
     int64_t intVal;
-    Z3_get_numeral_int64(mZ3Context, ast, &intVal);
+    if (!Z3_get_numeral_int64(mZ3Context, ast, &intVal)) {
+        // IntLiteralExpr can only represent 64-bit values, do not let
+        // larger ones be silently truncated.
+        std::string errStr;
+        llvm::raw_string_ostream err{errStr};
+
+        err << "Integer model value " << Z3_get_numeral_string(mZ3Context, ast)
+            << " does not fit into an integer literal!\n";
+        llvm::report_fatal_error(err.str(), true);
+    }
+
     return IntLiteralExpr::Get(IntType::Get(mContext), intVal);
 }
 
+auto Z3Model::getBitVectorValue(Z3AstHandle ast, unsigned width) -> llvm::APInt
+{
+    if (width <= 64) {
+        uint64_t value;
+        if (Z3_get_numeral_uint64(mZ3Context, ast, &value)) {
+            return llvm::APInt(width, value);
+        }
+    }
+
+    // Wider values are read back through their decimal representation.
+    return llvm::APInt(width, Z3_get_numeral_string(mZ3Context, ast), 10);
+}
+
 auto Z3Model::evalBv(Z3AstHandle ast, unsigned width) -> ExprRef<BvLiteralExpr>
 {
-    llvm::APInt value(width, Z3_get_numeral_string(mZ3Context, ast), 10);
-    return BvLiteralExpr::Get(BvType::Get(mContext, width), value);
+    return BvLiteralExpr::Get(BvType::Get(mContext, width), this->getBitVectorValue(ast, width));
 }
 
 auto Z3Model::evalFloat(Z3AstHandle ast, FloatType::FloatPrecision prec)
@@ -152,8 +176,11 @@ auto Z3Model::evalFloat(Z3AstHandle ast, FloatType::FloatPrecision prec)
         bool isNegative = Z3_fpa_is_numeral_negative(mZ3Context, ast);
         result = llvm::APFloat::getInf(semantics, isNegative);
     } else {
-        llvm::APInt intVal(fltTy.getWidth(), Z3_get_numeral_string(mZ3Context, ast), 10);
-        result = llvm::APFloat(semantics, intVal);
+        // Convert the value into its IEEE-754 bit pattern and rebuild it on our side.
+        Z3AstHandle bits(mZ3Context, Z3_mk_fpa_to_ieee_bv(mZ3Context, ast));
+        Z3AstHandle bitsValue(mZ3Context, Z3_simplify(mZ3Context, bits));
+
+        result = llvm::APFloat(semantics, this->getBitVectorValue(bitsValue, fltTy.getWidth()));
     }
 
     return FloatLiteralExpr::Get(fltTy, result);
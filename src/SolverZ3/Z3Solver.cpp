@@ -19,6 +19,7 @@
 
 #include "gazer/Support/Float.h"
 
+#include <llvm/ADT/SmallString.h>
 #include <llvm/Support/raw_os_ostream.h>
 #include <llvm/Support/CommandLine.h>
 #include <llvm/Support/Debug.h>
@@ -381,9 +382,7 @@ Z3Handle<Z3_sort> Z3ExprTransformer::handleTupleType(TupleType& tupTy)
 Z3AstHandle Z3ExprTransformer::translateLiteral(const ExprRef<LiteralExpr>& expr)
 {
     if (auto bvLit = llvm::dyn_cast<BvLiteralExpr>(expr)) {
-        return createHandle(Z3_mk_unsigned_int64(
-            mZ3Context, bvLit->getValue().getZExtValue(), typeToSort(bvLit->getType())
-        ));
+        return this->translateBitVector(bvLit->getValue());
     }
     
     if (auto bl = llvm::dyn_cast<BoolLiteralExpr>(expr)) {
@@ -406,6 +405,14 @@ Z3AstHandle Z3ExprTransformer::translateLiteral(const ExprRef<LiteralExpr>& expr
                 mZ3Context, fl->getValue().convertToDouble(), typeToSort(fl->getType())
             ));
         }
+
+        // Other precisions have no native numeral constructor, build them
+        // from their IEEE-754 bit pattern instead.
+        return createHandle(Z3_mk_fpa_to_fp_bv(
+            mZ3Context,
+            this->translateBitVector(fl->getValue().bitcastToAPInt()),
+            typeToSort(fl->getType())
+        ));
     }
 
     if (auto arrayLit = llvm::dyn_cast<ArrayLiteralExpr>(expr)) {
@@ -437,7 +444,29 @@ Z3AstHandle Z3ExprTransformer::translateLiteral(const ExprRef<LiteralExpr>& expr
     llvm_unreachable("Unsupported operand type.");
 }
 
+Z3AstHandle Z3ExprTransformer::translateBitVector(const llvm::APInt& value)
+{
+    auto sort = Z3Handle<Z3_sort>(mZ3Context, Z3_mk_bv_sort(mZ3Context, value.getBitWidth()));
+
+    if (value.getBitWidth() <= 64) {
+        return createHandle(Z3_mk_unsigned_int64(mZ3Context, value.getZExtValue(), sort));
+    }
+
+    // Wider values do not fit into a machine word, pass them as a decimal string.
+    llvm::SmallString<64> buffer;
+    value.toStringUnsigned(buffer, /*radix=*/10);
+
+    return createHandle(Z3_mk_numeral(mZ3Context, buffer.c_str(), sort));
+}
+
 std::unique_ptr<Solver> Z3SolverFactory::createSolver(GazerContext& context)
 {
     return std::unique_ptr<Solver>(new Z3Solver(context));
 }
+
+void Z3SolverFactory::printVersion(llvm::raw_ostream& os) const
+{
+    unsigned major, minor, build, revision;
+    Z3_get_version(&major, &minor, &build, &revision);
+    os << "z3-" << major << "." << minor << "." << build << "." << revision;
+}
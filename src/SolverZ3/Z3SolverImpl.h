@@ -205,6 +205,9 @@ protected:
 
     Z3AstHandle translateLiteral(const ExprRef<LiteralExpr>& expr);
 
+    /// Translates a bit-vector value of arbitrary width into a Z3 numeral.
+    Z3AstHandle translateBitVector(const llvm::APInt& value);
+
 private:
     bool shouldSkip(const ExprPtr& expr, Z3AstHandle* ret);  
     void handleResult(const ExprPtr& expr, Z3AstHandle& ret);
@@ -19,111 +19,254 @@
 
 #include <llvm/Support/raw_ostream.h>
 
+#include <algorithm>
 #include <cctype>
-#include <stack>
+#include <cstring>
 
 using namespace gazer;
+using namespace gazer::sexpr;
 
-static sexpr::Value* doParse(llvm::StringRef& input)
+// Arena
+//===----------------------------------------------------------------------===//
+
+const Value* Arena::atom(llvm::StringRef data)
 {
-    input = input.drop_while(&isspace);
-    if (input.empty()) {
-        // TODO
-        llvm::errs() << "Empty input string!\n";
-        return nullptr;
-    }
+    return new (mAllocator.Allocate<Value>()) Value(data.data(), data.size(), false);
+}
 
-    if (input.consume_front("(")) {
-        std::vector<sexpr::Value*> slist;
-        while (input.front() != ')') {
-            slist.emplace_back(doParse(input));
-        }
+const Value* Arena::atomCopy(llvm::StringRef data)
+{
+    char* buffer = mAllocator.Allocate<char>(data.size());
+    std::memcpy(buffer, data.data(), data.size());
 
-        input = input.drop_front();
+    return this->atom(llvm::StringRef(buffer, data.size()));
+}
 
-        return sexpr::list(std::move(slist));
-    } else {
-        // It must be an atom
-        size_t closePos = std::min(input.find_if([](char c) {
-            return isspace(c) || c == '(' || c == ')';
-        }), input.size() - 1);
-        auto data = input.substr(0, closePos);
+const Value* Arena::list(llvm::ArrayRef<const Value*> elements)
+{
+    const Value** buffer = mAllocator.Allocate<const Value*>(elements.size());
+    std::copy(elements.begin(), elements.end(), buffer);
 
-        input = input.drop_front(closePos);
+    return new (mAllocator.Allocate<Value>()) Value(buffer, elements.size(), true);
+}
 
-        return sexpr::atom(data.str());
-    }
+// Parser
+//===----------------------------------------------------------------------===//
+
+static bool isDelimiter(char c)
+{
+    return std::isspace(static_cast<unsigned char>(c)) || c == '(' || c == ')';
 }
 
-std::unique_ptr<sexpr::Value> gazer::sexpr::parse(llvm::StringRef input)
+void Parser::reset()
 {
-    std::vector<sexpr::Value*> list;
-    auto trimmed = input.trim();
-    
-    if (trimmed.front() != '(' && trimmed.back() != ')') {
-        llvm::errs() << "Invalid s-expression format!\n";
+    mElements.clear();
+    mListStarts.clear();
+    mAtomBuffer.clear();
+    mInAtom = false;
+    mResult = nullptr;
+    mFailed = false;
+    mError.clear();
+    mOffset = 0;
+    mLine = 1;
+    mLineStart = 0;
+}
+
+const Value* Parser::parse(llvm::StringRef input)
+{
+    this->reset();
+    if (!this->consume(input, /*copyAtoms=*/false, /*isLast=*/true)) {
         return nullptr;
     }
 
-    Value* tree = doParse(trimmed);
-
-    // Wrap the resulting raw pointer into a unique_ptr
-    return std::unique_ptr<sexpr::Value>(tree);
+    return this->finish();
 }
 
-auto gazer::sexpr::atom(llvm::StringRef data) -> sexpr::Value*
+bool Parser::feed(llvm::StringRef chunk)
 {
-    return new sexpr::Value(data);
+    if (mFailed) {
+        return false;
+    }
+
+    return this->consume(chunk, /*copyAtoms=*/true, /*isLast=*/false);
 }
 
-auto gazer::sexpr::list(std::vector<Value*> data) -> sexpr::Value*
+const Value* Parser::finish()
 {
-    return new sexpr::Value(std::move(data));
+    if (mFailed) {
+        return nullptr;
+    }
+
+    if (mInAtom) {
+        // A streamed atom was terminated by the end of the input.
+        mInAtom = false;
+        this->addValue(mArena.atomCopy(mAtomBuffer));
+        mAtomBuffer.clear();
+    }
+
+    if (mResult == nullptr) {
+        this->error(mOffset, mListStarts.empty() ? "empty input" : "unexpected end of input, expected ')'");
+        return nullptr;
+    }
+
+    return mResult;
 }
 
-void sexpr::Value::print(llvm::raw_ostream& os) const
+bool Parser::consume(llvm::StringRef input, bool copyAtoms, bool isLast)
 {
-    if (mData.index() == 0) {
-        os << std::get<0>(mData);
-    } else if (mData.index() == 1) {
-        os << "(";
-        auto& vec = std::get<1>(mData);
-        for (size_t i = 0; i < vec.size() - 1; ++i) {
-            vec[i]->print(os);
-            os << " ";
+    const char* begin = input.begin();
+    const char* it = begin;
+    const char* end = input.end();
+
+    auto offsetOf = [this, begin](const char* pos) { return mOffset + (pos - begin); };
+
+    while (it != end && mResult == nullptr) {
+        if (mInAtom) {
+            const char* atomEnd = std::find_if(it, end, isDelimiter);
+            mAtomBuffer.append(it, atomEnd);
+            it = atomEnd;
+            if (it == end) {
+                // The atom continues in the next chunk.
+                break;
+            }
+
+            mInAtom = false;
+            this->addValue(mArena.atomCopy(mAtomBuffer));
+            mAtomBuffer.clear();
+            continue;
+        }
+
+        char c = *it;
+        if (c == '\n') {
+            ++mLine;
+            mLineStart = offsetOf(it) + 1;
+            ++it;
+        } else if (std::isspace(static_cast<unsigned char>(c))) {
+            ++it;
+        } else if (c == '(') {
+            mListStarts.push_back(mElements.size());
+            ++it;
+        } else if (c == ')') {
+            if (mListStarts.empty()) {
+                return this->error(offsetOf(it), "unexpected ')'");
+            }
+
+            size_t start = mListStarts.pop_back_val();
+            const Value* list = mArena.list(llvm::makeArrayRef(mElements).drop_front(start));
+            mElements.resize(start);
+            ++it;
+
+            this->addValue(list);
+        } else {
+            const char* atomEnd = std::find_if(it, end, isDelimiter);
+            if (atomEnd == end && !isLast) {
+                mInAtom = true;
+                mAtomBuffer.assign(it, atomEnd);
+                it = atomEnd;
+                break;
+            }
+
+            llvm::StringRef data(it, atomEnd - it);
+            this->addValue(copyAtoms ? mArena.atomCopy(data) : mArena.atom(data));
+            it = atomEnd;
         }
-        vec.back()->print(os);
-        os << ")";
-    } else {
-        llvm_unreachable("Unknown variant state!");
     }
+
+    mOffset += input.size();
+    return true;
 }
 
-sexpr::Value::~Value()
+void Parser::addValue(const Value* value)
 {
-    if (std::holds_alternative<ListTy>(mData)) {
-        for (Value* val : std::get<ListTy>(mData)) {
-            delete val;
-        }
+    if (mListStarts.empty()) {
+        mResult = value;
+    } else {
+        mElements.push_back(value);
     }
 }
 
-bool sexpr::Value::operator==(const gazer::sexpr::Value& rhs) const
+bool Parser::error(size_t offset, const llvm::Twine& message)
 {
-    if (mData.index() != rhs.mData.index()) {
-        return false;
+    mFailed = true;
+    mError = (llvm::Twine(mLine) + ":" + llvm::Twine(offset - mLineStart + 1) + ": " + message).str();
+
+    return false;
+}
+
+const Value* gazer::sexpr::parse(llvm::StringRef input, Arena& arena)
+{
+    Parser parser(arena);
+    const Value* result = parser.parse(input);
+    if (result == nullptr) {
+        llvm::errs() << "Invalid s-expression: " << parser.getError() << "\n";
     }
 
-    if (mData.index() == 0) {
-        return asAtom() == rhs.asAtom();
-    } else if (mData.index() == 1) {
-        auto& vec1 = asList();
-        auto& vec2 = rhs.asList();
-        return std::equal(vec1.begin(), vec1.end(), vec2.begin(), [](auto& v1, auto& v2) {
-           return *v1 == *v2;
-        });
-    } else {
-        llvm_unreachable("Invalid variant state!");
+    return result;
+}
+
+// Value
+//===----------------------------------------------------------------------===//
+
+void Value::print(llvm::raw_ostream& os) const
+{
+    // Pairs of (list, next element index), printed without recursion.
+    llvm::SmallVector<std::pair<const Value*, size_t>, 16> stack;
+
+    auto open = [&os, &stack](const Value* value) {
+        if (value->isAtom()) {
+            os << value->asAtom();
+        } else {
+            os << "(";
+            stack.emplace_back(value, 0);
+        }
+    };
+
+    open(this);
+    while (!stack.empty()) {
+        auto& [list, next] = stack.back();
+        auto elements = list->asList();
+        if (next == elements.size()) {
+            os << ")";
+            stack.pop_back();
+            continue;
+        }
+
+        if (next != 0) {
+            os << " ";
+        }
+
+        open(elements[next++]);
     }
 }
 
+bool Value::operator==(const Value& rhs) const
+{
+    llvm::SmallVector<std::pair<const Value*, const Value*>, 16> worklist;
+    worklist.emplace_back(this, &rhs);
+
+    while (!worklist.empty()) {
+        auto [left, right] = worklist.pop_back_val();
+        if (left->isList() != right->isList()) {
+            return false;
+        }
+
+        if (left->isAtom()) {
+            if (left->asAtom() != right->asAtom()) {
+                return false;
+            }
+            continue;
+        }
+
+        auto leftElems = left->asList();
+        auto rightElems = right->asList();
+        if (leftElems.size() != rightElems.size()) {
+            return false;
+        }
+
+        for (size_t i = 0; i < leftElems.size(); ++i) {
+            worklist.emplace_back(leftElems[i], rightElems[i]);
+        }
+    }
+
+    return true;
+}
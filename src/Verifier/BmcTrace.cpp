@@ -18,6 +18,7 @@
 #include "BoundedModelCheckerImpl.h"
 
 #include "gazer/Core/Solver/Model.h"
+#include "gazer/Core/Expr/ExprEvaluator.h"
 
 #include <llvm/Support/raw_ostream.h>
 
@@ -64,12 +65,19 @@ std::unique_ptr<VerificationResult> BoundedModelCheckerImpl::createFailResult()
         model->dump(llvm::errs());
     }
 
+    // The model does not change while the trace is built, thus all
+    // queries may share the same memoized values.
+    CachingExprEvaluator eval(*model);
+
     std::unique_ptr<Trace> trace;
     if (mSettings.trace) {
         std::vector<Location*> states;
         std::vector<std::vector<VariableAssignment>> actions;
 
-        bmc::BmcCex cex{mError, *mRoot, *model, mPredecessors};
+        llvm::SmallVector<Variable*, 16> variables;
+        llvm::SmallVector<ExprRef<AtomicExpr>, 16> values;
+
+        bmc::BmcCex cex{mError, *mRoot, eval, mPredecessors};
         for (auto state : cex) {
             Location* loc = state.getLocation();
             Transition* edge = state.getOutgoingTransition();
@@ -85,26 +93,26 @@ std::unique_ptr<VerificationResult> BoundedModelCheckerImpl::createFailResult()
             auto assignEdge = llvm::dyn_cast<AssignTransition>(edge);
             assert(assignEdge != nullptr && "BMC traces must contain only assign transitions!");
 
-            std::vector<VariableAssignment> traceAction;
+            variables.clear();
+            values.clear();
             for (const VariableAssignment& assignment : *assignEdge) {
-                Variable* variable = assignment.getVariable();
-                Variable* origVariable = mInlinedVariables.lookup(assignment.getVariable());
+                variables.push_back(assignment.getVariable());
+            }
+            eval.evaluateAll(variables, values);
+
+            std::vector<VariableAssignment> traceAction;
+            traceAction.reserve(variables.size());
+            for (size_t i = 0, e = variables.size(); i != e; ++i) {
+                Variable* origVariable = mInlinedVariables.lookup(variables[i]);
                 if (origVariable == nullptr) {
                     // This variable was not inlined, just use the original one.
-                    origVariable = variable;
-                }
-
-                ExprRef<AtomicExpr> value;
-                if (auto lit = model->evaluate(assignment.getVariable()->getRefExpr())) {
-                    value = lit;
-                } else {
-                    value = UndefExpr::Get(variable->getType());
+                    origVariable = variables[i];
                 }
 
-                traceAction.emplace_back(origVariable, value);
+                traceAction.emplace_back(origVariable, values[i]);
             }
 
-            actions.push_back(traceAction);
+            actions.push_back(std::move(traceAction));
         }
 
         std::reverse(states.begin(), states.end());
@@ -115,7 +123,7 @@ std::unique_ptr<VerificationResult> BoundedModelCheckerImpl::createFailResult()
         trace = std::make_unique<Trace>(std::vector<std::unique_ptr<TraceEvent>>());
     }
 
-    ExprRef<AtomicExpr> errorExpr = model->evaluate(mErrorFieldVariable->getRefExpr());
+    ExprRef<AtomicExpr> errorExpr = eval.evaluate(mErrorFieldVariable->getRefExpr());
     assert(!errorExpr->isUndef() && "The error field must be present in the model as a literal expression!");
 
     switch (errorExpr->getType().getTypeID()) {
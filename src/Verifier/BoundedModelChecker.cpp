@@ -19,11 +19,13 @@
 
 #include "gazer/Core/Expr/ExprRewrite.h"
 #include "gazer/Core/Expr/ExprUtils.h"
+#include "gazer/Core/Expr/ExprMetrics.h"
 #include "gazer/Automaton/CfaUtils.h"
 
 #include "gazer/Support/Stopwatch.h"
 
 #include <llvm/ADT/DenseSet.h>
+#include <llvm/ADT/SmallPtrSet.h>
 #include <llvm/ADT/PostOrderIterator.h>
 #include <llvm/ADT/DepthFirstIterator.h>
 
@@ -63,6 +65,17 @@ auto BoundedModelChecker::check(AutomataSystem& system, CfaTraceBuilder& traceBu
     return result;
 }
 
+void BoundedModelChecker::printSettings(llvm::raw_ostream& os) const
+{
+    os << "bmc"
+        << " trace=" << mSettings.trace
+        << " max-bound=" << mSettings.maxBound
+        << " eager-unroll=" << mSettings.eagerUnroll
+        << " simplify-expr=" << mSettings.simplifyExpr
+        << " solver=";
+    mSolverFactory.printVersion(os);
+}
+
 BoundedModelCheckerImpl::BoundedModelCheckerImpl(
     AutomataSystem& system,
     ExprBuilder& builder,
@@ -263,7 +276,8 @@ auto BoundedModelCheckerImpl::check() -> std::unique_ptr<VerificationResult>
                 this->push();
                 llvm::outs() << "    Transforming formula...\n";
                 if (mSettings.dumpFormula) {
-                    formula->print(llvm::errs());
+                    InfixPrintExpr(formula, llvm::errs(), 10, /*useLetBindings=*/true);
+                    llvm::errs() << "\n";
                 }
 
                 mSolver->add(formula);
@@ -341,9 +355,15 @@ auto BoundedModelCheckerImpl::check() -> std::unique_ptr<VerificationResult>
             llvm::outs() << "    Calculating verification condition...\n";
             formula = pathConditions.encode(lca.first, lca.second);
             if (mSettings.dumpFormula) {
-                formula->print(llvm::errs());
+                InfixPrintExpr(formula, llvm::errs(), 10, /*useLetBindings=*/true);
+                llvm::errs() << "\n";
             }
 
+            LLVM_DEBUG(
+                llvm::dbgs() << "Verification condition metrics: ";
+                ExprMetrics(formula).print(llvm::dbgs());
+            );
+
             llvm::outs() << "    Transforming formula...\n";
             mSolver->add(formula);
 
@@ -515,10 +535,38 @@ void BoundedModelCheckerImpl::inlineCallIntoRoot(
 
     VariableExprRewrite rewrite(mExprBuilder);
 
+    // Locals which are never read do not influence the formula, thus they
+    // need not be cloned. They are kept if a counterexample is requested,
+    // as their values may be shown in the trace.
+    llvm::SmallPtrSet<Variable*, 16> deadLocals;
+    if (!mSettings.trace) {
+        auto& liveness = mLivenessMap[callee];
+        if (liveness == nullptr) {
+            liveness = std::make_unique<CfaLiveness>(*callee);
+        }
+
+        llvm::SmallPtrSet<Variable*, 16> callOutputs;
+        for (Transition* edge : callee->edges()) {
+            if (auto nestedCall = llvm::dyn_cast<CallTransition>(edge)) {
+                for (const VariableAssignment& output : nestedCall->outputs()) {
+                    callOutputs.insert(output.getVariable());
+                }
+            }
+        }
+
+        for (Variable& local : callee->locals()) {
+            bool isRead = liveness->isLiveAnywhere(&local) || callee->isOutput(&local);
+            if (!isRead && callOutputs.count(&local) == 0) {
+                deadLocals.insert(&local);
+            }
+        }
+        mStats.NumDeadLocals += deadLocals.size();
+    }
+
     // Clone all local variables into the parent
     for (Variable& local : callee->locals()) {
         LLVM_DEBUG(llvm::dbgs() << "Callee local " << local.getName() << "\n"); 
-        if (!callee->isOutput(&local)) {
+        if (!callee->isOutput(&local) && deadLocals.count(&local) == 0) {
             auto varname = (local.getName() + suffix).str();
             auto newLocal = mRoot->createLocal(varname, local.getType());
             oldVarToNew[&local] = newLocal;
@@ -575,15 +623,16 @@ void BoundedModelCheckerImpl::inlineCallIntoRoot(
         if (auto assign = llvm::dyn_cast<AssignTransition>(origEdge)) {
             // Transform the assignments of this edge to use the new variables.
             std::vector<VariableAssignment> newAssigns;
-            std::transform(
-                assign->begin(), assign->end(), std::back_inserter(newAssigns),
-                [&oldVarToNew, &rewrite] (const VariableAssignment& origAssign) {
-                    return VariableAssignment {
-                        oldVarToNew[origAssign.getVariable()],
-                        rewrite.walk(origAssign.getValue())
-                    };
+            for (const VariableAssignment& origAssign : *assign) {
+                if (deadLocals.count(origAssign.getVariable()) != 0) {
+                    continue;
                 }
-            );
+
+                newAssigns.emplace_back(
+                    oldVarToNew[origAssign.getVariable()],
+                    rewrite.walk(origAssign.getValue())
+                );
+            }
 
             newEdge = mRoot->createAssignTransition(
                 source, target, rewrite.walk(assign->getGuard()), newAssigns
@@ -700,6 +749,7 @@ void BoundedModelCheckerImpl::printStats(llvm::raw_ostream& os)
     os << "Number of locations on finish: " << mStats.NumEndLocs << "\n";
     os << "Number of variables on start: " << mStats.NumBeginLocals << "\n";
     os << "Number of variables on finish: " << mStats.NumEndLocals << "\n";
+    os << "Number of dead callee locals not inlined: " << mStats.NumDeadLocals << "\n";
     os << "------------------------------\n";
     if (mSettings.printSolverStats) {
         mSolver->printStats(os);
@@ -24,6 +24,7 @@
 #include "gazer/Core/Solver/Solver.h"
 #include "gazer/Core/Solver/Model.h"
 #include "gazer/Automaton/Cfa.h"
+#include "gazer/Automaton/CfaLiveness.h"
 #include "gazer/Trace/Trace.h"
 
 #include "gazer/Support/Stopwatch.h"
@@ -132,6 +133,7 @@ public:
         unsigned NumEndLocs = 0;
         unsigned NumBeginLocals = 0;
         unsigned NumEndLocals = 0;
+        unsigned NumDeadLocals = 0;
     };
 
     BoundedModelCheckerImpl(
@@ -196,6 +198,7 @@ private:
     llvm::DenseSet<CallTransition*> mOpenCalls;
     std::unordered_map<CallTransition*, CallInfo> mCalls;
     std::unordered_map<Cfa*, std::vector<Location*>> mTopoSortMap;
+    std::unordered_map<Cfa*, std::unique_ptr<CfaLiveness>> mLivenessMap;
 
     bmc::PredecessorMapT mPredecessors;
 
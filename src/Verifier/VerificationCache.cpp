@@ -0,0 +1,533 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+#include "gazer/Verifier/VerificationCache.h"
+#include "gazer/Automaton/Cfa.h"
+#include "gazer/Automaton/CfaSerialization.h"
+#include "gazer/Core/LiteralExpr.h"
+#include "gazer/Support/Warnings.h"
+
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/SmallString.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/LEB128.h>
+#include <llvm/Support/MD5.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/Path.h>
+
+// Set by the build system, see src/Verifier/CMakeLists.txt.
+#ifndef GAZER_REVISION
+#define GAZER_REVISION "unknown"
+#endif
+
+using namespace gazer;
+
+namespace
+{
+
+constexpr llvm::StringLiteral EntryMagic = "GZVR";
+
+/// The version of the entry format. Entries of other versions are ignored.
+constexpr unsigned EntryVersion = 1;
+
+enum TraceKind : unsigned
+{
+    Trace_None = 0,   ///< The result has no trace.
+    Trace_Empty,      ///< The result has a trace, but it was not built by the trace builder.
+    Trace_Recorded    ///< The trace was built from the recorded states and actions.
+};
+
+/// Numbers the locations and variables of an automata system, so that cached
+/// traces may refer to them. As the cache key is the serialization of the
+/// system, equal keys guarantee equal numberings.
+class SystemNumbering
+{
+public:
+    explicit SystemNumbering(AutomataSystem& system)
+    {
+        for (Cfa& cfa : system) {
+            for (Location* loc : cfa.nodes()) {
+                mLocationIds[loc] = mLocations.size();
+                mLocations.push_back(loc);
+            }
+
+            for (Variable& variable : cfa.inputs()) {
+                this->addVariable(&variable);
+            }
+
+            for (Variable& variable : cfa.locals()) {
+                this->addVariable(&variable);
+            }
+        }
+    }
+
+    std::vector<Location*> mLocations;
+    llvm::DenseMap<const Location*, unsigned> mLocationIds;
+
+    std::vector<Variable*> mVariables;
+    llvm::DenseMap<const Variable*, unsigned> mVariableIds;
+
+private:
+    void addVariable(Variable* variable)
+    {
+        mVariableIds[variable] = mVariables.size();
+        mVariables.push_back(variable);
+    }
+};
+
+/// Forwards trace construction to another builder, recording its input.
+class RecordingTraceBuilder : public CfaTraceBuilder
+{
+public:
+    explicit RecordingTraceBuilder(CfaTraceBuilder& builder)
+        : mBuilder(builder)
+    {}
+
+    std::unique_ptr<Trace> build(
+        std::vector<Location*>& states,
+        std::vector<std::vector<VariableAssignment>>& actions) override
+    {
+        mStates = states;
+        mActions = actions;
+        mRecorded = true;
+
+        return mBuilder.build(states, actions);
+    }
+
+    CfaTraceBuilder& mBuilder;
+    bool mRecorded = false;
+    std::vector<Location*> mStates;
+    std::vector<std::vector<VariableAssignment>> mActions;
+};
+
+void writeAPInt(const llvm::APInt& value, llvm::raw_ostream& os)
+{
+    for (unsigned i = 0; i < value.getNumWords(); ++i) {
+        llvm::encodeULEB128(value.getRawData()[i], os);
+    }
+}
+
+/// Writes the value of a trace assignment. Returns false if the value
+/// cannot be represented in the cache.
+bool writeValue(const ExprPtr& value, llvm::raw_ostream& os)
+{
+    if (value == nullptr || value->getKind() == Expr::Undef) {
+        llvm::encodeULEB128(0, os);
+        return true;
+    }
+
+    llvm::encodeULEB128(1, os);
+    if (auto boolLit = llvm::dyn_cast<BoolLiteralExpr>(value)) {
+        llvm::encodeULEB128(boolLit->getValue(), os);
+    } else if (auto intLit = llvm::dyn_cast<IntLiteralExpr>(value)) {
+        llvm::encodeSLEB128(intLit->getValue(), os);
+    } else if (auto realLit = llvm::dyn_cast<RealLiteralExpr>(value)) {
+        llvm::encodeSLEB128(realLit->getValue().numerator(), os);
+        llvm::encodeSLEB128(realLit->getValue().denominator(), os);
+    } else if (auto bvLit = llvm::dyn_cast<BvLiteralExpr>(value)) {
+        writeAPInt(bvLit->getValue(), os);
+    } else if (auto fltLit = llvm::dyn_cast<FloatLiteralExpr>(value)) {
+        writeAPInt(fltLit->getValue().bitcastToAPInt(), os);
+    } else {
+        return false;
+    }
+
+    return true;
+}
+
+/// Serializes a verification result. Returns false if the result
+/// should not be cached.
+bool writeEntry(
+    const VerificationResult& result,
+    const RecordingTraceBuilder& recorder,
+    const SystemNumbering& numbering,
+    llvm::raw_ostream& os)
+{
+    switch (result.getStatus()) {
+        case VerificationResult::Success:
+        case VerificationResult::Fail:
+        case VerificationResult::BoundReached:
+            break;
+        default:
+            return false;
+    }
+
+    os << EntryMagic;
+    llvm::encodeULEB128(EntryVersion, os);
+    llvm::encodeULEB128(result.getStatus(), os);
+
+    auto fail = llvm::dyn_cast<FailResult>(&result);
+    if (fail == nullptr) {
+        return true;
+    }
+
+    llvm::encodeULEB128(fail->getErrorID(), os);
+    if (!fail->hasTrace()) {
+        llvm::encodeULEB128(Trace_None, os);
+        return true;
+    }
+
+    if (!recorder.mRecorded) {
+        llvm::encodeULEB128(Trace_Empty, os);
+        return true;
+    }
+
+    llvm::encodeULEB128(Trace_Recorded, os);
+    llvm::encodeULEB128(recorder.mStates.size(), os);
+    for (Location* loc : recorder.mStates) {
+        auto it = numbering.mLocationIds.find(loc);
+        if (it == numbering.mLocationIds.end()) {
+            // The location was created by the algorithm itself.
+            return false;
+        }
+        llvm::encodeULEB128(it->second, os);
+    }
+
+    llvm::encodeULEB128(recorder.mActions.size(), os);
+    for (const std::vector<VariableAssignment>& action : recorder.mActions) {
+        llvm::encodeULEB128(action.size(), os);
+        for (const VariableAssignment& assign : action) {
+            auto it = numbering.mVariableIds.find(assign.getVariable());
+            if (it == numbering.mVariableIds.end()) {
+                return false;
+            }
+
+            llvm::encodeULEB128(it->second, os);
+            if (!writeValue(assign.getValue(), os)) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+/// Decodes a cache entry. Malformed entries are treated as cache misses.
+class EntryReader
+{
+public:
+    EntryReader(
+        llvm::MemoryBufferRef buffer,
+        const SystemNumbering& numbering,
+        CfaTraceBuilder& traceBuilder
+    ) : mCurrent(reinterpret_cast<const uint8_t*>(buffer.getBufferStart())),
+        mEnd(reinterpret_cast<const uint8_t*>(buffer.getBufferEnd())),
+        mNumbering(numbering), mTraceBuilder(traceBuilder)
+    {}
+
+    std::unique_ptr<VerificationResult> read();
+
+private:
+    bool readTrace(std::vector<Location*>& states, std::vector<std::vector<VariableAssignment>>& actions);
+    bool readValue(Type& type, ExprPtr& value);
+
+    bool readNumber(uint64_t& value)
+    {
+        const char* errorMsg = nullptr;
+        unsigned length = 0;
+        value = llvm::decodeULEB128(mCurrent, &length, mEnd, &errorMsg);
+        mCurrent += length;
+
+        return errorMsg == nullptr;
+    }
+
+    bool readSigned(int64_t& value)
+    {
+        const char* errorMsg = nullptr;
+        unsigned length = 0;
+        value = llvm::decodeSLEB128(mCurrent, &length, mEnd, &errorMsg);
+        mCurrent += length;
+
+        return errorMsg == nullptr;
+    }
+
+    /// Reads a number which must be less than \p limit.
+    bool readIndex(unsigned& value, size_t limit)
+    {
+        uint64_t number;
+        if (!readNumber(number) || number >= limit) {
+            return false;
+        }
+
+        value = static_cast<unsigned>(number);
+        return true;
+    }
+
+    bool readAPInt(unsigned width, llvm::APInt& value)
+    {
+        llvm::SmallVector<uint64_t, 2> words(llvm::APInt::getNumWords(width));
+        for (uint64_t& word : words) {
+            if (!readNumber(word)) {
+                return false;
+            }
+        }
+
+        value = llvm::APInt(width, words);
+        return true;
+    }
+
+private:
+    const uint8_t* mCurrent;
+    const uint8_t* mEnd;
+    const SystemNumbering& mNumbering;
+    CfaTraceBuilder& mTraceBuilder;
+};
+
+} // end anonymous namespace
+
+std::unique_ptr<VerificationResult> EntryReader::read()
+{
+    if (static_cast<size_t>(mEnd - mCurrent) < EntryMagic.size()
+        || llvm::StringRef(reinterpret_cast<const char*>(mCurrent), EntryMagic.size()) != EntryMagic) {
+        return nullptr;
+    }
+    mCurrent += EntryMagic.size();
+
+    uint64_t version, status;
+    if (!readNumber(version) || version != EntryVersion || !readNumber(status)) {
+        return nullptr;
+    }
+
+    std::unique_ptr<VerificationResult> result;
+    switch (status) {
+        case VerificationResult::Success:
+            result = VerificationResult::CreateSuccess();
+            break;
+        case VerificationResult::BoundReached:
+            result = VerificationResult::CreateBoundReached();
+            break;
+        case VerificationResult::Fail: {
+            uint64_t errorCode, traceKind;
+            if (!readNumber(errorCode) || !readNumber(traceKind)) {
+                return nullptr;
+            }
+
+            std::unique_ptr<Trace> trace;
+            if (traceKind == Trace_Empty) {
+                trace = std::make_unique<Trace>(std::vector<std::unique_ptr<TraceEvent>>());
+            } else if (traceKind == Trace_Recorded) {
+                std::vector<Location*> states;
+                std::vector<std::vector<VariableAssignment>> actions;
+                if (!readTrace(states, actions)) {
+                    return nullptr;
+                }
+                trace = mTraceBuilder.build(states, actions);
+            } else if (traceKind != Trace_None) {
+                return nullptr;
+            }
+
+            result = VerificationResult::CreateFail(errorCode, std::move(trace));
+            break;
+        }
+        default:
+            return nullptr;
+    }
+
+    if (mCurrent != mEnd) {
+        return nullptr;
+    }
+
+    return result;
+}
+
+bool EntryReader::readTrace(
+    std::vector<Location*>& states, std::vector<std::vector<VariableAssignment>>& actions)
+{
+    // Each record takes at least one byte, which bounds the reserved sizes.
+    size_t remaining = mEnd - mCurrent;
+
+    uint64_t numStates;
+    if (!readNumber(numStates) || numStates > remaining) {
+        return false;
+    }
+
+    states.reserve(numStates);
+    for (uint64_t i = 0; i < numStates; ++i) {
+        unsigned locId;
+        if (!readIndex(locId, mNumbering.mLocations.size())) {
+            return false;
+        }
+        states.push_back(mNumbering.mLocations[locId]);
+    }
+
+    uint64_t numActions;
+    if (!readNumber(numActions) || numActions > remaining) {
+        return false;
+    }
+
+    actions.resize(numActions);
+    for (std::vector<VariableAssignment>& action : actions) {
+        uint64_t numAssigns;
+        if (!readNumber(numAssigns) || numAssigns > remaining) {
+            return false;
+        }
+
+        action.reserve(numAssigns);
+        for (uint64_t i = 0; i < numAssigns; ++i) {
+            unsigned varId;
+            if (!readIndex(varId, mNumbering.mVariables.size())) {
+                return false;
+            }
+
+            Variable* variable = mNumbering.mVariables[varId];
+            ExprPtr value;
+            if (!readValue(variable->getType(), value)) {
+                return false;
+            }
+
+            action.emplace_back(variable, value);
+        }
+    }
+
+    return true;
+}
+
+bool EntryReader::readValue(Type& type, ExprPtr& value)
+{
+    uint64_t isLiteral;
+    if (!readNumber(isLiteral)) {
+        return false;
+    }
+
+    if (isLiteral == 0) {
+        value = UndefExpr::Get(type);
+        return true;
+    }
+
+    switch (type.getTypeID()) {
+        case Type::BoolTypeID: {
+            uint64_t number;
+            if (!readNumber(number)) {
+                return false;
+            }
+            value = BoolLiteralExpr::Get(llvm::cast<BoolType>(type), number != 0);
+            return true;
+        }
+        case Type::IntTypeID: {
+            int64_t number;
+            if (!readSigned(number)) {
+                return false;
+            }
+            value = IntLiteralExpr::Get(llvm::cast<IntType>(type), number);
+            return true;
+        }
+        case Type::RealTypeID: {
+            int64_t num, denom;
+            if (!readSigned(num) || !readSigned(denom) || denom <= 0) {
+                return false;
+            }
+            value = RealLiteralExpr::Get(llvm::cast<RealType>(type), num, denom);
+            return true;
+        }
+        case Type::BvTypeID: {
+            auto& bvTy = llvm::cast<BvType>(type);
+            llvm::APInt number;
+            if (!readAPInt(bvTy.getWidth(), number)) {
+                return false;
+            }
+            value = BvLiteralExpr::Get(bvTy, number);
+            return true;
+        }
+        case Type::FloatTypeID: {
+            auto& fltTy = llvm::cast<FloatType>(type);
+            llvm::APInt bits;
+            if (!readAPInt(fltTy.getWidth(), bits)) {
+                return false;
+            }
+            value = FloatLiteralExpr::Get(fltTy, llvm::APFloat(fltTy.getLLVMSemantics(), bits));
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+std::unique_ptr<VerificationResult> VerificationCache::check(
+    VerificationAlgorithm& algorithm,
+    AutomataSystem& system,
+    CfaTraceBuilder& traceBuilder)
+{
+    // The entry is located by the hash of the gazer revision, the settings
+    // (including the version of the solver) and the system.
+    llvm::SmallString<4096> key;
+    llvm::raw_svector_ostream keyOS(key);
+    keyOS << "gazer-" << GAZER_REVISION << '\n';
+    algorithm.printSettings(keyOS);
+    keyOS << '\n';
+    WriteAutomataSystem(system, keyOS);
+
+    llvm::MD5 hash;
+    hash.update(key);
+    llvm::MD5::MD5Result digest;
+    hash.final(digest);
+
+    llvm::SmallString<128> entryPath(mDirectory);
+    llvm::sys::path::append(entryPath, llvm::Twine(digest.digest()) + ".result");
+
+    // Locations and variables must be numbered before running the algorithm,
+    // as it is free to transform the system.
+    SystemNumbering numbering(system);
+
+    if (auto buffer = llvm::MemoryBuffer::getFile(entryPath)) {
+        EntryReader reader((*buffer)->getMemBufferRef(), numbering, traceBuilder);
+        if (auto result = reader.read()) {
+            ++mNumHits;
+            return result;
+        }
+    }
+
+    ++mNumMisses;
+
+    RecordingTraceBuilder recorder(traceBuilder);
+    auto result = algorithm.check(system, recorder);
+
+    llvm::SmallString<256> entry;
+    llvm::raw_svector_ostream entryOS(entry);
+    if (!writeEntry(*result, recorder, numbering, entryOS)) {
+        return result;
+    }
+
+    // Write into a temporary file first, so that concurrent runs never
+    // observe a partially written entry.
+    std::error_code ec = llvm::sys::fs::create_directories(mDirectory);
+    int fd;
+    llvm::SmallString<128> tmpPath;
+    if (!ec) {
+        ec = llvm::sys::fs::createUniqueFile(entryPath + "-%%%%%%.tmp", fd, tmpPath);
+    }
+
+    if (!ec) {
+        {
+            llvm::raw_fd_ostream tmpOS(fd, /*shouldClose=*/true);
+            tmpOS << entry;
+        }
+        ec = llvm::sys::fs::rename(tmpPath, entryPath);
+    }
+
+    if (ec) {
+        emit_warning("could not write verification cache entry '%s': %s",
+            entryPath.c_str(), ec.message().c_str());
+    }
+
+    return result;
+}
+
+void VerificationCache::printStats(llvm::raw_ostream& os) const
+{
+    os << "Verification cache hits: " << mNumHits << "\n";
+    os << "Verification cache misses: " << mNumMisses << "\n";
+}
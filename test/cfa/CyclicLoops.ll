@@ -0,0 +1,35 @@
+; RUN: %cfa -cyclic -no-prune-cfa -no-simplify-cfa -no-simplify-expr -elim-vars=off -memory=havoc "%s" | /usr/bin/diff -B -Z "%p/Expected/CyclicLoops.cfa" -
+
+declare i32 @__VERIFIER_nondet_int()
+
+define i32 @main() {
+entry:
+  %n = call i32 @__VERIFIER_nondet_int()
+  br label %outer.header
+
+outer.header:
+  %a = phi i32 [ 0, %entry ], [ %b, %outer.latch ]
+  %b = phi i32 [ 1, %entry ], [ %a, %outer.latch ]
+  %i = phi i32 [ 0, %entry ], [ %i.next, %outer.latch ]
+  %outer.cond = icmp slt i32 %i, %n
+  br i1 %outer.cond, label %inner.header, label %exit
+
+inner.header:
+  %j = phi i32 [ 0, %outer.header ], [ %j.next, %inner.body ]
+  %s = phi i32 [ %a, %outer.header ], [ %s.next, %inner.body ]
+  %inner.cond = icmp slt i32 %j, %i
+  br i1 %inner.cond, label %inner.body, label %outer.latch
+
+inner.body:
+  %s.next = add i32 %s, %b
+  %j.next = add nsw i32 %j, 1
+  br label %inner.header
+
+outer.latch:
+  %i.next = add nsw i32 %i, 1
+  br label %outer.header
+
+exit:
+  %res = add i32 %a, %b
+  ret i32 %res
+}
@@ -0,0 +1,48 @@
+; RUN: %cfa -no-prune-cfa -no-simplify-cfa -no-simplify-expr -elim-vars=normal -memory=havoc "%s" | /usr/bin/diff -B -Z "%p/Expected/ElimVars_Normal.cfa" -
+; RUN: %cfa -no-prune-cfa -no-simplify-cfa -no-simplify-expr -elim-vars=aggressive -memory=havoc "%s" | /usr/bin/diff -B -Z "%p/Expected/ElimVars_Aggressive.cfa" -
+
+declare i32 @__VERIFIER_nondet_int()
+declare void @__VERIFIER_error()
+
+define i32 @main() {
+entry:
+  %x = call i32 @__VERIFIER_nondet_int()
+  %y = call i32 @__VERIFIER_nondet_int()
+  ; Expensive, used three times: kept by 'normal', inlined by 'aggressive'.
+  %prod = mul i32 %x, %y
+  ; Cheap, used three times: inlined by both.
+  %low = trunc i32 %y to i8
+  %c1 = icmp sgt i32 %prod, 0
+  %c2 = icmp slt i32 %prod, 100
+  %c3 = icmp ne i32 %prod, 42
+  %d1 = icmp eq i8 %low, 1
+  %d2 = icmp ne i8 %low, 2
+  %d3 = icmp ult i8 %low, 3
+  %c12 = and i1 %c1, %c2
+  %c123 = and i1 %c12, %c3
+  %d12 = and i1 %d1, %d2
+  %d123 = and i1 %d12, %d3
+  %cd = and i1 %c123, %d123
+  br i1 %cd, label %chain, label %exit
+
+chain:
+  ; Each step doubles the tree cost of the previous one. 'aggressive' inlines
+  ; the steps until the growth exceeds its budget, then keeps a variable.
+  %a1 = add i32 %x, %x
+  %a2 = add i32 %a1, %a1
+  %a3 = add i32 %a2, %a2
+  %a4 = add i32 %a3, %a3
+  %a5 = add i32 %a4, %a4
+  %a6 = add i32 %a5, %a5
+  %a7 = add i32 %a6, %a6
+  %a8 = add i32 %a7, %a7
+  %e = icmp eq i32 %a8, 0
+  br i1 %e, label %error, label %exit
+
+error:
+  call void @__VERIFIER_error()
+  unreachable
+
+exit:
+  ret i32 0
+}
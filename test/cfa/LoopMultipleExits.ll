@@ -1,4 +1,4 @@
-; RUN: %cfa -no-simplify-expr -elim-vars=off -memory=havoc "%s" | /usr/bin/diff -B -Z "%p/Expected/LoopMultipleExits.cfa" -
+; RUN: %cfa -no-prune-cfa -no-simplify-cfa -no-simplify-expr -elim-vars=off -memory=havoc "%s" | /usr/bin/diff -B -Z "%p/Expected/LoopMultipleExits.cfa" -
 
 declare i32 @__VERIFIER_nondet_int()
 
@@ -1,4 +1,5 @@
-; RUN: %cfa -no-simplify-expr -elim-vars=off -memory=havoc "%s" | /usr/bin/diff -B -Z "%p/Expected/NestedLoops.cfa" -
+; RUN: %cfa -no-prune-cfa -no-simplify-cfa -no-simplify-expr -elim-vars=off -memory=havoc "%s" | /usr/bin/diff -B -Z "%p/Expected/NestedLoops.cfa" -
+; RUN: %cfa -no-prune-cfa -no-simplify-cfa -no-simplify-expr -elim-vars=off -memory=havoc -translation-threads=4 "%s" | /usr/bin/diff -B -Z "%p/Expected/NestedLoops.cfa" -
 
 declare i32 @__VERIFIER_nondet_int()
 
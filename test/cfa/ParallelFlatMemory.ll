@@ -0,0 +1,68 @@
+; RUN: %cfa -memory=flat -o "%t.seq" "%s"
+; RUN: %cfa -memory=flat -translation-threads=4 -o "%t.par" "%s"
+; RUN: cmp "%t.seq" "%t.par"
+; RUN: %cfa -memory=flat -trace -o "%t.seq" "%s"
+; RUN: %cfa -memory=flat -trace -translation-threads=4 -o "%t.par" "%s"
+; RUN: cmp "%t.seq" "%t.par"
+
+; Translating the procedures on multiple threads must produce the same
+; automata as the sequential translation with the flat memory model.
+
+@counter = global i32 0, align 4
+@table = global [4 x i32] [i32 1, i32 2, i32 3, i32 4], align 16
+@ptr = global i32* @counter, align 8
+
+declare i32 @__VERIFIER_nondet_int()
+declare void @__VERIFIER_error()
+
+define internal void @bump(i32* %p, i32 %n) {
+entry:
+  %old = load i32, i32* %p, align 4
+  %new = add i32 %old, %n
+  store i32 %new, i32* %p, align 4
+  %c = load i32, i32* @counter, align 4
+  %c.next = add i32 %c, 1
+  store i32 %c.next, i32* @counter, align 4
+  ret void
+}
+
+define i32 @sum(i32 %n) {
+entry:
+  %acc = alloca i32, align 4
+  store i32 0, i32* %acc, align 4
+  br label %loop
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %body ]
+  %cmp = icmp slt i32 %i, %n
+  br i1 %cmp, label %body, label %exit
+
+body:
+  %idx = and i32 %i, 3
+  %elem.ptr = getelementptr inbounds [4 x i32], [4 x i32]* @table, i32 0, i32 %idx
+  %elem = load i32, i32* %elem.ptr, align 4
+  call void @bump(i32* %acc, i32 %elem)
+  %i.next = add nsw i32 %i, 1
+  br label %loop
+
+exit:
+  %res = load i32, i32* %acc, align 4
+  ret i32 %res
+}
+
+define i32 @main() {
+entry:
+  %n = call i32 @__VERIFIER_nondet_int()
+  %s = call i32 @sum(i32 %n)
+  %p = load i32*, i32** @ptr, align 8
+  %c = load i32, i32* %p, align 4
+  %cmp = icmp eq i32 %s, %c
+  br i1 %cmp, label %error, label %exit
+
+error:
+  call void @__VERIFIER_error()
+  unreachable
+
+exit:
+  ret i32 0
+}
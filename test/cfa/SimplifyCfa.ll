@@ -0,0 +1,35 @@
+; RUN: %cfa -memory=havoc "%s" | /usr/bin/diff -B -Z "%p/Expected/SimplifyCfa.cfa" -
+; RUN: %cfa -memory=havoc -translation-threads=4 "%s" | /usr/bin/diff -B -Z "%p/Expected/SimplifyCfa.cfa" -
+
+declare i32 @__VERIFIER_nondet_int()
+declare void @gazer.error_code(i16)
+
+define void @check(i32 %v) {
+entry:
+    %e = icmp eq i32 %v, 0
+    br i1 %e, label %error, label %ok
+error:
+    call void @gazer.error_code(i16 1)
+    unreachable
+ok:
+    ret void
+}
+
+; The loop never exits, errors may only be reached through its calls.
+define i32 @main() {
+entry:
+    %x = call i32 @__VERIFIER_nondet_int()
+    %c = icmp sgt i32 %x, 0
+    br i1 %c, label %pos, label %neg
+pos:
+    %y = add nsw i32 %x, 1
+    br label %loop
+neg:
+    br label %loop
+loop:
+    %v = phi i32 [ %y, %pos ], [ 0, %neg ], [ %v1, %loop ]
+    call void @check(i32 %v)
+    %n = call i32 @__VERIFIER_nondet_int()
+    %v1 = add nsw i32 %v, %n
+    br label %loop
+}
@@ -0,0 +1,32 @@
+; RUN: %cfa -no-prune-cfa -no-simplify-cfa -no-simplify-expr -elim-vars=off -memory=havoc "%s" | /usr/bin/diff -B -Z "%p/Expected/Switch_Bv.cfa" -
+; RUN: %cfa -math-int -no-prune-cfa -no-simplify-cfa -no-simplify-expr -elim-vars=off -memory=havoc "%s" | /usr/bin/diff -B -Z "%p/Expected/Switch_Int.cfa" -
+
+declare i8 @__VERIFIER_nondet_char()
+
+define i32 @main() {
+entry:
+  %x = call i8 @__VERIFIER_nondet_char()
+  switch i8 %x, label %default [
+    i8 5, label %single
+    i8 1, label %range
+    i8 -1, label %range
+    i8 0, label %range
+    i8 2, label %range
+    i8 10, label %shared
+    i8 20, label %shared
+    i8 21, label %shared
+    i8 30, label %default
+  ]
+
+single:
+  ret i32 1
+
+range:
+  ret i32 2
+
+shared:
+  ret i32 3
+
+default:
+  ret i32 0
+}
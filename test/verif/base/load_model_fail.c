@@ -0,0 +1,17 @@
+// RUN: %cfa -run-pipeline -o "%t.gzm" "%s"
+// RUN: %bmc -bound 10 -load-model "%t.gzm" | FileCheck "%s"
+
+// CHECK: Verification FAILED
+// CHECK-NEXT: Error code
+extern int __VERIFIER_nondet_int(void);
+void __VERIFIER_error(void);
+
+int main(void)
+{
+    int x = __VERIFIER_nondet_int();
+    if (x > 5) {
+        __VERIFIER_error();
+    }
+
+    return 0;
+}
@@ -0,0 +1,27 @@
+// RUN: %bmc -bound 1 -memory=flat -no-inline-globals "%s" | FileCheck "%s"
+
+// CHECK: Verification FAILED
+
+// Lifted globals must be passed through the procedures which modify them.
+int __VERIFIER_nondet_int(void);
+void __VERIFIER_error(void) __attribute__((__noreturn__));
+
+int counter = 0;
+int unused = 5;
+
+void increment(void)
+{
+    counter = counter + 1;
+}
+
+int main(void)
+{
+    increment();
+    increment();
+
+    if (counter == 2) {
+        __VERIFIER_error();
+    }
+
+    return 0;
+}
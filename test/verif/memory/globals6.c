@@ -0,0 +1,33 @@
+// RUN: %bmc -bound 1 -memory=flat -no-inline-globals "%s" | FileCheck "%s"
+
+// CHECK: Verification SUCCESSFUL
+
+// Arrays whose address does not escape are placed into their own memory object.
+int __VERIFIER_nondet_int(void);
+void __VERIFIER_error(void) __attribute__((__noreturn__));
+
+int arr[4] = { 1, 2, 3, 4 };
+int x = 0;
+
+void set(int i, int v)
+{
+    arr[i] = v;
+}
+
+int main(void)
+{
+    int i = __VERIFIER_nondet_int();
+    if (i < 0 || i > 3) {
+        return 0;
+    }
+
+    int *p = &x;
+    *p = 10;
+    set(i, 10);
+
+    if (arr[i] != 10 || x != 10) {
+        __VERIFIER_error();
+    }
+
+    return 0;
+}
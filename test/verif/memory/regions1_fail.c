@@ -0,0 +1,28 @@
+// RUN: %bmc -bound 1 -memory=flat "%s" | FileCheck "%s"
+
+// CHECK: Verification FAILED
+
+// Pointers into distinct regions must not interfere, while pointers
+// which may alias must still observe each other's writes.
+int __VERIFIER_nondet_int(void);
+void __VERIFIER_error(void) __attribute__((__noreturn__));
+
+void write(int *p, int v)
+{
+    *p = v;
+}
+
+int main(void)
+{
+    int a = 0, b = 0, c = 0;
+    int *p = __VERIFIER_nondet_int() ? &a : &b;
+
+    write(p, 1);
+    write(&c, 2);
+
+    if (a + b == 1 && c == 2) {
+        __VERIFIER_error();
+    }
+
+    return 0;
+}
@@ -0,0 +1,24 @@
+// RUN: %bmc -bound 1 -memory=flat "%s" | FileCheck "%s"
+// RUN: %bmc -bound 1 -memory=flat -no-optimize "%s" | FileCheck "%s"
+
+// CHECK: Verification FAILED
+
+// A pointer stored into memory and reloaded as an integer may alias
+// any other pointer, thus the region of its target must not be separated.
+void __VERIFIER_error(void) __attribute__((__noreturn__));
+
+int main(void)
+{
+    int a = 0, b = 0;
+    int *p = &a;
+
+    long addr = *(long *) &p;
+    *(int *) addr = 1;
+    b = 2;
+
+    if (a == 1 && b == 2) {
+        __VERIFIER_error();
+    }
+
+    return 0;
+}
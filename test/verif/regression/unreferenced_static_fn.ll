@@ -0,0 +1,39 @@
+; RUN: %bmc -bound 1 -memory=flat -no-optimize "%s" | FileCheck "%s"
+
+; CHECK: Verification FAILED
+
+; The internal function @reset has no callers, thus it is not reachable from
+; the external calling node of the call graph. The flat memory model still
+; needs a mod/ref summary for it, as every defined function is translated.
+
+@counter = internal global i32 0, align 4
+
+declare i32 @__VERIFIER_nondet_int()
+declare void @__VERIFIER_error()
+
+define internal void @reset(i32* %p) {
+entry:
+  store i32 0, i32* @counter, align 4
+  store i32 0, i32* %p, align 4
+  ret void
+}
+
+define i32 @main() {
+entry:
+  %x = alloca i32, align 4
+  %n = call i32 @__VERIFIER_nondet_int()
+  store i32 %n, i32* %x, align 4
+  store i32 1, i32* @counter, align 4
+  %v = load i32, i32* %x, align 4
+  %c = load i32, i32* @counter, align 4
+  %sum = add i32 %v, %c
+  %cmp = icmp eq i32 %sum, 0
+  br i1 %cmp, label %error, label %exit
+
+error:
+  call void @__VERIFIER_error()
+  unreachable
+
+exit:
+  ret i32 0
+}
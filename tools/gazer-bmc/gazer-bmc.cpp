@@ -44,6 +44,11 @@ namespace
 
     cl::OptionCategory BmcAlgorithmCategory("Bounded model checker algorithm settings");
 
+    cl::opt<bool> LoadModel("load-model",
+        cl::desc("Verify an automata system written by 'gazer-cfa -o' instead of a program."
+                 " Error traces are not available for such inputs."),
+        cl::cat(BmcAlgorithmCategory));
+
     cl::opt<unsigned> MaxBound("bound", cl::desc("Maximum iterations for the bounded model checker"),
         cl::init(100), cl::cat(BmcAlgorithmCategory));
     cl::opt<unsigned> EagerUnroll("eager-unroll", cl::desc("Eager unrolling bound"), cl::init(0),
@@ -91,17 +96,31 @@ int main(int argc, char* argv[])
     llvm::EnableDebugBuffering = true;
     #endif
 
-    // Create the frontend object
     FrontendConfigWrapper config;
+    Z3SolverFactory solverFactory;
+
+    auto bmcSettings = initBmcSettingsFromCommandLine();
+    bmcSettings.simplifyExpr = config.getSettings().simplifyExpr;
+
+    if (LoadModel) {
+        if (InputFilenames.size() != 1) {
+            llvm::errs() << "ERROR: -load-model requires exactly one input file!\n";
+            return 1;
+        }
+
+        // Models have no LLVM counterpart to build traces for.
+        bmcSettings.trace = false;
+
+        BoundedModelChecker bmc(solverFactory, bmcSettings);
+        return VerifyModelFile(InputFilenames[0], config.context, bmc, config.getSettings()) ? 0 : 1;
+    }
+
+    // Create the frontend object
     auto frontend = config.buildFrontend(InputFilenames);
     if (frontend == nullptr) {
         return 1;
     }
 
-    Z3SolverFactory solverFactory;
-
-    auto bmcSettings = initBmcSettingsFromCommandLine();
-    bmcSettings.simplifyExpr = frontend->getSettings().simplifyExpr;
     bmcSettings.trace = frontend->getSettings().trace;
 
     frontend->setBackendAlgorithm(new BoundedModelChecker(solverFactory, bmcSettings));
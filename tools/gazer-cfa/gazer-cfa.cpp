@@ -26,6 +26,7 @@
 #include "gazer/LLVM/Memory/MemoryModel.h"
 
 #include <llvm/IR/Module.h>
+#include <llvm/Support/ToolOutputFile.h>
 
 #ifndef NDEBUG
 #include <llvm/Support/Debug.h>
@@ -42,6 +43,9 @@ namespace
     cl::opt<bool> ViewCfa("view", cl::desc("View the CFA in the system's GraphViz viewier."));
     cl::opt<bool> CyclicCfa("cyclic", cl::desc("Represent LoopRep as cycles instead of recursive calls."));
     cl::opt<bool> RunPipeline("run-pipeline", cl::desc("Run the early stages of the verification pipeline, such as instrumentation."));
+    cl::opt<std::string> OutputModel("o",
+        cl::desc("Write the automata system into <file> in gazer's binary model format instead of printing it."),
+        cl::value_desc("file"));
 }
 
 int main(int argc, char* argv[])
@@ -65,11 +69,26 @@ int main(int argc, char* argv[])
         frontend->getSettings().loops = LoopRepresentation::Cycle;
     }
 
+    std::unique_ptr<llvm::ToolOutputFile> modelOutput;
+    if (!OutputModel.empty()) {
+        std::error_code errorCode;
+        modelOutput = std::make_unique<llvm::ToolOutputFile>(OutputModel, errorCode, llvm::sys::fs::F_None);
+        if (errorCode) {
+            llvm::errs() << "ERROR: " << errorCode.message() << "\n";
+            return 1;
+        }
+    }
+
     if (RunPipeline) {
         frontend->registerVerificationPipeline();
     } else {
         frontend->registerPass(new gazer::MemoryModelWrapperPass(config.context, frontend->getSettings()));
         frontend->registerPass(new gazer::ModuleToAutomataPass(config.context, frontend->getSettings()));
+    }
+
+    if (modelOutput != nullptr) {
+        frontend->registerPass(gazer::createCfaWriterPass(modelOutput->os()));
+    } else if (!RunPipeline) {
         frontend->registerPass(gazer::createCfaPrinterPass());
     }
     
@@ -79,5 +98,9 @@ int main(int argc, char* argv[])
 
     frontend->run();
 
+    if (modelOutput != nullptr) {
+        modelOutput->keep();
+    }
+
     llvm::llvm_shutdown();
 }
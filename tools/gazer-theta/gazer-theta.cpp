@@ -73,6 +73,10 @@ namespace
     cl::opt<std::string> Encoding("encoding", cl::desc("Block encoding"), cl::init("LBE"), cl::cat(ThetaAlgorithmCategory));
     cl::opt<int> MaxEnum("maxenum", cl::desc("Maximal number of explicitly enumerated successors"), cl::init(0), cl::cat(ThetaAlgorithmCategory));
     cl::opt<std::string> InitPrec("initPrec", cl::desc("Initial precision of abstraction"), cl::init("EMPTY"), cl::cat(ThetaAlgorithmCategory));
+    cl::opt<bool> NoHavocDead("no-havoc-dead",
+        cl::desc("Do not havoc the variables which become dead in the generated model"),
+        cl::cat(ThetaAlgorithmCategory)
+    );
 } // end anonymous namespace
 
 namespace gazer
@@ -126,9 +130,19 @@ int main(int argc, char* argv[])
         }
     }
 
+    // Dead variables are havoc'd to keep them out of the abstraction, thus
+    // their values in a counterexample would be meaningless.
+    backendSettings.havocDeadVariables = !NoHavocDead
+        && !config.getSettings().trace
+        && config.getSettings().testHarnessFile.empty();
+
     // Force -math-int
     config.getSettings().ints = IntRepresentation::Integers;
 
+    // Theta works on cyclic automata, thus loops are encoded as cycles directly
+    // instead of being flattened from recursive calls by the CFA generator.
+    config.getSettings().loops = LoopRepresentation::Cycle;
+
     // Create the frontend object
     auto frontend = config.buildFrontend(InputFilenames);
     if (frontend == nullptr) {
@@ -17,17 +17,10 @@
 //===----------------------------------------------------------------------===//
 #include "ThetaCfaGenerator.h"
 #include "gazer/Core/LiteralExpr.h"
+#include "gazer/Automaton/CfaLiveness.h"
 #include "gazer/Automaton/CfaTransforms.h"
 
 #include <llvm/ADT/Twine.h>
-#include <llvm/ADT/DenseSet.h>
-
-#include <boost/algorithm/cxx11/any_of.hpp>
-#include <boost/range/join.hpp>
-
-#include <regex>
-#include <variant>
-#include <llvm/Pass.h>
 
 using namespace gazer;
 using namespace gazer::theta;
@@ -46,172 +39,47 @@ constexpr std::array ThetaKeywords = {
     "mod", "rem", "true", "false"
 };
 
-struct ThetaAst
-{
-    virtual void print(llvm::raw_ostream& os) const = 0;
-
-    virtual ~ThetaAst() = default;
-};
-
-struct ThetaLocDecl : ThetaAst
-{
-    enum Flag
-    {
-        Loc_State,
-        Loc_Init,
-        Loc_Final,
-        Loc_Error,
-    };
-
-    ThetaLocDecl(std::string name, Flag flag = Loc_State)
-        : mName(name), mFlag(flag)
-    {}
-
-    void print(llvm::raw_ostream& os) const override
-    {
-        switch (mFlag) {
-            case Loc_Init:  os << "init "; break;
-            case Loc_Final: os << "final "; break;
-            case Loc_Error: os << "error "; break;
-            default:
-                break;
-        }
-
-        os << "loc " << mName;
-    }
-
-    std::string mName;
-    Flag mFlag;
-};
-
-struct ThetaStmt : ThetaAst
-{
-    using VariantTy = std::variant<ExprPtr, std::pair<std::string, ExprPtr>, std::string>;
-
-    /* implicit */ ThetaStmt(VariantTy content)
-        : mContent(content)
-    {}
-
-    static ThetaStmt Assume(ExprPtr expr)
-    {
-        assert(expr->getType().isBoolType());
-
-        return VariantTy{expr};
-    }
-
-    static ThetaStmt Assign(std::string variableName, ExprPtr value)
-    {
-        assert(!llvm::isa<UndefExpr>(value)
-            && "Cannot assign an undef value to a variable."
-            "Use ::Havoc() to represent a nondetermistic value assignment."
-        );
-
-        std::pair<std::string, ExprPtr> pair = { variableName, value };
-
-        return VariantTy{pair};
-    }
-
-    static ThetaStmt Havoc(std::string variable)
-    {
-        return VariantTy{variable};
-    }
-
-    void print(llvm::raw_ostream& os) const override;
-
-    VariantTy mContent;
-};
-
-struct ThetaEdgeDecl : ThetaAst
-{
-    ThetaEdgeDecl(ThetaLocDecl& source, ThetaLocDecl& target, std::vector<ThetaStmt> stmts)
-        : mSource(source), mTarget(target), mStmts(std::move(stmts))
-    {}
-
-    void print(llvm::raw_ostream& os) const override;
-
-    ThetaLocDecl& mSource;
-    ThetaLocDecl& mTarget;
-    std::vector<ThetaStmt> mStmts;
-};
-
-class ThetaVarDecl : ThetaAst
-{
-public:
-    ThetaVarDecl(std::string name, std::string type)
-        : mName(name), mType(type)
-    {}
-
-    llvm::StringRef getName() { return mName; }
-
-    void print(llvm::raw_ostream& os) const override
-    {
-        os << "var " << mName << " : " << mType;
-    }
-
-private:
-    std::string mName;
-    std::string mType;
-};
+constexpr auto INDENT  = "    ";
+constexpr auto INDENT2 = "        ";
 
 } // end anonymous namespace
 
-void ThetaStmt::print(llvm::raw_ostream& os) const
-{
-    struct PrintVisitor
-    {
-        llvm::raw_ostream& mOS;
-        explicit PrintVisitor(llvm::raw_ostream& os) : mOS(os) {}
-
-        void operator()(const ExprPtr& expr) {
-            mOS << "assume ";
-            mOS << theta::printThetaExpr(expr);
-        }
-
-        void operator()(const std::pair<std::string, ExprPtr>& assign) {
-            mOS << assign.first << " := ";
-            mOS << theta::printThetaExpr(assign.second);
-        }
-
-        void operator()(const std::string& variable) {
-            mOS << "havoc " << variable;
-        }
-    } visitor(os);
-
-    std::visit(visitor, mContent);
-}
-
-void ThetaEdgeDecl::print(llvm::raw_ostream& os) const
-{
-    os << mSource.mName << " -> " << mTarget.mName << " {\n";
-    for (auto& stmt : mStmts) {
-        os << "    ";
-        stmt.print(os);
-        os << "\n";
-    }
-    os << "}\n";
-}
-
-static std::string typeName(Type& type)
+static void printTypeName(Type& type, llvm::raw_ostream& os)
 {
     switch (type.getTypeID()) {
         case Type::IntTypeID:
-            return "int";
+            os << "int";
+            return;
         case Type::RealTypeID:
-            return "rat";
+            os << "rat";
+            return;
         case Type::BoolTypeID:
-            return "bool";
+            os << "bool";
+            return;
         case Type::ArrayTypeID: {
             auto& arrTy = llvm::cast<ArrayType>(type);
-            return "[" + typeName(arrTy.getIndexType()) + "] -> " + typeName(arrTy.getElementType());
+            os << "[";
+            printTypeName(arrTy.getIndexType(), os);
+            os << "] -> ";
+            printTypeName(arrTy.getElementType(), os);
+            return;
         }
         default:
             llvm_unreachable("Types which are unsupported by theta should have been eliminated earlier!");
     }
 }
 
+static void printLocationName(Location* loc, llvm::raw_ostream& os)
+{
+    os << "loc" << loc->getId();
+}
+
 void ThetaCfaGenerator::write(llvm::raw_ostream& os, ThetaNameMapping& nameTrace)
 {
     Cfa* main = mSystem.getMainAutomaton();
+
+    // Adds the unique error location. Loops translated as recursive calls are also
+    // flattened here, if the system was not built with the cyclic loop representation.
     auto recursiveToCyclicResult = TransformRecursiveToCyclic(main);
 
     nameTrace.errorLocation = recursiveToCyclicResult.errorLocation;
@@ -219,136 +87,105 @@ void ThetaCfaGenerator::write(llvm::raw_ostream& os, ThetaNameMapping& nameTrace
     nameTrace.inlinedLocations = std::move(recursiveToCyclicResult.inlinedLocations);
     nameTrace.inlinedVariables = std::move(recursiveToCyclicResult.inlinedVariables);
 
-    llvm::DenseMap<Location*, std::unique_ptr<ThetaLocDecl>> locs;
-    llvm::DenseMap<Variable*, std::unique_ptr<ThetaVarDecl>> vars;
-    std::vector<std::unique_ptr<ThetaEdgeDecl>> edges;
-
-    // Create a closure to test variable names
-    auto isValidVarName = [&vars](const std::string& name) -> bool {
-        // The variable name should not be present in the variable list.
-        return std::find_if(vars.begin(), vars.end(), [name](auto& v1) {
-            return name == v1.second->getName();
-        }) == vars.end();
-    };
+    // The declarations are written directly into the output stream while
+    // walking the automaton. The only state kept is the name of each variable,
+    // as it is needed to print the assignments.
+    NameTable<Variable*>& varNames = nameTrace.variables;
+    for (const char* keyword : ThetaKeywords) {
+        varNames.reserve(keyword);
+    }
 
-    // Add variables
+    // Locals are named first, so they keep their original names on a clash.
     for (auto& variable : main->locals()) {
-        auto name = validName(variable.getName(), isValidVarName);
-        auto type = typeName(variable.getType());
-        
-        nameTrace.variables[name] = &variable;
-        vars.try_emplace(&variable, std::make_unique<ThetaVarDecl>(name, type));
+        varNames.getOrCreateName(&variable, variable.getName());
     }
 
     for (auto& variable : main->inputs()) {
-        auto name = validName(variable.getName(), isValidVarName);
-        auto type = typeName(variable.getType());
+        varNames.getOrCreateName(&variable, variable.getName());
+    }
 
-        nameTrace.variables[name] = &variable;
-        vars.try_emplace(&variable, std::make_unique<ThetaVarDecl>(name, type));
+    // Variables without an entry are printed with their own names.
+    std::function<std::string(Variable*)> canonizeName = [&varNames](Variable* variable) -> std::string {
+        return varNames.getName(variable).str();
+    };
+
+    std::unique_ptr<CfaLiveness> liveness;
+    if (mHavocDeadVariables) {
+        liveness = std::make_unique<CfaLiveness>(*main);
+    }
+
+    os << "main process __gazer_main_process {\n";
+
+    for (auto& variable : llvm::concat<Variable>(main->inputs(), main->locals())) {
+        os << INDENT << "var " << varNames.getName(&variable) << " : ";
+        printTypeName(variable.getType(), os);
+        os << "\n";
     }
 
-    // Add locations
     for (Location* loc : main->nodes()) {
-        ThetaLocDecl::Flag flag = ThetaLocDecl::Loc_State;
+        os << INDENT;
         if (loc == recursiveToCyclicResult.errorLocation) {
-            flag = ThetaLocDecl::Loc_Error;
+            os << "error ";
         } else if (main->getEntry() == loc) {
-            flag = ThetaLocDecl::Loc_Init;
+            os << "init ";
         } else if (main->getExit() == loc) {
-            flag = ThetaLocDecl::Loc_Final;
+            os << "final ";
         }
 
-        auto locName = "loc" + std::to_string(loc->getId());
+        os << "loc ";
+        printLocationName(loc, os);
+        os << "\n";
 
-        nameTrace.locations[locName] = loc;
-        locs.try_emplace(loc, std::make_unique<ThetaLocDecl>(locName, flag));
+        nameTrace.locations[("loc" + llvm::Twine(loc->getId())).str()] = loc;
     }
 
-    // Add edges
     for (Transition* edge : main->edges()) {
-        ThetaLocDecl& source = *locs[edge->getSource()];
-        ThetaLocDecl& target = *locs[edge->getTarget()];
-        
-        std::vector<ThetaStmt> stmts;
-
-        if (edge->getGuard() != BoolLiteralExpr::True(edge->getGuard()->getContext())) {
-            stmts.push_back(ThetaStmt::Assume(edge->getGuard()));
+        os << INDENT;
+        printLocationName(edge->getSource(), os);
+        os << " -> ";
+        printLocationName(edge->getTarget(), os);
+        os << " {\n";
+
+        ExprPtr guard = edge->getGuard();
+        if (guard != BoolLiteralExpr::True(guard->getContext())) {
+            os << INDENT2 << "assume ";
+            theta::printThetaExpr(guard, os, canonizeName);
+            os << "\n";
         }
 
         if (auto assignEdge = dyn_cast<AssignTransition>(edge)) {
             for (auto& assignment : *assignEdge) {
-                auto lhsName = vars[assignment.getVariable()]->getName();
+                llvm::StringRef lhsName = varNames.getName(assignment.getVariable());
+                assert(!lhsName.empty() && "Assignments must target variables of the main automaton!");
 
+                os << INDENT2;
                 if (llvm::isa<UndefExpr>(assignment.getValue())) {
-                    stmts.push_back(ThetaStmt::Havoc(lhsName));
+                    os << "havoc " << lhsName;
                 } else {
-                    stmts.push_back(ThetaStmt::Assign(lhsName, assignment.getValue()));
+                    os << lhsName << " := ";
+                    theta::printThetaExpr(assignment.getValue(), os, canonizeName);
                 }
+                os << "\n";
             }
-        } else if (auto callEdge = dyn_cast<CallTransition>(edge)) {
+        } else if (llvm::isa<CallTransition>(edge)) {
             llvm_unreachable("CallTransitions are not supported in theta CFAs!");
         }
 
-        edges.emplace_back(std::make_unique<ThetaEdgeDecl>(source, target, std::move(stmts)));
-    }
-
-    auto INDENT  = "    ";
-    auto INDENT2 = "        ";
-
-    auto canonizeName = [&vars](Variable* variable) -> std::string {
-        if (vars.count(variable) == 0) {
-            return variable->getName();
-        }
-
-        return vars[variable]->getName();
-    };
-
-    os << "main process __gazer_main_process {\n";
-    
-    for (auto& variable : llvm::concat<Variable>(main->inputs(), main->locals())) {
-        os << INDENT;
-        vars[&variable]->print(os);
-        os << "\n";
-    }
-
-    for (Location* loc : main->nodes()) {
-        os << INDENT;
-        locs[loc]->print(os);
-        os << "\n";
-    }
-
-    for (auto& edge : edges) {
-        os << INDENT << edge->mSource.mName << " -> " << edge->mTarget.mName << " {\n";
-        for (auto& stmt : edge->mStmts) {
-            os << INDENT2;
-            struct PrintVisitor
-            {
-                llvm::raw_ostream& mOS;
-                std::function<std::string(Variable*)> mCanonizeName;
-
-                PrintVisitor(llvm::raw_ostream& os, std::function<std::string(Variable*)> canonizeName)
-                    : mOS(os), mCanonizeName(canonizeName)
-                {}
-
-                void operator()(const ExprPtr& expr) {
-                    mOS << "assume ";
-                    mOS << theta::printThetaExpr(expr, mCanonizeName);
-                }
-
-                void operator()(const std::pair<std::string, ExprPtr>& assign) {
-                    mOS << assign.first << " := ";
-                    mOS << theta::printThetaExpr(assign.second, mCanonizeName);
+        if (liveness != nullptr) {
+            // Variables assigned on this transition are handled by the assignment.
+            llvm::SmallVector<Variable*, 16> liveAtSource;
+            liveness->getLiveVariables(edge->getSource(), liveAtSource);
+            for (Variable* variable : liveAtSource) {
+                bool isAssigned = llvm::any_of(*llvm::cast<AssignTransition>(edge), [variable](auto& assignment) {
+                    return assignment.getVariable() == variable;
+                });
+
+                if (!isAssigned && !liveness->isLiveAt(variable, edge->getTarget())) {
+                    os << INDENT2 << "havoc " << varNames.getName(variable) << "\n";
                 }
-
-                void operator()(const std::string& variable) {
-                    mOS << "havoc " << variable;
-                }
-            } visitor(os, canonizeName);
-
-            std::visit(visitor, stmt.mContent);
-            os << "\n";
+            }
         }
+
         os << INDENT << "}\n";
         os << "\n";
     }
@@ -356,19 +193,3 @@ void ThetaCfaGenerator::write(llvm::raw_ostream& os, ThetaNameMapping& nameTrace
     os << "}\n";
     os.flush();
 }
-
-std::string ThetaCfaGenerator::validName(std::string name, std::function<bool(const std::string&)> isUnique)
-{
-    name = std::regex_replace(name, std::regex("[^a-zA-Z0-9_]"), "_");
-
-    if (std::find(ThetaKeywords.begin(), ThetaKeywords.end(), name) != ThetaKeywords.end()) {
-        name += "_gazer";
-    }
-
-    while (!isUnique(name)) {
-        llvm::Twine nextTry = name + llvm::Twine(mTmpCount++);
-        name = nextTry.str();
-    }
-
-    return name;
-}
@@ -20,6 +20,7 @@
 
 #include "gazer/Automaton/Cfa.h"
 #include "gazer/Automaton/CallGraph.h"
+#include "gazer/ADT/NameTable.h"
 
 #include <llvm/Support/raw_ostream.h>
 
@@ -35,6 +36,12 @@ std::string printThetaExpr(const ExprPtr& expr);
 
 std::string printThetaExpr(const ExprPtr& expr, std::function<std::string(Variable*)> variableNames);
 
+/// Prints \p expr in theta's syntax directly into \p os.
+void printThetaExpr(const ExprPtr& expr, llvm::raw_ostream& os);
+
+void printThetaExpr(
+    const ExprPtr& expr, llvm::raw_ostream& os, std::function<std::string(Variable*)> variableNames);
+
 /// \brief Perform pre-processing steps required by theta on the input CFA.
 ///
 /// This pass does the following transformations:
@@ -45,29 +52,36 @@ void preprocessCfa(Cfa* cfa);
 struct ThetaNameMapping
 {
     llvm::StringMap<Location*> locations;
-    llvm::StringMap<Variable*> variables;
+    NameTable<Variable*> variables;
     Location* errorLocation;
     Variable* errorFieldVariable;
     llvm::DenseMap<Location*, Location*> inlinedLocations;
     llvm::DenseMap<Variable*, Variable*> inlinedVariables;
 };
 
+/// Writes the main automaton of a system as a theta CFA.
+///
+/// The model is emitted in a single pass over the automaton, without building
+/// an intermediate representation. Apart from the returned name mapping, only
+/// the names of the variables are kept in memory.
+///
+/// If \p havocDeadVariables is set, the variables which become dead on a
+/// transition are havoc'd at its end. Their values are then not tracked by
+/// the abstraction where they cannot influence the result anymore, but they
+/// are not meaningful in counterexamples either.
 class ThetaCfaGenerator
 {
 public:
-    ThetaCfaGenerator(AutomataSystem& system)
-        : mSystem(system), mCallGraph(system)
+    explicit ThetaCfaGenerator(AutomataSystem& system, bool havocDeadVariables = false)
+        : mSystem(system), mCallGraph(system), mHavocDeadVariables(havocDeadVariables)
     {}
 
     void write(llvm::raw_ostream& os, ThetaNameMapping& names);
 
-private:
-    std::string validName(std::string name, std::function<bool(const std::string&)> isUnique);
-
 private:
     AutomataSystem& mSystem;
     CallGraph mCallGraph;
-    unsigned mTmpCount = 0;
+    bool mHavocDeadVariables;
 };
 
 llvm::Pass* createThetaCfaWriterPass(llvm::raw_ostream& os);
@@ -16,161 +16,151 @@
 //
 //===----------------------------------------------------------------------===//
 #include "ThetaCfaGenerator.h"
-#include "gazer/Core/Expr/ExprWalker.h"
-#include "gazer/ADT/StringUtils.h"
+#include "gazer/Core/Expr/ExprStreamPrinter.h"
+#include "gazer/Core/LiteralExpr.h"
 
 #include <llvm/Support/raw_ostream.h>
 
-#include <boost/range/irange.hpp>
-
 #include <functional>
 
 using namespace gazer;
 
-class ThetaExprPrinter : public ExprWalker<ThetaExprPrinter, std::string>
+namespace
+{
+
+class ThetaExprPrinter : public ExprStreamPrinter<ThetaExprPrinter>
 {
 public:
-    ThetaExprPrinter(std::function<std::string(Variable*)> replacedNames)
-        : mReplacedNames(replacedNames)
+    ThetaExprPrinter(llvm::raw_ostream& os, std::function<std::string(Variable*)> replacedNames)
+        : ExprStreamPrinter(os), mReplacedNames(std::move(replacedNames))
     {}
 
     /// If there was an expression which could not be handled by
-    /// this walker, returns it. Otherwise returns nullptr.
+    /// this printer, returns it. Otherwise returns nullptr.
     ExprPtr getInvalidExpr() {
         return mUnhandledExpr;
     }
 
 public:
-    std::string visitExpr(const ExprPtr& expr) {
-        mUnhandledExpr = expr;
-        llvm::errs() << "Unhandled expr " << *expr << "\n";
-        return "__UNHANDLED_EXPR__";
-    }
-
-    std::string visitLiteral(const ExprRef<LiteralExpr>& expr)
+    void printAtom(const ExprPtr& expr, llvm::raw_ostream& os)
     {
+        if (auto varRef = llvm::dyn_cast<VarRefExpr>(expr)) {
+            std::string newName = mReplacedNames(&varRef->getVariable());
+            if (!newName.empty()) {
+                os << newName;
+            } else {
+                os << varRef->getVariable().getName();
+            }
+            return;
+        }
+
         if (auto intLit = llvm::dyn_cast<IntLiteralExpr>(expr)) {
             auto val = intLit->getValue();
-            return val < 0 ? "(" + std::to_string(val) + ")" : std::to_string(intLit->getValue());
+            if (val < 0) {
+                os << "(" << val << ")";
+            } else {
+                os << val;
+            }
+            return;
         }
 
         if (auto boolLit = llvm::dyn_cast<BoolLiteralExpr>(expr)) {
-            return boolLit->getValue() ? "true" : "false";
+            os << (boolLit->getValue() ? "true" : "false");
+            return;
         }
 
         if (auto realLit = llvm::dyn_cast<RealLiteralExpr>(expr)) {
             auto val = realLit->getValue();
-            return std::to_string(val.numerator()) + "%" + std::to_string(val.denominator());
+            os << val.numerator() << "%" << val.denominator();
+            return;
         }
 
-        return visitExpr(expr);
+        this->printUnhandled(expr, os);
     }
 
-    std::string visitVarRef(const ExprRef<VarRefExpr>& expr) {
-        std::string newName = mReplacedNames(&expr->getVariable());
-        if (!newName.empty()) {
-            return newName;
+    bool printPrefix(const ExprRef<NonNullaryExpr>& expr, llvm::raw_ostream& os)
+    {
+        switch (expr->getKind()) {
+            case Expr::Not:
+                os << "(not ";
+                return true;
+            case Expr::Select:
+                os << "(if ";
+                return true;
+            case Expr::ArrayRead:
+            case Expr::ArrayWrite:
+                os << "(";
+                return true;
+            default:
+                break;
         }
 
-        return expr->getVariable().getName();
-    }
-
-    std::string visitNot(const ExprRef<NotExpr>& expr) {
-        return "(not " + getOperand(0) + ")";
-    }
-
-    // Binary
-    std::string visitAdd(const ExprRef<AddExpr>& expr) {
-        return "(" + getOperand(0) + " + " + getOperand(1) + ")";
-    }
-
-    std::string visitSub(const ExprRef<SubExpr>& expr) {
-        return "(" + getOperand(0) + " - " + getOperand(1) + ")";
-    }
-
-    std::string visitMul(const ExprRef<MulExpr>& expr) {
-        return "(" + getOperand(0) + " * " + getOperand(1) + ")";
-    }
-
-    std::string visitDiv(const ExprRef<DivExpr>& expr) {
-        return "(" + getOperand(0) + " / " + getOperand(1) + ")";
-    }
+        if (getInfixOperator(expr->getKind()).empty()) {
+            this->printUnhandled(expr, os);
+            return false;
+        }
 
-    std::string visitMod(const ExprRef<ModExpr>& expr) {
-        return "(" + getOperand(0) + " mod " + getOperand(1) + ")";
+        os << "(";
+        return true;
     }
 
-    std::string visitAnd(const ExprRef<AndExpr>& expr)
+    void printSeparator(const ExprRef<NonNullaryExpr>& expr, size_t i, llvm::raw_ostream& os)
     {
-        std::string buffer;
-        llvm::raw_string_ostream rso{buffer};
-
-        rso << "(";
-        auto r = boost::irange<size_t>(0, expr->getNumOperands());
-
-        join_print_as(rso, r.begin(), r.end(), " and ", [this](auto& rso, size_t i) {
-            rso << getOperand(i);
-        });
-        rso << ")";
-
-        return rso.str();
+        switch (expr->getKind()) {
+            case Expr::Select:
+                os << (i == 1 ? " then " : " else ");
+                return;
+            case Expr::ArrayRead:
+            case Expr::ArrayWrite:
+                os << (i == 1 ? ")[" : " <- ");
+                return;
+            default:
+                os << getInfixOperator(expr->getKind());
+                return;
+        }
     }
 
-    std::string visitOr(const ExprRef<OrExpr>& expr)
+    void printSuffix(const ExprRef<NonNullaryExpr>& expr, llvm::raw_ostream& os)
     {
-        std::string buffer;
-        llvm::raw_string_ostream rso{buffer};
-
-        rso << "(";
-        auto r = boost::irange<size_t>(0, expr->getNumOperands());
-
-        join_print_as(rso, r.begin(), r.end(), " or ", [this](auto& rso, size_t i) {
-            rso << getOperand(i);
-        });
-        rso << ")";
-
-
-        return rso.str();
-    }
-
-    std::string visitImply(const ExprRef<ImplyExpr>& expr) {
-        return "(" + getOperand(0) + " imply " + getOperand(1) + ")";
-    }
-
-    std::string visitEq(const ExprRef<EqExpr>& expr) {
-        return "(" + getOperand(0) + " = " + getOperand(1) + ")";
-    }
-    
-    std::string visitNotEq(const ExprRef<NotEqExpr>& expr) {
-        return "(" + getOperand(0) + " /= " + getOperand(1) + ")";
-    }
-
-    std::string visitLt(const ExprRef<LtExpr>& expr) {
-        return "(" + getOperand(0) + " < " + getOperand(1) + ")";
-    }
-
-    std::string visitLtEq(const ExprRef<LtEqExpr>& expr) {
-        return "(" + getOperand(0) + " <= " + getOperand(1) + ")";
-    }
-
-    std::string visitGt(const ExprRef<GtExpr>& expr) {
-        return "(" + getOperand(0) + " > " + getOperand(1) + ")";
-    }
-
-    std::string visitGtEq(const ExprRef<GtEqExpr>& expr) {
-        return "(" + getOperand(0) + " >= " + getOperand(1) + ")";
-    }
-
-    std::string visitSelect(const ExprRef<SelectExpr>& expr) {
-        return "(if " + getOperand(0) + " then " + getOperand(1) + " else " + getOperand(2) + ")";
+        switch (expr->getKind()) {
+            case Expr::ArrayRead:
+            case Expr::ArrayWrite:
+                os << "]";
+                return;
+            default:
+                os << ")";
+                return;
+        }
     }
 
-    std::string visitArrayRead(const ExprRef<ArrayReadExpr>& expr) {
-        return  "(" + getOperand(0) + ")[" + getOperand(1) + "]";
+private:
+    void printUnhandled(const ExprPtr& expr, llvm::raw_ostream& os)
+    {
+        mUnhandledExpr = expr;
+        llvm::errs() << "Unhandled expr " << *expr << "\n";
+        os << "__UNHANDLED_EXPR__";
     }
 
-    std::string visitArrayWrite(const ExprRef<ArrayWriteExpr>& expr) {
-        return  "(" + getOperand(0) + ")[" + getOperand(1) + " <- " + getOperand(2) + "]";
+    static llvm::StringRef getInfixOperator(Expr::ExprKind kind)
+    {
+        switch (kind) {
+            case Expr::Add: return " + ";
+            case Expr::Sub: return " - ";
+            case Expr::Mul: return " * ";
+            case Expr::Div: return " / ";
+            case Expr::Mod: return " mod ";
+            case Expr::And: return " and ";
+            case Expr::Or: return " or ";
+            case Expr::Imply: return " imply ";
+            case Expr::Eq: return " = ";
+            case Expr::NotEq: return " /= ";
+            case Expr::Lt: return " < ";
+            case Expr::LtEq: return " <= ";
+            case Expr::Gt: return " > ";
+            case Expr::GtEq: return " >= ";
+            default:
+                return "";
+        }
     }
 
 private:
@@ -178,15 +168,35 @@ private:
     std::function<std::string(Variable*)> mReplacedNames;
 };
 
+} // end anonymous namespace
+
+void gazer::theta::printThetaExpr(
+    const ExprPtr& expr, llvm::raw_ostream& os, std::function<std::string(Variable*)> variableNames)
+{
+    ThetaExprPrinter printer(os, std::move(variableNames));
+    printer.print(expr);
+}
+
+void gazer::theta::printThetaExpr(const ExprPtr& expr, llvm::raw_ostream& os)
+{
+    // Variables without a replacement are printed with their own names.
+    printThetaExpr(expr, os, [](Variable*) { return std::string(); });
+}
+
 std::string gazer::theta::printThetaExpr(const ExprPtr& expr)
 {
-    auto getName = [](Variable* var) -> std::string { return var->getName(); };
-    return printThetaExpr(expr, getName);
+    std::string buffer;
+    llvm::raw_string_ostream rso{buffer};
+    printThetaExpr(expr, rso);
+
+    return rso.str();
 }
 
 std::string gazer::theta::printThetaExpr(const ExprPtr& expr, std::function<std::string(Variable*)> variableNames)
 {
-    ThetaExprPrinter printer(variableNames);
+    std::string buffer;
+    llvm::raw_string_ostream rso{buffer};
+    printThetaExpr(expr, rso, std::move(variableNames));
 
-    return printer.walk(expr);
-}
\ No newline at end of file
+    return rso.str();
+}
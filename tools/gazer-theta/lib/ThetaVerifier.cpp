@@ -221,11 +221,11 @@ auto ThetaVerifierImpl::execute(llvm::StringRef input) -> std::unique_ptr<Verifi
 
 void ThetaVerifierImpl::writeSystem(llvm::raw_ostream& os)
 {
-    theta::ThetaCfaGenerator generator{mSystem};
+    theta::ThetaCfaGenerator generator{mSystem, mSettings.havocDeadVariables};
     generator.write(os, mNameMapping);
 }
 
-static void reportInvalidCex(llvm::StringRef message, llvm::StringRef cex, sexpr::Value* value = nullptr)
+static void reportInvalidCex(llvm::StringRef message, llvm::StringRef cex, const sexpr::Value* value = nullptr)
 {
     llvm::errs() << "Could not parse theta counterexample: " <<  message << "\n";
     if (value != nullptr) {
@@ -238,23 +238,53 @@ static void reportInvalidCex(llvm::StringRef message, llvm::StringRef cex, sexpr
 
 std::unique_ptr<Trace> ThetaVerifierImpl::parseCex(llvm::StringRef cex, unsigned* errorCode)
 {
-    // TODO: The whole parsing process is very fragile. We should introduce some proper error cheks.
-    auto trace = sexpr::parse(cex);
-    assert(trace->isList());
+    // The parsed atoms point into the counterexample buffer, which outlives this function.
+    sexpr::Arena arena;
+    sexpr::Parser parser(arena);
+    const sexpr::Value* trace = parser.parse(cex);
+    if (trace == nullptr) {
+        reportInvalidCex(parser.getError(), cex);
+        return nullptr;
+    }
+
+    // Checks that `value` is a list of at least `size` elements whose head is the atom `head`.
+    auto isListOf = [](const sexpr::Value* value, llvm::StringRef head, size_t size) {
+        return value->isList() && value->asList().size() >= size
+            && value->asList()[0]->isAtom() && value->asList()[0]->asAtom() == head;
+    };
+
+    if (!isListOf(trace, "Trace", 2)) {
+        reportInvalidCex("expected a 'Trace' list", cex, trace);
+        return nullptr;
+    }
+
+    const sexpr::Value* initState = trace->asList()[1];
+    if (!isListOf(initState, "CfaState", 2) || !initState->asList()[1]->isAtom()) {
+        reportInvalidCex("expected a named initial 'CfaState'", cex, initState);
+        return nullptr;
+    }
 
     std::vector<Location*> states;
     std::vector<std::vector<VariableAssignment>> actions;
-    llvm::StringRef initLocName = trace->asList()[1]->asList()[1]->asAtom();
+    llvm::StringRef initLocName = initState->asList()[1]->asAtom();
 
-    states.push_back(mNameMapping.locations[initLocName]);
+    Location* initLoc = mNameMapping.locations.lookup(initLocName);
+    if (initLoc == nullptr) {
+        reportInvalidCex("unknown location", cex, initState->asList()[1]);
+        return nullptr;
+    }
+
+    states.push_back(initLoc);
 
     for (size_t i = 3; i < trace->asList().size(); i += 2) {
-        auto& stateList = trace->asList()[i]->asList();
-        if (stateList[0]->asAtom() != "CfaState") {
-            reportInvalidCex("expected 'CfaState' atom in list", cex, &*(trace->asList()[i]));
+        const sexpr::Value* state = trace->asList()[i];
+        if (!isListOf(state, "CfaState", 2)) {
+            reportInvalidCex("expected 'CfaState' atom in list", cex, state);
             return nullptr;
         }
 
+        auto stateList = state->asList();
+
         // Theta may insert unnamed locations, thus the format is either
         // (CfaState locName (ExplState ...)) or (CfaState (ExplState ...)).
         // In the latter case, we must skip this location as it is not present
@@ -263,7 +293,12 @@ std::unique_ptr<Trace> ThetaVerifierImpl::parseCex(llvm::StringRef cex, unsigned
             continue;
         }
 
-        auto& actionList = stateList[2]->asList();
+        if (stateList.size() < 3 || !stateList[2]->isList()) {
+            reportInvalidCex("expected an explicit state in 'CfaState'", cex, state);
+            return nullptr;
+        }
+
+        auto actionList = stateList[2]->asList();
 
         if (actionList.size() < 2) {
             // `(CfaState (ExplState))`, nothing to do here.
@@ -271,11 +306,21 @@ std::unique_ptr<Trace> ThetaVerifierImpl::parseCex(llvm::StringRef cex, unsigned
         } else {
             std::vector<VariableAssignment> assigns;
             for (size_t j = 1; j < actionList.size(); ++j) {
-                llvm::StringRef varName = actionList[j]->asList()[0]->asAtom();
-                llvm::StringRef value = actionList[j]->asList()[1]->asAtom();
+                const sexpr::Value* assign = actionList[j];
+                if (!assign->isList() || assign->asList().size() != 2
+                    || !assign->asList()[0]->isAtom() || !assign->asList()[1]->isAtom()) {
+                    reportInvalidCex("expected a (variable value) pair", cex, assign);
+                    return nullptr;
+                }
+
+                llvm::StringRef varName = assign->asList()[0]->asAtom();
+                llvm::StringRef value = assign->asList()[1]->asAtom();
 
                 Variable* variable = mNameMapping.variables.lookup(varName);
-                assert(variable != nullptr && "Each variable must be present in the theta name mapping!");
+                if (variable == nullptr) {
+                    reportInvalidCex("unknown variable", cex, assign->asList()[0]);
+                    return nullptr;
+                }
 
                 Variable* origVariable = mNameMapping.inlinedVariables.lookup(variable);
                 if (origVariable == nullptr) {
@@ -314,7 +359,7 @@ std::unique_ptr<Trace> ThetaVerifierImpl::parseCex(llvm::StringRef cex, unsigned
                 }
 
                 if (rhs == nullptr) {
-                    reportInvalidCex("expected a valid integer or boolean value", cex, &*(actionList[j]->asList()[1]));
+                    reportInvalidCex("expected a valid integer or boolean value", cex, assign->asList()[1]);
                     return nullptr;
                 }
 
@@ -327,6 +372,11 @@ std::unique_ptr<Trace> ThetaVerifierImpl::parseCex(llvm::StringRef cex, unsigned
         llvm::StringRef locName = stateList[1]->asAtom();
 
         Location* loc = mNameMapping.locations.lookup(locName);
+        if (loc == nullptr) {
+            reportInvalidCex("unknown location", cex, stateList[1]);
+            return nullptr;
+        }
+
         Location* origLoc = mNameMapping.inlinedLocations.lookup(loc);
 
         if (origLoc == nullptr) {
@@ -336,25 +386,30 @@ std::unique_ptr<Trace> ThetaVerifierImpl::parseCex(llvm::StringRef cex, unsigned
         states.push_back(origLoc);
     }
 
+    if (actions.empty()) {
+        reportInvalidCex("expected at least one named state after the initial one", cex);
+        return nullptr;
+    }
+
     // Find the value of the error field variable and extract the error code.
     auto& lastAction = actions.back();
     auto errAssign = std::find_if(lastAction.begin(), lastAction.end(), [this](VariableAssignment& assignment) {
         return assignment.getVariable() == mNameMapping.errorFieldVariable;
     });
 
-    assert(errAssign != lastAction.end()
-        && "The error field variable must be present in the last element of the trace!");
-
-    auto errorExpr = llvm::dyn_cast_or_null<LiteralExpr>(errAssign->getValue());
-    assert(errorExpr != nullptr && "The error field must be present in the trace as a literal expression!");
+    if (errAssign == lastAction.end()) {
+        reportInvalidCex("the error field is missing from the last state", cex);
+        return nullptr;
+    }
 
     unsigned ec = 0;
-    if (auto bvLit = llvm::dyn_cast<BvLiteralExpr>(errorExpr)) {
+    if (auto bvLit = llvm::dyn_cast_or_null<BvLiteralExpr>(errAssign->getValue().get())) {
         ec = bvLit->getValue().getLimitedValue();
-    } else if (auto intLit = llvm::dyn_cast<IntLiteralExpr>(errorExpr)) {
+    } else if (auto intLit = llvm::dyn_cast_or_null<IntLiteralExpr>(errAssign->getValue().get())) {
         ec = intLit->getValue();
     } else {
-        llvm_unreachable("Invalid error field type!");
+        reportInvalidCex("the error field must be an integer literal", cex);
+        return nullptr;
     }
 
     *errorCode = ec;
@@ -393,3 +448,30 @@ auto ThetaVerifier::check(AutomataSystem& system, CfaTraceBuilder& traceBuilder)
 
     return impl.execute(outputFile);
 }
+
+void ThetaVerifier::printSettings(llvm::raw_ostream& os) const
+{
+    // The model path only names an output file, it does not affect the result.
+    os << "theta"
+        << " cfa-path=" << mSettings.thetaCfaPath
+        << " lib-path=" << mSettings.thetaLibPath
+        << " timeout=" << mSettings.timeout
+        << " domain=" << mSettings.domain
+        << " refinement=" << mSettings.refinement
+        << " search=" << mSettings.search
+        << " prec-granularity=" << mSettings.precGranularity
+        << " pred-split=" << mSettings.predSplit
+        << " encoding=" << mSettings.encoding
+        << " max-enum=" << mSettings.maxEnum
+        << " init-prec=" << mSettings.initPrec
+        << " havoc-dead=" << mSettings.havocDeadVariables;
+
+    // Theta has no cheap way to query its version, the size and modification
+    // time of its jar identify a build instead.
+    llvm::sys::fs::file_status status;
+    if (!llvm::sys::fs::status(mSettings.thetaCfaPath, status)) {
+        os << " theta-size=" << status.getSize()
+            << " theta-mtime="
+            << status.getLastModificationTime().time_since_epoch().count();
+    }
+}
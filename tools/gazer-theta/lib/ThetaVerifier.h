@@ -41,6 +41,9 @@ struct ThetaSettings
     std::string encoding;
     std::string maxEnum;
     std::string initPrec;
+
+    // Model settings
+    bool havocDeadVariables = false;
 };
 
 class ThetaVerifier : public VerificationAlgorithm
@@ -51,6 +54,7 @@ public:
     {}
 
     std::unique_ptr<VerificationResult> check(AutomataSystem& system, CfaTraceBuilder& traceBuilder) override;
+    void printSettings(llvm::raw_ostream& os) const override;
 private:
     ThetaSettings mSettings;
 };
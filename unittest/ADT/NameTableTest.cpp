@@ -0,0 +1,64 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+#include "gazer/ADT/NameTable.h"
+
+#include <gtest/gtest.h>
+
+using namespace gazer;
+
+namespace
+{
+
+TEST(NameTableTest, SanitizesNames)
+{
+    int a, b, c;
+    NameTable<int*> names;
+
+    EXPECT_EQ(names.getOrCreateName(&a, "main/x.1"), "main_x_1");
+    EXPECT_EQ(names.getOrCreateName(&b, "valid_name0"), "valid_name0");
+
+    NameTable<int*> dotted("_.");
+    EXPECT_EQ(dotted.getOrCreateName(&c, "main/x.1"), "main_x.1");
+}
+
+TEST(NameTableTest, UniquesNames)
+{
+    int keys[5];
+    NameTable<int*> names;
+    names.reserve("int");
+
+    EXPECT_EQ(names.getOrCreateName(&keys[0], "x"), "x");
+    EXPECT_EQ(names.getOrCreateName(&keys[1], "x"), "x0");
+    EXPECT_EQ(names.getOrCreateName(&keys[2], "x"), "x1");
+    EXPECT_EQ(names.getOrCreateName(&keys[3], "x0"), "x00");
+    EXPECT_EQ(names.getOrCreateName(&keys[4], "int"), "int0");
+
+    // Existing names are returned unchanged.
+    EXPECT_EQ(names.getOrCreateName(&keys[1], "y"), "x0");
+    EXPECT_EQ(names.size(), 5u);
+
+    for (int* key : { &keys[0], &keys[1], &keys[2], &keys[3], &keys[4] }) {
+        EXPECT_EQ(names.lookup(names.getName(key)), key);
+    }
+
+    EXPECT_EQ(names.lookup("int"), nullptr);
+    EXPECT_EQ(names.lookup("y"), nullptr);
+    EXPECT_EQ(names.getName(nullptr), "");
+}
+
+} // end anonymous namespace
@@ -0,0 +1,120 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+#include "gazer/Automaton/CfaAbstractInterpretation.h"
+#include "gazer/Core/ExprTypes.h"
+#include "gazer/Core/Expr/ExprBuilder.h"
+
+#include <gtest/gtest.h>
+
+using namespace gazer;
+
+namespace
+{
+
+class CfaAbstractInterpretationTest : public ::testing::Test
+{
+protected:
+    GazerContext context;
+    AutomataSystem system{context};
+    std::unique_ptr<ExprBuilder> builder = CreateFoldingExprBuilder(context);
+    Cfa* cfa = system.createCfa("main");
+};
+
+TEST_F(CfaAbstractInterpretationTest, RemovesInfeasibleErrorAndFoldsConstants)
+{
+    Variable* x = cfa->createLocal("x", BvType::Get(context, 32));
+    Variable* y = cfa->createLocal("y", BvType::Get(context, 32));
+
+    Location* loc1 = cfa->createLocation();
+    Location* err = cfa->createErrorLocation();
+    cfa->addErrorCode(err, builder->BvLit(1, 16));
+
+    cfa->createAssignTransition(cfa->getEntry(), loc1, builder->True(), {
+        { x, builder->BvLit32(5) }
+    });
+    cfa->createAssignTransition(loc1, err, builder->Eq(x->getRefExpr(), builder->BvLit32(6)));
+    cfa->createAssignTransition(loc1, cfa->getExit(), builder->True(), {
+        { y, builder->Add(x->getRefExpr(), builder->BvLit32(1)) }
+    });
+
+    ASSERT_TRUE(SimplifyCfaWithInvariants(*cfa, *builder));
+
+    EXPECT_EQ(0, cfa->getNumErrors());
+    EXPECT_EQ(3, cfa->getNumLocations());
+
+    auto last = llvm::cast<AssignTransition>(*cfa->getExit()->incoming_begin());
+    ASSERT_EQ(1, last->getNumAssignments());
+    EXPECT_EQ(builder->BvLit32(6), last->begin()->getValue());
+}
+
+TEST_F(CfaAbstractInterpretationTest, KnownBitsProveDisequality)
+{
+    Variable* y = cfa->createInput("y", BvType::Get(context, 8));
+    Variable* x = cfa->createLocal("x", BvType::Get(context, 8));
+
+    Location* loc1 = cfa->createLocation();
+    Location* err = cfa->createErrorLocation();
+    cfa->addErrorCode(err, builder->BvLit(1, 16));
+
+    cfa->createAssignTransition(cfa->getEntry(), loc1, builder->True(), {
+        { x, builder->BvOr(y->getRefExpr(), builder->BvLit8(1)) }
+    });
+    cfa->createAssignTransition(loc1, err, builder->Eq(x->getRefExpr(), builder->BvLit8(0)));
+    cfa->createAssignTransition(loc1, cfa->getExit(), builder->NotEq(x->getRefExpr(), builder->BvLit8(0)));
+
+    CfaAbstractInterpreter<KnownBitsDomain> knownBits(*cfa);
+    EXPECT_FALSE(knownBits.isReachable(err));
+
+    ASSERT_TRUE(SimplifyCfaWithInvariants(*cfa, *builder));
+    EXPECT_EQ(0, cfa->getNumErrors());
+}
+
+TEST_F(CfaAbstractInterpretationTest, WideningTerminatesOnLoops)
+{
+    Variable* i = cfa->createLocal("i", BvType::Get(context, 32));
+
+    Location* head = cfa->createLocation();
+    Location* body = cfa->createLocation();
+
+    cfa->createAssignTransition(cfa->getEntry(), head, builder->True(), {
+        { i, builder->BvLit32(0) }
+    });
+    cfa->createAssignTransition(head, body, builder->BvULt(i->getRefExpr(), builder->BvLit32(10)));
+    cfa->createAssignTransition(body, head, builder->True(), {
+        { i, builder->Add(i->getRefExpr(), builder->BvLit32(1)) }
+    });
+    cfa->createAssignTransition(head, cfa->getExit(), builder->BvUGtEq(i->getRefExpr(), builder->BvLit32(10)));
+
+    CfaAbstractInterpreter<IntervalDomain> intervals(*cfa);
+    ASSERT_TRUE(intervals.isReachable(cfa->getExit()));
+
+    // The loop body is only entered with i < 10.
+    auto bodyValue = intervals.getState(body).lookup(i);
+    ASSERT_TRUE(bodyValue.has_value());
+    EXPECT_EQ(llvm::ConstantRange(llvm::APInt(32, 0), llvm::APInt(32, 10)), *bodyValue);
+
+    auto exitValue = intervals.getState(cfa->getExit()).lookup(i);
+    ASSERT_TRUE(exitValue.has_value());
+    EXPECT_EQ(llvm::APInt(32, 10), exitValue->getUnsignedMin());
+
+    // Nothing can be removed, the automaton must stay intact.
+    EXPECT_FALSE(SimplifyCfaWithInvariants(*cfa, *builder));
+    EXPECT_EQ(4, cfa->getNumLocations());
+}
+
+} // end anonymous namespace
@@ -0,0 +1,301 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+#include "gazer/Automaton/CfaPasses.h"
+#include "gazer/Automaton/CfaLiveness.h"
+#include "gazer/Core/ExprTypes.h"
+#include "gazer/Core/Expr/ExprBuilder.h"
+
+#include <llvm/Support/raw_ostream.h>
+
+#include <gtest/gtest.h>
+
+using namespace gazer;
+
+namespace
+{
+
+class CfaPassesTest : public ::testing::Test
+{
+protected:
+    GazerContext context;
+    AutomataSystem system{context};
+    std::unique_ptr<ExprBuilder> builder = CreateExprBuilder(context);
+    Cfa* cfa = system.createCfa("main");
+};
+
+TEST_F(CfaPassesTest, LivenessFollowsReadsAndWrites)
+{
+    Variable* x = cfa->createLocal("x", BvType::Get(context, 32));
+    Variable* y = cfa->createLocal("y", BvType::Get(context, 32));
+    cfa->addOutput(y);
+
+    Location* loc1 = cfa->createLocation();
+    Location* loc2 = cfa->createLocation();
+
+    cfa->createAssignTransition(cfa->getEntry(), loc1, {
+        { x, builder->BvLit32(1) }
+    });
+    cfa->createAssignTransition(loc1, loc2, {
+        { y, builder->Add(x->getRefExpr(), builder->BvLit32(1)) }
+    });
+    cfa->createAssignTransition(loc2, cfa->getExit(), {
+        { x, builder->BvLit32(2) }
+    });
+
+    CfaLiveness liveness(*cfa);
+    EXPECT_FALSE(liveness.isLiveAt(x, cfa->getEntry()));
+    EXPECT_TRUE(liveness.isLiveAt(x, loc1));
+    EXPECT_FALSE(liveness.isLiveAt(x, loc2));
+    EXPECT_FALSE(liveness.isLiveAt(y, loc1));
+    EXPECT_TRUE(liveness.isLiveAt(y, loc2));
+    EXPECT_TRUE(liveness.isLiveAt(y, cfa->getExit()));
+
+    EXPECT_TRUE(liveness.isLiveAnywhere(x));
+    EXPECT_TRUE(liveness.isLiveAnywhere(y));
+
+    llvm::SmallVector<Variable*, 2> live;
+    ASSERT_TRUE(liveness.getLiveVariables(loc1, live));
+    ASSERT_EQ(1, live.size());
+    EXPECT_EQ(x, live[0]);
+
+    live.clear();
+    ASSERT_TRUE(liveness.getLiveVariables(cfa->getEntry(), live));
+    EXPECT_TRUE(live.empty());
+}
+
+TEST_F(CfaPassesTest, SequentialMergeSubstitutesAndDropsDeadAssignments)
+{
+    Variable* a = cfa->createInput("a", BvType::Get(context, 32));
+    Variable* x = cfa->createLocal("x", BvType::Get(context, 32));
+    Variable* y = cfa->createLocal("y", BvType::Get(context, 32));
+    cfa->addOutput(y);
+
+    Location* loc1 = cfa->createLocation();
+    Location* loc2 = cfa->createLocation();
+
+    cfa->createAssignTransition(cfa->getEntry(), loc1, {
+        { x, builder->Add(a->getRefExpr(), builder->BvLit32(1)) }
+    });
+    cfa->createAssignTransition(loc1, loc2, builder->BvSLt(x->getRefExpr(), builder->BvLit32(10)), {
+        { y, builder->Mul(x->getRefExpr(), builder->BvLit32(2)) }
+    });
+    cfa->createAssignTransition(loc2, cfa->getExit());
+
+    auto pass = createSequentialMergePass(*builder);
+    ASSERT_TRUE(pass->run(*cfa));
+
+    ASSERT_EQ(2, cfa->getNumLocations());
+    ASSERT_EQ(1, cfa->getNumTransitions());
+
+    auto edge = llvm::cast<AssignTransition>(*cfa->getEntry()->outgoing_begin());
+    EXPECT_EQ(cfa->getExit(), edge->getTarget());
+
+    ExprPtr xValue = builder->Add(a->getRefExpr(), builder->BvLit32(1));
+    EXPECT_EQ(
+        builder->And(
+            builder->And(builder->True(), builder->BvSLt(xValue, builder->BvLit32(10))),
+            builder->True()
+        ),
+        edge->getGuard()
+    );
+
+    // The assignment of 'x' is not needed after the merged transition.
+    ASSERT_EQ(1, edge->getNumAssignments());
+    EXPECT_EQ(y, edge->begin()->getVariable());
+    EXPECT_EQ(builder->Mul(xValue, builder->BvLit32(2)), edge->begin()->getValue());
+}
+
+TEST_F(CfaPassesTest, SequentialMergeKeepsSelfDependentAssignments)
+{
+    Variable* x = cfa->createInput("x", BvType::Get(context, 32));
+    cfa->addOutput(x);
+
+    Location* loc1 = cfa->createLocation();
+
+    cfa->createAssignTransition(cfa->getEntry(), loc1, {
+        { x, builder->Add(x->getRefExpr(), builder->BvLit32(1)) }
+    });
+    cfa->createAssignTransition(loc1, cfa->getExit(), {
+        { x, builder->Add(x->getRefExpr(), builder->BvLit32(1)) }
+    });
+
+    auto pass = createSequentialMergePass(*builder);
+    EXPECT_FALSE(pass->run(*cfa));
+    EXPECT_EQ(3, cfa->getNumLocations());
+}
+
+TEST_F(CfaPassesTest, SequentialMergeDoesNotSubstituteUndef)
+{
+    Variable* x = cfa->createLocal("x", BvType::Get(context, 32));
+    Variable* y = cfa->createLocal("y", BvType::Get(context, 32));
+    cfa->addOutput(y);
+
+    Location* loc1 = cfa->createLocation();
+
+    cfa->createAssignTransition(cfa->getEntry(), loc1, {
+        { x, builder->Undef(BvType::Get(context, 32)) }
+    });
+    cfa->createAssignTransition(loc1, cfa->getExit(), builder->BvSGt(x->getRefExpr(), builder->BvLit32(0)), {
+        { y, x->getRefExpr() }
+    });
+
+    // The guard and the assignment must read the same nondeterministic value.
+    auto pass = createSequentialMergePass(*builder);
+    EXPECT_FALSE(pass->run(*cfa));
+    EXPECT_EQ(3, cfa->getNumLocations());
+    EXPECT_EQ(2, cfa->getNumTransitions());
+}
+
+TEST_F(CfaPassesTest, ParallelMergeJoinsGuards)
+{
+    Variable* c = cfa->createInput("c", BoolType::Get(context));
+    Variable* d = cfa->createInput("d", BoolType::Get(context));
+    Variable* y = cfa->createLocal("y", BvType::Get(context, 32));
+    cfa->addOutput(y);
+
+    cfa->createAssignTransition(cfa->getEntry(), cfa->getExit(), c->getRefExpr(), {
+        { y, builder->BvLit32(1) }
+    });
+    cfa->createAssignTransition(cfa->getEntry(), cfa->getExit(), d->getRefExpr(), {
+        { y, builder->BvLit32(1) }
+    });
+    cfa->createAssignTransition(cfa->getEntry(), cfa->getExit(), builder->Not(c->getRefExpr()), {
+        { y, builder->BvLit32(2) }
+    });
+
+    auto pass = createParallelMergePass(*builder);
+    ASSERT_TRUE(pass->run(*cfa));
+    ASSERT_EQ(2, cfa->getNumTransitions());
+
+    bool found = false;
+    for (Transition* edge : cfa->getEntry()->outgoing()) {
+        if (edge->getGuard() == builder->Or(c->getRefExpr(), d->getRefExpr())) {
+            found = true;
+            EXPECT_EQ(builder->BvLit32(1), llvm::cast<AssignTransition>(edge)->begin()->getValue());
+        }
+    }
+    EXPECT_TRUE(found);
+}
+
+TEST_F(CfaPassesTest, DeadAssignmentsAreRemoved)
+{
+    Variable* x = cfa->createLocal("x", BvType::Get(context, 32));
+    Variable* y = cfa->createLocal("y", BvType::Get(context, 32));
+    cfa->addOutput(y);
+
+    cfa->createAssignTransition(cfa->getEntry(), cfa->getExit(), {
+        { x, builder->BvLit32(1) },
+        { y, y->getRefExpr() }
+    });
+
+    auto pass = createDeadAssignmentEliminationPass();
+    ASSERT_TRUE(pass->run(*cfa));
+
+    auto edge = llvm::cast<AssignTransition>(*cfa->getEntry()->outgoing_begin());
+    EXPECT_EQ(0, edge->getNumAssignments());
+
+    // 'x' is not referenced anymore, but 'y' is an output.
+    ASSERT_EQ(1, cfa->getNumLocals());
+    EXPECT_EQ(y, &*cfa->local_begin());
+}
+
+TEST_F(CfaPassesTest, CompactionRemovesEmptyTransitionsAndDeadEnds)
+{
+    Variable* c = cfa->createInput("c", BoolType::Get(context));
+
+    Location* loc1 = cfa->createLocation();
+    Location* loc2 = cfa->createLocation();
+    Location* stuck = cfa->createLocation();
+    Location* err = cfa->createErrorLocation();
+    cfa->addErrorCode(err, builder->BvLit(1, 16));
+
+    cfa->createAssignTransition(cfa->getEntry(), loc1, c->getRefExpr());
+    cfa->createAssignTransition(loc1, loc2);
+    cfa->createAssignTransition(loc2, err, c->getRefExpr());
+    cfa->createAssignTransition(loc2, cfa->getExit(), builder->Not(c->getRefExpr()));
+    cfa->createAssignTransition(cfa->getEntry(), stuck, builder->Not(c->getRefExpr()));
+    cfa->createAssignTransition(stuck, stuck);
+
+    auto pass = createLocationCompactionPass(*builder);
+    ASSERT_TRUE(pass->run(*cfa));
+
+    // Neither the exit nor the error location is reachable from 'stuck',
+    // and 'loc1' is bypassed.
+    EXPECT_EQ(4, cfa->getNumLocations());
+    EXPECT_EQ(3, cfa->getNumTransitions());
+    EXPECT_EQ(1, cfa->getNumErrors());
+    EXPECT_EQ(1, cfa->getEntry()->getNumOutgoing());
+}
+
+TEST_F(CfaPassesTest, CompactionKeepsCallsToNonReturningAutomata)
+{
+    // A loop without exits, which may only leave through an error location.
+    Cfa* loop = system.createCfa("main/loop");
+    Variable* c = loop->createInput("c", BoolType::Get(context));
+    Location* err = loop->createErrorLocation();
+    loop->addErrorCode(err, builder->BvLit(1, 16));
+    loop->createAssignTransition(loop->getEntry(), err, c->getRefExpr());
+    loop->createAssignTransition(loop->getEntry(), loop->getExit(), builder->False());
+
+    Variable* d = cfa->createLocal("d", BoolType::Get(context));
+    Location* call = cfa->createLocation();
+    Location* ret = cfa->createLocation();
+    cfa->createAssignTransition(cfa->getEntry(), call, {
+        { d, builder->Undef(BoolType::Get(context)) }
+    });
+    cfa->createCallTransition(call, ret, loop, { { c, d->getRefExpr() } }, {});
+    cfa->createAssignTransition(cfa->getEntry(), cfa->getExit(), builder->False());
+
+    auto pass = createLocationCompactionPass(*builder);
+    pass->run(*cfa);
+
+    ASSERT_EQ(1, call->getNumOutgoing());
+    EXPECT_TRUE((*call->outgoing_begin())->isCall());
+    EXPECT_EQ(1, call->getNumIncoming());
+}
+
+TEST_F(CfaPassesTest, PassManagerReportsStatistics)
+{
+    Variable* x = cfa->createLocal("x", BvType::Get(context, 32));
+    cfa->addOutput(x);
+
+    Location* loc1 = cfa->createLocation();
+    Location* loc2 = cfa->createLocation();
+    cfa->createAssignTransition(cfa->getEntry(), loc1, { { x, builder->BvLit32(1) } });
+    cfa->createAssignTransition(loc1, loc2);
+    cfa->createAssignTransition(loc2, cfa->getExit());
+
+    CfaPassManager passManager;
+    passManager.addPass(createLocationCompactionPass(*builder));
+    passManager.addPass(createSequentialMergePass(*builder));
+    ASSERT_TRUE(passManager.run(system));
+
+    EXPECT_EQ(2, cfa->getNumLocations());
+    EXPECT_EQ(1, cfa->getNumTransitions());
+
+    std::string buffer;
+    llvm::raw_string_ostream rso(buffer);
+    passManager.printStats(rso);
+    rso.flush();
+
+    EXPECT_NE(std::string::npos, buffer.find("Number of locations on start: 4"));
+    EXPECT_NE(std::string::npos, buffer.find("Number of locations on finish: 2"));
+    EXPECT_NE(std::string::npos, buffer.find("Pass location-compaction: changed 1 of 1 automata"));
+}
+
+} // end anonymous namespace
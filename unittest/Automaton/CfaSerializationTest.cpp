@@ -0,0 +1,293 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+#include "gazer/Automaton/CfaSerialization.h"
+#include "gazer/Core/Expr/ExprBuilder.h"
+#include "gazer/Core/Expr/ExprMetrics.h"
+#include "gazer/Core/LiteralExpr.h"
+
+#include <llvm/Support/raw_ostream.h>
+
+#include <gtest/gtest.h>
+
+using namespace gazer;
+
+namespace
+{
+
+class CfaSerializationTest : public ::testing::Test
+{
+protected:
+    CfaSerializationTest()
+        : system(ctx), builder(CreateExprBuilder(ctx))
+    {}
+
+    void buildSystem();
+
+    std::string write()
+    {
+        std::string buffer;
+        llvm::raw_string_ostream rso(buffer);
+        WriteAutomataSystem(system, rso);
+
+        return rso.str();
+    }
+
+    static std::string print(const AutomataSystem& sys)
+    {
+        std::string buffer;
+        llvm::raw_string_ostream rso(buffer);
+        sys.print(rso);
+
+        return rso.str();
+    }
+
+protected:
+    GazerContext ctx;
+    AutomataSystem system;
+    std::unique_ptr<ExprBuilder> builder;
+};
+
+void CfaSerializationTest::buildSystem()
+{
+    auto& bv32 = BvType::Get(ctx, 32);
+    auto& fp64 = FloatType::Get(ctx, FloatType::Double);
+    auto& intTy = IntType::Get(ctx);
+    auto& arrTy = ArrayType::Get(intTy, intTy);
+
+    Cfa* callee = system.createCfa("calc");
+    Variable* a = callee->createInput("a", bv32);
+    Variable* q = callee->createLocal("q", bv32);
+    callee->addOutput(q);
+    callee->createAssignTransition(callee->getEntry(), callee->getExit(), {
+        { q, builder->ZExt(builder->Extract(a->getRefExpr(), 0, 8), bv32) }
+    });
+
+    Cfa* main = system.createCfa("main");
+    Variable* x = main->createInput("x", bv32);
+    Variable* f = main->createLocal("f", fp64);
+    Variable* i = main->createLocal("i", intTy);
+    Variable* arr = main->createLocal("arr", arrTy);
+    Variable* res = main->createLocal("res", bv32);
+
+    Location* l1 = main->createLocation();
+    Location* l2 = main->createLocation();
+    Location* err = main->createErrorLocation();
+    main->addErrorCode(err, builder->IntLit(2));
+
+    ExprPtr shared = builder->Add(x->getRefExpr(), builder->BvLit(0xFFFFFFFF, 32));
+    main->createAssignTransition(main->getEntry(), l1, builder->BvSLt(shared, x->getRefExpr()), {
+        { f, builder->FAdd(f->getRefExpr(), builder->FloatLit(llvm::APFloat(1.5)), llvm::APFloat::rmTowardZero) },
+        { i, builder->Select(builder->Eq(shared, x->getRefExpr()), builder->IntLit(1), builder->Undef(intTy)) },
+        { arr, builder->Write(arr->getRefExpr(), i->getRefExpr(), builder->IntLit(-5)) }
+    });
+    main->createCallTransition(l1, l2, builder->True(), callee, {
+        { a, shared }
+    }, {
+        { res, q->getRefExpr() }
+    });
+    main->createAssignTransition(l2, err, builder->Gt(builder->Read(arr->getRefExpr(), i->getRefExpr()), builder->IntLit(0)));
+    main->createAssignTransition(l2, main->getExit(), builder->Not(builder->Eq(res->getRefExpr(), builder->BvLit(0, 32))));
+
+    system.setMainAutomaton(main);
+}
+
+TEST_F(CfaSerializationTest, TestRoundTrip)
+{
+    buildSystem();
+    std::string data = write();
+
+    GazerContext other;
+    std::string error;
+    auto result = ReadAutomataSystem(llvm::MemoryBufferRef(data, "test"), other, error);
+
+    ASSERT_NE(result, nullptr) << error;
+    EXPECT_EQ(print(*result), print(system));
+    ASSERT_NE(result->getMainAutomaton(), nullptr);
+    EXPECT_EQ(result->getMainAutomaton()->getName(), "main");
+    EXPECT_EQ(result->getMainAutomaton()->getNumErrors(), 1u);
+
+    // The written model should be the same as well.
+    std::string rewritten;
+    llvm::raw_string_ostream rso(rewritten);
+    WriteAutomataSystem(*result, rso);
+    EXPECT_EQ(rso.str(), data);
+}
+
+TEST_F(CfaSerializationTest, TestCallerBeforeCallee)
+{
+    auto& intTy = IntType::Get(ctx);
+
+    // The caller is written first, thus the outputs of the callee are not
+    // known yet when its body is read.
+    Cfa* main = system.createCfa("main");
+    Variable* res = main->createLocal("res", intTy);
+
+    Cfa* callee = system.createCfa("calc");
+    Variable* q = callee->createLocal("q", intTy);
+    callee->addOutput(q);
+    callee->createAssignTransition(callee->getEntry(), callee->getExit(), {
+        { q, builder->IntLit(1) }
+    });
+
+    main->createCallTransition(main->getEntry(), main->getExit(), builder->True(), callee, {}, {
+        { res, q->getRefExpr() }
+    });
+    system.setMainAutomaton(main);
+
+    std::string data = write();
+
+    GazerContext other;
+    std::string error;
+    auto result = ReadAutomataSystem(llvm::MemoryBufferRef(data, "test"), other, error);
+
+    ASSERT_NE(result, nullptr) << error;
+    EXPECT_EQ(print(*result), print(system));
+}
+
+TEST_F(CfaSerializationTest, TestArrayLiterals)
+{
+    auto& intTy = IntType::Get(ctx);
+    auto& arrTy = ArrayType::Get(intTy, intTy);
+
+    ArrayLiteralExpr::Builder arrayLit(arrTy);
+    arrayLit.addValue(builder->IntLit(1), builder->IntLit(-5));
+    arrayLit.addValue(builder->IntLit(2), builder->IntLit(7));
+    arrayLit.setDefault(builder->IntLit(0));
+
+    Cfa* main = system.createCfa("main");
+    Variable* arr = main->createLocal("arr", arrTy);
+    main->createAssignTransition(main->getEntry(), main->getExit(), {
+        { arr, arrayLit.build() }
+    });
+
+    GazerContext other;
+    std::string error;
+    std::string data = write();
+    auto result = ReadAutomataSystem(llvm::MemoryBufferRef(data, "test"), other, error);
+    ASSERT_NE(result, nullptr) << error;
+
+    auto edge = llvm::cast<AssignTransition>(*result->getAutomatonByName("main")->edges().begin());
+    auto value = llvm::dyn_cast<ArrayLiteralExpr>(edge->begin()->getValue());
+    ASSERT_NE(value, nullptr);
+    ASSERT_EQ(value->getMap().size(), 2u);
+    EXPECT_EQ(value->getValue(IntLiteralExpr::Get(other, 2)), IntLiteralExpr::Get(other, 7));
+    EXPECT_EQ(value->getDefault(), IntLiteralExpr::Get(other, 0));
+}
+
+TEST_F(CfaSerializationTest, TestSharedAndDeepExpressions)
+{
+    Cfa* main = system.createCfa("main");
+    Variable* x = main->createLocal("x", IntType::Get(ctx));
+
+    // Each node of this DAG is written once, although the tree it represents
+    // would be of exponential size.
+    ExprPtr expr = x->getRefExpr();
+    for (unsigned i = 0; i < 50000; ++i) {
+        expr = builder->Add(expr, i % 100 == 0 ? expr : builder->IntLit(i));
+    }
+
+    main->createAssignTransition(main->getEntry(), main->getExit(), builder->Lt(expr, builder->IntLit(0)));
+    system.setMainAutomaton(main);
+
+    std::string data = write();
+    EXPECT_LT(data.size(), 8 * ExprMetrics(expr).getDagSize());
+
+    GazerContext other;
+    std::string error;
+    auto result = ReadAutomataSystem(llvm::MemoryBufferRef(data, "test"), other, error);
+    ASSERT_NE(result, nullptr) << error;
+
+    Transition* original = *main->edges().begin();
+    Transition* edge = *result->getMainAutomaton()->edges().begin();
+
+    ExprMetrics expected(original->getGuard());
+    ExprMetrics actual(edge->getGuard());
+    EXPECT_EQ(actual.getDagSize(), expected.getDagSize());
+    EXPECT_EQ(actual.getTreeSize(), expected.getTreeSize());
+}
+
+TEST_F(CfaSerializationTest, TestErrors)
+{
+    buildSystem();
+    std::string data = write();
+
+    auto read = [this](llvm::StringRef input) {
+        GazerContext other;
+        std::string error;
+        auto result = ReadAutomataSystem(llvm::MemoryBufferRef(input, "test"), other, error);
+        EXPECT_EQ(result, nullptr);
+
+        return error;
+    };
+
+    EXPECT_EQ(read(""), "offset 0: not a gazer model file");
+    EXPECT_EQ(read("GZCF\x7f"), "offset 5: unsupported format version 127");
+
+    // Every truncated prefix must be rejected.
+    for (size_t i = 0; i < data.size(); ++i) {
+        EXPECT_NE(read(llvm::StringRef(data).take_front(i)), "") << i;
+    }
+
+    EXPECT_EQ(read(data + "x"), "offset " + std::to_string(data.size()) + ": unexpected data after the end of the model");
+
+    // An expression count which cannot fit into the input is rejected before
+    // allocating anything for it (no automata, types or variables follow).
+    EXPECT_EQ(
+        read(llvm::StringRef("GZCF\x02\x00\x00\x00\xff\xff\xff\xff\xff\x0f", 14)),
+        "offset 14: invalid number of expressions"
+    );
+}
+
+TEST_F(CfaSerializationTest, TestCorruptedTypes)
+{
+    buildSystem();
+    std::string data = write();
+    unsigned numTypeErrors = 0;
+
+    // Changing any single byte must either produce a well-typed system
+    // or be rejected, without tripping the checks of expression builders.
+    for (size_t i = 0; i < data.size(); ++i) {
+        for (unsigned value : { 0u, 1u, 2u, 3u, 5u, 8u, 16u, 32u, 64u, 127u }) {
+            std::string corrupted = data;
+            corrupted[i] = static_cast<char>(value);
+
+            GazerContext other;
+            std::string error;
+            auto result = ReadAutomataSystem(llvm::MemoryBufferRef(corrupted, "test"), other, error);
+            if (result == nullptr) {
+                numTypeErrors += llvm::StringRef(error).contains("type mismatch");
+                continue;
+            }
+
+            for (Cfa& cfa : *result) {
+                for (Transition* edge : cfa.edges()) {
+                    EXPECT_TRUE(edge->getGuard()->getType().isBoolType());
+                    if (auto assign = llvm::dyn_cast<AssignTransition>(edge)) {
+                        for (const VariableAssignment& va : *assign) {
+                            EXPECT_EQ(va.getValue()->getType(), va.getVariable()->getType());
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    EXPECT_NE(numTypeErrors, 0u);
+}
+
+} // end anonymous namespace
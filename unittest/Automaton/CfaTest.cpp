@@ -17,6 +17,7 @@
 //===----------------------------------------------------------------------===//
 #include "gazer/Automaton/Cfa.h"
 #include "gazer/Core/ExprTypes.h"
+#include "gazer/Core/LiteralExpr.h"
 
 #include <llvm/ADT/Twine.h>
 
@@ -82,3 +83,27 @@ TEST(Cfa, CanCreateCfa)
     ASSERT_EQ(loc2, edge1->getTarget());
     ASSERT_EQ(loc3, edge2->getTarget());
 }
+
+TEST(Cfa, RemoveUnreachableLocationsKeepsExit)
+{
+    GazerContext context;
+    AutomataSystem system(context);
+
+    auto cfa = system.createCfa("Test");
+
+    // The exit is only reachable through a location which is not
+    // reachable from the entry.
+    Location* loc2 = cfa->createLocation();
+    Location* loc3 = cfa->createLocation();
+    cfa->createAssignTransition(cfa->getEntry(), loc2);
+    cfa->createAssignTransition(loc3, cfa->getExit());
+
+    cfa->removeUnreachableLocations();
+
+    ASSERT_EQ(3, cfa->getNumLocations());
+    ASSERT_EQ(1, cfa->getExit()->getNumIncoming());
+
+    Transition* edge = *cfa->getExit()->incoming_begin();
+    EXPECT_EQ(cfa->getEntry(), edge->getSource());
+    EXPECT_EQ(BoolLiteralExpr::False(context), edge->getGuard());
+}
@@ -0,0 +1,201 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+#include "gazer/Automaton/CfaTransforms.h"
+#include "gazer/Core/ExprTypes.h"
+#include "gazer/Core/Expr/ExprBuilder.h"
+
+#include <llvm/ADT/SmallPtrSet.h>
+
+#include <gtest/gtest.h>
+
+using namespace gazer;
+
+namespace
+{
+
+class LargeBlockEncodingTest : public ::testing::Test
+{
+protected:
+    GazerContext context;
+    AutomataSystem system{context};
+    std::unique_ptr<ExprBuilder> builder = CreateExprBuilder(context);
+    Cfa* cfa = system.createCfa("main");
+};
+
+TEST_F(LargeBlockEncodingTest, CollapsesDiamond)
+{
+    Variable* c = cfa->createInput("c", BoolType::Get(context));
+    Variable* x = cfa->createLocal("x", BvType::Get(context, 32));
+    Variable* y = cfa->createLocal("y", BvType::Get(context, 32));
+    cfa->addOutput(y);
+
+    Location* loc1 = cfa->createLocation();
+    Location* loc2 = cfa->createLocation();
+    Location* loc3 = cfa->createLocation();
+
+    cfa->createAssignTransition(cfa->getEntry(), loc1, c->getRefExpr(), { { x, builder->BvLit32(1) } });
+    cfa->createAssignTransition(cfa->getEntry(), loc2, builder->Not(c->getRefExpr()), { { x, builder->BvLit32(2) } });
+    cfa->createAssignTransition(loc1, loc3);
+    cfa->createAssignTransition(loc2, loc3);
+    cfa->createAssignTransition(loc3, cfa->getExit(), {
+        { y, builder->Add(x->getRefExpr(), builder->BvLit32(1)) }
+    });
+
+    ASSERT_TRUE(EncodeLargeBlocks(*cfa, *builder));
+
+    ASSERT_EQ(2, cfa->getNumLocations());
+    ASSERT_EQ(1, cfa->getNumTransitions());
+
+    auto edge = llvm::cast<AssignTransition>(*cfa->getEntry()->outgoing_begin());
+    EXPECT_EQ(builder->Or({ c->getRefExpr(), builder->Not(c->getRefExpr()) }), edge->getGuard());
+
+    // 'x' is not live at the exit, only the output is assigned.
+    ASSERT_EQ(1, edge->getNumAssignments());
+    EXPECT_EQ(y, edge->begin()->getVariable());
+    EXPECT_EQ(
+        builder->Add(
+            builder->Select(c->getRefExpr(), builder->BvLit32(1), builder->BvLit32(2)),
+            builder->BvLit32(1)
+        ),
+        edge->begin()->getValue()
+    );
+}
+
+TEST_F(LargeBlockEncodingTest, DoesNotSelectBetweenOverlappingPaths)
+{
+    Variable* c = cfa->createInput("c", BoolType::Get(context));
+    Variable* d = cfa->createInput("d", BoolType::Get(context));
+    Variable* x = cfa->createLocal("x", BvType::Get(context, 32));
+    Variable* y = cfa->createLocal("y", BvType::Get(context, 32));
+    cfa->addOutput(y);
+
+    Location* loc1 = cfa->createLocation();
+    Location* loc2 = cfa->createLocation();
+    Location* loc3 = cfa->createLocation();
+
+    // Both paths may be taken if 'c' and 'd' are true.
+    cfa->createAssignTransition(cfa->getEntry(), loc1, c->getRefExpr(), { { x, builder->BvLit32(1) } });
+    cfa->createAssignTransition(cfa->getEntry(), loc2, d->getRefExpr(), { { x, builder->BvLit32(2) } });
+    cfa->createAssignTransition(loc1, loc3);
+    cfa->createAssignTransition(loc2, loc3);
+    cfa->createAssignTransition(loc3, cfa->getExit(), {
+        { y, builder->Add(x->getRefExpr(), builder->BvLit32(1)) }
+    });
+
+    ASSERT_TRUE(EncodeLargeBlocks(*cfa, *builder));
+
+    // The join point becomes a cut point, reached by a transition for each path.
+    ASSERT_EQ(3, cfa->getNumLocations());
+    ASSERT_EQ(3, cfa->getNumTransitions());
+    ASSERT_EQ(2, loc3->getNumIncoming());
+
+    llvm::SmallPtrSet<Expr*, 2> values;
+    for (Transition* edge : loc3->incoming()) {
+        auto assign = llvm::cast<AssignTransition>(edge);
+        ASSERT_EQ(1, assign->getNumAssignments());
+        EXPECT_EQ(x, assign->begin()->getVariable());
+        values.insert(assign->begin()->getValue().get());
+    }
+    EXPECT_EQ(2, values.size());
+}
+
+TEST_F(LargeBlockEncodingTest, DoesNotSubstituteUndef)
+{
+    Variable* x = cfa->createLocal("x", BvType::Get(context, 32));
+    Variable* y = cfa->createLocal("y", BvType::Get(context, 32));
+    cfa->addOutput(y);
+
+    Location* loc1 = cfa->createLocation();
+    Location* loc2 = cfa->createLocation();
+
+    cfa->createAssignTransition(cfa->getEntry(), loc1);
+    cfa->createAssignTransition(loc1, loc2, { { x, builder->Undef(BvType::Get(context, 32)) } });
+    cfa->createAssignTransition(loc2, cfa->getExit(), builder->BvSGt(x->getRefExpr(), builder->BvLit32(0)), {
+        { y, x->getRefExpr() }
+    });
+
+    ASSERT_TRUE(EncodeLargeBlocks(*cfa, *builder));
+
+    // The nondeterministic value is stored in 'x', so the guard
+    // and the assignment of 'y' read the same value.
+    ASSERT_EQ(3, cfa->getNumLocations());
+    ASSERT_EQ(1, loc2->getNumOutgoing());
+
+    auto edge = llvm::cast<AssignTransition>(*loc2->outgoing_begin());
+    EXPECT_EQ(builder->BvSGt(x->getRefExpr(), builder->BvLit32(0)), edge->getGuard());
+    EXPECT_EQ(x->getRefExpr(), edge->begin()->getValue());
+
+    auto entry = llvm::cast<AssignTransition>(*cfa->getEntry()->outgoing_begin());
+    ASSERT_EQ(1, entry->getNumAssignments());
+    EXPECT_EQ(builder->Undef(BvType::Get(context, 32)), entry->begin()->getValue());
+}
+
+TEST_F(LargeBlockEncodingTest, KeepsLoopHeadsAndCallSites)
+{
+    Cfa* callee = system.createCfa("callee");
+    callee->createAssignTransition(callee->getEntry(), callee->getExit());
+
+    Variable* i = cfa->createLocal("i", BvType::Get(context, 32));
+
+    Location* head = cfa->createLocation();
+    Location* body = cfa->createLocation();
+    Location* latch = cfa->createLocation();
+    Location* call = cfa->createLocation();
+    Location* ret = cfa->createLocation();
+
+    cfa->createAssignTransition(cfa->getEntry(), head, { { i, builder->BvLit32(0) } });
+    cfa->createAssignTransition(head, body, builder->BvSLt(i->getRefExpr(), builder->BvLit32(10)));
+    cfa->createAssignTransition(body, latch, { { i, builder->Add(i->getRefExpr(), builder->BvLit32(1)) } });
+    cfa->createAssignTransition(latch, head);
+    cfa->createAssignTransition(head, call, builder->BvSGtEq(i->getRefExpr(), builder->BvLit32(10)));
+    cfa->createCallTransition(call, ret, callee, {}, {});
+    cfa->createAssignTransition(ret, cfa->getExit());
+
+    ASSERT_TRUE(EncodeLargeBlocks(*cfa, *builder));
+
+    // The entry, exit, loop head and the endpoints of the call remain.
+    EXPECT_EQ(5, cfa->getNumLocations());
+    EXPECT_EQ(5, cfa->getNumTransitions());
+
+    Transition* loop = nullptr;
+    for (Transition* edge : head->outgoing()) {
+        if (edge->getTarget() == head) {
+            loop = edge;
+        }
+    }
+    ASSERT_NE(nullptr, loop);
+    EXPECT_EQ(builder->BvSLt(i->getRefExpr(), builder->BvLit32(10)), loop->getGuard());
+
+    auto assign = llvm::cast<AssignTransition>(loop);
+    ASSERT_EQ(1, assign->getNumAssignments());
+    EXPECT_EQ(builder->Add(i->getRefExpr(), builder->BvLit32(1)), assign->begin()->getValue());
+
+    EXPECT_EQ(1, call->getNumOutgoing());
+    EXPECT_TRUE((*call->outgoing_begin())->isCall());
+}
+
+TEST_F(LargeBlockEncodingTest, DoesNotChangeAutomataWithoutInnerLocations)
+{
+    Variable* c = cfa->createInput("c", BoolType::Get(context));
+    cfa->createAssignTransition(cfa->getEntry(), cfa->getExit(), c->getRefExpr());
+
+    EXPECT_FALSE(EncodeLargeBlocks(*cfa, *builder));
+    EXPECT_EQ(1, cfa->getNumTransitions());
+}
+
+} // end anonymous namespace
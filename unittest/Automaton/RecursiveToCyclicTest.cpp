@@ -0,0 +1,121 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+#include "gazer/Automaton/CfaTransforms.h"
+#include "gazer/Automaton/CallGraph.h"
+#include "gazer/Core/ExprTypes.h"
+#include "gazer/Core/Expr/ExprBuilder.h"
+
+#include <gtest/gtest.h>
+
+using namespace gazer;
+
+namespace
+{
+
+class RecursiveToCyclicTest : public ::testing::Test
+{
+protected:
+    GazerContext context;
+    AutomataSystem system{context};
+    std::unique_ptr<ExprBuilder> builder = CreateExprBuilder(context);
+
+    Cfa* main = nullptr;
+    Cfa* loop = nullptr;
+    Variable* mainX = nullptr;
+    Variable* mainR = nullptr;
+    Variable* loopI = nullptr;
+    Variable* loopRes = nullptr;
+
+    void SetUp() override
+    {
+        // The loop: loop(i) { if (i < 10) loop(i + 1) else return i }
+        loop = system.createCfa("loop");
+        loopI = loop->createInput("i", IntType::Get(context));
+        loopRes = loop->createLocal("res", IntType::Get(context));
+        loop->addOutput(loopRes);
+
+        Location* body = loop->createLocation();
+        loop->createAssignTransition(loop->getEntry(), body);
+        loop->createCallTransition(
+            body, loop->getExit(), builder->Lt(loopI->getRefExpr(), builder->IntLit(10)), loop,
+            { { loopI, builder->Add(loopI->getRefExpr(), builder->IntLit(1)) } },
+            { { loopRes, loopRes->getRefExpr() } }
+        );
+        loop->createAssignTransition(
+            body, loop->getExit(), builder->GtEq(loopI->getRefExpr(), builder->IntLit(10)),
+            { { loopRes, loopI->getRefExpr() } }
+        );
+
+        main = system.createCfa("main");
+        mainX = main->createLocal("x", IntType::Get(context));
+        mainR = main->createLocal("r", IntType::Get(context));
+
+        system.setMainAutomaton(main);
+    }
+};
+
+TEST_F(RecursiveToCyclicTest, SplicesSingleCallInPlace)
+{
+    main->createCallTransition(
+        main->getEntry(), main->getExit(), builder->True(), loop,
+        { { loopI, mainX->getRefExpr() } },
+        { { mainR, loopRes->getRefExpr() } }
+    );
+
+    ASSERT_TRUE(CallGraph(system).isTailRecursive(loop));
+
+    auto result = TransformRecursiveToCyclic(main);
+
+    for (Transition* edge : main->edges()) {
+        EXPECT_FALSE(llvm::isa<CallTransition>(edge));
+    }
+
+    // The variables of the loop are taken over by the main automaton.
+    std::vector<Variable*> locals;
+    for (Variable& local : main->locals()) {
+        locals.push_back(&local);
+    }
+    EXPECT_NE(locals.end(), std::find(locals.begin(), locals.end(), loopI));
+    EXPECT_NE(locals.end(), std::find(locals.begin(), locals.end(), loopRes));
+    EXPECT_TRUE(result.inlinedVariables.empty());
+    EXPECT_EQ(loop->getNumLocations(), result.inlinedLocations.size());
+}
+
+TEST_F(RecursiveToCyclicTest, ClonesRepeatedCalls)
+{
+    Location* middle = main->createLocation();
+    for (auto [source, target] : { std::make_pair(main->getEntry(), middle), std::make_pair(middle, main->getExit()) }) {
+        main->createCallTransition(
+            source, target, builder->True(), loop,
+            { { loopI, mainX->getRefExpr() } },
+            { { mainR, loopRes->getRefExpr() } }
+        );
+    }
+
+    auto result = TransformRecursiveToCyclic(main);
+
+    for (Transition* edge : main->edges()) {
+        EXPECT_FALSE(llvm::isa<CallTransition>(edge));
+    }
+
+    // The second call gets its own copy of the input variable.
+    EXPECT_FALSE(result.inlinedVariables.empty());
+    EXPECT_EQ(2 * loop->getNumLocations(), result.inlinedLocations.size());
+}
+
+} // end anonymous namespace
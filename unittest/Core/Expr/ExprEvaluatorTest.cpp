@@ -260,4 +260,131 @@ TEST_F(ExprEvalTest, TestSignedCompareBv)
 }
 
 #undef TRUE_COMPARE
-#undef FALSE_COMPARE
\ No newline at end of file
+#undef FALSE_COMPARE
+namespace
+{
+
+class RecordingEvaluator : public ValuationExprEvaluator
+{
+public:
+    using ValuationExprEvaluator::ValuationExprEvaluator;
+
+    std::vector<std::string> Visited;
+
+protected:
+    ExprRef<AtomicExpr> getVariableValue(Variable& variable) override
+    {
+        Visited.push_back(variable.getName());
+        return ValuationExprEvaluator::getVariableValue(variable);
+    }
+};
+
+} // end anonymous namespace
+
+TEST_F(ExprEvalTest, TestShortCircuitEvaluation)
+{
+    auto vb = Valuation::CreateBuilder();
+    vb.put(&a->getVariable(), builder->BoolLit(false));
+    vb.put(&b->getVariable(), builder->BoolLit(true));
+    vb.put(&x->getVariable(), builder->BvLit(1, 32));
+    vb.put(&y->getVariable(), builder->BvLit(2, 32));
+    auto valuation = vb.build();
+
+    using Names = std::vector<std::string>;
+
+    {
+        RecordingEvaluator eval(valuation);
+        EXPECT_EQ(eval.evaluate(builder->And({b, a, c, d})), builder->False());
+        EXPECT_EQ(eval.Visited, (Names{"b", "a"}));
+    }
+    {
+        RecordingEvaluator eval(valuation);
+        EXPECT_EQ(eval.evaluate(builder->Or({a, b, c})), builder->True());
+        EXPECT_EQ(eval.Visited, (Names{"a", "b"}));
+    }
+    {
+        RecordingEvaluator eval(valuation);
+        EXPECT_EQ(eval.evaluate(builder->Imply(a, c)), builder->True());
+        EXPECT_EQ(eval.Visited, (Names{"a"}));
+    }
+    {
+        RecordingEvaluator eval(valuation);
+        auto lit = eval.evaluate(builder->Select(b, x, builder->Add(y, z)));
+        ASSERT_TRUE(llvm::isa<BvLiteralExpr>(lit));
+        EXPECT_EQ(llvm::cast<BvLiteralExpr>(lit)->getValue(), llvm::APInt(32, 1));
+        EXPECT_EQ(eval.Visited, (Names{"b", "x"}));
+    }
+    {
+        RecordingEvaluator eval(valuation);
+        auto lit = eval.evaluate(builder->Select(a, builder->Add(x, z), y));
+        ASSERT_TRUE(llvm::isa<BvLiteralExpr>(lit));
+        EXPECT_EQ(llvm::cast<BvLiteralExpr>(lit)->getValue(), llvm::APInt(32, 2));
+        EXPECT_EQ(eval.Visited, (Names{"a", "y"}));
+    }
+    {
+        // Undefined operands do not stop the evaluation.
+        RecordingEvaluator eval(valuation);
+        EXPECT_EQ(eval.evaluate(builder->And({c, a})), builder->False());
+        EXPECT_EQ(eval.Visited, (Names{"c", "a"}));
+    }
+}
+
+namespace
+{
+
+class CountingModel : public ExprEvaluator
+{
+public:
+    explicit CountingModel(const Valuation& valuation)
+        : mEval(valuation)
+    {}
+
+    ExprRef<AtomicExpr> evaluate(const ExprPtr& expr) override
+    {
+        ++NumQueries;
+        return mEval.evaluate(expr);
+    }
+
+    unsigned NumQueries = 0;
+
+private:
+    ValuationExprEvaluator mEval;
+};
+
+} // end anonymous namespace
+
+TEST_F(ExprEvalTest, TestCachingEvaluator)
+{
+    auto vb = Valuation::CreateBuilder();
+    vb.put(&x->getVariable(), builder->BvLit(1, 32));
+    vb.put(&y->getVariable(), builder->BvLit(2, 32));
+    auto valuation = vb.build();
+
+    CountingModel model(valuation);
+    CachingExprEvaluator eval(model);
+
+    auto sum = builder->Add(x, y);
+    auto expr = builder->Mul(sum, builder->Add(sum, x));
+
+    auto lit = eval.evaluate(expr);
+    ASSERT_TRUE(llvm::isa<BvLiteralExpr>(lit));
+    EXPECT_EQ(llvm::cast<BvLiteralExpr>(lit)->getValue(), llvm::APInt(32, 12));
+    EXPECT_EQ(model.NumQueries, 2u);
+
+    // Repeated queries are answered from the cache.
+    EXPECT_EQ(eval.evaluate(sum), builder->BvLit(3, 32));
+    EXPECT_EQ(eval.evaluate(expr), lit);
+    EXPECT_EQ(model.NumQueries, 2u);
+
+    llvm::SmallVector<ExprRef<AtomicExpr>, 3> values;
+    eval.evaluateAll({&x->getVariable(), &y->getVariable(), &z->getVariable()}, values);
+    ASSERT_EQ(values.size(), 3u);
+    EXPECT_EQ(values[0], builder->BvLit(1, 32));
+    EXPECT_EQ(values[1], builder->BvLit(2, 32));
+    EXPECT_TRUE(values[2]->isUndef());
+    EXPECT_EQ(model.NumQueries, 3u);
+
+    eval.invalidate();
+    eval.evaluate(sum);
+    EXPECT_EQ(model.NumQueries, 5u);
+}
@@ -0,0 +1,100 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+#include "gazer/Core/Expr/ExprMetrics.h"
+#include "gazer/Core/Expr/ExprUtils.h"
+#include "gazer/Core/Expr/ExprBuilder.h"
+
+#include <gtest/gtest.h>
+
+using namespace gazer;
+
+namespace
+{
+
+TEST(ExprMetricsTest, TestSharedDag)
+{
+    GazerContext context;
+    auto builder = CreateExprBuilder(context);
+
+    auto x = context.createVariable("x", BvType::Get(context, 32))->getRefExpr();
+    auto y = context.createVariable("y", BvType::Get(context, 32))->getRefExpr();
+
+    // x + y, shared twice on each level.
+    ExprPtr expr = builder->Add(x, y);
+    for (unsigned i = 0; i < 3; ++i) {
+        expr = builder->Mul(expr, expr);
+    }
+
+    ExprMetrics metrics(expr);
+
+    EXPECT_EQ(metrics.getDepth(), 5u);
+    EXPECT_EQ(metrics.getDagSize(), 6u);
+    EXPECT_EQ(metrics.getTreeSize(), 8u * 3u + 7u);
+    EXPECT_EQ(metrics.getTreeCost(), 7u * ExprMetrics::getOperatorWeight(Expr::Mul) + 8u * 3u);
+    EXPECT_EQ(metrics.getNumNodesOfKind(Expr::Mul), 3u);
+    EXPECT_EQ(metrics.getNumNodesOfKind(Expr::Add), 1u);
+    EXPECT_EQ(metrics.getNumNodesOfKind(Expr::VarRef), 2u);
+    EXPECT_EQ(metrics.getNumNodesOfKind(Expr::And), 0u);
+
+    ASSERT_EQ(metrics.getSupport().size(), 2u);
+    EXPECT_EQ(metrics.getSupport()[0], &x->getVariable());
+    EXPECT_EQ(metrics.getSupport()[1], &y->getVariable());
+
+    EXPECT_EQ(metrics.getDepthOf(x), 1u);
+    EXPECT_EQ(metrics.getTreeSizeOf(builder->Add(x, y)), 3u);
+    EXPECT_EQ(metrics.getTreeCostOf(builder->Add(x, y)), 3u);
+    EXPECT_GT(ExprMetrics::getOperatorWeight(Expr::BvUDiv), ExprMetrics::getOperatorWeight(Expr::ArrayRead));
+    EXPECT_GT(ExprMetrics::getOperatorWeight(Expr::ArrayRead), ExprMetrics::getOperatorWeight(Expr::Add));
+    EXPECT_EQ(ExprDepth(expr), 5u);
+}
+
+TEST(ExprMetricsTest, TestMultipleRoots)
+{
+    GazerContext context;
+    auto builder = CreateExprBuilder(context);
+
+    auto a = context.createVariable("a", BoolType::Get(context))->getRefExpr();
+    auto b = context.createVariable("b", BoolType::Get(context))->getRefExpr();
+    auto c = context.createVariable("c", BoolType::Get(context))->getRefExpr();
+
+    ExprMetrics metrics;
+    metrics.add(builder->And(a, b));
+    metrics.add(builder->Or(builder->And(a, b), c));
+
+    EXPECT_EQ(metrics.getDepth(), 3u);
+    EXPECT_EQ(metrics.getDagSize(), 5u);
+    EXPECT_EQ(metrics.getTreeSize(), 3u + 5u);
+    EXPECT_EQ(metrics.getSupport().size(), 3u);
+}
+
+TEST(ExprMetricsTest, TestDeepExpr)
+{
+    GazerContext context;
+    auto builder = CreateExprBuilder(context);
+
+    ExprPtr expr = context.createVariable("a", BoolType::Get(context))->getRefExpr();
+    for (unsigned i = 0; i < 100000; ++i) {
+        expr = builder->Not(expr);
+    }
+
+    ExprMetrics metrics(expr);
+    EXPECT_EQ(metrics.getDepth(), 100001u);
+    EXPECT_EQ(metrics.getDagSize(), 100001u);
+}
+
+} // end anonymous namespace
@@ -27,12 +27,13 @@ using namespace gazer;
 namespace
 {
 
-::testing::AssertionResult printEquals(const std::string& expected, const ExprPtr& expr, unsigned radix = 10)
+::testing::AssertionResult printEquals(
+    const std::string& expected, const ExprPtr& expr, unsigned radix = 10, bool useLetBindings = false)
 {
     std::string buff;
     llvm::raw_string_ostream rso{buff};
 
-    InfixPrintExpr(expr, rso, radix);
+    InfixPrintExpr(expr, rso, radix, useLetBindings);
     rso.flush();
 
     if (expected == buff) {
@@ -126,3 +127,58 @@ TEST(InfixPrintExpr, TestPrintNot)
     EXPECT_TRUE(printEquals("not true", e1));
     EXPECT_TRUE(printEquals("not (true and false)", e2));
 }
+
+TEST(InfixPrintExpr, TestPrintSelect)
+{
+    GazerContext ctx;
+    auto builder = CreateExprBuilder(ctx);
+
+    auto x = ctx.createVariable("x", BvType::Get(ctx, 8))->getRefExpr();
+    auto e1 = builder->Select(builder->Eq(x, builder->BvLit(0, 8)), x, builder->BvLit(1, 8));
+    auto e2 = builder->Imply(builder->True(), builder->False());
+
+    EXPECT_TRUE(printEquals("if (x = 0bv8) then x else 1bv8", e1));
+    EXPECT_TRUE(printEquals("true imply false", e2));
+}
+
+TEST(InfixPrintExpr, TestPrintLetBindings)
+{
+    GazerContext ctx;
+    auto builder = CreateExprBuilder(ctx);
+
+    auto x = ctx.createVariable("x", BvType::Get(ctx, 8))->getRefExpr();
+    auto y = ctx.createVariable("y", BvType::Get(ctx, 8))->getRefExpr();
+
+    auto sum = builder->Add(x, y);
+    auto twice = builder->Mul(sum, sum);
+    auto expr = builder->And(builder->Eq(twice, x), builder->Eq(twice, y));
+
+    EXPECT_TRUE(printEquals("(x + y * x + y = x) and (x + y * x + y = y)", expr));
+    EXPECT_TRUE(printEquals(
+        "let t0 = x + y in\n"
+        "let t1 = t0 * t0 in\n"
+        "(t1 = x) and (t1 = y)",
+        expr, 10, true
+    ));
+
+    // Expressions without shared subterms are printed as usual.
+    EXPECT_TRUE(printEquals("x + y", sum, 10, true));
+}
+
+TEST(InfixPrintExpr, TestPrintDeepExpr)
+{
+    GazerContext ctx;
+    auto builder = CreateExprBuilder(ctx);
+
+    // Deep expressions must not overflow the call stack.
+    ExprPtr expr = builder->True();
+    for (unsigned i = 0; i < 100000; ++i) {
+        expr = builder->Not(expr);
+    }
+
+    std::string buff;
+    llvm::raw_string_ostream rso{buff};
+    InfixPrintExpr(expr, rso);
+
+    EXPECT_EQ(rso.str().size(), 100000 * std::string("not ").size() + 99999 * 2 + 4);
+}
@@ -0,0 +1,134 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+#include "gazer/Core/Expr/ExprRewrite.h"
+#include "gazer/Core/Expr/ExprBuilder.h"
+#include "gazer/Core/LiteralExpr.h"
+
+#include <llvm/Support/raw_ostream.h>
+
+#include <gtest/gtest.h>
+
+using namespace gazer;
+
+namespace
+{
+
+std::string exprToString(const ExprPtr& expr)
+{
+    std::string buffer;
+    llvm::raw_string_ostream rso(buffer);
+    rso << *expr;
+
+    return rso.str();
+}
+
+TEST(ExprImporterTest, TestImportIntoOtherContext)
+{
+    GazerContext source;
+    GazerContext target;
+    auto sb = CreateExprBuilder(source);
+    auto tb = CreateExprBuilder(target);
+
+    auto& fp64 = FloatType::Get(source, FloatType::Double);
+    auto& arrTy = ArrayType::Get(BvType::Get(source, 8), IntType::Get(source));
+
+    Variable* x = source.createVariable("x", BvType::Get(source, 8));
+    Variable* y = source.createVariable("y", IntType::Get(source));
+    Variable* a = source.createVariable("a", arrTy);
+
+    Variable* tx = target.createVariable("x", BvType::Get(target, 8));
+    Variable* ty = target.createVariable("y", IntType::Get(target));
+    Variable* ta = target.createVariable("a", ArrayType::Get(BvType::Get(target, 8), IntType::Get(target)));
+
+    ArrayLiteralExpr::Builder arrBuilder(arrTy);
+    arrBuilder.addValue(sb->BvLit8(1), sb->IntLit(10));
+    arrBuilder.setDefault(sb->IntLit(0));
+
+    auto rm = llvm::APFloat::rmNearestTiesToEven;
+    auto fp = sb->SignedToFp(sb->ZExt(x->getRefExpr(), BvType::Get(source, 32)), fp64, rm);
+    auto cast = sb->FpToSigned(fp, BvType::Get(source, 16), rm);
+
+    auto read = sb->Read(sb->Write(a->getRefExpr(), x->getRefExpr(), y->getRefExpr()), sb->BvLit8(2));
+    auto expr = sb->And({
+        sb->Eq(sb->Extract(cast, 0, 8), x->getRefExpr()),
+        sb->Eq(sb->Add(read, sb->IntLit(1)), sb->Undef(IntType::Get(source))),
+        sb->Eq(sb->Read(arrBuilder.build(), x->getRefExpr()), y->getRefExpr())
+    });
+
+    ExprImporter importer(*tb);
+    importer[x] = tx;
+    importer[y] = ty;
+    importer[a] = ta;
+
+    auto result = importer.import(expr);
+
+    EXPECT_EQ(&result->getContext(), &target);
+    EXPECT_EQ(exprToString(result), exprToString(expr));
+
+    // The result must be built from the target's variables and types.
+    auto and1 = llvm::cast<NonNullaryExpr>(result)->getOperand(0);
+    auto eq = llvm::cast<NonNullaryExpr>(and1);
+    EXPECT_EQ(eq->getOperand(1), tx->getRefExpr());
+
+    auto extract = llvm::cast<NonNullaryExpr>(eq->getOperand(0));
+    EXPECT_EQ(&extract->getOperand(0)->getType(), &BvType::Get(target, 16));
+
+    // Importing again yields the same uniqued expression.
+    EXPECT_EQ(importer.import(expr), result);
+}
+
+TEST(ExprImporterTest, TestSharedSubexpressions)
+{
+    GazerContext source;
+    GazerContext target;
+    auto sb = CreateExprBuilder(source);
+    auto tb = CreateExprBuilder(target);
+
+    Variable* x = source.createVariable("x", BvType::Get(source, 32));
+    Variable* tx = target.createVariable("x", BvType::Get(target, 32));
+
+    ExprPtr shared = sb->Add(x->getRefExpr(), sb->BvLit32(1));
+    auto expr = sb->Mul(shared, sb->Sub(shared, x->getRefExpr()));
+
+    ExprImporter importer(*tb);
+    importer[x] = tx;
+
+    auto result = llvm::cast<NonNullaryExpr>(importer.import(expr));
+    auto rhs = llvm::cast<NonNullaryExpr>(result->getOperand(1));
+
+    EXPECT_EQ(result->getOperand(0), rhs->getOperand(0));
+    EXPECT_EQ(rhs->getOperand(1), tx->getRefExpr());
+}
+
+TEST(ExprImporterTest, TestImportType)
+{
+    GazerContext source;
+    GazerContext target;
+    auto tb = CreateExprBuilder(target);
+
+    ExprImporter importer(*tb);
+
+    auto& arrTy = ArrayType::Get(BvType::Get(source, 32), FloatType::Get(source, FloatType::Single));
+    auto& result = importer.importType(arrTy);
+
+    EXPECT_EQ(&result.getContext(), &target);
+    EXPECT_EQ(&result, &ArrayType::Get(BvType::Get(target, 32), FloatType::Get(target, FloatType::Single)));
+    EXPECT_EQ(&importer.importType(BoolType::Get(source)), &BoolType::Get(target));
+}
+
+} // namespace
@@ -0,0 +1,211 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+#include "gazer/LLVM/Analysis/PDG.h"
+
+#include <llvm/Analysis/AssumptionCache.h>
+#include <llvm/Analysis/BasicAliasAnalysis.h>
+#include <llvm/Analysis/TargetLibraryInfo.h>
+#include <llvm/AsmParser/Parser.h>
+#include <llvm/IR/Dominators.h>
+#include <llvm/IR/InstIterator.h>
+#include <llvm/IR/Instructions.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Support/SourceMgr.h>
+
+#include <gtest/gtest.h>
+
+using namespace gazer;
+
+namespace
+{
+
+class PDGTest : public ::testing::Test
+{
+protected:
+    void setUp(const char* moduleStr)
+    {
+        module = llvm::parseAssemblyString(moduleStr, error, llvmContext);
+        if (module == nullptr) {
+            error.print("PDGTest", llvm::errs());
+            FAIL() << "Failed to construct LLVM module!\n";
+            return;
+        }
+
+        function = module->getFunction("main");
+        tli = std::make_unique<llvm::TargetLibraryInfo>(tlii);
+        ac = std::make_unique<llvm::AssumptionCache>(*function);
+        dt = std::make_unique<llvm::DominatorTree>(*function);
+        pdt = std::make_unique<llvm::PostDominatorTree>(*function);
+
+        basicAA = std::make_unique<llvm::BasicAAResult>(module->getDataLayout(), *function, *tli, *ac, &*dt);
+        aa = std::make_unique<llvm::AAResults>(*tli);
+        aa->addAAResult(*basicAA);
+        mssa = std::make_unique<llvm::MemorySSA>(*function, &*aa, &*dt);
+
+        pdg = ProgramDependenceGraph::Create(*function, *pdt, *mssa, *aa);
+    }
+
+    /// Returns the store instruction writing the constant \p value.
+    llvm::Instruction* store(uint64_t value)
+    {
+        for (llvm::Instruction& inst : llvm::instructions(*function)) {
+            if (auto st = llvm::dyn_cast<llvm::StoreInst>(&inst)) {
+                auto ci = llvm::dyn_cast<llvm::ConstantInt>(st->getValueOperand());
+                if (ci != nullptr && ci->getZExtValue() == value) {
+                    return st;
+                }
+            }
+        }
+        return nullptr;
+    }
+
+    llvm::Instruction* inst(llvm::StringRef name)
+    {
+        for (llvm::Instruction& inst : llvm::instructions(*function)) {
+            if (inst.getName() == name) {
+                return &inst;
+            }
+        }
+        return nullptr;
+    }
+
+    std::vector<llvm::Instruction*> memoryDeps(llvm::Instruction* target)
+    {
+        std::vector<llvm::Instruction*> result;
+        for (PDGEdge* edge : pdg->getNode(target)->incoming()) {
+            if (edge->getKind() == PDGEdge::Memory) {
+                result.push_back(edge->getSource()->getInstruction());
+            }
+        }
+        std::sort(result.begin(), result.end());
+        return result;
+    }
+
+    static std::vector<llvm::Instruction*> sorted(std::vector<llvm::Instruction*> insts)
+    {
+        std::sort(insts.begin(), insts.end());
+        return insts;
+    }
+
+protected:
+    llvm::LLVMContext llvmContext;
+    llvm::SMDiagnostic error;
+    std::unique_ptr<llvm::Module> module;
+    llvm::Function* function = nullptr;
+
+    llvm::TargetLibraryInfoImpl tlii;
+    std::unique_ptr<llvm::TargetLibraryInfo> tli;
+    std::unique_ptr<llvm::AssumptionCache> ac;
+    std::unique_ptr<llvm::DominatorTree> dt;
+    std::unique_ptr<llvm::PostDominatorTree> pdt;
+    std::unique_ptr<llvm::BasicAAResult> basicAA;
+    std::unique_ptr<llvm::AAResults> aa;
+    std::unique_ptr<llvm::MemorySSA> mssa;
+    std::unique_ptr<ProgramDependenceGraph> pdg;
+};
+
+TEST_F(PDGTest, MemoryEdgesFollowAliasing)
+{
+    setUp(R"ASM(
+@a = global i32 0, align 4
+@b = global i32 0, align 4
+
+define i32 @main(i1 %c, i32* %p) {
+entry:
+  store i32 1, i32* @a, align 4
+  store i32 2, i32* @b, align 4
+  %x = load i32, i32* @a, align 4
+  br i1 %c, label %then, label %exit
+
+then:
+  store i32 3, i32* @a, align 4
+  store i32 4, i32* %p, align 4
+  br label %exit
+
+exit:
+  %y = load i32, i32* @a, align 4
+  %z = load i32, i32* @b, align 4
+  %s1 = add i32 %x, %y
+  %s2 = add i32 %s1, %z
+  ret i32 %s2
+}
+)ASM");
+
+    // The store to @b does not alias @a.
+    EXPECT_EQ(memoryDeps(inst("x")), sorted({ store(1) }));
+
+    // Both stores to @a may reach %y. The store through %p may alias @a,
+    // but it does not hide the store before it.
+    EXPECT_EQ(memoryDeps(inst("y")), sorted({ store(1), store(3), store(4) }));
+
+    // The stores to @a do not alias @b, the one through %p might.
+    EXPECT_EQ(memoryDeps(inst("z")), sorted({ store(2), store(4) }));
+
+    // Stores do not read memory.
+    EXPECT_TRUE(memoryDeps(store(3)).empty());
+
+    EXPECT_EQ(pdg->node_size(), 12);
+}
+
+TEST_F(PDGTest, MustAliasStoreHidesEarlierStores)
+{
+    setUp(R"ASM(
+@a = global i32 0, align 4
+
+define i32 @main() {
+entry:
+  store i32 1, i32* @a, align 4
+  store i32 2, i32* @a, align 4
+  %x = load i32, i32* @a, align 4
+  ret i32 %x
+}
+)ASM");
+
+    EXPECT_EQ(memoryDeps(inst("x")), sorted({ store(2) }));
+}
+
+TEST_F(PDGTest, LoopCarriedDependencies)
+{
+    setUp(R"ASM(
+@a = global i32 0, align 4
+
+define void @main(i32 %n) {
+entry:
+  store i32 0, i32* @a, align 4
+  br label %loop
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i1, %loop ]
+  %x = load i32, i32* @a, align 4
+  %x1 = add i32 %x, 1
+  store i32 %x1, i32* @a, align 4
+  %i1 = add i32 %i, 1
+  %cond = icmp slt i32 %i1, %n
+  br i1 %cond, label %loop, label %exit
+
+exit:
+  ret void
+}
+)ASM");
+
+    llvm::Instruction* loopStore = inst("x1")->user_back();
+    EXPECT_EQ(memoryDeps(inst("x")), sorted({ store(0), loopStore }));
+}
+
+} // end anonymous namespace
@@ -0,0 +1,147 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+#include "../../../src/LLVM/Automaton/LoopUseInfo.h"
+
+#include <llvm/AsmParser/Parser.h>
+#include <llvm/IR/Dominators.h>
+#include <llvm/IR/InstIterator.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Support/SourceMgr.h>
+
+#include <gtest/gtest.h>
+
+using namespace gazer::llvm2cfa;
+
+namespace
+{
+
+const char* NestedLoops = R"ASM(
+define i32 @main(i32 %x) {
+entry:
+  br label %outer
+outer:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %outer.latch ]
+  %a = add i32 %i, 1
+  br label %inner
+inner:
+  %j = phi i32 [ 0, %outer ], [ %j.next, %inner ]
+  %b = add i32 %a, %j
+  %j.next = add i32 %j, 1
+  %c1 = icmp slt i32 %j.next, 10
+  br i1 %c1, label %inner, label %outer.latch
+outer.latch:
+  %u = add i32 %b, 0
+  %i.next = add i32 %i, %u
+  %c2 = icmp slt i32 %i.next, 10
+  br i1 %c2, label %outer, label %exit
+exit:
+  %r = add i32 %i.next, %x
+  ret i32 %r
+}
+)ASM";
+
+class LoopUseInfoTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        module = llvm::parseAssemblyString(NestedLoops, error, llvmContext);
+        ASSERT_NE(module, nullptr);
+
+        function = module->getFunction("main");
+        dt = std::make_unique<llvm::DominatorTree>(*function);
+        loopInfo = std::make_unique<llvm::LoopInfo>(*dt);
+        useInfo = std::make_unique<LoopUseInfo>(*function, *loopInfo);
+
+        outer = loopInfo->getLoopFor(block("outer"));
+        inner = loopInfo->getLoopFor(block("inner"));
+        ASSERT_EQ(inner->getParentLoop(), outer);
+    }
+
+    llvm::BasicBlock* block(llvm::StringRef name)
+    {
+        for (llvm::BasicBlock& bb : *function) {
+            if (bb.getName() == name) {
+                return &bb;
+            }
+        }
+        return nullptr;
+    }
+
+    llvm::Instruction* inst(llvm::StringRef name)
+    {
+        for (llvm::Instruction& inst : llvm::instructions(*function)) {
+            if (inst.getName() == name) {
+                return &inst;
+            }
+        }
+        return nullptr;
+    }
+
+protected:
+    llvm::LLVMContext llvmContext;
+    llvm::SMDiagnostic error;
+    std::unique_ptr<llvm::Module> module;
+    llvm::Function* function = nullptr;
+    std::unique_ptr<llvm::DominatorTree> dt;
+    std::unique_ptr<llvm::LoopInfo> loopInfo;
+    std::unique_ptr<LoopUseInfo> useInfo;
+    llvm::Loop* outer = nullptr;
+    llvm::Loop* inner = nullptr;
+};
+
+TEST_F(LoopUseInfoTest, BlockRanges)
+{
+    EXPECT_TRUE(useInfo->contains(outer, block("outer")));
+    EXPECT_TRUE(useInfo->contains(outer, block("inner")));
+    EXPECT_TRUE(useInfo->contains(outer, block("outer.latch")));
+    EXPECT_FALSE(useInfo->contains(outer, block("entry")));
+    EXPECT_FALSE(useInfo->contains(outer, block("exit")));
+    EXPECT_FALSE(useInfo->contains(inner, block("outer.latch")));
+
+    EXPECT_TRUE(useInfo->containsDirectly(outer, block("outer.latch")));
+    EXPECT_FALSE(useInfo->containsDirectly(outer, block("inner")));
+    EXPECT_TRUE(useInfo->containsDirectly(inner, block("inner")));
+}
+
+TEST_F(LoopUseInfoTest, Inputs)
+{
+    EXPECT_TRUE(useInfo->isDefinedOutside(inner, inst("a")));
+    EXPECT_FALSE(useInfo->isDefinedOutside(inner, inst("j")));
+    EXPECT_FALSE(useInfo->isDefinedOutside(outer, inst("b")));
+    EXPECT_TRUE(useInfo->isDefinedOutside(outer, &*function->arg_begin()));
+    EXPECT_FALSE(useInfo->isDefinedOutside(outer, inst("u")->getOperand(1)));
+}
+
+TEST_F(LoopUseInfoTest, Uses)
+{
+    EXPECT_TRUE(useInfo->hasUsesOutside(inner, inst("b")));
+    EXPECT_FALSE(useInfo->hasUsesOutside(outer, inst("b")));
+    EXPECT_FALSE(useInfo->hasUsesOutside(inner, inst("j.next")));
+    EXPECT_TRUE(useInfo->hasUsesOutside(outer, inst("i.next")));
+    EXPECT_FALSE(useInfo->hasUsesOutside(inner, inst("c1")));
+
+    EXPECT_TRUE(useInfo->hasUsesDirectlyIn(outer, inst("b")));
+    EXPECT_FALSE(useInfo->hasUsesDirectlyIn(outer, inst("j")));
+    EXPECT_TRUE(useInfo->hasUsesDirectlyIn(inner, inst("a")));
+    EXPECT_TRUE(useInfo->hasUsesDirectlyIn(nullptr, inst("i.next")));
+    EXPECT_FALSE(useInfo->hasUsesDirectlyIn(nullptr, inst("a")));
+}
+
+} // end anonymous namespace
@@ -17,6 +17,7 @@
 //===----------------------------------------------------------------------===//
 #include "gazer/LLVM/Memory/MemoryObject.h"
 #include "gazer/LLVM/Memory/MemoryModel.h"
+#include "gazer/LLVM/Memory/MemorySSA.h"
 
 #include <llvm/AsmParser/Parser.h>
 #include <llvm/Support/SourceMgr.h>
@@ -113,4 +114,83 @@ bb8:                                              ; preds = %bb6
     // TODO
 }
 
-} // end anonymous namespace
\ No newline at end of file
+TEST_F(MemoryObjectTest, MemorySSAPlacesOnlyLivePhis)
+{
+    setUp(R"ASM(
+@a = global i32 0, align 4
+@b = global i32 0, align 4
+
+define i32 @main(i32 %n) {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i1, %body ]
+  %c = icmp slt i32 %i, %n
+  br i1 %c, label %body, label %exit
+
+body:
+  %x = load i32, i32* @a, align 4
+  %y = add i32 %x, 1
+  store i32 %y, i32* @a, align 4
+  store i32 %i, i32* @b, align 4
+  %i1 = add i32 %i, 1
+  br label %loop
+
+exit:
+  %r = load i32, i32* @a, align 4
+  ret i32 %r
+}
+)ASM");
+
+    llvm::Function* main = module->getFunction("main");
+    auto blockNamed = [main](llvm::StringRef name) -> llvm::BasicBlock* {
+        for (llvm::BasicBlock& bb : *main) {
+            if (bb.getName() == name) { return &bb; }
+        }
+        return nullptr;
+    };
+
+    llvm::BasicBlock* loop = blockNamed("loop");
+    llvm::BasicBlock* body = blockNamed("body");
+    llvm::BasicBlock* exit = blockNamed("exit");
+
+    memory::MemorySSABuilder builder(*main, module->getDataLayout(), *analyses->dtMap[main]);
+    MemoryObject* a = builder.createMemoryObject(
+        0, MemoryObjectType::Scalar, 4, llvm::Type::getInt32Ty(llvmContext), "a");
+    MemoryObject* b = builder.createMemoryObject(
+        1, MemoryObjectType::Scalar, 4, llvm::Type::getInt32Ty(llvmContext), "b");
+
+    builder.createLiveOnEntryDef(a);
+    builder.createLiveOnEntryDef(b);
+
+    auto load = llvm::cast<llvm::LoadInst>(&*body->begin());
+    auto storeA = llvm::cast<llvm::StoreInst>(load->getNextNode()->getNextNode());
+    auto storeB = llvm::cast<llvm::StoreInst>(storeA->getNextNode());
+    auto exitLoad = llvm::cast<llvm::LoadInst>(&*exit->begin());
+
+    builder.createLoadUse(a, *load);
+    builder.createStoreDef(a, *storeA);
+    builder.createStoreDef(b, *storeB);
+    builder.createLoadUse(a, *exitLoad);
+
+    auto memorySSA = builder.build();
+
+    // 'a' is live at the loop header, thus it needs a PHI node.
+    // 'b' is never read, so its PHI node would be dead.
+    llvm::SmallVector<memory::PhiDef*, 2> phis;
+    memorySSA->memoryAccessOfKind(loop, phis);
+    ASSERT_EQ(phis.size(), 1u);
+    EXPECT_EQ(phis[0]->getObject(), a);
+
+    MemoryObjectDef* storeDef = memorySSA->getUniqueDefinitionFor(storeA, a);
+    ASSERT_NE(storeDef, nullptr);
+    EXPECT_EQ(phis[0]->getIncomingDefForBlock(body), storeDef);
+    EXPECT_EQ(memorySSA->getUniqueDefinitionFor(storeA, b), nullptr);
+
+    EXPECT_EQ(memorySSA->getUniqueUseFor(load, a)->getReachingDef(), phis[0]);
+    EXPECT_EQ(memorySSA->getUniqueUseFor(exitLoad, a)->getReachingDef(), phis[0]);
+    EXPECT_EQ(memorySSA->getUniqueUseFor(exitLoad, b), nullptr);
+}
+
+} // end anonymous namespace
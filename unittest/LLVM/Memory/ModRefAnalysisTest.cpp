@@ -0,0 +1,223 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+#include "gazer/LLVM/Memory/ModRefAnalysis.h"
+
+#include <llvm/Analysis/CallGraph.h>
+#include <llvm/AsmParser/Parser.h>
+#include <llvm/Support/SourceMgr.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+
+#include <gtest/gtest.h>
+
+using namespace gazer;
+using namespace gazer::memory;
+
+namespace
+{
+
+class ModRefAnalysisTest : public ::testing::Test
+{
+protected:
+    void setUp(const char* moduleStr)
+    {
+        module = llvm::parseAssemblyString(moduleStr, error, llvmContext);
+        if (module == nullptr) {
+            error.print("ModRefAnalysisTest", llvm::errs());
+            FAIL() << "Failed to construct LLVM module!\n";
+            return;
+        }
+
+        // Each global variable is its own location, everything else is location zero.
+        unsigned numLocations = 1;
+        for (llvm::GlobalVariable& gv : module->globals()) {
+            locations[&gv] = numLocations++;
+        }
+
+        cg = std::make_unique<llvm::CallGraph>(*module);
+        modRef = std::make_unique<ModRefAnalysis>(*cg, numLocations, [this](const llvm::Value* ptr) {
+            return locations.lookup(ptr->stripPointerCasts());
+        });
+    }
+
+    const ModRefSummary& summary(llvm::StringRef function) {
+        return modRef->getSummary(module->getFunction(function));
+    }
+
+    unsigned loc(llvm::StringRef global) {
+        return locations.lookup(module->getGlobalVariable(global));
+    }
+
+protected:
+    llvm::LLVMContext llvmContext;
+    llvm::SMDiagnostic error;
+    std::unique_ptr<llvm::Module> module;
+    std::unique_ptr<llvm::CallGraph> cg;
+    std::unique_ptr<ModRefAnalysis> modRef;
+    llvm::DenseMap<const llvm::Value*, unsigned> locations;
+};
+
+TEST_F(ModRefAnalysisTest, PropagatesCalleeEffects)
+{
+    setUp(R"ASM(
+@a = global i32 0, align 4
+@b = global i32 0, align 4
+@c = global i32 0, align 4
+
+declare void @external()
+
+define void @writeA() {
+  store i32 1, i32* @a, align 4
+  ret void
+}
+
+define i32 @readB() {
+  %x = load i32, i32* @b, align 4
+  call void @external()
+  ret i32 %x
+}
+
+define i32 @middle() {
+  call void @writeA()
+  %x = call i32 @readB()
+  ret i32 %x
+}
+
+define i32 @main() {
+  %x = call i32 @middle()
+  %y = load i32, i32* @c, align 4
+  ret i32 %x
+}
+)ASM");
+
+    EXPECT_TRUE(summary("writeA").mod.test(loc("a")));
+    EXPECT_FALSE(summary("writeA").ref.test(loc("a")));
+    EXPECT_FALSE(summary("writeA").accesses(loc("b")));
+
+    EXPECT_TRUE(summary("readB").ref.test(loc("b")));
+    EXPECT_FALSE(summary("readB").mod.test(loc("b")));
+
+    EXPECT_TRUE(summary("middle").mod.test(loc("a")));
+    EXPECT_TRUE(summary("middle").ref.test(loc("b")));
+    EXPECT_FALSE(summary("middle").accesses(loc("c")));
+
+    EXPECT_TRUE(summary("main").mod.test(loc("a")));
+    EXPECT_TRUE(summary("main").ref.test(loc("b")));
+    EXPECT_TRUE(summary("main").ref.test(loc("c")));
+    EXPECT_FALSE(summary("main").mod.test(loc("c")));
+}
+
+TEST_F(ModRefAnalysisTest, RecursiveFunctionsShareSummaries)
+{
+    setUp(R"ASM(
+@a = global i32 0, align 4
+@b = global i32 0, align 4
+@c = global i32 0, align 4
+
+define void @even(i32 %n) {
+  store i32 %n, i32* @a, align 4
+  %c = icmp eq i32 %n, 0
+  br i1 %c, label %exit, label %rec
+rec:
+  %m = sub i32 %n, 1
+  call void @odd(i32 %m)
+  br label %exit
+exit:
+  ret void
+}
+
+define void @odd(i32 %n) {
+  %x = load i32, i32* @b, align 4
+  call void @even(i32 %n)
+  ret void
+}
+
+define void @main() {
+  %p = alloca i32, align 4
+  call void @even(i32 10)
+  ret void
+}
+)ASM");
+
+    for (auto name : { "even", "odd", "main" }) {
+        EXPECT_TRUE(summary(name).mod.test(loc("a"))) << name;
+        EXPECT_TRUE(summary(name).ref.test(loc("b"))) << name;
+        EXPECT_FALSE(summary(name).accesses(loc("c"))) << name;
+    }
+
+    // Allocations are local to the allocating function.
+    EXPECT_TRUE(summary("main").local.test(0));
+    EXPECT_FALSE(summary("main").accesses(0));
+}
+
+TEST_F(ModRefAnalysisTest, IndirectCallsAccessEverything)
+{
+    setUp(R"ASM(
+@a = global i32 0, align 4
+@fp = global void ()* null, align 8
+
+define void @caller() {
+  %f = load void ()*, void ()** @fp, align 8
+  call void %f()
+  ret void
+}
+)ASM");
+
+    EXPECT_TRUE(summary("caller").mod.test(loc("a")));
+    EXPECT_TRUE(summary("caller").ref.test(loc("a")));
+}
+
+TEST_F(ModRefAnalysisTest, UnreferencedInternalFunctions)
+{
+    setUp(R"ASM(
+@a = global i32 0, align 4
+@b = global i32 0, align 4
+
+define internal void @writeB() {
+  store i32 2, i32* @b, align 4
+  ret void
+}
+
+define internal void @unused() {
+  store i32 1, i32* @a, align 4
+  call void @writeB()
+  ret void
+}
+
+define internal void @unusedRec() {
+  %x = load i32, i32* @a, align 4
+  call void @unusedRec()
+  ret void
+}
+
+define i32 @main() {
+  call void @writeB()
+  ret i32 0
+}
+)ASM");
+
+    EXPECT_TRUE(summary("unused").mod.test(loc("a")));
+    EXPECT_TRUE(summary("unused").mod.test(loc("b")));
+    EXPECT_TRUE(summary("unusedRec").ref.test(loc("a")));
+    EXPECT_FALSE(summary("unusedRec").accesses(loc("b")));
+
+    EXPECT_TRUE(summary("writeB").mod.test(loc("b")));
+    EXPECT_FALSE(summary("writeB").accesses(loc("a")));
+}
+
+} // namespace
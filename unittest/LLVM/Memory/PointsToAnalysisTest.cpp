@@ -0,0 +1,230 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+#include "gazer/LLVM/Memory/PointsToAnalysis.h"
+
+#include <llvm/AsmParser/Parser.h>
+#include <llvm/Support/SourceMgr.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+#include <llvm/IR/InstIterator.h>
+
+#include <gtest/gtest.h>
+
+using namespace gazer;
+using namespace gazer::memory;
+
+namespace
+{
+
+class PointsToAnalysisTest : public ::testing::Test
+{
+protected:
+    void setUp(const char* moduleStr)
+    {
+        module = llvm::parseAssemblyString(moduleStr, error, llvmContext);
+        if (module == nullptr) {
+            error.print("PointsToAnalysisTest", llvm::errs());
+            FAIL() << "Failed to construct LLVM module!\n";
+            return;
+        }
+
+        pta = std::make_unique<PointsToAnalysis>(*module);
+    }
+
+    llvm::Value* getValue(llvm::StringRef function, llvm::StringRef name)
+    {
+        for (llvm::Instruction& inst : llvm::instructions(module->getFunction(function))) {
+            if (inst.getName() == name) {
+                return &inst;
+            }
+        }
+
+        return nullptr;
+    }
+
+protected:
+    llvm::LLVMContext llvmContext;
+    llvm::SMDiagnostic error;
+    std::unique_ptr<llvm::Module> module;
+    std::unique_ptr<PointsToAnalysis> pta;
+};
+
+TEST_F(PointsToAnalysisTest, DistinctAllocationsHaveDistinctRegions)
+{
+    setUp(R"ASM(
+@g = global i32 0, align 4
+
+define i32 @main() {
+entry:
+  %a = alloca i32, align 4
+  %b = alloca [4 x i32], align 4
+  %b1 = getelementptr inbounds [4 x i32], [4 x i32]* %b, i32 0, i32 1
+  store i32 1, i32* %a, align 4
+  store i32 2, i32* %b1, align 4
+  store i32 3, i32* @g, align 4
+  %x = load i32, i32* %a, align 4
+  ret i32 %x
+}
+)ASM");
+
+    auto a = getValue("main", "a");
+    auto b = getValue("main", "b");
+    auto b1 = getValue("main", "b1");
+    auto g = module->getGlobalVariable("g");
+
+    EXPECT_NE(pta->getRegionFor(a), pta->getRegionFor(b));
+    EXPECT_NE(pta->getRegionFor(a), pta->getRegionFor(g));
+    EXPECT_NE(pta->getRegionFor(b), pta->getRegionFor(g));
+
+    // Derived pointers point into the same region.
+    EXPECT_EQ(pta->getRegionFor(b), pta->getRegionFor(b1));
+
+    for (auto v : { a, b, llvm::cast<llvm::Value>(g) }) {
+        EXPECT_NE(pta->getRegionFor(v), PointsToAnalysis::UnknownRegion);
+    }
+}
+
+TEST_F(PointsToAnalysisTest, UnifiesThroughPhisAndCalls)
+{
+    setUp(R"ASM(
+define void @set(i32* %p) {
+entry:
+  store i32 0, i32* %p, align 4
+  ret void
+}
+
+define i32 @main(i1 %c) {
+entry:
+  %a = alloca i32, align 4
+  %b = alloca i32, align 4
+  %d = alloca i32, align 4
+  br i1 %c, label %then, label %end
+then:
+  br label %end
+end:
+  %p = phi i32* [ %a, %entry ], [ %b, %then ]
+  call void @set(i32* %d)
+  store i32 1, i32* %p, align 4
+  %x = load i32, i32* %d, align 4
+  ret i32 %x
+}
+)ASM");
+
+    auto a = getValue("main", "a");
+    auto b = getValue("main", "b");
+    auto d = getValue("main", "d");
+    auto p = getValue("main", "p");
+    auto formal = &*module->getFunction("set")->arg_begin();
+
+    EXPECT_EQ(pta->getRegionFor(a), pta->getRegionFor(b));
+    EXPECT_EQ(pta->getRegionFor(a), pta->getRegionFor(p));
+    EXPECT_EQ(pta->getRegionFor(d), pta->getRegionFor(formal));
+    EXPECT_NE(pta->getRegionFor(a), pta->getRegionFor(d));
+}
+
+TEST_F(PointsToAnalysisTest, StoredPointersAreTracked)
+{
+    setUp(R"ASM(
+@ptr = global i32* null, align 8
+
+define i32 @main() {
+entry:
+  %a = alloca i32, align 4
+  %b = alloca i32, align 4
+  store i32* %a, i32** @ptr, align 8
+  %q = load i32*, i32** @ptr, align 8
+  store i32 1, i32* %q, align 4
+  store i32 2, i32* %b, align 4
+  %x = load i32, i32* %a, align 4
+  ret i32 %x
+}
+)ASM");
+
+    auto a = getValue("main", "a");
+    auto b = getValue("main", "b");
+    auto q = getValue("main", "q");
+
+    EXPECT_EQ(pta->getRegionFor(a), pta->getRegionFor(q));
+    EXPECT_NE(pta->getRegionFor(a), pta->getRegionFor(b));
+}
+
+TEST_F(PointsToAnalysisTest, EscapingPointersPointToUnknown)
+{
+    setUp(R"ASM(
+declare void @external(i32*)
+
+define i32 @main(i64 %addr) {
+entry:
+  %a = alloca i32, align 4
+  %b = alloca i32, align 4
+  %c = inttoptr i64 %addr to i32*
+  call void @external(i32* %a)
+  store i32 2, i32* %b, align 4
+  store i32 3, i32* %c, align 4
+  %x = load i32, i32* %a, align 4
+  ret i32 %x
+}
+)ASM");
+
+    auto a = getValue("main", "a");
+    auto b = getValue("main", "b");
+    auto c = getValue("main", "c");
+
+    EXPECT_EQ(pta->getRegionFor(a), PointsToAnalysis::UnknownRegion);
+    EXPECT_EQ(pta->getRegionFor(c), PointsToAnalysis::UnknownRegion);
+    EXPECT_NE(pta->getRegionFor(b), PointsToAnalysis::UnknownRegion);
+}
+
+TEST_F(PointsToAnalysisTest, PointersThroughIntegerMemoryPointToUnknown)
+{
+    setUp(R"ASM(
+define i32 @main(i64 %addr) {
+entry:
+  %a = alloca i32, align 4
+  %b = alloca i32, align 4
+  %c = alloca i32, align 4
+  %slot = alloca i32*, align 8
+  %slot2 = alloca i32*, align 8
+  store i32* %a, i32** %slot, align 8
+  %slot.int = bitcast i32** %slot to i64*
+  %v = load i64, i64* %slot.int, align 8
+  %p = inttoptr i64 %v to i32*
+  store i32 1, i32* %p, align 4
+  %slot2.int = bitcast i32** %slot2 to i64*
+  store i64 %addr, i64* %slot2.int, align 8
+  %q = load i32*, i32** %slot2, align 8
+  store i32 2, i32* %q, align 4
+  store i32 3, i32* %b, align 4
+  %x = load i32, i32* %c, align 4
+  ret i32 %x
+}
+)ASM");
+
+    auto a = getValue("main", "a");
+    auto b = getValue("main", "b");
+    auto q = getValue("main", "q");
+
+    // The pointer stored into the slot is reloaded as an integer.
+    EXPECT_EQ(pta->getRegionFor(a), PointsToAnalysis::UnknownRegion);
+
+    // The pointer loaded from the slot was stored as an integer.
+    EXPECT_EQ(pta->getRegionFor(q), PointsToAnalysis::UnknownRegion);
+    EXPECT_NE(pta->getRegionFor(b), PointsToAnalysis::UnknownRegion);
+}
+
+} // namespace
@@ -45,4 +45,51 @@ TEST(Z3ModelTest, Arrays)
     ASSERT_EQ(solver->getModel()->evaluate(ArrayReadExpr::Create(write, one)), one);
 }
 
+TEST(Z3ModelTest, WideBitVectors)
+{
+    GazerContext ctx;
+    Z3SolverFactory factory;
+
+    auto& bv128Ty = BvType::Get(ctx, 128);
+    auto x = ctx.createVariable("x", bv128Ty);
+
+    // A 128-bit value with bits set in both of its words
+    llvm::APInt value = llvm::APInt::getHighBitsSet(128, 3) | llvm::APInt(128, 0xDEADBEEF);
+    auto lit = BvLiteralExpr::Get(bv128Ty, value);
+
+    auto solver = factory.createSolver(ctx);
+    solver->add(EqExpr::Create(x->getRefExpr(), lit));
+
+    auto status = solver->run();
+
+    ASSERT_EQ(status, Solver::SAT);
+    ASSERT_EQ(solver->getModel()->evaluate(x->getRefExpr()), lit);
+}
+
+TEST(Z3ModelTest, FloatBitPatterns)
+{
+    GazerContext ctx;
+    Z3SolverFactory factory;
+
+    auto& halfTy = FloatType::Get(ctx, FloatType::Half);
+    auto& quadTy = FloatType::Get(ctx, FloatType::Quad);
+
+    auto h = ctx.createVariable("h", halfTy);
+    auto q = ctx.createVariable("q", quadTy);
+
+    auto halfLit = FloatLiteralExpr::Get(halfTy, llvm::APFloat(halfTy.getLLVMSemantics(), "1.5"));
+    auto quadLit = FloatLiteralExpr::Get(quadTy, llvm::APFloat(quadTy.getLLVMSemantics(), "-3.25"));
+
+    auto solver = factory.createSolver(ctx);
+    solver->add(FEqExpr::Create(h->getRefExpr(), halfLit));
+    solver->add(FEqExpr::Create(q->getRefExpr(), quadLit));
+
+    auto status = solver->run();
+    ASSERT_EQ(status, Solver::SAT);
+
+    auto model = solver->getModel();
+    ASSERT_EQ(model->evaluate(h->getRefExpr()), halfLit);
+    ASSERT_EQ(model->evaluate(q->getRefExpr()), quadLit);
+}
+
 } // namespace
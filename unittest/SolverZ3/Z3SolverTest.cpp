@@ -164,4 +164,15 @@ TEST(SolverZ3Test, Tuples)
 
     status = solver->run();
     EXPECT_EQ(status, Solver::UNSAT);
-}
\ No newline at end of file
+}
+
+TEST(SolverZ3Test, PrintVersion)
+{
+    Z3SolverFactory factory;
+
+    std::string buffer;
+    llvm::raw_string_ostream rso(buffer);
+    factory.printVersion(rso);
+
+    EXPECT_TRUE(llvm::StringRef(rso.str()).startswith("z3-"));
+}
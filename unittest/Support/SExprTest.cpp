@@ -25,31 +25,94 @@ using namespace gazer;
 namespace
 {
 
-TEST(SExprTest, TestParse)
+class SExprTest : public ::testing::Test
 {
-    EXPECT_EQ(*sexpr::parse("(A B\n \nC)"), *std::unique_ptr<sexpr::Value>(sexpr::list({
-        sexpr::atom("A"),
-        sexpr::atom("B"),
-        sexpr::atom("C")
-    })));
-
-    EXPECT_EQ(*sexpr::parse("(A (X Y Z))"), *std::unique_ptr<sexpr::Value>(sexpr::list({
-        sexpr::atom("A"),
-        sexpr::list({
-            sexpr::atom("X"),
-            sexpr::atom("Y"),
-            sexpr::atom("Z")
-        })
-    })));
-
-    EXPECT_EQ(*sexpr::parse("(A (X Y (Z)))"), *std::unique_ptr<sexpr::Value>(sexpr::list({
-        sexpr::atom("A"),
-        sexpr::list({
-            sexpr::atom("X"),
-            sexpr::atom("Y"),
-            sexpr::list({ sexpr::atom("Z") })
-        })
-    })));
+protected:
+    const sexpr::Value* parse(llvm::StringRef input)
+    {
+        sexpr::Parser parser(arena);
+        return parser.parse(input);
+    }
+
+    const sexpr::Value* a(llvm::StringRef data) { return arena.atom(data); }
+    const sexpr::Value* l(llvm::ArrayRef<const sexpr::Value*> elems) { return arena.list(elems); }
+
+protected:
+    sexpr::Arena arena;
+};
+
+TEST_F(SExprTest, TestParse)
+{
+    EXPECT_EQ(*parse("(A B\n \nC)"), *l({ a("A"), a("B"), a("C") }));
+    EXPECT_EQ(*parse("(A (X Y Z))"), *l({ a("A"), l({ a("X"), a("Y"), a("Z") }) }));
+    EXPECT_EQ(*parse("(A (X Y (Z)))"), *l({
+        a("A"),
+        l({ a("X"), a("Y"), l({ a("Z") }) })
+    }));
+
+    EXPECT_EQ(*parse("()"), *l({}));
+    EXPECT_EQ(*parse("  atom  "), *a("atom"));
+    EXPECT_NE(*parse("(A B)"), *l({ a("A"), a("C") }));
+    EXPECT_NE(*parse("(A B)"), *l({ a("A"), l({ a("B") }) }));
+}
+
+TEST_F(SExprTest, TestAtomsReferToInput)
+{
+    llvm::StringRef input = "(Trace (CfaState loc0))";
+    auto value = parse(input);
+    ASSERT_NE(value, nullptr);
+
+    llvm::StringRef loc = value->asList()[1]->asList()[1]->asAtom();
+    EXPECT_EQ(loc, "loc0");
+    EXPECT_EQ(loc.data(), input.data() + input.find("loc0"));
+}
+
+TEST_F(SExprTest, TestErrors)
+{
+    sexpr::Parser parser(arena);
+
+    EXPECT_EQ(parser.parse("(A\n  (B C)"), nullptr);
+    EXPECT_EQ(parser.getError(), "2:8: unexpected end of input, expected ')'");
+
+    EXPECT_EQ(parser.parse("\n\n  )"), nullptr);
+    EXPECT_EQ(parser.getError(), "3:3: unexpected ')'");
+
+    EXPECT_EQ(parser.parse("   "), nullptr);
+    EXPECT_EQ(parser.getError(), "1:4: empty input");
+}
+
+TEST_F(SExprTest, TestStreaming)
+{
+    llvm::StringRef input = "(Trace (CfaState loc0 (ExplState (x 1)))\n (CfaState loc12 (ExplState)))";
+
+    // Feed the input in every possible chunk size.
+    for (size_t chunkSize = 1; chunkSize <= input.size(); ++chunkSize) {
+        sexpr::Parser parser(arena);
+        for (size_t i = 0; i < input.size(); i += chunkSize) {
+            std::string chunk = input.substr(i, chunkSize).str();
+            ASSERT_TRUE(parser.feed(chunk));
+        }
+
+        auto value = parser.finish();
+        ASSERT_NE(value, nullptr) << parser.getError().str();
+        EXPECT_EQ(*value, *parse(input)) << "Chunk size: " << chunkSize;
+    }
+}
+
+TEST_F(SExprTest, TestDeepNesting)
+{
+    constexpr size_t depth = 100000;
+    std::string input = std::string(depth, '(') + "X" + std::string(depth, ')');
+
+    auto value = parse(input);
+    ASSERT_NE(value, nullptr);
+
+    std::string printed;
+    llvm::raw_string_ostream rso{printed};
+    value->print(rso);
+
+    EXPECT_EQ(rso.str(), input);
+    EXPECT_EQ(*value, *parse(input));
 }
 
-} // namespace
\ No newline at end of file
+} // namespace
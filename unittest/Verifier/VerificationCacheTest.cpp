@@ -0,0 +1,171 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+#include "gazer/Verifier/VerificationCache.h"
+#include "gazer/Automaton/Cfa.h"
+#include "gazer/Core/LiteralExpr.h"
+
+#include <llvm/Support/FileSystem.h>
+
+#include <gtest/gtest.h>
+
+using namespace gazer;
+
+namespace
+{
+
+class FakeTraceBuilder : public CfaTraceBuilder
+{
+public:
+    std::unique_ptr<Trace> build(
+        std::vector<Location*>& states,
+        std::vector<std::vector<VariableAssignment>>& actions) override
+    {
+        this->states = states;
+        this->actions = actions;
+        return std::make_unique<Trace>(std::vector<std::unique_ptr<TraceEvent>>());
+    }
+
+    std::vector<Location*> states;
+    std::vector<std::vector<VariableAssignment>> actions;
+};
+
+/// Fails with a trace through the first automaton of the system.
+class FakeAlgorithm : public VerificationAlgorithm
+{
+public:
+    std::unique_ptr<VerificationResult> check(
+        AutomataSystem& system, CfaTraceBuilder& traceBuilder) override
+    {
+        ++numChecks;
+        if (timeout) {
+            return VerificationResult::CreateTimeout();
+        }
+
+        Cfa& cfa = *system.begin();
+        Variable* x = cfa.findLocalByName("x");
+
+        std::vector<Location*> states = { cfa.getEntry(), cfa.getExit() };
+        std::vector<std::vector<VariableAssignment>> actions = {
+            { { x, BvLiteralExpr::Get(llvm::cast<BvType>(x->getType()), 5) } }
+        };
+
+        return VerificationResult::CreateFail(3, traceBuilder.build(states, actions));
+    }
+
+    void printSettings(llvm::raw_ostream& os) const override { os << "fake bound=" << bound; }
+
+    unsigned numChecks = 0;
+    unsigned bound = 1;
+    bool timeout = false;
+};
+
+class VerificationCacheTest : public ::testing::Test
+{
+protected:
+    VerificationCacheTest()
+        : system(ctx)
+    {
+        Cfa* main = system.createCfa("main");
+        Variable* x = main->createLocal("x", BvType::Get(ctx, 32));
+        main->createAssignTransition(main->getEntry(), main->getExit(), {
+            { x, BvLiteralExpr::Get(BvType::Get(ctx, 32), 5) }
+        });
+        system.setMainAutomaton(main);
+    }
+
+    void SetUp() override
+    {
+        ASSERT_FALSE(llvm::sys::fs::createUniqueDirectory("gazer-cache-test", directory));
+    }
+
+    void TearDown() override
+    {
+        llvm::sys::fs::remove_directories(directory);
+    }
+
+    std::unique_ptr<VerificationResult> check()
+    {
+        // Each run uses a new cache object, as separate processes would.
+        VerificationCache cache(directory.str().str());
+        auto result = cache.check(algorithm, system, traceBuilder);
+        numHits += cache.getNumHits();
+
+        return result;
+    }
+
+protected:
+    GazerContext ctx;
+    AutomataSystem system;
+    llvm::SmallString<128> directory;
+
+    FakeAlgorithm algorithm;
+    FakeTraceBuilder traceBuilder;
+    unsigned numHits = 0;
+};
+
+TEST_F(VerificationCacheTest, TestFailureWithTrace)
+{
+    auto first = check();
+    ASSERT_TRUE(first->isFail());
+    auto expectedStates = traceBuilder.states;
+    auto expectedActions = traceBuilder.actions;
+
+    traceBuilder.states.clear();
+    traceBuilder.actions.clear();
+
+    auto second = check();
+    EXPECT_EQ(algorithm.numChecks, 1);
+    EXPECT_EQ(numHits, 1);
+
+    ASSERT_TRUE(second->isFail());
+    auto fail = llvm::cast<FailResult>(second.get());
+    EXPECT_EQ(fail->getErrorID(), 3);
+    EXPECT_TRUE(fail->hasTrace());
+
+    // The trace is rebuilt from the same states and values.
+    EXPECT_EQ(traceBuilder.states, expectedStates);
+    EXPECT_EQ(traceBuilder.actions, expectedActions);
+}
+
+TEST_F(VerificationCacheTest, TestKeyCoversSettingsAndSystem)
+{
+    check();
+    algorithm.bound = 2;
+    check();
+    EXPECT_EQ(algorithm.numChecks, 2);
+
+    Cfa& main = *system.begin();
+    main.createAssignTransition(main.getEntry(), main.getExit());
+    check();
+    EXPECT_EQ(algorithm.numChecks, 3);
+
+    check();
+    EXPECT_EQ(algorithm.numChecks, 3);
+    EXPECT_EQ(numHits, 1);
+}
+
+TEST_F(VerificationCacheTest, TestTimeoutIsNotCached)
+{
+    algorithm.timeout = true;
+    EXPECT_EQ(check()->getStatus(), VerificationResult::Timeout);
+    EXPECT_EQ(check()->getStatus(), VerificationResult::Timeout);
+    EXPECT_EQ(algorithm.numChecks, 2);
+    EXPECT_EQ(numHits, 0);
+}
+
+} // end anonymous namespace
@@ -0,0 +1,166 @@
+//==-------------------------------------------------------------*- C++ -*--==//
+//
+// Copyright 2019 Contributors to the Gazer project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+#include "../../../tools/gazer-theta/lib/ThetaCfaGenerator.h"
+
+#include "gazer/Core/Expr/ExprBuilder.h"
+#include "gazer/Core/LiteralExpr.h"
+
+#include <gtest/gtest.h>
+
+using namespace gazer;
+
+namespace
+{
+
+TEST(ThetaCfaGeneratorTest, TestWriteCfa)
+{
+    GazerContext ctx;
+    AutomataSystem system(ctx);
+    auto builder = CreateExprBuilder(ctx);
+
+    Cfa* cfa = system.createCfa("main");
+    system.setMainAutomaton(cfa);
+
+    auto& intTy = IntType::Get(ctx);
+    Variable* x = cfa->createInput("x", intTy);
+    Variable* loc = cfa->createLocal("loc", intTy);
+    Variable* nondet = cfa->createLocal("nondet", intTy);
+
+    // Invalid characters are replaced, clashing names get a unique suffix.
+    Variable* clash1 = cfa->createLocal("a.b", intTy);
+    Variable* clash2 = cfa->createInput("a_b", intTy);
+
+    Location* loop = cfa->createLocation();
+    cfa->createAssignTransition(cfa->getEntry(), loop, {
+        { loc, x->getRefExpr() },
+        { nondet, builder->Undef(intTy) },
+        { clash1, clash2->getRefExpr() }
+    });
+    cfa->createAssignTransition(loop, loop, builder->Lt(loc->getRefExpr(), builder->IntLit(10)), {
+        { loc, builder->Add(loc->getRefExpr(), builder->IntLit(1)) }
+    });
+    cfa->createAssignTransition(loop, cfa->getExit(), builder->GtEq(loc->getRefExpr(), builder->IntLit(10)));
+
+    std::string buffer;
+    llvm::raw_string_ostream rso{buffer};
+
+    theta::ThetaNameMapping names;
+    theta::ThetaCfaGenerator generator{system};
+    generator.write(rso, names);
+
+    EXPECT_EQ(rso.str(), R"(main process __gazer_main_process {
+    var main_x : int
+    var main_a_b0 : int
+    var main_loc : int
+    var main_nondet : int
+    var main_a_b : int
+    var main___gazer_error_field : int
+    init loc loc0
+    final loc loc1
+    loc loc2
+    error loc loc3
+    loc0 -> loc2 {
+        main_loc := main_x
+        havoc main_nondet
+        main_a_b := main_a_b0
+    }
+
+    loc2 -> loc2 {
+        assume (main_loc < 10)
+        main_loc := (main_loc + 1)
+    }
+
+    loc2 -> loc1 {
+        assume (main_loc >= 10)
+    }
+
+    loc0 -> loc3 {
+        assume false
+        main___gazer_error_field := 0
+    }
+
+}
+)");
+
+    EXPECT_EQ(names.variables.lookup("main_a_b"), clash1);
+    EXPECT_EQ(names.variables.lookup("main_a_b0"), clash2);
+    EXPECT_EQ(names.locations["loc2"], loop);
+    EXPECT_EQ(names.errorLocation, names.locations["loc3"]);
+}
+
+TEST(ThetaCfaGeneratorTest, TestHavocDeadVariables)
+{
+    GazerContext ctx;
+    AutomataSystem system(ctx);
+    auto builder = CreateExprBuilder(ctx);
+
+    Cfa* cfa = system.createCfa("main");
+    system.setMainAutomaton(cfa);
+
+    auto& intTy = IntType::Get(ctx);
+    Variable* x = cfa->createInput("x", intTy);
+    Variable* y = cfa->createLocal("y", intTy);
+
+    Location* loc1 = cfa->createLocation();
+    Location* loc2 = cfa->createLocation();
+    cfa->createAssignTransition(cfa->getEntry(), loc1, {
+        { y, builder->Add(x->getRefExpr(), builder->IntLit(1)) }
+    });
+    cfa->createAssignTransition(loc1, loc2, builder->Gt(y->getRefExpr(), builder->IntLit(0)));
+    cfa->createAssignTransition(loc2, cfa->getExit());
+
+    std::string buffer;
+    llvm::raw_string_ostream rso{buffer};
+
+    theta::ThetaNameMapping names;
+    theta::ThetaCfaGenerator generator{system, /*havocDeadVariables=*/true};
+    generator.write(rso, names);
+
+    EXPECT_EQ(rso.str(), R"(main process __gazer_main_process {
+    var main_x : int
+    var main_y : int
+    var main___gazer_error_field : int
+    init loc loc0
+    final loc loc1
+    loc loc2
+    loc loc3
+    error loc loc4
+    loc0 -> loc2 {
+        main_y := (main_x + 1)
+        havoc main_x
+    }
+
+    loc2 -> loc3 {
+        assume (main_y > 0)
+        havoc main_y
+    }
+
+    loc3 -> loc1 {
+    }
+
+    loc0 -> loc4 {
+        assume false
+        main___gazer_error_field := 0
+        havoc main_x
+    }
+
+}
+)");
+}
+
+}